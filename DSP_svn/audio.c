@@ -15,267 +15,55 @@
 #include <math.h>
 
 #include "audio.h"
-#include "dma.h"
 #include "fixed_point.h"
+#include "period_tables.h"
 #include "uart.h"
 #include "utilities.h"
 #include "midi.h"
 #include "rng.h"
+#include "timer.h"
+#include "log.h"
+#include "trace.h"
 
 // =============================================================================
 // Private type definitions
 // =============================================================================
 
-/* ADSR envelope
- *
- * Attack - Decay - Substain - Release
- *
- *          Amplitude
- *              ^
- *              |
- * amplitude - -|- - ->*
- *              |     *  *
- *              |    *     *
- *         s - -| - * - - - -* * * * * * * * * *
- *              |  *                             *
- *              | *                                *
- *              |*                                   *
- *          0 - *--------------------------------------*-------> Time
- *              <------><---->                  <------>
- *                 a      d                         r
- */
-typedef enum adsr_state_t
-{
-    ADSR_STATE_OFF,
-    ADSR_STATE_ATTACK,
-    ADSR_STATE_DECAY,
-    ADSR_STATE_SUBSTAIN,
-    ADSR_STATE_RELEASE
-} adsr_state_t;
-
-typedef struct adsr_envelope_t
-{
-    bool            on;
-    bool            update_amplitude_event;
-    adsr_state_t    state;
-    uint8_t         attack;     // a
-    uint8_t         decay;      // d
-    uint8_t         substain;   // s
-    uint8_t         release;    // r
-    q16_16_t        amplitude_factor;
-    q16_16_t        substain_factor;
-    q16_16_t        attack_stepp;
-    q16_16_t        decay_stepp;
-    q16_16_t        release_stepp;
-} adsr_envelope_t;
-
-/*
- * Vibrato
- *
- * (frequency modulation)
- *
- *           Frequency
- *              ^       falling_edge           sampling frequency
- *              |           !                        <->
- *              |            ---                     ---
- *              |  stepp -> |   |                   |   |
- *              |        ---     ---             ---     ---
- *              |-------|-----------|-----------|-----------|--------> Time
- *              |    ---             ---     ---             ---
- *              |   |           stepp-> |   |                   |
- *  low_level-->|---                     ---                     ---
- *              |<---------------------->
- *                       period
- */
-typedef struct vibrato_t
-{
-    bool on;
-    uint8_t     depth;
-    uint8_t     rate;
-    bool        rising;
-    q16_16_t    falling_edge;
-    q16_16_t    period;
-    q16_16_t    time;
-    q16_16_t    low_level;
-    q16_16_t    stepp;
-} vibrato_t;
-
-
-/*
- * Portamento
- *
- *      Frequency
- *          ^                 duration
- *          |                  <---->
- *          |                  .    /---------------- . . . target_frequency
- *          |                  .   /
- *          |                  .  /
- *          |                  . /
- *          |------------------./
- *          |                  .
- *          |------------------.--------------------------> time
- *                             .
- *                          note on
- */
-typedef struct portamento_t
-{
-    bool        on;
-    bool        active;
-    q16_16_t    stepp;
-    q16_16_t    target_frequency;    
-} portamento_t;
-
-/*
- * Arpeggio
- *
- *      |----|)-------------6--------------------------6--------------
- *      |----/-----mmmmmmmmmmmmmmmmmmmmm----mmmmmmmmmmmmmmmmmmmmm-----
- *      |-- /|-----|---|---|---|---|---|----|---|---|---|---|---|-----
- *      |--/(|,\---|---|--@----|---|--@-----|---|--@----|---|--@------
- *      |--\_|_/---|--@--------|--@---------|--@--------|--@----------
- *         (_|   -@-         -@-          -@-         -@-
- */
-typedef struct arpeggio_t
-{
-    bool    on;
-    uint8_t speed;
-
-} arpeggio_t;
-
-
-/* Square wave type
- *
- *          Amplitude
- *              ^    rising_edge
- *              |        !
- * high_level-->|. . . . .------------------          ------------------
- *              |        |                  |        |                  |
- *              |--------|------------------|--------|------------------|-> Time
- *              |        |                  |        |                  |
- * low_level--->|--------                    --------                    -----
- *              |
- *              |<------------------------->
- *                         period
- */
-typedef struct square_wave_ch_t
-{
-    bool            note_on;
-    uint8_t         note_nbr;
-    uint8_t         duty;
-    bool            is_high;
-    int16_t         high_level;
-    int16_t         low_level;
-    int16_t         high_level_limit;
-    q16_16_t        rising_edge;
-    q16_16_t        period;
-    q16_16_t        time;
-    vibrato_t       vibrato;
-    adsr_envelope_t envelope;
-} square_wave_ch_t;
-
-/*
- * Triangle wave type
- *
- *          Amplitude
- *              ^       falling_edge           sampling frequency
- *              |           !                        <->
- *              |            ---                     ---
- *          up_step_size -> |   |                   |   |
- *              |        ---     ---             ---     ---
- *              |-------|-----------|-----------|-----------|---------> Time
- *              |    ---             ---     ---             ---
- *              |   |  down_step_size-> |   |                   |
- *  low_level-->|---                     ---                     ---
- *              |<---------------------->
- *                       period
- */
-typedef struct triangle_wave_ch_t
-{
-    bool            note_on;
-    uint8_t         note_nbr;
-    uint8_t         amplitude;
-    bool            is_rising;
-    uint8_t         duty;
-    int16_t         current_value;
-    int16_t         up_step_size;
-    int16_t         down_step_size;
-    int16_t         low_level;
-    q16_16_t        time;
-    q16_16_t        falling_edge;
-    q16_16_t        period;
-    vibrato_t       vibrato;
-} triangle_wave_ch_t;
-
-/* Noise wave type
- *
- *          Amplitude
- *              ^
- *              |
- * high_level-->|. . . . .----   -----        --      ----
- *              |        |    | |     |      |  |    |    |
- *              |--------|----|-|-----|------|--|----|----|--------> Time
- *              |        |    | |     |      |  |    |    |
- * low_level--->|--------      -       ------    ----      --------                    -----
- *              |
- *              |
- */
-typedef struct noise_wave_ch_t
-{
-    bool            note_on;
-    uint8_t         note_nbr;
-    uint8_t         prescaler;
-    uint8_t         counter;
-    bool            is_high;
-    uint16_t        amplitude;
-    uint16_t        current_amplitude;
-    int16_t         high_level;
-    int16_t         low_level;
-    int16_t         high_level_limit;
-    q16_16_t        time;
-    q16_16_t        period;
-    adsr_envelope_t envelope;
-} noise_wave_ch_t;
-
-
 // =============================================================================
 // Global variables
 // =============================================================================
-uint16_t g_audio_sample_buff_size = 0;
+
+// The engine of the device.
+audio_engine_t g_audio_engine;
 
 // =============================================================================
 // Private constants
 // =============================================================================
 // Since the amplitude in MIDI messages are [0, 255], the MIDI-amplitudes
-// are multiplied with these constats to form the square channel amplitudes.
-static const int16_t LOW_AMPLITUDE_FACTOR = (-32);
+// are multiplied with this constat to form the square channel amplitudes.
 static const int16_t HIGH_AMPLITUDE_FACTOR = (32);
 
-static const float ONE_CENT_CHANGE_FACTOR = 0.000561256873183065;
+static const float ONE_CENT_CHANGE_FACTOR = AUDIO_ONE_CENT_CHANGE_FACTOR;
 
-// =============================================================================
-// Private variables
-// =============================================================================
+// The number of modulation ticks a gain change is ramped over.
+static const uint8_t GAIN_RAMP_TICKS = 4;
 
-/*
- * Channels:
- * - 2 square channels
- * - 1 triangle channel
- * - 1 noise channel
- * 
- */
-static square_wave_ch_t     sq0;
-static square_wave_ch_t     sq1;
-static triangle_wave_ch_t   tri0;
-static noise_wave_ch_t      noise0;
+// The number of lines printed by audio_print_channel_status.
+#define SQUARE_STATUS_LINES     (18u)
+#define TRIANGLE_STATUS_LINES   (5u)
+
+#if (AUDIO_SCOPE_SIZE & (AUDIO_SCOPE_SIZE - 1)) != 0
+#error AUDIO_SCOPE_SIZE must be a power of two
+#endif
 
-static int16_t sample_buff[SAMPLE_BUFF_SIZE];
-static uint16_t sample_buff_first = 0;
-static uint16_t sample_buff_last = 0;
+#define AUDIO_SCOPE_MASK        (AUDIO_SCOPE_SIZE - 1)
 
-// Accumulates the samples of each channel
-static int16_t accumulator;
+// The stop index while waiting for the trigger, never reached by next.
+#define AUDIO_SCOPE_NO_STOP     (0xFFFFu)
 
-static q16_16_t midi_note_periods[MIDI_FREQUENCIES_SIZE];
+// =============================================================================
+// Private variables
+// =============================================================================
 
 // =============================================================================
 // Private function declarations
@@ -283,592 +71,810 @@ static q16_16_t midi_note_periods[MIDI_FREQUENCIES_SIZE];
 
 /**
  * @brief Pushes one sample into the sample buffer.
+ * @param engine - The engine.
  * @param sample - the sample to append to the buffer.
  * @return void
  */
-static inline void buffer_push(int16_t sample);
+static inline void buffer_push(audio_engine_t* engine, int16_t sample);
+
+/**
+ * @brief Records the current value of the scope source.
+ * @param engine - The engine.
+ * @return void
+ */
+static inline void record_scope_sample(audio_engine_t* engine);
+
+/**
+ * @brief Checks the recorded samples against the scope level and triggers
+ *        the scope at the first sample which reaches it.
+ * @param engine - The engine.
+ * @return void
+ */
+static void check_scope_level(audio_engine_t* engine);
+
+/**
+ * @brief Triggers the scope if it is armed.
+ * @details May be called from the interrupt context.
+ * @param engine - The engine.
+ * @return void
+ */
+static inline void scope_trigger(audio_engine_t* engine);
 
 /**
  * @brief Calculates the next sample of square wave channel 0.
  * @details The calculated sample is added to the accumulator.
+ * @param engine - The engine.
  * @return void
  */
-static inline void calc_sq0_sample(void);
+static inline void calc_sq0_sample(audio_engine_t* engine);
 
 /**
  * @brief Calculates the next sample of square wave channel 1.
  * @details The calculated sample is added to the accumulator.
+ * @param engine - The engine.
  * @return void
  */
-static inline void calc_sq1_sample(void);
+static inline void calc_sq1_sample(audio_engine_t* engine);
 
 /**
  * @brief Calculates the next sample of triangle wave channel 0.
  * @details The calculated sample is added to the accumulator.
+ * @param engine - The engine.
  * @return void
  */
-static inline void calc_tri0_sample(void);
+static inline void calc_tri0_sample(audio_engine_t* engine);
 
 /**
  * @brief Calculates the next sample of noise channel 0.
  * @details The calculated sample is added to the accumulator.
+ * @param engine - The engine.
+ * @return void
+ */
+static inline void calc_noise0_sample(audio_engine_t* engine);
+
+/**
+ * @brief Re-derives the timing of a square wave channel from its note after
+ *        the sample rate has been changed.
+ * @details Only the phase is rescaled, the period, the rising edge and the
+ *          vibrato steps are calculated from the new period table, so that
+ *          repeated changes do not accumulate rounding errors. The vibrato
+ *          keeps its position within its cycle.
+ * @param engine - The engine, with the new period table.
+ * @param ch - The channel.
+ * @param ratio - The new sample rate divided by the old sample rate.
  * @return void
  */
-static inline void calc_noise0_sample(void);
+static void rederive_square_ch(audio_engine_t* engine,
+                               square_wave_ch_t* ch,
+                               q16_16_t ratio);
 
 /**
  * @brief Updates the square 0 vibrator modulation.
- * @param void
+ * @param engine - The engine.
  * @return void
  */
-static inline void modulate_sq0_vibrato(void);
+static inline void modulate_sq0_vibrato(audio_engine_t* engine);
 
 /**
  * @brief Updates the square 1 vibrator modulation.
- * @param void
+ * @param engine - The engine.
  * @return void
  */
-static inline void modulate_sq1_vibrato(void);
+static inline void modulate_sq1_vibrato(audio_engine_t* engine);
 
 /**
  * @brief Updates the square 0 amplitude adsr envelope.
- * @param void
+ * @param engine - The engine.
  * @return void
  */
-static inline void modulate_sq0_adsr(void);
+static inline void modulate_sq0_adsr(audio_engine_t* engine);
 
 /**
  * @brief Updates the square 1 amplitude adsr envelope.
- * @param void
+ * @param engine - The engine.
  * @return void
  */
-static inline void modulate_sq1_adsr(void);
+static inline void modulate_sq1_adsr(audio_engine_t* engine);
 
 /**
  * @brief Updates the noise 0 amplude adsr envelope.
- * @param void
+ * @param engine - The engine.
+ * @return void
+ */
+static inline void modulate_noise0_adsr(audio_engine_t* engine);
+
+/**
+ * @brief Scales a channel level with the envelope and the channel gain.
+ * @param limit - The level at full amplitude.
+ * @param envelope_factor - The current envelope amplitude factor.
+ * @param gain - The current channel gain.
+ * @return The scaled level.
+ */
+static inline int16_t scale_level(int16_t limit,
+                                  q16_16_t envelope_factor,
+                                  q16_16_t gain);
+
+/**
+ * @brief Recalculates the triangle 0 levels and step sizes.
+ * @details Uses the amplitude, the period, the falling edge and the gain
+ *          of the channel. Does nothing if no note is playing.
+ * @param engine - The engine.
+ * @return void
+ */
+static void update_tri0_levels(audio_engine_t* engine);
+
+/**
+ * @brief Recalculates the target gain of all channels.
+ * @details Must be called when a volume, mute or solo setting changes.
+ * @param engine - The engine.
+ * @return void
+ */
+static void update_gain_targets(audio_engine_t* engine);
+
+/**
+ * @brief Moves the gain of all channels one step towards their targets.
+ * @param engine - The engine.
+ * @return void
+ */
+static inline void ramp_gains(audio_engine_t* engine);
+
+/**
+ * @brief Restarts the vibrato of a square wave channel around its note.
+ * @details Uses the precalculated falling edge and depth factor, so that no
+ *          floating point arithmetic is needed when a note is started.
+ * @param engine - The engine.
+ * @param ch - The channel.
+ * @return void
+ */
+static void restart_vibrato(audio_engine_t* engine, square_wave_ch_t* ch);
+
+/**
+ * @brief Calculates the lowest period and the step size of the vibrato of a
+ *        square wave channel from the period of its note.
+ * @param engine - The engine.
+ * @param ch - The channel.
+ * @return void
+ */
+static void calc_vibrato_steps(audio_engine_t* engine, square_wave_ch_t* ch);
+
+/**
+ * @brief Loads the envelope part of a patch.
+ * @param env - The envelope to load into.
+ * @param adsr - The envelope settings of the patch.
  * @return void
  */
-static inline void modulate_noise0_adsr(void);
+static void load_envelope(adsr_envelope_t* env,
+                          const audio_patch_adsr_t* adsr);
+
+/**
+ * @brief Calculates the time step which bends a channel by some cents.
+ * @details The bend is split in whole semitones and remaining cents, and
+ *          the ratio of each is looked up in the period tables.
+ * @param cents - The bend in cents, up is positive.
+ * @return The time step per sample.
+ */
+static q16_16_t bend_time_step(int16_t cents);
+
+/**
+ * @brief Prints one line of the status of a square wave channel.
+ * @param ch - The channel.
+ * @param line - The line to print, from 0.
+ * @return True if there are more lines after this one.
+ */
+static bool print_square_status_line(const square_wave_ch_t* ch,
+                                     uint8_t line);
+
+/**
+ * @brief Prints one line of the status of a triangle wave channel.
+ * @param ch - The channel.
+ * @param line - The line to print, from 0.
+ * @return True if there are more lines after this one.
+ */
+static bool print_triangle_status_line(const triangle_wave_ch_t* ch,
+                                       uint8_t line);
 
 // =============================================================================
 // Public function definitions
 // =============================================================================
 
-void audio_init(void)
+void audio_init(audio_engine_t* engine)
 {
-    uint16_t i;
-    double freq;
+    uint8_t i;
 
     rng_init();
-    midi_freq_table_init();
+
+    // Fields which are not set below start from zero
+    memset(engine, 0, sizeof(audio_engine_t));
+
+    engine->sample_rate_index = PERIOD_TABLES_DEFAULT_RATE_INDEX;
+    engine->midi_note_periods =
+        g_period_tables_note_periods[engine->sample_rate_index];
+    engine->sample_rate_factor = Q16_16_T_ONE;
+
+    audio_set_sample_buff_depth(engine, SAMPLE_BUFF_DEFAULT_DEPTH);
+    engine->modulation_divider = 1;
+    engine->modulation_counter = 0;
 
     //
-    // Initialize midi_note_periods
+    // Initialize all channels
     //
-    for (i = 0; i != MIDI_FREQUENCIES_SIZE; ++i)
+    memset(engine->channel_enabled, true, sizeof(engine->channel_enabled));
+
+    memset(engine->channel_gain, 0, sizeof(engine->channel_gain));
+    engine->master_volume = AUDIO_VOLUME_MAX;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
     {
-        freq = (double)SAMPLE_FREQ_HZ / g_midi_frequencies[i];
-        midi_note_periods[i] = double_to_q16_16(freq);
+        engine->channel_gain[i].volume = AUDIO_VOLUME_MAX;
     }
 
-    //
-    // Initialize all channels
-    //
-    memset(&sq0, 0, sizeof(square_wave_ch_t));
-    memset(&sq1, 0, sizeof(square_wave_ch_t));
-    memset(&tri0, 0, sizeof(triangle_wave_ch_t));
-    memset(&noise0, 0, sizeof(noise_wave_ch_t));
+    update_gain_targets(engine);
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        engine->channel_gain[i].gain = engine->channel_gain[i].target;
+    }
 
-    sq0.duty = 64;
-    sq1.duty = 127;
-    tri0.duty = 32;
+    memset(&engine->sq0, 0, sizeof(square_wave_ch_t));
+    memset(&engine->sq1, 0, sizeof(square_wave_ch_t));
+    memset(&engine->tri0, 0, sizeof(triangle_wave_ch_t));
+    memset(&engine->noise0, 0, sizeof(noise_wave_ch_t));
+
+    engine->sq0.duty = 64;
+    engine->sq1.duty = 127;
+    engine->tri0.duty = 32;
+
+    engine->sq0.time_step = Q16_16_T_ONE;
+    engine->sq1.time_step = Q16_16_T_ONE;
+    engine->tri0.time_step = Q16_16_T_ONE;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        engine->pitch_bend[i] = AUDIO_PITCH_BEND_CENTER;
+        engine->pitch_bend_range[i] = AUDIO_PITCH_BEND_DEFAULT_RANGE;
+    }
 
     // TODO remove me
 #if 0
-    sq0.note_on = true;
-    sq0.duty = 128;
-    sq0.low_level = -6000;
-    sq0.high_level = 6000;
-    sq0.period = midi_note_periods[MIDI_NOTE_C3];
-    sq0.rising_edge = sq0.period / 2;
+    engine->sq0.note_on = true;
+    engine->sq0.duty = 128;
+    engine->sq0.low_level = -6000;
+    engine->sq0.high_level = 6000;
+    engine->sq0.period = engine->midi_note_periods[MIDI_NOTE_C3];
+    engine->sq0.rising_edge = engine->sq0.period / 2;
 #endif
 #if 0
-    sq1.note_on = true;
-    sq1.duty = 128;
-    sq1.low_level = -6000;
-    sq1.high_level = 6000;
-    sq1.period = midi_note_periods[MIDI_NOTE_E3];
-    sq1.rising_edge = sq1.period / 2;
+    engine->sq1.note_on = true;
+    engine->sq1.duty = 128;
+    engine->sq1.low_level = -6000;
+    engine->sq1.high_level = 6000;
+    engine->sq1.period = engine->midi_note_periods[MIDI_NOTE_E3];
+    engine->sq1.rising_edge = engine->sq1.period / 2;
 #endif
 #if 0
-    tri0.note_on = true;
-    tri0.low_level = -16000;
-    tri0.period = midi_note_periods[MIDI_NOTE_G3];
-    tri0.falling_edge = tri0.period / 2;
-    tri0.up_step_size = 200;
-    tri0.down_step_size = -200;
+    engine->tri0.note_on = true;
+    engine->tri0.low_level = -16000;
+    engine->tri0.period = engine->midi_note_periods[MIDI_NOTE_G3];
+    engine->tri0.falling_edge = engine->tri0.period / 2;
+    engine->tri0.up_step_size = 200;
+    engine->tri0.down_step_size = -200;
 #endif
 #if 0
-    sq0.duty = 128;
-    audio_note_on(AUDIO_CH_SQUARE0, MIDI_NOTE_E4, 32);
+    engine->sq0.duty = 128;
+    audio_note_on(engine, AUDIO_CH_SQUARE0, MIDI_NOTE_E4, 32);
 #endif
 #if 0
-    sq1.duty = 128;
-    audio_note_on(AUDIO_CH_SQUARE1, MIDI_NOTE_G4, 32);
+    engine->sq1.duty = 128;
+    audio_note_on(engine, AUDIO_CH_SQUARE1, MIDI_NOTE_G4, 32);
 #endif
 #if 0
-    tri0.duty = 128;
-    audio_note_on(AUDIO_CH_TRIANGLE0, MIDI_NOTE_C3, 128);
+    engine->tri0.duty = 128;
+    audio_note_on(engine, AUDIO_CH_TRIANGLE0, MIDI_NOTE_C3, 128);
 #endif
 #if 1
-    audio_configure_amplitude_adsr(AUDIO_CH_SQUARE0,
-                                   0,  // a
-                                   10,  // d
-                                   5,  // s
-                                   50); // r
-    //audio_amplitude_adsr_on(AUDIO_CH_SQUARE0);
-
-    audio_configure_amplitude_adsr(AUDIO_CH_SQUARE1,
-                                   0,  // a
-                                   10,  // d
-                                   5,  // s
-                                   50); // r
-    //audio_amplitude_adsr_on(AUDIO_CH_SQUARE1);
-
-    audio_configure_amplitude_adsr(AUDIO_CH_NOISE0,
-                                   2,  // a
-                                   6,  // d
-                                   0,  // s
-                                   0); // r
-    audio_amplitude_adsr_on(AUDIO_CH_NOISE0);
-
-    audio_configure_vibrato(AUDIO_CH_SQUARE0, 115, 30);
-    audio_vibrato_on(AUDIO_CH_SQUARE0);
-
-    audio_configure_vibrato(AUDIO_CH_SQUARE1, 115, 30);
-    audio_vibrato_on(AUDIO_CH_SQUARE1);
-
-    audio_note_on(AUDIO_CH_SQUARE0, MIDI_NOTE_E4, 32);
-    audio_note_on(AUDIO_CH_SQUARE1, MIDI_NOTE_G4, 32);
-    audio_note_on(AUDIO_CH_TRIANGLE0, MIDI_NOTE_C3, 92);
+    // The channel settings are loaded from the patch bank, see patch.c
+    audio_note_on(engine, AUDIO_CH_SQUARE0, MIDI_NOTE_E4, 32);
+    audio_note_on(engine, AUDIO_CH_SQUARE1, MIDI_NOTE_G4, 32);
+    audio_note_on(engine, AUDIO_CH_TRIANGLE0, MIDI_NOTE_C3, 92);
 #endif
 }
 
-void audio_calc_sample(void)
+void audio_calc_sample(audio_engine_t* engine)
 {
     // Accumulate the samples for each channel
-    accumulator = 0;
+    engine->accumulator = 0;
+
+    if (engine->channel_enabled[AUDIO_CH_SQUARE0])
+    {
+        calc_sq0_sample(engine);
+    }
+
+    if (engine->channel_enabled[AUDIO_CH_SQUARE1])
+    {
+        calc_sq1_sample(engine);
+    }
+
+    if (engine->channel_enabled[AUDIO_CH_TRIANGLE0])
+    {
+        calc_tri0_sample(engine);
+    }
+
+    if (engine->channel_enabled[AUDIO_CH_NOISE0])
+    {
+        calc_noise0_sample(engine);
+    }
+
+    if (engine->scope.state >= AUDIO_SCOPE_ARMED)
+    {
+        record_scope_sample(engine);
+    }
 
-    calc_sq0_sample();
-    calc_sq1_sample();
-    calc_tri0_sample();
-    calc_noise0_sample();
+    buffer_push(engine, engine->accumulator);
+    ++engine->sample_index;
+}
+
+void audio_calc_samples(audio_engine_t* engine, uint16_t nbr_of_samples)
+{
+    while (0 != nbr_of_samples--)
+    {
+        audio_calc_sample(engine);
+    }
 
-    buffer_push(accumulator);
+    if ((AUDIO_SCOPE_ARMED == engine->scope.state) &&
+        (AUDIO_SCOPE_TRIGGER_LEVEL == engine->scope.trigger))
+    {
+        check_scope_level(engine);
+    }
 }
 
-void audio_apply_modulation(void)
-{ 
-    if (sq0.vibrato.on)
+void audio_apply_modulation(audio_engine_t* engine)
+{
+    ramp_gains(engine);
+
+    if (++engine->modulation_counter < engine->modulation_divider)
+    {
+        return;
+    }
+
+    engine->modulation_counter = 0;
+
+    if (engine->sq0.vibrato.on)
     {
-        modulate_sq0_vibrato();
+        modulate_sq0_vibrato(engine);
     }
 
-    if (sq1.vibrato.on)
+    if (engine->sq1.vibrato.on)
     {
-        modulate_sq1_vibrato();
+        modulate_sq1_vibrato(engine);
     }
 
-    if (sq0.envelope.on)
+    if (engine->sq0.envelope.on)
     {
-        modulate_sq0_adsr();
+        modulate_sq0_adsr(engine);
     }
 
-    if (sq1.envelope.on)
+    if (engine->sq1.envelope.on)
     {
-        modulate_sq1_adsr();
+        modulate_sq1_adsr(engine);
     }
 
-    if (noise0.envelope.on)
+    if (engine->noise0.envelope.on)
     {
-        modulate_noise0_adsr();
+        modulate_noise0_adsr(engine);
     }
 }
 
-int16_t audio_pop_sample(void)
+int16_t audio_pop_sample(audio_engine_t* engine)
 {
-    int16_t return_val = sample_buff[sample_buff_first];
+    int16_t return_val = engine->sample_buff[engine->sample_buff_first];
+
+    engine->sample_buff_first =
+        (engine->sample_buff_first + 1) & engine->sample_buff_mask;
 
-    if (++sample_buff_first == SAMPLE_BUFF_SIZE)
+    --engine->sample_buff_size;
+
+    if (engine->sample_buff_size < engine->sample_buff_low_water)
     {
-        sample_buff_first = 0;
+        engine->sample_buff_low_water = engine->sample_buff_size;
     }
 
-    --g_audio_sample_buff_size;
+    if (engine->sample_buff_size < engine->stats_min_fill)
+    {
+        engine->stats_min_fill = engine->sample_buff_size;
+    }
 
     return return_val;
 }
 
-void audio_note_on(audio_ch_nbr_t channel, midi_notes_t note_nbr, uint8_t velocity)
+bool audio_set_sample_buff_depth(audio_engine_t* engine, uint16_t depth)
+{
+    if ((depth < SAMPLE_BUFF_MIN_DEPTH) ||
+        (depth > SAMPLE_BUFF_POOL_SIZE) ||
+        (0 != (depth & (depth - 1))))
+    {
+        log_write(LOG_AUDIO_INVALID_BUFF_DEPTH, depth, 0, 0);
+
+        return false;
+    }
+
+    engine->sample_buff_depth = depth;
+    engine->sample_buff_mask = depth - 1;
+
+    engine->sample_buff_first = 0;
+    engine->sample_buff_next = 0;
+    engine->sample_buff_size = 0;
+
+    engine->sample_buff_low_water = SAMPLE_BUFF_POOL_SIZE;
+    audio_reset_stats(engine);
+
+    return true;
+}
+
+uint32_t audio_get_latency_us(audio_engine_t* engine)
+{
+    return ((uint32_t)engine->sample_buff_depth * 1000000UL) /
+           audio_get_sample_freq(engine);
+}
+
+uint16_t audio_get_and_reset_low_water_mark(audio_engine_t* engine)
+{
+    uint16_t low_water = engine->sample_buff_low_water;
+
+    engine->sample_buff_low_water = engine->sample_buff_size;
+
+    return low_water;
+}
+
+void audio_note_on(audio_engine_t* engine,
+                   audio_ch_nbr_t channel,
+                   midi_notes_t note_nbr, uint8_t velocity)
 {
     q16_16_t tmp;
 
+    TRACE_INSTANT(TRACE_NOTE_ON, channel, note_nbr);
+
+    if ((AUDIO_SCOPE_TRIGGER_NOTE_ON == engine->scope.trigger) &&
+        ((AUDIO_SCOPE_MIX == engine->scope.source) ||
+         (channel == engine->scope.source)))
+    {
+        scope_trigger(engine);
+    }
+
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sq0.note_nbr = note_nbr;
-        sq0.is_high = false;
-        sq0.high_level_limit = HIGH_AMPLITUDE_FACTOR * velocity;
-        sq0.time = 0;
-        sq0.period = midi_note_periods[note_nbr];
-        tmp = sq0.period / UINT8_MAX;
-        sq0.rising_edge = tmp * sq0.duty;
-
-        if (sq0.vibrato.on)
+        engine->sq0.note_nbr = note_nbr;
+        engine->sq0.is_high = false;
+        engine->sq0.high_level_limit = HIGH_AMPLITUDE_FACTOR * velocity;
+        engine->sq0.time = 0;
+        engine->sq0.period = engine->midi_note_periods[note_nbr];
+        tmp = engine->sq0.period / UINT8_MAX;
+        engine->sq0.rising_edge = tmp * engine->sq0.duty;
+
+        if (engine->sq0.vibrato.on)
         {
-            audio_configure_vibrato(channel,
-                                    sq0.vibrato.rate,
-                                    sq0.vibrato.depth);
+            restart_vibrato(engine, &engine->sq0);
         }
 
-        if (sq0.envelope.on)
+        if (engine->sq0.envelope.on)
         {
-            sq0.low_level = 0;
-            sq0.high_level = 0;
-            sq0.envelope.amplitude_factor = 0;
-            sq0.envelope.state = ADSR_STATE_ATTACK;
-            sq0.envelope.update_amplitude_event = true;
+            engine->sq0.low_level = 0;
+            engine->sq0.high_level = 0;
+            engine->sq0.envelope.amplitude_factor = 0;
+            engine->sq0.envelope.state = ADSR_STATE_ATTACK;
+            engine->sq0.envelope.update_amplitude_event = true;
         }
         else
         {
-            sq0.high_level = sq0.high_level_limit;
-            sq0.low_level = (-1) * sq0.high_level;
+            engine->sq0.envelope.amplitude_factor = Q16_16_T_ONE;
+            engine->sq0.high_level =
+                scale_level(engine->sq0.high_level_limit,
+                            engine->sq0.envelope.amplitude_factor,
+                            engine->channel_gain[AUDIO_CH_SQUARE0].gain);
+            engine->sq0.low_level = (-1) * engine->sq0.high_level;
         }
 
-        sq0.note_on = true;
+        engine->sq0.note_on = true;
         break;
 
     case AUDIO_CH_SQUARE1:
-        sq1.note_nbr = note_nbr;
-        sq1.is_high = false;
-        sq1.high_level_limit = HIGH_AMPLITUDE_FACTOR * velocity;
-        sq1.time = 0;
-        sq1.period = midi_note_periods[note_nbr];
-        tmp = sq1.period / UINT8_MAX;
-        sq1.rising_edge = tmp * sq1.duty;
-
-        if (sq1.vibrato.on)
+        engine->sq1.note_nbr = note_nbr;
+        engine->sq1.is_high = false;
+        engine->sq1.high_level_limit = HIGH_AMPLITUDE_FACTOR * velocity;
+        engine->sq1.time = 0;
+        engine->sq1.period = engine->midi_note_periods[note_nbr];
+        tmp = engine->sq1.period / UINT8_MAX;
+        engine->sq1.rising_edge = tmp * engine->sq1.duty;
+
+        if (engine->sq1.vibrato.on)
         {
-            audio_configure_vibrato(channel,
-                                    sq1.vibrato.rate,
-                                    sq1.vibrato.depth);
+            restart_vibrato(engine, &engine->sq1);
         }
 
-        if (sq1.envelope.on)
+        if (engine->sq1.envelope.on)
         {
-            sq1.low_level = 0;
-            sq1.high_level = 0;
-            sq1.envelope.amplitude_factor = 0;
-            sq1.envelope.state = ADSR_STATE_ATTACK;
-            sq1.envelope.update_amplitude_event = true;
+            engine->sq1.low_level = 0;
+            engine->sq1.high_level = 0;
+            engine->sq1.envelope.amplitude_factor = 0;
+            engine->sq1.envelope.state = ADSR_STATE_ATTACK;
+            engine->sq1.envelope.update_amplitude_event = true;
         }
         else
         {
-            sq1.high_level = sq1.high_level_limit;
-            sq1.low_level = (-1) * sq1.high_level;
+            engine->sq1.envelope.amplitude_factor = Q16_16_T_ONE;
+            engine->sq1.high_level =
+                scale_level(engine->sq1.high_level_limit,
+                            engine->sq1.envelope.amplitude_factor,
+                            engine->channel_gain[AUDIO_CH_SQUARE1].gain);
+            engine->sq1.low_level = (-1) * engine->sq1.high_level;
         }
 
-        sq1.note_on = true;
+        engine->sq1.note_on = true;
         break;
 
     case AUDIO_CH_TRIANGLE0:
-        tri0.note_nbr = note_nbr;
-        tri0.amplitude = velocity;
-        tri0.is_rising = true;
-        tri0.low_level = (LOW_AMPLITUDE_FACTOR / 2) * velocity;
-        tri0.time = 0;
-        tri0.period = midi_note_periods[note_nbr];
-        tmp = tri0.period / UINT8_MAX;
-        tri0.falling_edge = tmp * tri0.duty;
-        tri0.up_step_size = (int16_t)q16_16_to_int(
-            q16_16_divide(
-                int_to_q16_16(velocity * HIGH_AMPLITUDE_FACTOR),
-                tri0.falling_edge));
-        tri0.down_step_size = (-1) * (int16_t)q16_16_to_int(
-            q16_16_divide(
-                int_to_q16_16(velocity * HIGH_AMPLITUDE_FACTOR),
-                tri0.period - tri0.falling_edge));
-        tri0.current_value = tri0.low_level;
-        tri0.note_on = true;
+        engine->tri0.note_nbr = note_nbr;
+        engine->tri0.amplitude = velocity;
+        engine->tri0.is_rising = true;
+        engine->tri0.time = 0;
+        engine->tri0.period = engine->midi_note_periods[note_nbr];
+        tmp = engine->tri0.period / UINT8_MAX;
+        engine->tri0.falling_edge = tmp * engine->tri0.duty;
+        engine->tri0.note_on = true;
+        update_tri0_levels(engine);
+        engine->tri0.current_value = engine->tri0.low_level;
         break;
 
     case AUDIO_CH_NOISE0:
-        noise0.note_nbr = note_nbr;
-        noise0.prescaler = 128 - note_nbr;
-        noise0.counter = noise0.prescaler;
-        noise0.high_level_limit = velocity * HIGH_AMPLITUDE_FACTOR;
-        noise0.time = 0;
-        noise0.period = midi_note_periods[note_nbr];
-
-        if (noise0.envelope.on)
+        engine->noise0.note_nbr = note_nbr;
+        engine->noise0.prescaler = q16_16_to_int(q16_16_multiply(
+            int_to_q16_16(128 - note_nbr), engine->sample_rate_factor));
+        engine->noise0.counter = engine->noise0.prescaler;
+        engine->noise0.high_level_limit = velocity * HIGH_AMPLITUDE_FACTOR;
+        engine->noise0.time = 0;
+        engine->noise0.period = engine->midi_note_periods[note_nbr];
+
+        if (engine->noise0.envelope.on)
         {
-            noise0.current_amplitude = 0;
-            noise0.envelope.amplitude_factor = 0;
-            noise0.high_level = 0;
-            noise0.low_level = 0;
-            noise0.envelope.state = ADSR_STATE_ATTACK;
-            noise0.envelope.update_amplitude_event = true;
+            engine->noise0.current_amplitude = 0;
+            engine->noise0.envelope.amplitude_factor = 0;
+            engine->noise0.high_level = 0;
+            engine->noise0.low_level = 0;
+            engine->noise0.envelope.state = ADSR_STATE_ATTACK;
+            engine->noise0.envelope.update_amplitude_event = true;
         }
         else
         {
-            noise0.high_level = noise0.high_level_limit;
-            noise0.low_level = 0 - noise0.high_level;
+            engine->noise0.envelope.amplitude_factor = Q16_16_T_ONE;
+            engine->noise0.high_level =
+                scale_level(engine->noise0.high_level_limit,
+                            engine->noise0.envelope.amplitude_factor,
+                            engine->channel_gain[AUDIO_CH_NOISE0].gain);
+            engine->noise0.low_level = 0 - engine->noise0.high_level;
         }
 
-        noise0.note_on = true;
+        engine->noise0.note_on = true;
         break;
 
     default:
-#ifdef DEBUG
-    sprintf(g_utilities_char_buffer,
-            "%s Channel %d does not exist. (Note on: ch: %d, note: %d, vel: %d)%s",
-                    WARNING_TAG, channel, channel, note_nbr, velocity, NEWLINE);
-    uart_write_string(g_utilities_char_buffer);
-#endif
+        log_write(LOG_AUDIO_NOTE_ON_INVALID_CH, channel, note_nbr, velocity);
         break;
     }
 }
 
-void audio_note_off(audio_ch_nbr_t channel)
+void audio_note_off(audio_engine_t* engine, audio_ch_nbr_t channel)
 {
+    TRACE_INSTANT(TRACE_NOTE_OFF, channel, 0);
+
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sq0.note_on = false;
+        engine->sq0.note_on = false;
         
-        if (sq0.envelope.on)
+        if (engine->sq0.envelope.on)
         {
-            sq0.envelope.state = ADSR_STATE_RELEASE;
+            engine->sq0.envelope.state = ADSR_STATE_RELEASE;
         }
         else
         {
-            sq0.low_level = 0;
-            sq0.high_level = 0;
+            engine->sq0.high_level_limit = 0;
+            engine->sq0.low_level = 0;
+            engine->sq0.high_level = 0;
         }
         
         break;
 
     case AUDIO_CH_SQUARE1:
-        sq1.note_on = false;
+        engine->sq1.note_on = false;
 
-        if (sq1.envelope.on)
+        if (engine->sq1.envelope.on)
         {
-            sq1.envelope.state = ADSR_STATE_RELEASE;
+            engine->sq1.envelope.state = ADSR_STATE_RELEASE;
         }
         else
         {
-            sq1.low_level = 0;
-            sq1.high_level = 0;
+            engine->sq1.high_level_limit = 0;
+            engine->sq1.low_level = 0;
+            engine->sq1.high_level = 0;
         }
         break;
 
     case AUDIO_CH_TRIANGLE0:
-        tri0.note_on = false;
-        tri0.low_level = 0;
-        tri0.up_step_size = 0;
-        tri0.down_step_size = 0;
+        engine->tri0.note_on = false;
+        engine->tri0.low_level = 0;
+        engine->tri0.up_step_size = 0;
+        engine->tri0.down_step_size = 0;
         break;
 
     case AUDIO_CH_NOISE0:
-        noise0.note_on = false;
+        engine->noise0.note_on = false;
 
-        if (noise0.envelope.on)
+        if (engine->noise0.envelope.on)
         {
-            noise0.envelope.state = ADSR_STATE_RELEASE;
+            engine->noise0.envelope.state = ADSR_STATE_RELEASE;
         }
         else
         {
-            noise0.low_level = 0;
-            noise0.high_level = 0;
+            engine->noise0.high_level_limit = 0;
+            engine->noise0.low_level = 0;
+            engine->noise0.high_level = 0;
         }
         break;
 
     default:
-#ifdef DEBUG
-    sprintf(g_utilities_char_buffer,
-            "%s Channel %d does not exist. Note off: ch: %d%s",
-                    WARNING_TAG, channel, channel, NEWLINE);
-    uart_write_string(g_utilities_char_buffer);
-#endif
+        log_write(LOG_AUDIO_NOTE_OFF_INVALID_CH, channel, 0, 0);
         break;
     }
 }
 
-void audio_set_duty(audio_ch_nbr_t channel, uint8_t duty)
+void audio_set_duty(audio_engine_t* engine,
+                    audio_ch_nbr_t channel,
+                    uint8_t duty)
 {
     q16_16_t tmp;
 
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sq0.duty = duty;
-        tmp = sq0.period / UINT8_MAX;
-        sq0.rising_edge = tmp * sq0.duty;
+        engine->sq0.duty = duty;
+        tmp = engine->sq0.period / UINT8_MAX;
+        engine->sq0.rising_edge = tmp * engine->sq0.duty;
         break;
 
     case AUDIO_CH_SQUARE1:
-        sq1.duty = duty;
-        tmp = sq1.period / UINT8_MAX;
-        sq1.rising_edge = tmp * sq1.duty;
+        engine->sq1.duty = duty;
+        tmp = engine->sq1.period / UINT8_MAX;
+        engine->sq1.rising_edge = tmp * engine->sq1.duty;
         break;
 
     case AUDIO_CH_TRIANGLE0:
-        tri0.duty = duty;
-        tmp = tri0.period / UINT8_MAX;
-        tri0.falling_edge = tmp * tri0.duty;
-        tri0.up_step_size = (int16_t)q16_16_to_int(
-            q16_16_divide(
-                int_to_q16_16(tri0.amplitude * HIGH_AMPLITUDE_FACTOR),
-                tri0.falling_edge));
-        tri0.down_step_size = (-1) * (int16_t)q16_16_to_int(
-            q16_16_divide(
-                int_to_q16_16(tri0.amplitude * HIGH_AMPLITUDE_FACTOR),
-                tri0.period - tri0.falling_edge));
+        engine->tri0.duty = duty;
+        tmp = engine->tri0.period / UINT8_MAX;
+        engine->tri0.falling_edge = tmp * engine->tri0.duty;
+        update_tri0_levels(engine);
         break;
 
     default:
-#ifdef DEBUG
-    sprintf(g_utilities_char_buffer,
-            "%s Channel %d does not exist. (Set duty: ch: %d) %s",
-                    WARNING_TAG, channel, channel, NEWLINE);
-    uart_write_string(g_utilities_char_buffer);
-#endif
+        log_write(LOG_AUDIO_SET_DUTY_INVALID_CH, channel, 0, 0);
         break;
     }
 }
 
-void audio_configure_vibrato(audio_ch_nbr_t channel,
+void audio_configure_vibrato(audio_engine_t* engine,
+                             audio_ch_nbr_t channel,
                              uint8_t speed,
                              uint8_t amount)
 {
-    uint8_t nbr_of_stepps;
+    square_wave_ch_t* ch;
 
     if (speed > 127)
     {
         speed = 127;
     }
 
-    nbr_of_stepps = 128 - speed; // whitin the range [1, 128]
+    switch (channel)
+    {
+    case AUDIO_CH_SQUARE0:
+    case AUDIO_CH_SQUARE1:
+        ch = (AUDIO_CH_SQUARE0 == channel) ? &engine->sq0 : &engine->sq1;
+
+        ch->vibrato.rate = speed;
+        ch->vibrato.depth = amount;
+        ch->vibrato.falling_edge = Q16_16_T_ONE * (128 - speed);
+        ch->vibrato.depth_factor =
+            double_to_q16_16(amount * ONE_CENT_CHANGE_FACTOR);
+        restart_vibrato(engine, ch);
+        ch->vibrato.on = true;
+        break;
+
+    default:
+        log_write(LOG_AUDIO_VIBRATO_CONFIG_NOT_SUPPORTED,
+                  channel, speed, amount);
+        break;
+    }
+}
+
+bool audio_get_vibrato(audio_engine_t* engine,
+                       audio_ch_nbr_t channel,
+                       uint8_t* speed,
+                       uint8_t* amount)
+{
+    square_wave_ch_t* ch;
 
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sq0.vibrato.rate = speed;
-        sq0.vibrato.depth = amount;
-        sq0.vibrato.falling_edge = Q16_16_T_ONE * nbr_of_stepps;
-        sq0.vibrato.period = 2 * sq0.vibrato.falling_edge;
-        sq0.vibrato.stepp = q16_16_multiply(
-            midi_note_periods[sq0.note_nbr],
-            double_to_q16_16(amount * ONE_CENT_CHANGE_FACTOR)) /
-            nbr_of_stepps;
-        sq0.vibrato.low_level = midi_note_periods[sq0.note_nbr] -
-            sq0.vibrato.stepp * nbr_of_stepps;
-        sq0.vibrato.rising = true;
-        sq0.vibrato.time = 0;
-        sq0.vibrato.on = true;
+        ch = &engine->sq0;
         break;
 
     case AUDIO_CH_SQUARE1:
-        sq1.vibrato.rate = speed;
-        sq1.vibrato.depth = amount;
-        sq1.vibrato.falling_edge = Q16_16_T_ONE * nbr_of_stepps;
-        sq1.vibrato.period = 2 * sq1.vibrato.falling_edge;
-        sq1.vibrato.stepp = q16_16_multiply(
-            midi_note_periods[sq1.note_nbr],
-            double_to_q16_16(amount * ONE_CENT_CHANGE_FACTOR)) /
-            nbr_of_stepps;
-        sq1.vibrato.low_level = midi_note_periods[sq1.note_nbr] -
-            sq1.vibrato.stepp * nbr_of_stepps;
-        sq1.vibrato.rising = true;
-        sq1.vibrato.time = 0;
-        sq1.vibrato.on = true;
+        ch = &engine->sq1;
         break;
-        
+
     default:
-#ifdef DEBUG
-    sprintf(g_utilities_char_buffer,
-            "%s Vibrato not supported on channel %d. (speed: %u: amount: %u) %s",
-                    WARNING_TAG, channel, speed, amount, NEWLINE);
-    uart_write_string(g_utilities_char_buffer);
-#endif
-        break;
+        return false;
     }
+
+    *speed = ch->vibrato.rate;
+    *amount = ch->vibrato.depth;
+
+    return true;
 }
 
-void audio_vibrato_off(audio_ch_nbr_t channel)
+void audio_vibrato_off(audio_engine_t* engine, audio_ch_nbr_t channel)
 {
     q16_16_t tmp;
 
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sq0.vibrato.on = false;
-        sq0.period = midi_note_periods[sq0.note_nbr];
-        tmp = sq0.period / UINT8_MAX;
-        sq0.rising_edge = tmp * sq0.duty;
+        engine->sq0.vibrato.on = false;
+        engine->sq0.period = engine->midi_note_periods[engine->sq0.note_nbr];
+        tmp = engine->sq0.period / UINT8_MAX;
+        engine->sq0.rising_edge = tmp * engine->sq0.duty;
         break;
 
     case AUDIO_CH_SQUARE1:
-        sq1.vibrato.on = false;
-        sq1.period = midi_note_periods[sq1.note_nbr];
-        tmp = sq1.period / UINT8_MAX;
-        sq1.rising_edge = tmp * sq1.duty;
+        engine->sq1.vibrato.on = false;
+        engine->sq1.period = engine->midi_note_periods[engine->sq1.note_nbr];
+        tmp = engine->sq1.period / UINT8_MAX;
+        engine->sq1.rising_edge = tmp * engine->sq1.duty;
         break;
 
     case AUDIO_CH_TRIANGLE0:
-        tri0.vibrato.on = false;
+        engine->tri0.vibrato.on = false;
         break;
 
     default:
-#ifdef DEBUG
-    sprintf(g_utilities_char_buffer,
-            "%s Vibrato not supported on channel %d. (vibrato off) %s",
-                    WARNING_TAG, channel, NEWLINE);
-    uart_write_string(g_utilities_char_buffer);
-#endif
+        log_write(LOG_AUDIO_VIBRATO_OFF_NOT_SUPPORTED, channel, 0, 0);
         break;
     }
 }
 
-void audio_vibrato_on(audio_ch_nbr_t channel)
+void audio_vibrato_on(audio_engine_t* engine, audio_ch_nbr_t channel)
 {
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sq0.vibrato.on = true;
+        engine->sq0.vibrato.on = true;
         break;
 
     case AUDIO_CH_SQUARE1:
-        sq1.vibrato.on = true;
+        engine->sq1.vibrato.on = true;
         break;
 
     case AUDIO_CH_TRIANGLE0:
-        tri0.vibrato.on = true;
+        engine->tri0.vibrato.on = true;
         break;
 
     default:
-#ifdef DEBUG
-    sprintf(g_utilities_char_buffer,
-            "%s Vibrato not supported on channel %d. (vibrato on) %s",
-                    WARNING_TAG, channel, NEWLINE);
-    uart_write_string(g_utilities_char_buffer);
-#endif
+        log_write(LOG_AUDIO_VIBRATO_ON_NOT_SUPPORTED, channel, 0, 0);
         break;
     }
 }
 
-void audio_configure_amplitude_adsr(audio_ch_nbr_t channel,
+void audio_configure_amplitude_adsr(audio_engine_t* engine,
+                                    audio_ch_nbr_t channel,
                                     uint8_t a, uint8_t d,
                                     uint8_t s, uint8_t r)
 {
@@ -877,22 +883,19 @@ void audio_configure_amplitude_adsr(audio_ch_nbr_t channel,
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        env = &sq0.envelope;
+        env = &engine->sq0.envelope;
         break;
 
     case AUDIO_CH_SQUARE1:
-        env = &sq1.envelope;
+        env = &engine->sq1.envelope;
         break;
 
     case AUDIO_CH_NOISE0:
-        env = &noise0.envelope;
+        env = &engine->noise0.envelope;
         break;
 
     default:
-        sprintf(g_utilities_char_buffer,
-        "%s Cannot configure adsr envelope on ch %d (adsr not supported)%s",
-                WARNING_TAG, channel, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        log_write(LOG_AUDIO_ADSR_CONFIG_NOT_SUPPORTED, channel, 0, 0);
         break;
     }
 
@@ -935,298 +938,519 @@ void audio_configure_amplitude_adsr(audio_ch_nbr_t channel,
     }
 }
 
-void audio_amplitude_adsr_on(audio_ch_nbr_t channel)
+bool audio_get_amplitude_adsr(audio_engine_t* engine,
+                              audio_ch_nbr_t channel,
+                              uint8_t adsr[4])
 {
+    adsr_envelope_t* env;
+
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sq0.envelope.on = true;
+        env = &engine->sq0.envelope;
         break;
 
     case AUDIO_CH_SQUARE1:
-        sq1.envelope.on = true;
+        env = &engine->sq1.envelope;
         break;
 
     case AUDIO_CH_NOISE0:
-        noise0.envelope.on = true;
+        env = &engine->noise0.envelope;
         break;
 
     default:
-        sprintf(g_utilities_char_buffer,
-        "%s Cannot activate adsr envelope on ch %d (adsr not supported)%s",
-                WARNING_TAG, channel, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
-        break;
-
+        return false;
     }
+
+    adsr[0] = env->attack;
+    adsr[1] = env->decay;
+    adsr[2] = env->substain;
+    adsr[3] = env->release;
+
+    return true;
 }
 
-void audio_amplitude_adsr_off(audio_ch_nbr_t channel)
+void audio_amplitude_adsr_on(audio_engine_t* engine, audio_ch_nbr_t channel)
 {
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sq0.envelope.on = false;
+        engine->sq0.envelope.on = true;
         break;
 
     case AUDIO_CH_SQUARE1:
-        sq1.envelope.on = false;
+        engine->sq1.envelope.on = true;
         break;
 
     case AUDIO_CH_NOISE0:
-        noise0.envelope.on = false;
+        engine->noise0.envelope.on = true;
         break;
 
     default:
-        sprintf(g_utilities_char_buffer,
-        "%s Cannot deactivate adsr envelope on ch %d (adsr not supported)%s",
-                WARNING_TAG, channel, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        log_write(LOG_AUDIO_ADSR_ON_NOT_SUPPORTED, channel, 0, 0);
         break;
 
     }
 }
 
-void audio_print_channel_status(audio_ch_nbr_t channel)
+void audio_amplitude_adsr_off(audio_engine_t* engine, audio_ch_nbr_t channel)
 {
     switch (channel)
     {
     case AUDIO_CH_SQUARE0:
-        sprintf(g_utilities_char_buffer,
-            "\tnote on: %d\t\t\tnote number: %u%s",
-                    sq0.note_on, sq0.note_nbr, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        engine->sq0.envelope.on = false;
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\tduty: %u\t\t\tis high: %d%s",
-                    sq0.duty, sq0.is_high, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    case AUDIO_CH_SQUARE1:
+        engine->sq1.envelope.on = false;
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\thigh level: %d\t\tlow level: %d%s",
-                    sq0.high_level, sq0.low_level, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    case AUDIO_CH_NOISE0:
+        engine->noise0.envelope.on = false;
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\trising edge: %f\t\tperiod: %f%s", q16_16_to_double(sq0.rising_edge),
-            q16_16_to_double(sq0.period), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    default:
+        log_write(LOG_AUDIO_ADSR_OFF_NOT_SUPPORTED, channel, 0, 0);
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\ttime: %f%s",
-                    q16_16_to_double(sq0.time), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    }
+}
 
-        //
-        // Vibrato
-        //
-        sprintf(g_utilities_char_buffer,
-            "\t[Vibrato]%s", NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+bool audio_set_sample_freq(audio_engine_t* engine, uint16_t sample_freq_hz)
+{
+    uint8_t i;
+    uint8_t new_index = PERIOD_TABLES_NBR_OF_SAMPLE_RATES;
+    q16_16_t ratio;
+    q16_16_t tmp;
+    uint8_t counter;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ton: %d\t\t\tdepth: %u%s",
-            sq0.vibrato.on, sq0.vibrato.depth, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    for (i = 0; i != PERIOD_TABLES_NBR_OF_SAMPLE_RATES; ++i)
+    {
+        if (g_period_tables_sample_freqs_hz[i] == sample_freq_hz)
+        {
+            new_index = i;
+        }
+    }
 
-        sprintf(g_utilities_char_buffer,
-            "\t\trate: %u\t\t\trising: %d%s",
-            sq0.vibrato.rate, sq0.vibrato.rising, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    if (PERIOD_TABLES_NBR_OF_SAMPLE_RATES == new_index)
+    {
+        log_write(LOG_AUDIO_INVALID_SAMPLE_RATE, sample_freq_hz, 0, 0);
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tfalling edge: %f\tperiod: %f%s",
-            q16_16_to_double(sq0.vibrato.falling_edge),
-            q16_16_to_double(sq0.vibrato.period),
-            NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        return false;
+    }
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ttime: %f\t\tlow level: %f%s",
-            q16_16_to_double(sq0.vibrato.time),
-            q16_16_to_double(sq0.vibrato.low_level), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    ratio = q16_16_divide(
+        int_to_q16_16(g_period_tables_sample_freqs_hz[new_index]),
+        int_to_q16_16(
+            g_period_tables_sample_freqs_hz[engine->sample_rate_index]));
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tstepp: %f%s",
-            q16_16_to_double(sq0.vibrato.stepp), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    engine->sample_rate_index = new_index;
+    engine->midi_note_periods = g_period_tables_note_periods[new_index];
+    engine->sample_rate_factor = q16_16_divide(
+        int_to_q16_16(g_period_tables_sample_freqs_hz[new_index]),
+        int_to_q16_16(
+            g_period_tables_sample_freqs_hz[PERIOD_TABLES_DEFAULT_RATE_INDEX]));
 
-        //
-        // ADSR modulation
-        //
-        sprintf(g_utilities_char_buffer,
-            "\t[ADSR]%s", NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    //
+    // Re-derive the timing of all channels from their notes, as when the
+    // notes are started. Only the phases are scaled, so that the channels
+    // keep their phase and no new note is started.
+    //
+    rederive_square_ch(engine, &engine->sq0, ratio);
+    rederive_square_ch(engine, &engine->sq1, ratio);
+
+    engine->tri0.time = q16_16_multiply(engine->tri0.time, ratio);
+    engine->tri0.period = engine->midi_note_periods[engine->tri0.note_nbr];
+    tmp = engine->tri0.period / UINT8_MAX;
+    engine->tri0.falling_edge = tmp * engine->tri0.duty;
+
+    update_tri0_levels(engine);
+
+    engine->noise0.time = q16_16_multiply(engine->noise0.time, ratio);
+    engine->noise0.period = engine->midi_note_periods[engine->noise0.note_nbr];
+    engine->noise0.prescaler = q16_16_to_int(q16_16_multiply(
+        int_to_q16_16(128 - engine->noise0.note_nbr),
+        engine->sample_rate_factor));
+    counter = q16_16_to_int(q16_16_multiply(
+        int_to_q16_16(engine->noise0.counter), ratio));
+    engine->noise0.counter = counter < engine->noise0.prescaler ?
+                             counter : engine->noise0.prescaler;
+
+    return true;
+}
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ton: %u\t\t\tstate: %u%s",
-            sq0.envelope.on, sq0.envelope.state, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
-        
-        sprintf(g_utilities_char_buffer,
-            "\t\ta: %u\t\t\td: %u%s",
-            sq0.envelope.attack, sq0.envelope.decay, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+void audio_register_underrun(audio_engine_t* engine)
+{
+    ++engine->stats.underruns;
+    engine->stats.last_underrun_tick = timer_get_tick_count();
+    engine->stats_min_fill = 0;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ts: %u\t\t\tr: %u%s",
-            sq0.envelope.substain, sq0.envelope.release, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    if (AUDIO_SCOPE_TRIGGER_UNDERRUN == engine->scope.trigger)
+    {
+        scope_trigger(engine);
+    }
+}
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tattack stepp: %f\t\tdecay stepp: %f%s",
-            q16_16_to_double(sq0.envelope.attack_stepp),
-            q16_16_to_double(sq0.envelope.decay_stepp),
-            NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+void audio_update_stats(audio_engine_t* engine)
+{
+    uint16_t bin;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tsubstain factor: %f\trelease stepp: %f%s",
-            q16_16_to_double(sq0.envelope.substain_factor),
-            q16_16_to_double(sq0.envelope.release_stepp),
-            NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    bin = engine->stats_min_fill /
+          (engine->sample_buff_depth / AUDIO_STATS_HISTOGRAM_SIZE);
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tamplitude factor: %f%s",
-            q16_16_to_double(sq0.envelope.amplitude_factor),
-            NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    engine->stats_min_fill = engine->sample_buff_size;
+
+    if (bin >= AUDIO_STATS_HISTOGRAM_SIZE)
+    {
+        bin = AUDIO_STATS_HISTOGRAM_SIZE - 1;
+    }
+
+    ++engine->stats.min_fill_histogram[bin];
+}
+
+void audio_get_stats(audio_engine_t* engine, audio_stats_t* dst)
+{
+    // The underrun fields may change during the copy, copy until they are
+    // consistent.
+    do
+    {
+        memcpy(dst, (const void*)&engine->stats, sizeof(audio_stats_t));
+    } while ((dst->underruns != engine->stats.underruns) ||
+             (dst->last_underrun_tick != engine->stats.last_underrun_tick));
+}
 
+void audio_reset_stats(audio_engine_t* engine)
+{
+    memset((void*)&engine->stats, 0, sizeof(audio_stats_t));
+    engine->stats_min_fill = SAMPLE_BUFF_POOL_SIZE;
+}
+
+uint16_t audio_get_sample_freq(audio_engine_t* engine)
+{
+    return g_period_tables_sample_freqs_hz[engine->sample_rate_index];
+}
+
+void audio_set_volume(audio_engine_t* engine,
+                      audio_ch_nbr_t channel,
+                      uint8_t volume)
+{
+    if (channel >= AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        return;
+    }
+
+    if (volume > AUDIO_VOLUME_MAX)
+    {
+        volume = AUDIO_VOLUME_MAX;
+    }
+
+    engine->channel_gain[channel].volume = volume;
+    update_gain_targets(engine);
+}
+
+void audio_set_master_volume(audio_engine_t* engine, uint8_t volume)
+{
+    if (volume > AUDIO_VOLUME_MAX)
+    {
+        volume = AUDIO_VOLUME_MAX;
+    }
+
+    engine->master_volume = volume;
+    update_gain_targets(engine);
+}
+
+void audio_set_mute(audio_engine_t* engine, audio_ch_nbr_t channel, bool mute)
+{
+    if (channel < AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        engine->channel_gain[channel].mute = mute;
+        update_gain_targets(engine);
+    }
+}
+
+void audio_set_solo(audio_engine_t* engine, audio_ch_nbr_t channel, bool solo)
+{
+    if (channel < AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        engine->channel_gain[channel].solo = solo;
+        update_gain_targets(engine);
+    }
+}
+
+void audio_set_pitch_bend(audio_engine_t* engine,
+                          audio_ch_nbr_t channel,
+                          uint16_t bend)
+{
+    int16_t cents;
+    q16_16_t time_step;
+
+    if ((channel >= AUDIO_CH_NBR_OF_CHANNELS) || (bend > AUDIO_PITCH_BEND_MAX))
+    {
+        return;
+    }
+
+    engine->pitch_bend[channel] = bend;
+
+    // [-8192, 8191] -> [-range, range] semitones
+    cents = (int16_t)(((int32_t)bend - AUDIO_PITCH_BEND_CENTER) *
+                      (engine->pitch_bend_range[channel] * 100) /
+                      (int32_t)AUDIO_PITCH_BEND_CENTER);
+
+    time_step = bend_time_step(cents);
+
+    switch (channel)
+    {
+    case AUDIO_CH_SQUARE0:
+        engine->sq0.time_step = time_step;
         break;
 
     case AUDIO_CH_SQUARE1:
-        sprintf(g_utilities_char_buffer,
-            "\tnote on: %d\t\t\tnote number: %u%s",
-                    sq1.note_on, sq1.note_nbr, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        engine->sq1.time_step = time_step;
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\tduty: %u\t\t\tis high: %d%s",
-                    sq1.duty, sq1.is_high, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    case AUDIO_CH_TRIANGLE0:
+        engine->tri0.time_step = time_step;
+        engine->tri0.update_amplitude_event = true;
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\thigh level: %d\t\tlow level: %d%s",
-                    sq1.high_level, sq1.low_level, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    default:
+        // The noise channel has no pitch to bend
+        break;
+    }
+}
 
-        sprintf(g_utilities_char_buffer,
-            "\trising edge: %f\t\tperiod: %f%s", q16_16_to_double(sq1.rising_edge),
-            q16_16_to_double(sq1.period), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+void audio_set_pitch_bend_range(audio_engine_t* engine,
+                                audio_ch_nbr_t channel,
+                                uint8_t semitones)
+{
+    if (channel >= AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        return;
+    }
 
-        sprintf(g_utilities_char_buffer,
-            "\ttime: %f%s",
-                    q16_16_to_double(sq1.time), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    if (semitones > PERIOD_TABLES_MAX_BEND_SEMITONES)
+    {
+        semitones = PERIOD_TABLES_MAX_BEND_SEMITONES;
+    }
 
-        //
-        // Vibrato
-        //
-        sprintf(g_utilities_char_buffer,
-            "\t[Vibrato]%s", NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    engine->pitch_bend_range[channel] = semitones;
+    audio_set_pitch_bend(engine, channel, engine->pitch_bend[channel]);
+}
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ton: %d\t\t\tdepth: %u%s",
-            sq1.vibrato.on, sq1.vibrato.depth, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+void audio_set_patch(audio_engine_t* engine,
+                     audio_ch_nbr_t channel,
+                     const audio_patch_t* patch)
+{
+    square_wave_ch_t* ch;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\trate: %u\t\t\trising: %d%s",
-            sq1.vibrato.rate, sq1.vibrato.rising, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    switch (channel)
+    {
+    case AUDIO_CH_SQUARE0:
+    case AUDIO_CH_SQUARE1:
+        ch = (AUDIO_CH_SQUARE0 == channel) ? &engine->sq0 : &engine->sq1;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tfalling edge: %f\tperiod: %f%s",
-            q16_16_to_double(sq1.vibrato.falling_edge),
-            q16_16_to_double(sq1.vibrato.period),
-            NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        ch->duty = patch->duty;
+        ch->rising_edge = (ch->period / UINT8_MAX) * ch->duty;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ttime: %f\t\tlow level: %f%s",
-            q16_16_to_double(sq1.vibrato.time),
-            q16_16_to_double(sq1.vibrato.low_level), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        ch->vibrato.rate = patch->vibrato.rate;
+        ch->vibrato.depth = patch->vibrato.depth;
+        ch->vibrato.falling_edge = patch->vibrato.falling_edge;
+        ch->vibrato.depth_factor = patch->vibrato.depth_factor;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tstepp: %f%s",
-            q16_16_to_double(sq1.vibrato.stepp), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        if (patch->vibrato.on)
+        {
+            restart_vibrato(engine, ch);
+            ch->vibrato.on = true;
+        }
+        else if (ch->vibrato.on)
+        {
+            audio_vibrato_off(engine, channel);
+        }
 
-        //
-        // ADSR modulation
-        //
-        sprintf(g_utilities_char_buffer,
-            "\t[ADSR]%s", NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        load_envelope(&ch->envelope, &patch->adsr);
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ton: %u\t\t\tstate: %u%s",
-            sq1.envelope.on, sq1.envelope.state, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    case AUDIO_CH_TRIANGLE0:
+        audio_set_duty(engine, channel, patch->duty);
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ta: %u\t\t\td: %u%s",
-            sq1.envelope.attack, sq1.envelope.decay, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    case AUDIO_CH_NOISE0:
+        load_envelope(&engine->noise0.envelope, &patch->adsr);
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\t\ts: %u\t\t\tr: %u%s",
-            sq1.envelope.substain, sq1.envelope.release, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    default:
+        break;
+    }
+}
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tattack stepp: %f\t\tdecay stepp: %f%s",
-            q16_16_to_double(sq1.envelope.attack_stepp),
-            q16_16_to_double(sq1.envelope.decay_stepp),
-            NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+void audio_set_channel_enabled(audio_engine_t* engine,
+                               audio_ch_nbr_t channel,
+                               bool enabled)
+{
+    if (channel < AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        engine->channel_enabled[channel] = enabled;
+    }
+}
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tsubstain factor: %f\trelease stepp: %f%s",
-            q16_16_to_double(sq1.envelope.substain_factor),
-            q16_16_to_double(sq1.envelope.release_stepp),
-            NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+bool audio_is_channel_enabled(audio_engine_t* engine, audio_ch_nbr_t channel)
+{
+    return (channel < AUDIO_CH_NBR_OF_CHANNELS) &&
+           engine->channel_enabled[channel];
+}
 
-        sprintf(g_utilities_char_buffer,
-            "\t\tamplitude factor: %f%s",
-            q16_16_to_double(sq1.envelope.amplitude_factor),
-            NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+bool audio_is_note_on(audio_engine_t* engine, audio_ch_nbr_t channel)
+{
+    switch (channel)
+    {
+    case AUDIO_CH_SQUARE0:
+        return engine->sq0.note_on;
+
+    case AUDIO_CH_SQUARE1:
+        return engine->sq1.note_on;
+
+    case AUDIO_CH_TRIANGLE0:
+        return engine->tri0.note_on;
 
+    case AUDIO_CH_NOISE0:
+        return engine->noise0.note_on;
+
+    default:
+        return false;
+    }
+}
+
+adsr_state_t audio_get_envelope_state(audio_engine_t* engine,
+                                      audio_ch_nbr_t channel)
+{
+    switch (channel)
+    {
+    case AUDIO_CH_SQUARE0:
+        return engine->sq0.envelope.state;
+
+    case AUDIO_CH_SQUARE1:
+        return engine->sq1.envelope.state;
+
+    case AUDIO_CH_NOISE0:
+        return engine->noise0.envelope.state;
+
+    default:
+        return ADSR_STATE_OFF;
+    }
+}
+
+void audio_set_modulation_divider(audio_engine_t* engine, uint8_t divider)
+{
+    if (0 == divider)
+    {
+        divider = 1;
+    }
+
+    engine->modulation_divider = divider;
+    engine->modulation_counter = 0;
+}
+
+bool audio_scope_arm(audio_engine_t* engine,
+                     uint8_t source,
+                     audio_scope_trigger_t trigger,
+                     int16_t level)
+{
+    audio_scope_t* scope = &engine->scope;
+
+    if ((source > AUDIO_SCOPE_MIX) || (trigger >= AUDIO_SCOPE_NBR_OF_TRIGGERS))
+    {
+        return false;
+    }
+
+    scope->state = AUDIO_SCOPE_IDLE;
+
+    memset(scope->buff, 0, sizeof(scope->buff));
+    scope->next = 0;
+    scope->stop = AUDIO_SCOPE_NO_STOP;
+    scope->checked = 0;
+    scope->source = source;
+    scope->trigger = trigger;
+    scope->level = level;
+
+    switch (source)
+    {
+    case AUDIO_CH_SQUARE0:
+        scope->sample = &engine->sq0.output;
+        break;
+
+    case AUDIO_CH_SQUARE1:
+        scope->sample = &engine->sq1.output;
         break;
 
     case AUDIO_CH_TRIANGLE0:
-        sprintf(g_utilities_char_buffer,
-            "\tnote on: %d\t\t\tnote number: %u%s",
-                    tri0.note_on, tri0.note_nbr, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+        scope->sample = &engine->tri0.current_value;
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\tduty: %u\t\t\tis rising: %d%s",
-                    tri0.duty, tri0.is_rising, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    case AUDIO_CH_NOISE0:
+        scope->sample = &engine->noise0.output;
+        break;
 
-        sprintf(g_utilities_char_buffer,
-            "\tcurret value: %d\t\tlow level: %d%s",
-                    tri0.current_value, tri0.low_level, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    default:
+        scope->sample = &engine->accumulator;
+        break;
+    }
 
-        sprintf(g_utilities_char_buffer,
-            "\tfalling edge: %f\tperiod: %f%s", q16_16_to_double(tri0.falling_edge),
-            q16_16_to_double(tri0.period), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
+    scope->state = AUDIO_SCOPE_ARMED;
 
-        sprintf(g_utilities_char_buffer,
-            "\ttime: %f%s",
-                    q16_16_to_double(tri0.time), NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
-        
+    if (AUDIO_SCOPE_TRIGGER_NOW == trigger)
+    {
+        scope_trigger(engine);
+    }
+
+    return true;
+}
+
+uint16_t audio_scope_read(audio_engine_t* engine,
+                          uint16_t first,
+                          uint16_t nbr_of_samples,
+                          int16_t* dst)
+{
+    audio_scope_t* scope = &engine->scope;
+    uint16_t i;
+
+    if ((AUDIO_SCOPE_DONE != scope->state) || (first >= AUDIO_SCOPE_SIZE))
+    {
+        return 0;
+    }
+
+    if (nbr_of_samples > AUDIO_SCOPE_SIZE - first)
+    {
+        nbr_of_samples = AUDIO_SCOPE_SIZE - first;
+    }
+
+    // The recording ends when the buffer is full, the oldest sample is the
+    // one which would have been overwritten next.
+    for (i = 0; i != nbr_of_samples; ++i)
+    {
+        dst[i] = scope->buff[(scope->next + first + i) & AUDIO_SCOPE_MASK];
+    }
+
+    return nbr_of_samples;
+}
+
+bool audio_print_channel_status(audio_engine_t* engine,
+                                audio_ch_nbr_t channel,
+                                uint8_t line)
+{
+    bool more = false;
+
+    switch (channel)
+    {
+    case AUDIO_CH_SQUARE0:
+        more = print_square_status_line(&engine->sq0, line);
+        break;
+
+    case AUDIO_CH_SQUARE1:
+        more = print_square_status_line(&engine->sq1, line);
+        break;
+
+    case AUDIO_CH_TRIANGLE0:
+        more = print_triangle_status_line(&engine->tri0, line);
         break;
 
     case AUDIO_CH_NOISE0:
@@ -1235,45 +1459,92 @@ void audio_print_channel_status(audio_ch_nbr_t channel)
     default:
         break;
     }
+
+    return more;
 }
 
 // =============================================================================
 // Private function definitions
 // =============================================================================
 
-static inline void buffer_push(int16_t sample)
+static inline void buffer_push(audio_engine_t* engine, int16_t sample)
 {
-    if (g_audio_sample_buff_size++)
+    if (engine->sample_buff_depth == engine->sample_buff_size)
     {
-        ++sample_buff_last;
+        // Pushing would overwrite a sample which has not been played yet
+        ++engine->stats.overruns;
+        return;
+    }
+
+    engine->sample_buff[engine->sample_buff_next] = sample;
+    engine->sample_buff_next =
+        (engine->sample_buff_next + 1) & engine->sample_buff_mask;
+
+    ++engine->sample_buff_size;
+}
 
-        if (sample_buff_last == SAMPLE_BUFF_SIZE)
+static inline void scope_trigger(audio_engine_t* engine)
+{
+    if (AUDIO_SCOPE_ARMED == engine->scope.state)
+    {
+        engine->scope.stop = (engine->scope.next + AUDIO_SCOPE_SIZE -
+                              AUDIO_SCOPE_PRE_TRIGGER) & AUDIO_SCOPE_MASK;
+        engine->scope.state = AUDIO_SCOPE_TRIGGERED;
+    }
+}
+
+static inline void record_scope_sample(audio_engine_t* engine)
+{
+    audio_scope_t* scope = &engine->scope;
+
+    scope->buff[scope->next] = *scope->sample;
+    scope->next = (scope->next + 1) & AUDIO_SCOPE_MASK;
+
+    if (scope->next == scope->stop)
+    {
+        scope->state = AUDIO_SCOPE_DONE;
+    }
+}
+
+static void check_scope_level(audio_engine_t* engine)
+{
+    audio_scope_t* scope = &engine->scope;
+    int16_t sample;
+
+    while (scope->checked != scope->next)
+    {
+        sample = scope->buff[scope->checked];
+
+        if ((sample >= scope->level) || (sample <= -scope->level))
         {
-            sample_buff_last = 0;
+            scope->stop = (scope->checked + AUDIO_SCOPE_SIZE -
+                           AUDIO_SCOPE_PRE_TRIGGER) & AUDIO_SCOPE_MASK;
+            scope->state = AUDIO_SCOPE_TRIGGERED;
+            return;
         }
-    }
 
-    sample_buff[sample_buff_last] = sample;
+        scope->checked = (scope->checked + 1) & AUDIO_SCOPE_MASK;
+    }
 }
 
 /* *********************************************************
  *      Sample generation                                  *
  ***********************************************************/
 
-static inline void calc_sq0_sample(void)
+static inline void calc_sq0_sample(audio_engine_t* engine)
 {
-    sq0.time += Q16_16_T_ONE;
+    engine->sq0.time += engine->sq0.time_step;
 
-    if (false == sq0.is_high)
+    if (false == engine->sq0.is_high)
     {
         //
         // Low state
         //
-        accumulator += sq0.low_level;
+        engine->sq0.output = engine->sq0.low_level;
 
-        if (sq0.time >= sq0.rising_edge)
+        if (engine->sq0.time >= engine->sq0.rising_edge)
         {
-            sq0.is_high = true;
+            engine->sq0.is_high = true;
         }
     }
     else
@@ -1281,41 +1552,44 @@ static inline void calc_sq0_sample(void)
         //
         // High state
         //
-        accumulator += sq0.high_level;
+        engine->sq0.output = engine->sq0.high_level;
 
-        if (sq0.time >= sq0.period)
+        if (engine->sq0.time >= engine->sq0.period)
         {
-            sq0.time -= sq0.period;
+            engine->sq0.time -= engine->sq0.period;
 
-            sq0.is_high = false;
+            engine->sq0.is_high = false;
 
-            if (sq0.envelope.update_amplitude_event)
+            if (engine->sq0.envelope.update_amplitude_event)
             {
-                sq0.envelope.update_amplitude_event = false;
+                engine->sq0.envelope.update_amplitude_event = false;
 
-                sq0.high_level = q16_16_to_int(q16_16_multiply(
-                        int_to_q16_16(sq0.high_level_limit),
-                        sq0.envelope.amplitude_factor));
-                sq0.low_level = 0 - sq0.high_level;
+                engine->sq0.high_level =
+                    scale_level(engine->sq0.high_level_limit,
+                                engine->sq0.envelope.amplitude_factor,
+                                engine->channel_gain[AUDIO_CH_SQUARE0].gain);
+                engine->sq0.low_level = 0 - engine->sq0.high_level;
             }
         }
     }
+
+    engine->accumulator += engine->sq0.output;
 }
 
-static inline void calc_sq1_sample(void)
+static inline void calc_sq1_sample(audio_engine_t* engine)
 {
-    sq1.time += Q16_16_T_ONE;
+    engine->sq1.time += engine->sq1.time_step;
 
-    if (false == sq1.is_high)
+    if (false == engine->sq1.is_high)
     {
         //
         // Low state
         //
-        accumulator += sq1.low_level;
+        engine->sq1.output = engine->sq1.low_level;
 
-        if (sq1.time >= sq1.rising_edge)
+        if (engine->sq1.time >= engine->sq1.rising_edge)
         {
-            sq1.is_high = true;
+            engine->sq1.is_high = true;
         }
     }
     else
@@ -1323,43 +1597,46 @@ static inline void calc_sq1_sample(void)
         //
         // High state
         //
-        accumulator += sq1.high_level;
+        engine->sq1.output = engine->sq1.high_level;
 
-        if (sq1.time >= sq1.period)
+        if (engine->sq1.time >= engine->sq1.period)
         {
-            sq1.time -= sq1.period;
+            engine->sq1.time -= engine->sq1.period;
 
-            sq1.is_high = false;
+            engine->sq1.is_high = false;
 
-            if (sq1.envelope.update_amplitude_event)
+            if (engine->sq1.envelope.update_amplitude_event)
             {
-                sq1.envelope.update_amplitude_event = false;
+                engine->sq1.envelope.update_amplitude_event = false;
 
-                sq1.high_level = q16_16_to_int(q16_16_multiply(
-                        int_to_q16_16(sq1.high_level_limit),
-                        sq1.envelope.amplitude_factor));
-                sq1.low_level = 0 - sq1.high_level;
+                engine->sq1.high_level =
+                    scale_level(engine->sq1.high_level_limit,
+                                engine->sq1.envelope.amplitude_factor,
+                                engine->channel_gain[AUDIO_CH_SQUARE1].gain);
+                engine->sq1.low_level = 0 - engine->sq1.high_level;
             }
         }
 
     }
+
+    engine->accumulator += engine->sq1.output;
 }
 
 
-static inline void calc_tri0_sample(void)
+static inline void calc_tri0_sample(audio_engine_t* engine)
 {
-    tri0.time += Q16_16_T_ONE;
+    engine->tri0.time += engine->tri0.time_step;
 
-    if (tri0.is_rising)
+    if (engine->tri0.is_rising)
     {
         //
         // Rising
         //
-        tri0.current_value += tri0.up_step_size;
+        engine->tri0.current_value += engine->tri0.up_step_size;
 
-        if (tri0.time >= tri0.falling_edge)
+        if (engine->tri0.time >= engine->tri0.falling_edge)
         {
-           tri0.is_rising = false;
+           engine->tri0.is_rising = false;
         }
     }
     else
@@ -1367,148 +1644,326 @@ static inline void calc_tri0_sample(void)
         //
         // Falling
         //
-        tri0.current_value += tri0.down_step_size;
+        engine->tri0.current_value += engine->tri0.down_step_size;
 
-        if (tri0.time >= tri0.period)
+        if (engine->tri0.time >= engine->tri0.period)
         {
-           tri0.is_rising = true;
-           tri0.current_value = tri0.low_level;
-           tri0.time -= tri0.period;
+           engine->tri0.is_rising = true;
+
+           if (engine->tri0.update_amplitude_event)
+           {
+               engine->tri0.update_amplitude_event = false;
+               update_tri0_levels(engine);
+           }
+
+           engine->tri0.current_value = engine->tri0.low_level;
+           engine->tri0.time -= engine->tri0.period;
         }
     }
 
-    accumulator += tri0.current_value;
+    engine->accumulator += engine->tri0.current_value;
 }
 
-static inline void calc_noise0_sample(void)
+static inline void calc_noise0_sample(audio_engine_t* engine)
 {
 #if 0
-    noise0.time += Q16_16_T_ONE;
+    engine->noise0.time += Q16_16_T_ONE;
 
-    if (noise0.time >= noise0.period)
+    if (engine->noise0.time >= engine->noise0.period)
     {
-        noise0.time -= noise0.period;
+        engine->noise0.time -= engine->noise0.period;
 
-        noise0.is_high = rng_get_random();
+        engine->noise0.is_high = rng_get_random();
 
-        if (noise0.envelope.update_amplitude_event)
+        if (engine->noise0.envelope.update_amplitude_event)
         {
-            noise0.envelope.update_amplitude_event = false;
+            engine->noise0.envelope.update_amplitude_event = false;
             
-            noise0.high_level = q16_16_to_int(q16_16_multiply(
-                        int_to_q16_16(noise0.high_level_limit),
-                        noise0.envelope.amplitude_factor));
-            noise0.low_level = 0 - noise0.high_level;
+            engine->noise0.high_level =
+                scale_level(engine->noise0.high_level_limit,
+                            engine->noise0.envelope.amplitude_factor,
+                            engine->channel_gain[AUDIO_CH_NOISE0].gain);
+            engine->noise0.low_level = 0 - engine->noise0.high_level;
         }
     }
 
-    if (noise0.is_high)
+    if (engine->noise0.is_high)
     {
-        accumulator += noise0.high_level;
+        engine->noise0.output = engine->noise0.high_level;
     }
     else
     {
-        accumulator += noise0.low_level;
+        engine->noise0.output = engine->noise0.low_level;
     }
+
+    engine->accumulator += engine->noise0.output;
 #else
-    if (0 == noise0.counter--)
+    if (0 == engine->noise0.counter--)
     {
-        noise0.counter = noise0.prescaler;
+        engine->noise0.counter = engine->noise0.prescaler;
 
-        noise0.is_high = rng_get_random();
+        engine->noise0.is_high = rng_get_random();
 
-        if (noise0.envelope.update_amplitude_event)
+        if (engine->noise0.envelope.update_amplitude_event)
         {
-            noise0.envelope.update_amplitude_event = false;
+            engine->noise0.envelope.update_amplitude_event = false;
 
-            noise0.high_level = q16_16_to_int(q16_16_multiply(
-                        int_to_q16_16(noise0.high_level_limit),
-                        noise0.envelope.amplitude_factor));
-            noise0.low_level = 0 - noise0.high_level;
+            engine->noise0.high_level =
+                scale_level(engine->noise0.high_level_limit,
+                            engine->noise0.envelope.amplitude_factor,
+                            engine->channel_gain[AUDIO_CH_NOISE0].gain);
+            engine->noise0.low_level = 0 - engine->noise0.high_level;
         }
     }
-    if (noise0.is_high)
+    if (engine->noise0.is_high)
     {
-        accumulator += noise0.high_level;
+        engine->noise0.output = engine->noise0.high_level;
     }
     else
     {
-        accumulator += noise0.low_level;
+        engine->noise0.output = engine->noise0.low_level;
     }
 
+    engine->accumulator += engine->noise0.output;
+
 #endif
 }
 
+static void rederive_square_ch(audio_engine_t* engine,
+                               square_wave_ch_t* ch,
+                               q16_16_t ratio)
+{
+    q16_16_t steps = 0;
+    q16_16_t tmp;
+
+    ch->time = q16_16_multiply(ch->time, ratio);
+
+    if (ch->vibrato.on)
+    {
+        // The number of steps the vibrato has taken from its lowest period
+        if (0 != ch->vibrato.stepp)
+        {
+            steps = (ch->period - ch->vibrato.low_level +
+                     ch->vibrato.stepp / 2) / ch->vibrato.stepp;
+        }
+
+        calc_vibrato_steps(engine, ch);
+        ch->period = ch->vibrato.low_level + steps * ch->vibrato.stepp;
+    }
+    else
+    {
+        ch->period = engine->midi_note_periods[ch->note_nbr];
+    }
+
+    tmp = ch->period / UINT8_MAX;
+    ch->rising_edge = tmp * ch->duty;
+}
+
+/* *********************************************************
+ *      Gain                                               *
+ ***********************************************************/
+
+static inline int16_t scale_level(int16_t limit,
+                                  q16_16_t envelope_factor,
+                                  q16_16_t gain)
+{
+    return q16_16_to_int(q16_16_multiply(
+        int_to_q16_16(limit),
+        q16_16_multiply(envelope_factor, gain)));
+}
+
+static void update_tri0_levels(audio_engine_t* engine)
+{
+    int16_t peak_to_peak;
+
+    if (false == engine->tri0.note_on)
+    {
+        return;
+    }
+
+    peak_to_peak = scale_level(engine->tri0.amplitude * HIGH_AMPLITUDE_FACTOR,
+                               Q16_16_T_ONE,
+                               engine->channel_gain[AUDIO_CH_TRIANGLE0].gain);
+
+    //
+    // The step sizes are scaled with the time step, so that a bent note
+    // reaches the same peak level.
+    //
+    engine->tri0.low_level = 0 - (peak_to_peak / 2);
+    engine->tri0.up_step_size = (int16_t)q16_16_to_int(q16_16_multiply(
+        q16_16_divide(int_to_q16_16(peak_to_peak), engine->tri0.falling_edge),
+        engine->tri0.time_step));
+    engine->tri0.down_step_size = (-1) * (int16_t)q16_16_to_int(q16_16_multiply(
+        q16_16_divide(int_to_q16_16(peak_to_peak),
+                      engine->tri0.period - engine->tri0.falling_edge),
+        engine->tri0.time_step));
+}
+
+static void update_gain_targets(audio_engine_t* engine)
+{
+    uint8_t i;
+    bool solo_active = false;
+    bool audible;
+    channel_gain_t* ch;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        solo_active |= engine->channel_gain[i].solo;
+    }
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        ch = &engine->channel_gain[i];
+
+        audible = !ch->mute && (!solo_active || ch->solo);
+
+        if (audible)
+        {
+            ch->target = ((uint32_t)ch->volume * engine->master_volume *
+                          Q16_16_T_ONE) /
+                         ((uint32_t)AUDIO_VOLUME_MAX * AUDIO_VOLUME_MAX);
+        }
+        else
+        {
+            ch->target = 0;
+        }
+
+        if (ch->target > ch->gain)
+        {
+            ch->stepp = (ch->target - ch->gain) / GAIN_RAMP_TICKS;
+        }
+        else
+        {
+            ch->stepp = (ch->gain - ch->target) / GAIN_RAMP_TICKS;
+        }
+
+        if (0 == ch->stepp)
+        {
+            ch->stepp = 1;
+        }
+    }
+}
+
+static inline void ramp_gains(audio_engine_t* engine)
+{
+    uint8_t i;
+    channel_gain_t* ch;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        ch = &engine->channel_gain[i];
+
+        if (ch->gain == ch->target)
+        {
+            continue;
+        }
+
+        if (ch->target > ch->gain)
+        {
+            ch->gain = ((ch->target - ch->gain) > ch->stepp) ?
+                       (ch->gain + ch->stepp) : ch->target;
+        }
+        else
+        {
+            ch->gain = ((ch->gain - ch->target) > ch->stepp) ?
+                       (ch->gain - ch->stepp) : ch->target;
+        }
+
+        // The new gain is applied at the start of the next period
+        switch (i)
+        {
+        case AUDIO_CH_SQUARE0:
+            engine->sq0.envelope.update_amplitude_event = true;
+            break;
+
+        case AUDIO_CH_SQUARE1:
+            engine->sq1.envelope.update_amplitude_event = true;
+            break;
+
+        case AUDIO_CH_TRIANGLE0:
+            engine->tri0.update_amplitude_event = true;
+            break;
+
+        case AUDIO_CH_NOISE0:
+            engine->noise0.envelope.update_amplitude_event = true;
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
 /* *********************************************************
  *      Vibrato modulation                                 *
  ***********************************************************/
 
-static inline void modulate_sq0_vibrato(void)
+static inline void modulate_sq0_vibrato(audio_engine_t* engine)
 {
     q16_16_t tmp;
 
-    sq0.vibrato.time += Q16_16_T_ONE;
+    engine->sq0.vibrato.time += Q16_16_T_ONE;
 
-    if (sq0.vibrato.rising)
+    if (engine->sq0.vibrato.rising)
     {
-        sq0.period += sq0.vibrato.stepp;
-        tmp = sq0.period / UINT8_MAX;
-        sq0.rising_edge = tmp * sq0.duty;
+        engine->sq0.period += engine->sq0.vibrato.stepp;
+        tmp = engine->sq0.period / UINT8_MAX;
+        engine->sq0.rising_edge = tmp * engine->sq0.duty;
 
-        if (sq0.vibrato.time >= sq0.vibrato.falling_edge)
+        if (engine->sq0.vibrato.time >= engine->sq0.vibrato.falling_edge)
         {
-            sq0.vibrato.rising = false;
+            engine->sq0.vibrato.rising = false;
         }
     }
     else
     {
-        sq0.period -= sq0.vibrato.stepp;
-        tmp = sq0.period / UINT8_MAX;
-        sq0.rising_edge = tmp * sq0.duty;
+        engine->sq0.period -= engine->sq0.vibrato.stepp;
+        tmp = engine->sq0.period / UINT8_MAX;
+        engine->sq0.rising_edge = tmp * engine->sq0.duty;
 
-        if (sq0.vibrato.time >= sq0.vibrato.period)
+        if (engine->sq0.vibrato.time >= engine->sq0.vibrato.period)
         {
-            sq0.vibrato.time -= sq0.vibrato.period;
-            sq0.vibrato.rising = true;
+            engine->sq0.vibrato.time -= engine->sq0.vibrato.period;
+            engine->sq0.vibrato.rising = true;
 
-            sq0.period = sq0.vibrato.low_level;
-            tmp = sq0.period / UINT8_MAX;
-            sq0.rising_edge = tmp * sq0.duty;
+            engine->sq0.period = engine->sq0.vibrato.low_level;
+            tmp = engine->sq0.period / UINT8_MAX;
+            engine->sq0.rising_edge = tmp * engine->sq0.duty;
         }
     }
 }
 
-static inline void modulate_sq1_vibrato(void)
+static inline void modulate_sq1_vibrato(audio_engine_t* engine)
 {
     q16_16_t tmp;
 
-    sq1.vibrato.time += Q16_16_T_ONE;
+    engine->sq1.vibrato.time += Q16_16_T_ONE;
 
-    if (sq1.vibrato.rising)
+    if (engine->sq1.vibrato.rising)
     {
-        sq1.period += sq1.vibrato.stepp;
-        tmp = sq1.period / UINT8_MAX;
-        sq1.rising_edge = tmp * sq1.duty;
+        engine->sq1.period += engine->sq1.vibrato.stepp;
+        tmp = engine->sq1.period / UINT8_MAX;
+        engine->sq1.rising_edge = tmp * engine->sq1.duty;
 
-        if (sq1.vibrato.time >= sq1.vibrato.falling_edge)
+        if (engine->sq1.vibrato.time >= engine->sq1.vibrato.falling_edge)
         {
-            sq1.vibrato.rising = false;
+            engine->sq1.vibrato.rising = false;
         }
     }
     else
     {
-        sq1.period -= sq1.vibrato.stepp;
-        tmp = sq1.period / UINT8_MAX;
-        sq1.rising_edge = tmp * sq1.duty;
+        engine->sq1.period -= engine->sq1.vibrato.stepp;
+        tmp = engine->sq1.period / UINT8_MAX;
+        engine->sq1.rising_edge = tmp * engine->sq1.duty;
 
-        if (sq1.vibrato.time >= sq1.vibrato.period)
+        if (engine->sq1.vibrato.time >= engine->sq1.vibrato.period)
         {
-            sq1.vibrato.time -= sq1.vibrato.period;
-            sq1.vibrato.rising = true;
+            engine->sq1.vibrato.time -= engine->sq1.vibrato.period;
+            engine->sq1.vibrato.rising = true;
 
-            sq1.period = sq1.vibrato.low_level;
-            tmp = sq1.period / UINT8_MAX;
-            sq1.rising_edge = tmp * sq1.duty;
+            engine->sq1.period = engine->sq1.vibrato.low_level;
+            tmp = engine->sq1.period / UINT8_MAX;
+            engine->sq1.rising_edge = tmp * engine->sq1.duty;
         }
     }
 }
@@ -1517,200 +1972,452 @@ static inline void modulate_sq1_vibrato(void)
  *      ADSR volume modulation                             *
  ***********************************************************/
 
-static inline void modulate_sq0_adsr(void)
+static inline void modulate_sq0_adsr(audio_engine_t* engine)
 {
-    switch (sq0.envelope.state)
+    adsr_envelope_t* env = &engine->sq0.envelope;
+
+    switch (env->state)
     {
     case ADSR_STATE_OFF:
         break;
 
     case ADSR_STATE_ATTACK:
-        sq0.envelope.amplitude_factor += sq0.envelope.attack_stepp;
+        env->amplitude_factor += env->attack_stepp;
 
-        if (sq0.envelope.amplitude_factor >= Q16_16_T_ONE)
+        if (env->amplitude_factor >= Q16_16_T_ONE)
         {
-            sq0.envelope.amplitude_factor = Q16_16_T_ONE;
-            sq0.envelope.state = ADSR_STATE_DECAY;
+            env->amplitude_factor = Q16_16_T_ONE;
+            env->state = ADSR_STATE_DECAY;
         }
 
-        sq0.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     case ADSR_STATE_DECAY:
-        if (sq0.envelope.amplitude_factor >= sq0.envelope.decay_stepp)
+        if (env->amplitude_factor >= env->decay_stepp)
         {
-            sq0.envelope.amplitude_factor -= sq0.envelope.decay_stepp;
+            env->amplitude_factor -= env->decay_stepp;
 
-            if (sq0.envelope.amplitude_factor <= sq0.envelope.substain_factor)
+            if (env->amplitude_factor <= env->substain_factor)
             {
-                sq0.envelope.amplitude_factor = sq0.envelope.substain_factor;
-                sq0.envelope.state = ADSR_STATE_SUBSTAIN;
+                env->amplitude_factor = env->substain_factor;
+                env->state = ADSR_STATE_SUBSTAIN;
             }
         }
         else
         {
-            sq0.envelope.amplitude_factor = sq0.envelope.substain_factor;
-            sq0.envelope.state = ADSR_STATE_SUBSTAIN;
+            env->amplitude_factor = env->substain_factor;
+            env->state = ADSR_STATE_SUBSTAIN;
         }
 
-        sq0.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     case ADSR_STATE_SUBSTAIN:
         break;
 
     case ADSR_STATE_RELEASE:
-        if (sq0.envelope.amplitude_factor <= sq0.envelope.release_stepp)
+        if (env->amplitude_factor <= env->release_stepp)
         {
-            sq0.envelope.amplitude_factor = 0;
-            sq0.envelope.state = ADSR_STATE_OFF;
+            env->amplitude_factor = 0;
+            env->state = ADSR_STATE_OFF;
         }
         else
         {
-            sq0.envelope.amplitude_factor -= sq0.envelope.release_stepp;
+            env->amplitude_factor -= env->release_stepp;
         }
 
-        sq0.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     default:
-#ifdef DEBUG
-        sprintf(g_utilities_char_buffer, "%s Invalid adsr envelope state sq0%s",
-                WARNING_TAG, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
-#endif
+        log_write(LOG_AUDIO_INVALID_ADSR_STATE,
+                  AUDIO_CH_SQUARE0, env->state, 0);
         break;
     }
 }
 
-static inline void modulate_sq1_adsr(void)
+static inline void modulate_sq1_adsr(audio_engine_t* engine)
 {
-    switch (sq1.envelope.state)
+    adsr_envelope_t* env = &engine->sq1.envelope;
+
+    switch (env->state)
     {
     case ADSR_STATE_OFF:
         break;
 
     case ADSR_STATE_ATTACK:
-        sq1.envelope.amplitude_factor += sq1.envelope.attack_stepp;
+        env->amplitude_factor += env->attack_stepp;
 
-        if (sq1.envelope.amplitude_factor >= Q16_16_T_ONE)
+        if (env->amplitude_factor >= Q16_16_T_ONE)
         {
-            sq1.envelope.amplitude_factor = Q16_16_T_ONE;
-            sq1.envelope.state = ADSR_STATE_DECAY;
+            env->amplitude_factor = Q16_16_T_ONE;
+            env->state = ADSR_STATE_DECAY;
         }
 
-        sq1.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     case ADSR_STATE_DECAY:
-        if (sq1.envelope.amplitude_factor >= sq1.envelope.decay_stepp)
+        if (env->amplitude_factor >= env->decay_stepp)
         {
-            sq1.envelope.amplitude_factor -= sq1.envelope.decay_stepp;
+            env->amplitude_factor -= env->decay_stepp;
 
-            if (sq1.envelope.amplitude_factor <= sq1.envelope.substain_factor)
+            if (env->amplitude_factor <= env->substain_factor)
             {
-                sq1.envelope.amplitude_factor = sq1.envelope.substain_factor;
-                sq1.envelope.state = ADSR_STATE_SUBSTAIN;
+                env->amplitude_factor = env->substain_factor;
+                env->state = ADSR_STATE_SUBSTAIN;
             }
         }
         else
         {
-            sq1.envelope.amplitude_factor = sq1.envelope.substain_factor;
-            sq1.envelope.state = ADSR_STATE_SUBSTAIN;
+            env->amplitude_factor = env->substain_factor;
+            env->state = ADSR_STATE_SUBSTAIN;
         }
 
-        sq1.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     case ADSR_STATE_SUBSTAIN:
         break;
 
     case ADSR_STATE_RELEASE:
-        if (sq1.envelope.amplitude_factor <= sq1.envelope.release_stepp)
+        if (env->amplitude_factor <= env->release_stepp)
         {
-            sq1.envelope.amplitude_factor = 0;
-            sq1.envelope.state = ADSR_STATE_OFF;
+            env->amplitude_factor = 0;
+            env->state = ADSR_STATE_OFF;
         }
         else
         {
-            sq1.envelope.amplitude_factor -= sq1.envelope.release_stepp;
+            env->amplitude_factor -= env->release_stepp;
         }
 
-        sq1.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     default:
-#ifdef DEBUG
-        sprintf(g_utilities_char_buffer, "%s Invalid adsr envelope state sq1%s",
-                WARNING_TAG, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
-#endif
+        log_write(LOG_AUDIO_INVALID_ADSR_STATE,
+                  AUDIO_CH_SQUARE1, env->state, 0);
         break;
     }
 }
 
-static inline void modulate_noise0_adsr(void)
+static inline void modulate_noise0_adsr(audio_engine_t* engine)
 {
-    switch (noise0.envelope.state)
+    adsr_envelope_t* env = &engine->noise0.envelope;
+
+    switch (env->state)
     {
     case ADSR_STATE_OFF:
         break;
 
     case ADSR_STATE_ATTACK:
-        noise0.envelope.amplitude_factor += noise0.envelope.attack_stepp;
+        env->amplitude_factor += env->attack_stepp;
 
-        if (noise0.envelope.amplitude_factor >= Q16_16_T_ONE)
+        if (env->amplitude_factor >= Q16_16_T_ONE)
         {
-            noise0.envelope.amplitude_factor = Q16_16_T_ONE;
-            noise0.envelope.state = ADSR_STATE_DECAY;
+            env->amplitude_factor = Q16_16_T_ONE;
+            env->state = ADSR_STATE_DECAY;
         }
 
-        noise0.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     case ADSR_STATE_DECAY:
-        if (noise0.envelope.amplitude_factor >= noise0.envelope.decay_stepp)
+        if (env->amplitude_factor >= env->decay_stepp)
         {
-            noise0.envelope.amplitude_factor -= noise0.envelope.decay_stepp;
+            env->amplitude_factor -= env->decay_stepp;
 
-            if (noise0.envelope.amplitude_factor <= noise0.envelope.substain_factor)
+            if (env->amplitude_factor <= env->substain_factor)
             {
-                noise0.envelope.amplitude_factor = noise0.envelope.substain_factor;
-                noise0.envelope.state = ADSR_STATE_SUBSTAIN;
+                env->amplitude_factor = env->substain_factor;
+                env->state = ADSR_STATE_SUBSTAIN;
             }
         }
         else
         {
-            noise0.envelope.amplitude_factor = noise0.envelope.substain_factor;
-            noise0.envelope.state = ADSR_STATE_SUBSTAIN;
+            env->amplitude_factor = env->substain_factor;
+            env->state = ADSR_STATE_SUBSTAIN;
         }
 
-        noise0.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     case ADSR_STATE_SUBSTAIN:
         break;
 
     case ADSR_STATE_RELEASE:
-        if (noise0.envelope.amplitude_factor <= noise0.envelope.release_stepp)
+        if (env->amplitude_factor <= env->release_stepp)
         {
-            noise0.envelope.amplitude_factor = 0;
-            noise0.envelope.state = ADSR_STATE_OFF;
+            env->amplitude_factor = 0;
+            env->state = ADSR_STATE_OFF;
         }
         else
         {
-            noise0.envelope.amplitude_factor -= noise0.envelope.release_stepp;
+            env->amplitude_factor -= env->release_stepp;
         }
 
-        noise0.envelope.update_amplitude_event = true;
+        env->update_amplitude_event = true;
         break;
 
     default:
-#ifdef DEBUG
-        sprintf(g_utilities_char_buffer, "%s Invalid adsr envelope state n%s",
-                WARNING_TAG, NEWLINE);
-        uart_write_string(g_utilities_char_buffer);
-#endif
+        log_write(LOG_AUDIO_INVALID_ADSR_STATE,
+                  AUDIO_CH_NOISE0, env->state, 0);
         break;
     }
+}
+
+static q16_16_t bend_time_step(int16_t cents)
+{
+    int16_t semitones;
+
+    if (0 == cents)
+    {
+        return Q16_16_T_ONE;
+    }
+
+    // Round towards minus infinity, so that the remaining cents are positive
+    if (cents >= 0)
+    {
+        semitones = cents / PERIOD_TABLES_CENTS_PER_SEMITONE;
+    }
+    else
+    {
+        semitones = -((PERIOD_TABLES_CENTS_PER_SEMITONE - 1 - cents) /
+                      PERIOD_TABLES_CENTS_PER_SEMITONE);
+    }
+
+    cents -= semitones * PERIOD_TABLES_CENTS_PER_SEMITONE;
+
+    return q16_16_multiply(
+        g_period_tables_semitone_ratios[PERIOD_TABLES_MAX_BEND_SEMITONES +
+                                        semitones],
+        g_period_tables_cent_ratios[cents]);
+}
+
+static void restart_vibrato(audio_engine_t* engine, square_wave_ch_t* ch)
+{
+    ch->vibrato.period = 2 * ch->vibrato.falling_edge;
+    calc_vibrato_steps(engine, ch);
+    ch->vibrato.rising = true;
+    ch->vibrato.time = 0;
+}
+
+static void calc_vibrato_steps(audio_engine_t* engine, square_wave_ch_t* ch)
+{
+    uint8_t nbr_of_stepps = q16_16_to_int(ch->vibrato.falling_edge);
+
+    ch->vibrato.stepp = q16_16_multiply(engine->midi_note_periods[ch->note_nbr],
+                                        ch->vibrato.depth_factor) /
+                        nbr_of_stepps;
+    ch->vibrato.low_level = engine->midi_note_periods[ch->note_nbr] -
+                            ch->vibrato.stepp * nbr_of_stepps;
+}
+
+static void load_envelope(adsr_envelope_t* env,
+                          const audio_patch_adsr_t* adsr)
+{
+    env->attack = adsr->attack;
+    env->decay = adsr->decay;
+    env->substain = adsr->sustain;
+    env->release = adsr->release;
+    env->attack_stepp = adsr->attack_stepp;
+    env->decay_stepp = adsr->decay_stepp;
+    env->substain_factor = adsr->sustain_factor;
+    env->release_stepp = adsr->release_stepp;
+
+    if (env->on && !adsr->on)
+    {
+        //
+        // Without the envelope the note plays at full amplitude, the level
+        // is updated at the next period boundary.
+        //
+        env->state = ADSR_STATE_OFF;
+        env->amplitude_factor = Q16_16_T_ONE;
+        env->update_amplitude_event = true;
+    }
+
+    env->on = adsr->on;
+}
+
+static bool print_square_status_line(const square_wave_ch_t* ch,
+                                     uint8_t line)
+{
+    switch (line)
+    {
+    case 0:
+        sprintf(g_utilities_char_buffer,
+            "\tnote on: %d\t\t\tnote number: %u%s",
+                    ch->note_on, ch->note_nbr, NEWLINE);
+        break;
+
+    case 1:
+        sprintf(g_utilities_char_buffer,
+            "\tduty: %u\t\t\tis high: %d%s",
+                    ch->duty, ch->is_high, NEWLINE);
+        break;
+
+    case 2:
+        sprintf(g_utilities_char_buffer,
+            "\thigh level: %d\t\tlow level: %d%s",
+                    ch->high_level, ch->low_level, NEWLINE);
+        break;
+
+    case 3:
+        sprintf(g_utilities_char_buffer,
+            "\trising edge: %f\t\tperiod: %f%s",
+            q16_16_to_double(ch->rising_edge),
+            q16_16_to_double(ch->period), NEWLINE);
+        break;
+
+    case 4:
+        sprintf(g_utilities_char_buffer,
+            "\ttime: %f%s",
+                    q16_16_to_double(ch->time), NEWLINE);
+        break;
+
+    //
+    // Vibrato
+    //
+    case 5:
+        sprintf(g_utilities_char_buffer,
+            "\t[Vibrato]%s", NEWLINE);
+        break;
+
+    case 6:
+        sprintf(g_utilities_char_buffer,
+            "\t\ton: %d\t\t\tdepth: %u%s",
+            ch->vibrato.on, ch->vibrato.depth, NEWLINE);
+        break;
+
+    case 7:
+        sprintf(g_utilities_char_buffer,
+            "\t\trate: %u\t\t\trising: %d%s",
+            ch->vibrato.rate, ch->vibrato.rising, NEWLINE);
+        break;
+
+    case 8:
+        sprintf(g_utilities_char_buffer,
+            "\t\tfalling edge: %f\tperiod: %f%s",
+            q16_16_to_double(ch->vibrato.falling_edge),
+            q16_16_to_double(ch->vibrato.period),
+            NEWLINE);
+        break;
+
+    case 9:
+        sprintf(g_utilities_char_buffer,
+            "\t\ttime: %f\t\tlow level: %f%s",
+            q16_16_to_double(ch->vibrato.time),
+            q16_16_to_double(ch->vibrato.low_level), NEWLINE);
+        break;
+
+    case 10:
+        sprintf(g_utilities_char_buffer,
+            "\t\tstepp: %f%s",
+            q16_16_to_double(ch->vibrato.stepp), NEWLINE);
+        break;
+
+    //
+    // ADSR modulation
+    //
+    case 11:
+        sprintf(g_utilities_char_buffer,
+            "\t[ADSR]%s", NEWLINE);
+        break;
+
+    case 12:
+        sprintf(g_utilities_char_buffer,
+            "\t\ton: %u\t\t\tstate: %u%s",
+            ch->envelope.on, ch->envelope.state, NEWLINE);
+        break;
+
+    case 13:
+        sprintf(g_utilities_char_buffer,
+            "\t\ta: %u\t\t\td: %u%s",
+            ch->envelope.attack, ch->envelope.decay, NEWLINE);
+        break;
+
+    case 14:
+        sprintf(g_utilities_char_buffer,
+            "\t\ts: %u\t\t\tr: %u%s",
+            ch->envelope.substain, ch->envelope.release,
+            NEWLINE);
+        break;
+
+    case 15:
+        sprintf(g_utilities_char_buffer,
+            "\t\tattack stepp: %f\t\tdecay stepp: %f%s",
+            q16_16_to_double(ch->envelope.attack_stepp),
+            q16_16_to_double(ch->envelope.decay_stepp),
+            NEWLINE);
+        break;
+
+    case 16:
+        sprintf(g_utilities_char_buffer,
+            "\t\tsubstain factor: %f\trelease stepp: %f%s",
+            q16_16_to_double(ch->envelope.substain_factor),
+            q16_16_to_double(ch->envelope.release_stepp),
+            NEWLINE);
+        break;
+
+    case 17:
+        sprintf(g_utilities_char_buffer,
+            "\t\tamplitude factor: %f%s",
+            q16_16_to_double(ch->envelope.amplitude_factor),
+            NEWLINE);
+        break;
+
+    default:
+        return false;
+    }
+
+    uart_write_string(g_utilities_char_buffer);
+
+    return (line + 1u) < SQUARE_STATUS_LINES;
+}
+
+static bool print_triangle_status_line(const triangle_wave_ch_t* ch,
+                                       uint8_t line)
+{
+    switch (line)
+    {
+    case 0:
+        sprintf(g_utilities_char_buffer,
+            "\tnote on: %d\t\t\tnote number: %u%s",
+                    ch->note_on, ch->note_nbr, NEWLINE);
+        break;
+
+    case 1:
+        sprintf(g_utilities_char_buffer,
+            "\tduty: %u\t\t\tis rising: %d%s",
+                    ch->duty, ch->is_rising, NEWLINE);
+        break;
+
+    case 2:
+        sprintf(g_utilities_char_buffer,
+            "\tcurret value: %d\t\tlow level: %d%s",
+                    ch->current_value, ch->low_level,
+                    NEWLINE);
+        break;
+
+    case 3:
+        sprintf(g_utilities_char_buffer,
+            "\tfalling edge: %f\tperiod: %f%s",
+            q16_16_to_double(ch->falling_edge),
+            q16_16_to_double(ch->period), NEWLINE);
+        break;
+
+    case 4:
+        sprintf(g_utilities_char_buffer,
+            "\ttime: %f%s",
+                    q16_16_to_double(ch->time), NEWLINE);
+        break;
+
+    default:
+        return false;
+    }
+
+    uart_write_string(g_utilities_char_buffer);
+
+    return (line + 1u) < TRIANGLE_STATUS_LINES;
 }
\ No newline at end of file
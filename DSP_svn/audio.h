@@ -26,6 +26,7 @@
 
 #include "midi.h"
 #include "fixed_point.h"
+#include "audio_channels.h"
 
 // =============================================================================
 // Public type definitions
@@ -40,19 +41,264 @@ typedef enum audio_ch_nbr_t
     AUDIO_CH_NBR_OF_CHANNELS
 } audio_ch_nbr_t;
 
+/*
+ * Sample buffer statistics.
+ *
+ * The min fill histogram counts, for every modulation tick, which eighth of
+ * the sample buffer depth the lowest buffer level during that tick fell into.
+ * Bin 0 means that the buffer was close to empty.
+ */
+#define AUDIO_STATS_HISTOGRAM_SIZE  (8u)
+
+typedef struct audio_stats_t
+{
+    uint32_t underruns;             // Samples requested from an empty buffer
+    uint32_t overruns;              // Samples pushed into a full buffer
+    uint32_t last_underrun_tick;    // Timer tick of the last underrun
+    uint32_t min_fill_histogram[AUDIO_STATS_HISTOGRAM_SIZE];
+} audio_stats_t;
+
+/*
+ * Patch (instrument) settings.
+ *
+ * A patch holds the whole timbre of a voice. Besides the settings it holds
+ * the values derived from them, so that loading a patch is only copying.
+ * Use AUDIO_PATCH_VIBRATO and AUDIO_PATCH_ADSR to initialize the parts, they
+ * calculate the derived values at compile time so that patches can be
+ * placed in flash.
+ *
+ * Each channel uses the parts it supports: the square channels use all of
+ * them, the triangle channel the duty and the noise channel the envelope.
+ */
+typedef struct audio_patch_vibrato_t
+{
+    bool        on;
+    uint8_t     rate;           // [0, 127]
+    uint8_t     depth;          // [cents]
+    q16_16_t    falling_edge;   // Derived from rate
+    q16_16_t    depth_factor;   // Derived from depth
+} audio_patch_vibrato_t;
+
+typedef struct audio_patch_adsr_t
+{
+    bool        on;
+    uint8_t     attack;         // [10 ms]
+    uint8_t     decay;          // [10 ms]
+    uint8_t     sustain;        // [0, 127]
+    uint8_t     release;        // [10 ms]
+    q16_16_t    attack_stepp;   // Derived from attack
+    q16_16_t    decay_stepp;    // Derived from decay
+    q16_16_t    sustain_factor; // Derived from sustain
+    q16_16_t    release_stepp;  // Derived from release
+} audio_patch_adsr_t;
+
+/*
+ * Scope capture.
+ *
+ * While the scope is armed every calculated sample of the source, the mix
+ * or one channel, is stored in a ring buffer. When the trigger occurs the
+ * recording continues for AUDIO_SCOPE_SIZE - AUDIO_SCOPE_PRE_TRIGGER
+ * samples, so that the buffer holds the samples around the trigger.
+ *
+ * The only work per sample is storing the value the source points to. The
+ * level trigger is evaluated on the recorded samples by audio_calc_samples
+ * after each block.
+ */
+#define AUDIO_SCOPE_SIZE            (256u)
+#define AUDIO_SCOPE_PRE_TRIGGER     (AUDIO_SCOPE_SIZE / 2)
+
+// Scope source which records the mix of all channels.
+#define AUDIO_SCOPE_MIX             (AUDIO_CH_NBR_OF_CHANNELS)
+
+typedef enum audio_scope_trigger_t
+{
+    AUDIO_SCOPE_TRIGGER_NOW         = 0,    // When armed
+    AUDIO_SCOPE_TRIGGER_NOTE_ON     = 1,    // Note on, of any channel for
+                                            // the mix
+    AUDIO_SCOPE_TRIGGER_UNDERRUN    = 2,    // Sample buffer underrun
+    AUDIO_SCOPE_TRIGGER_LEVEL       = 3,    // |sample| >= level, e.g. clipping
+    AUDIO_SCOPE_NBR_OF_TRIGGERS
+} audio_scope_trigger_t;
+
+// The recording states are last, so that recording is one comparison.
+typedef enum audio_scope_state_t
+{
+    AUDIO_SCOPE_IDLE,           // Never armed
+    AUDIO_SCOPE_DONE,           // A capture is available
+    AUDIO_SCOPE_ARMED,          // Recording, waiting for the trigger
+    AUDIO_SCOPE_TRIGGERED       // Recording the samples after the trigger
+} audio_scope_state_t;
+
+typedef struct audio_scope_t
+{
+    int16_t                 buff[AUDIO_SCOPE_SIZE];
+    uint16_t                next;           // Index of the next sample
+    volatile uint16_t       stop;           // The value of next at which
+                                            // the recording stops
+    uint16_t                checked;        // Index of the next sample to
+                                            // check against level
+    volatile audio_scope_state_t state;
+    uint8_t                 source;         // Channel or AUDIO_SCOPE_MIX
+    const int16_t*          sample;         // The value recorded for source
+    audio_scope_trigger_t   trigger;
+    int16_t                 level;
+} audio_scope_t;
+
+typedef struct audio_patch_t
+{
+    uint8_t                 duty;
+    audio_patch_vibrato_t   vibrato;
+    audio_patch_adsr_t      adsr;
+} audio_patch_t;
+
+/*
+ * The sample buffer is backed by a statically allocated pool. The depth
+ * which is actually used can be changed at runtime to any power of two
+ * between SAMPLE_BUFF_MIN_DEPTH and SAMPLE_BUFF_POOL_SIZE. A deeper buffer
+ * is more robust against load spikes but adds latency.
+ *
+ * Both the pool size and the default depth can be overridden as project
+ * macros.
+ */
+#ifndef SAMPLE_BUFF_POOL_SIZE
+#define SAMPLE_BUFF_POOL_SIZE       (256u)
+#endif
+
+#ifndef SAMPLE_BUFF_DEFAULT_DEPTH
+#define SAMPLE_BUFF_DEFAULT_DEPTH   (128u)
+#endif
+
+#define SAMPLE_BUFF_MIN_DEPTH       (16u)
+
+/*
+ * Engine context.
+ *
+ * All state of one audio engine. Every audio function takes the engine it
+ * works on, so that host tools can run several engines side by side. The
+ * device has a single engine, g_audio_engine, whose address is a constant.
+ * Only audio.c should access the fields, use the functions below.
+ */
+typedef struct audio_engine_t
+{
+    // Channels: 2 square channels, 1 triangle channel and 1 noise channel
+    square_wave_ch_t    sq0;
+    square_wave_ch_t    sq1;
+    triangle_wave_ch_t  tri0;
+    noise_wave_ch_t     noise0;
+
+    int16_t     sample_buff[SAMPLE_BUFF_POOL_SIZE];
+    uint16_t    sample_buff_mask;
+    uint16_t    sample_buff_first;  // Index of the next sample to pop
+    uint16_t    sample_buff_next;   // Index of the next sample to push
+    uint16_t    sample_buff_size;   // The number of samples in the buffer
+    uint16_t    sample_buff_depth;  // The number of samples it can hold
+
+    // The index of the next sample to calculate. Wraps around.
+    uint32_t    sample_index;
+
+    // Accumulates the samples of each channel
+    int16_t     accumulator;
+
+    // Index of the current sample rate in the period tables.
+    uint8_t     sample_rate_index;
+
+    // The note periods for the current sample rate.
+    const q16_16_t* midi_note_periods;
+
+    // The current sample rate relative to the default sample rate.
+    q16_16_t    sample_rate_factor;
+
+    // The lowest number of samples in the sample buffer since the last read.
+    volatile uint16_t sample_buff_low_water;
+
+    // Sample buffer statistics. The underrun fields are written from the
+    // interrupt context.
+    volatile audio_stats_t stats;
+
+    // The lowest number of samples in the sample buffer during the current
+    // tick.
+    volatile uint16_t stats_min_fill;
+
+    // Channels which are disabled are not calculated at all.
+    bool            channel_enabled[AUDIO_CH_NBR_OF_CHANNELS];
+
+    channel_gain_t  channel_gain[AUDIO_CH_NBR_OF_CHANNELS];
+    uint8_t         master_volume;
+
+    // The modulation is applied once every modulation_divider calls.
+    uint8_t     modulation_divider;
+    uint8_t     modulation_counter;
+
+    // The pitch bend value and range (in semitones) of each channel.
+    uint16_t    pitch_bend[AUDIO_CH_NBR_OF_CHANNELS];
+    uint8_t     pitch_bend_range[AUDIO_CH_NBR_OF_CHANNELS];
+
+    audio_scope_t   scope;
+} audio_engine_t;
+
+
 
 // =============================================================================
 // Global variable declarations
 // =============================================================================
 
-// The number of samples in the sample buffer.
-extern uint16_t g_audio_sample_buff_size;
+// The engine of the device.
+extern audio_engine_t g_audio_engine;
 
 // =============================================================================
 // Global constatants
 // =============================================================================
-#define SAMPLE_BUFF_SIZE        ((uint16_t)128u)
-#define SAMPLE_BUFF_HALF_SIZE   ((uint16_t)64u)
+
+// The relative period change of one cent.
+#define AUDIO_ONE_CENT_CHANGE_FACTOR    (0.000561256873183065)
+
+/*
+ * Initializers for the patch parts, see audio_patch_t. The derived values
+ * are calculated in the same way as by audio_configure_vibrato and
+ * audio_configure_amplitude_adsr.
+ */
+#define AUDIO_PATCH_NO_VIBRATO                                              \
+    { false, 0, 0, Q16_16_T_ONE * 128, 0 }
+
+#define AUDIO_PATCH_VIBRATO(rate, depth)                                    \
+    { true, (rate), (depth),                                                \
+      Q16_16_T_ONE * (128 - (rate)),                                        \
+      (q16_16_t)((depth) * AUDIO_ONE_CENT_CHANGE_FACTOR * UINT16_MAX) }
+
+#define AUDIO_PATCH_ADSR_STEPP(t)                                           \
+    ((0 != (t)) ? (Q16_16_T_ONE / (t)) : Q16_16_T_ONE)
+
+#define AUDIO_PATCH_ADSR(on, a, d, s, r)                                    \
+    { (on), (a), (d), (s), (r),                                             \
+      AUDIO_PATCH_ADSR_STEPP(a),                                            \
+      AUDIO_PATCH_ADSR_STEPP(d),                                            \
+      (Q16_16_T_ONE / 127) * (s),                                           \
+      ((0 != (r)) ? (Q16_16_T_ONE / (r)) : (2 * Q16_16_T_ONE)) }
+
+// The maximum channel and master volume, which gives unity gain.
+#define AUDIO_VOLUME_MAX            (127u)
+
+// The 14 bit pitch bend value which gives no bend.
+#define AUDIO_PITCH_BEND_CENTER     (8192u)
+
+// The largest 14 bit pitch bend value.
+#define AUDIO_PITCH_BEND_MAX        (16383u)
+
+// The default pitch bend range in semitones.
+#define AUDIO_PITCH_BEND_DEFAULT_RANGE  (2u)
+
+#if (SAMPLE_BUFF_POOL_SIZE & (SAMPLE_BUFF_POOL_SIZE - 1)) != 0
+#error SAMPLE_BUFF_POOL_SIZE must be a power of two
+#endif
+
+#if (SAMPLE_BUFF_DEFAULT_DEPTH & (SAMPLE_BUFF_DEFAULT_DEPTH - 1)) != 0
+#error SAMPLE_BUFF_DEFAULT_DEPTH must be a power of two
+#endif
+
+#if (SAMPLE_BUFF_DEFAULT_DEPTH > SAMPLE_BUFF_POOL_SIZE) || \
+    (SAMPLE_BUFF_DEFAULT_DEPTH < SAMPLE_BUFF_MIN_DEPTH)
+#error SAMPLE_BUFF_DEFAULT_DEPTH must fit in the sample buffer pool
+#endif
 
 // =============================================================================
 // Public function declarations
@@ -64,10 +310,10 @@ extern uint16_t g_audio_sample_buff_size;
 
 /**
  * @brief Initializes the audio engine.
- * @param void
+ * @param engine - The engine.
  * @return void
  */
-void audio_init(void);
+void audio_init(audio_engine_t* engine);
 
 
 /* *********************************************************
@@ -76,19 +322,31 @@ void audio_init(void);
 /**
  * @brief Calculates one audio sample.
  * @details The calculated sample is pushed into the sample FIFO buffer.
- * @param void
+ *          The scope level trigger is not evaluated, see audio_calc_samples.
+ * @param engine - The engine.
+ * @return void
+ */
+void audio_calc_sample(audio_engine_t* engine);
+
+/**
+ * @brief Calculates a block of audio samples.
+ * @details The calculated samples are pushed into the sample FIFO buffer.
+ *          The scope level trigger is evaluated after the block.
+ * @param engine - The engine.
+ * @param nbr_of_samples - The number of samples to calculate, at most
+ *        AUDIO_SCOPE_SIZE - AUDIO_SCOPE_PRE_TRIGGER.
  * @return void
  */
-void audio_calc_sample(void);
+void audio_calc_samples(audio_engine_t* engine, uint16_t nbr_of_samples);
 
 
 /**
  * @brief Applies the configured delta modulation to all channels.
  * @details This function should be called every 480 samples.
- * @param void
+ * @param engine - The engine.
  * @return void
  */
-void audio_apply_modulation(void);
+void audio_apply_modulation(audio_engine_t* engine);
 
 /* *********************************************************
  *      Sample FIFO buffer                                 *
@@ -96,39 +354,152 @@ void audio_apply_modulation(void);
 
 /**
  * @brief Pops one sample from the sample buffer.
- * @param void
+ * @param engine - The engine.
  * @return The first sample if the FIFO buffer.
  */
-int16_t audio_pop_sample(void);
+int16_t audio_pop_sample(audio_engine_t* engine);
 
 /**
  * @brief Checks if the sample buffer is empty.
- * @param void
+ * @param engine - The engine.
  * @return True if the sample buffer is empty, false otherwise.
  */
-static inline bool audio_is_sample_buffer_empty(void)
+static inline bool audio_is_sample_buffer_empty(audio_engine_t* engine)
 {
-    return 0 == g_audio_sample_buff_size;
+    return 0 == engine->sample_buff_size;
 }
 
 /**
  * @brief Checks if the sample buffer is full.
- * @param void
+ * @param engine - The engine.
  * @return True if the sample buffer is full, false otherwise.
  */
-static inline bool audio_is_sample_buff_full(void)
+static inline bool audio_is_sample_buff_full(audio_engine_t* engine)
 {
-    return SAMPLE_BUFF_SIZE == g_audio_sample_buff_size;
+    return engine->sample_buff_depth == engine->sample_buff_size;
 }
 
 /**
  * @brief Gets the number of calculated samples in the sample buffer.
- * @param void
+ * @param engine - The engine.
  * @return The number of samples in the sample buffer.
  */
-static inline uint16_t audio_get_sample_buff_size(void)
+static inline uint16_t audio_get_sample_buff_size(audio_engine_t* engine)
+{
+    return engine->sample_buff_size;
+}
+
+/**
+ * @brief Gets the number of samples the sample buffer can hold.
+ * @param engine - The engine.
+ * @return The depth of the sample buffer.
+ */
+static inline uint16_t audio_get_sample_buff_depth(audio_engine_t* engine)
+{
+    return engine->sample_buff_depth;
+}
+
+/**
+ * @brief Gets the index of the next sample to calculate.
+ * @details The index counts all samples calculated since start up and is
+ *          used as time base for timestamped events.
+ * @param engine - The engine.
+ * @return The index of the next sample.
+ */
+static inline uint32_t audio_get_sample_index(audio_engine_t* engine)
+{
+    return engine->sample_index;
+}
+
+/**
+ * @brief Gets the sample index at which an event scheduled now will be
+ *        heard one full sample buffer later.
+ * @details Scheduling events relative to this index, instead of relative to
+ *          the sample currently being calculated, gives the same latency
+ *          regardless of how full the sample buffer is.
+ * @param engine - The engine.
+ * @return The sample index.
+ */
+static inline uint32_t audio_get_schedule_base(audio_engine_t* engine)
 {
-    return g_audio_sample_buff_size;
+    return engine->sample_index - engine->sample_buff_size +
+           engine->sample_buff_depth;
+}
+
+/**
+ * @brief Changes the depth of the sample buffer.
+ * @details The sample buffer is flushed. The caller must make sure that no
+ *          samples are popped while the depth is changed.
+ * @param engine - The engine.
+ * @param depth - The new depth. Must be a power of two within
+ *        [SAMPLE_BUFF_MIN_DEPTH, SAMPLE_BUFF_POOL_SIZE].
+ * @return True if the depth was changed, false if it is not valid.
+ */
+bool audio_set_sample_buff_depth(audio_engine_t* engine, uint16_t depth);
+
+/**
+ * @brief Gets the latency from a note on until it reaches the DAC.
+ * @details This is the time it takes to play a full sample buffer at the
+ *          current sample rate.
+ * @param engine - The engine.
+ * @return The latency in microseconds.
+ */
+uint32_t audio_get_latency_us(audio_engine_t* engine);
+
+/**
+ * @brief Gets the lowest sample buffer level since the last call.
+ * @details The low water mark is updated every time a sample is popped and
+ *          is reset to the current buffer level by this function.
+ * @param engine - The engine.
+ * @return The lowest number of samples in the sample buffer.
+ */
+uint16_t audio_get_and_reset_low_water_mark(audio_engine_t* engine);
+
+/* *********************************************************
+ *      Statistics                                         *
+ ***********************************************************/
+
+/**
+ * @brief Registers that a sample was requested from an empty sample buffer.
+ * @details Should be called from the interrupt that consumes the samples.
+ * @param engine - The engine.
+ * @return void
+ */
+void audio_register_underrun(audio_engine_t* engine);
+
+/**
+ * @brief Updates the min fill histogram.
+ * @details Should be called every timer tick.
+ * @param engine - The engine.
+ * @return void
+ */
+void audio_update_stats(audio_engine_t* engine);
+
+/**
+ * @brief Gets a copy of the sample buffer statistics.
+ * @param engine - The engine.
+ * @param dst - Pointer to where the statistics will be copied.
+ * @return void
+ */
+void audio_get_stats(audio_engine_t* engine, audio_stats_t* dst);
+
+/**
+ * @brief Resets the sample buffer statistics.
+ * @param engine - The engine.
+ * @return void
+ */
+void audio_reset_stats(audio_engine_t* engine);
+
+/**
+ * @brief Gets the lowest number of samples in the sample buffer during the
+ *        current timer tick.
+ * @details Should be read before audio_update_stats, which starts a new tick.
+ * @param engine - The engine.
+ * @return The lowest sample buffer fill level of the tick.
+ */
+static inline uint16_t audio_get_tick_min_fill(audio_engine_t* engine)
+{
+    return engine->stats_min_fill;
 }
 
 /* *********************************************************
@@ -137,58 +508,78 @@ static inline uint16_t audio_get_sample_buff_size(void)
 
 /**
  * @brief Turns a note on for one channel.
+ * @param engine - The engine.
  * @param channel - The channel to play the note on.
  * @param note_nbr - The note to play.
  * @param amplitude - The amplitude of the note.
  * @return void
  */
-void audio_note_on(audio_ch_nbr_t channel,
+void audio_note_on(audio_engine_t* engine, audio_ch_nbr_t channel,
                    midi_notes_t note_nbr,
                    uint8_t amplitude);
 
 /**
  * @brief Turns the current note off on a specified channel.
+ * @param engine - The engine.
  * @param channel - The channel which note to turn off.
  * @return void
  */
-void audio_note_off(audio_ch_nbr_t channel);
+void audio_note_off(audio_engine_t* engine, audio_ch_nbr_t channel);
 
 /**
  * @brief Sets the duty cycle of a square or triangle channel.
+ * @param engine - The engine.
  * @param channel - The channel which duty cycle to change.
  * @param duty - The new duty cycle.
  * @return void
  */
-void audio_set_duty(audio_ch_nbr_t channel, uint8_t duty);
+void audio_set_duty(audio_engine_t* engine, audio_ch_nbr_t channel,
+                    uint8_t duty);
+
+/**
+ * @brief Gets the vibrato settings of one channel.
+ * @param engine - The engine.
+ * @param channel - The channel which vibrato settings to get.
+ * @param speed - Where the speed of the vibrato will be written.
+ * @param amount - Where the amount of the vibrato will be written.
+ * @return True if the channel supports vibrato, false otherwise.
+ */
+bool audio_get_vibrato(audio_engine_t* engine, audio_ch_nbr_t channel,
+                       uint8_t* speed,
+                       uint8_t* amount);
 
 /**
  * @brief Configures the vibrato settings of one channel.
+ * @param engine - The engine.
  * @param channel - The channel which vibrato settings to change.
  * @param speed - The speed of the vibrato. Must be within [0, 127]
  * @param amount - How much the pich should change during the vibrato.
  * @return void
  */
-void audio_configure_vibrato(audio_ch_nbr_t channel,
+void audio_configure_vibrato(audio_engine_t* engine, audio_ch_nbr_t channel,
                              uint8_t speed,
                              uint8_t amount);
 
 /**
  * @brief Turns the vibrato off for one channel.
+ * @param engine - The engine.
  * @param channel - The channel which vibrator to turn off.
  * @return void
  */
-void audio_vibrato_off(audio_ch_nbr_t channel);
+void audio_vibrato_off(audio_engine_t* engine, audio_ch_nbr_t channel);
 
 /**
  * @brief Turns the vibrato on for one channel.
+ * @param engine - The engine.
  * @param channel - The channel which vibrator to turn off.
  * @return void
  */
-void audio_vibrato_on(audio_ch_nbr_t channel);
+void audio_vibrato_on(audio_engine_t* engine, audio_ch_nbr_t channel);
 
 /**
  * @brief Configures the ADSR envelope for the amplitude.
  * @details a, d, s and r must be less than 128
+ * @param engine - The engine.
  * @param channel - The channels which adsr envelope to configure.
  * @param a - The attack time [10ms]
  * @param d - The decay time [10ms]
@@ -196,32 +587,251 @@ void audio_vibrato_on(audio_ch_nbr_t channel);
  * @param r - The release time [10ms]
  * @return void
  */
-void audio_configure_amplitude_adsr(audio_ch_nbr_t channel,
+void audio_configure_amplitude_adsr(audio_engine_t* engine,
+                                    audio_ch_nbr_t channel,
                                     uint8_t a, uint8_t d,
                                     uint8_t s, uint8_t r);
 
+/**
+ * @brief Gets the ADSR envelope configuration of one channel.
+ * @param engine - The engine.
+ * @param channel - The channel which adsr envelope to get.
+ * @param adsr - Where the a, d, s and r values will be written.
+ * @return True if the channel has an ADSR envelope, false otherwise.
+ */
+bool audio_get_amplitude_adsr(audio_engine_t* engine, audio_ch_nbr_t channel,
+                              uint8_t adsr[4]);
+
 /**
  * @brief Turns the amplitude ADSR modulation on for one channel.
+ * @param engine - The engine.
  * @param channel - The channel which ADSR modulation to turn on.
  */
-void audio_amplitude_adsr_on(audio_ch_nbr_t channel);
+void audio_amplitude_adsr_on(audio_engine_t* engine, audio_ch_nbr_t channel);
 
 /**
  * @brief Turns the amplitude ADSR modulation off for one channel.
+ * @param engine - The engine.
  * @param channel - The channel which ADSR modulation to turn off.
  */
-void audio_amplitude_adsr_off(audio_ch_nbr_t channel);
+void audio_amplitude_adsr_off(audio_engine_t* engine, audio_ch_nbr_t channel);
+
+/* *********************************************************
+ *      Mixer                                              *
+ ***********************************************************/
+
+/**
+ * @brief Sets the volume of one channel.
+ * @details The change is ramped in over a few modulation ticks.
+ * @param engine - The engine.
+ * @param channel - The channel which volume to set.
+ * @param volume - The volume within [0, AUDIO_VOLUME_MAX].
+ * @return void
+ */
+void audio_set_volume(audio_engine_t* engine, audio_ch_nbr_t channel,
+                      uint8_t volume);
+
+/**
+ * @brief Sets the master volume of the digital mix.
+ * @details The change is ramped in over a few modulation ticks.
+ * @param engine - The engine.
+ * @param volume - The volume within [0, AUDIO_VOLUME_MAX].
+ * @return void
+ */
+void audio_set_master_volume(audio_engine_t* engine, uint8_t volume);
+
+/**
+ * @brief Mutes or unmutes one channel.
+ * @param engine - The engine.
+ * @param channel - The channel to mute or unmute.
+ * @param mute - True to mute the channel, false to unmute it.
+ * @return void
+ */
+void audio_set_mute(audio_engine_t* engine, audio_ch_nbr_t channel, bool mute);
+
+/**
+ * @brief Solos or unsolos one channel.
+ * @details While at least one channel is soloed, all channels which are not
+ *          soloed are silent.
+ * @param engine - The engine.
+ * @param channel - The channel to solo or unsolo.
+ * @param solo - True to solo the channel, false to unsolo it.
+ * @return void
+ */
+void audio_set_solo(audio_engine_t* engine, audio_ch_nbr_t channel, bool solo);
+
+/**
+ * @brief Loads a patch into one channel.
+ * @details All settings of the patch are changed at once, between two
+ *          samples. A playing note keeps playing with the new settings.
+ * @param engine - The engine.
+ * @param channel - The channel to load the patch into.
+ * @param patch - The patch to load.
+ * @return void
+ */
+void audio_set_patch(audio_engine_t* engine, audio_ch_nbr_t channel,
+                     const audio_patch_t* patch);
+
+/**
+ * @brief Bends the pitch of one tonal channel.
+ * @details The bend is kept until it is changed, also over new notes.
+ * @param engine - The engine.
+ * @param channel - The channel to bend, a square or triangle channel.
+ * @param bend - The 14 bit bend value within [0, AUDIO_PITCH_BEND_MAX].
+ *        AUDIO_PITCH_BEND_CENTER gives no bend, the limits give a bend of
+ *        the pitch bend range down and up.
+ * @return void
+ */
+void audio_set_pitch_bend(audio_engine_t* engine, audio_ch_nbr_t channel,
+                          uint16_t bend);
+
+/**
+ * @brief Sets the pitch bend range of one tonal channel.
+ * @param engine - The engine.
+ * @param channel - The channel, a square or triangle channel.
+ * @param semitones - The range within [0, PERIOD_TABLES_MAX_BEND_SEMITONES].
+ * @return void
+ */
+void audio_set_pitch_bend_range(audio_engine_t* engine, audio_ch_nbr_t channel,
+                                uint8_t semitones);
+
+/* *********************************************************
+ *      Sample rate                                        *
+ ***********************************************************/
+
+/**
+ * @brief Changes the sample rate of the audio engine.
+ * @details The note periods are taken from precomputed tables and the timing
+ *          of all channels is re-derived from their notes, so notes that
+ *          are playing keep their pitch and phase. The samples in the sample
+ *          buffer are not recalculated. The DAC must be reconfigured
+ *          separately.
+ * @param engine - The engine.
+ * @param sample_freq_hz - The new sample rate. Must be one of
+ *        16000, 22050, 24000, 32000, 44100 or 48000.
+ * @return True if the sample rate is supported, false otherwise.
+ */
+bool audio_set_sample_freq(audio_engine_t* engine, uint16_t sample_freq_hz);
+
+/**
+ * @brief Gets the current sample rate of the audio engine.
+ * @param engine - The engine.
+ * @return The sample rate in Hz.
+ */
+uint16_t audio_get_sample_freq(audio_engine_t* engine);
+
+/* *********************************************************
+ *      Load shedding                                      *
+ ***********************************************************/
+
+/**
+ * @brief Enables or disables the sample calculation of one channel.
+ * @details A disabled channel keeps its state but does not contribute to
+ *          the output and costs no time in audio_calc_sample.
+ * @param engine - The engine.
+ * @param channel - The channel to enable or disable.
+ * @param enabled - True to enable the channel, false to disable it.
+ * @return void
+ */
+void audio_set_channel_enabled(audio_engine_t* engine, audio_ch_nbr_t channel,
+                               bool enabled);
+
+/**
+ * @brief Checks if a channel is enabled.
+ * @param engine - The engine.
+ * @param channel - The channel to check.
+ * @return True if the channel is enabled, false otherwise.
+ */
+bool audio_is_channel_enabled(audio_engine_t* engine, audio_ch_nbr_t channel);
+
+/**
+ * @brief Checks if a note is playing on a channel.
+ * @details A released note is not on, also while its envelope is in the
+ *          release state.
+ * @param engine - The engine.
+ * @param channel - The channel to check.
+ * @return True if a note is playing, false otherwise.
+ */
+bool audio_is_note_on(audio_engine_t* engine, audio_ch_nbr_t channel);
+
+/**
+ * @brief Gets the state of the amplitude envelope of a channel.
+ * @param engine - The engine.
+ * @param channel - The channel.
+ * @return The envelope state, ADSR_STATE_OFF for the triangle channel
+ *         which has no envelope.
+ */
+adsr_state_t audio_get_envelope_state(audio_engine_t* engine,
+                                      audio_ch_nbr_t channel);
+
+/**
+ * @brief Sets how often the modulation is applied.
+ * @details With a divider of n, only every n:th call to
+ *          audio_apply_modulation has any effect. Vibrato and envelopes
+ *          will run n times slower.
+ * @param engine - The engine.
+ * @param divider - The modulation divider, 1 applies modulation every call.
+ * @return void
+ */
+void audio_set_modulation_divider(audio_engine_t* engine, uint8_t divider);
 
 /* *********************************************************
  *      Debug functions                                    *
  ***********************************************************/
 
 /**
- * @brief Prints the channel status on the UART interface.
+ * @brief Arms the scope, which discards the previous capture.
+ * @details A channel which is disabled while recording keeps its last
+ *          sample.
+ * @param engine - The engine.
+ * @param source - The channel to record, or AUDIO_SCOPE_MIX.
+ * @param trigger - The event to capture the samples around.
+ * @param level - The level of AUDIO_SCOPE_TRIGGER_LEVEL, not used by the
+ *                other triggers.
+ * @return True if the scope was armed, false if an argument is invalid.
+ */
+bool audio_scope_arm(audio_engine_t* engine,
+                     uint8_t source,
+                     audio_scope_trigger_t trigger,
+                     int16_t level);
+
+/**
+ * @brief Gets the state of the scope.
+ * @param engine - The engine.
+ * @return The scope state.
+ */
+static inline audio_scope_state_t audio_scope_get_state(audio_engine_t* engine)
+{
+    return engine->scope.state;
+}
+
+/**
+ * @brief Reads samples of the last capture.
+ * @details Sample AUDIO_SCOPE_PRE_TRIGGER is the first sample at or after
+ *          the trigger.
+ * @param engine - The engine.
+ * @param first - The first sample to read, 0 is the oldest sample.
+ * @param nbr_of_samples - The number of samples to read.
+ * @param dst - Where to write the samples.
+ * @return The number of samples read, 0 if there is no capture.
+ */
+uint16_t audio_scope_read(audio_engine_t* engine,
+                          uint16_t first,
+                          uint16_t nbr_of_samples,
+                          int16_t* dst);
+
+/**
+ * @brief Prints one line of the channel status on the UART interface.
+ * @details Some lines format floating point values, which takes a long
+ *          time, so the status is printed one line per call.
+ * @param engine - The engine.
  * @param channel - The channels which status to print.
- * @return void
+ * @param line - The line to print, from 0.
+ * @return True if there are more lines after this one.
  */
-void audio_print_channel_status(audio_ch_nbr_t channel);
+bool audio_print_channel_status(audio_engine_t* engine,
+                                audio_ch_nbr_t channel,
+                                uint8_t line);
 
 #ifdef	__cplusplus
 }
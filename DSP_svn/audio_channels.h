@@ -0,0 +1,281 @@
+/*
+ * File:   audio_channels.h
+ * Author: Erik
+ *
+ * The state of the audio engine channels, which is held in audio_engine_t.
+ * Only audio.c should access it.
+ */
+
+#ifndef AUDIO_CHANNELS_H
+#define	AUDIO_CHANNELS_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fixed_point.h"
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+/* ADSR envelope
+ *
+ * Attack - Decay - Substain - Release
+ *
+ *          Amplitude
+ *              ^
+ *              |
+ * amplitude - -|- - ->*
+ *              |     *  *
+ *              |    *     *
+ *         s - -| - * - - - -* * * * * * * * * *
+ *              |  *                             *
+ *              | *                                *
+ *              |*                                   *
+ *          0 - *--------------------------------------*-------> Time
+ *              <------><---->                  <------>
+ *                 a      d                         r
+ */
+typedef enum adsr_state_t
+{
+    ADSR_STATE_OFF,
+    ADSR_STATE_ATTACK,
+    ADSR_STATE_DECAY,
+    ADSR_STATE_SUBSTAIN,
+    ADSR_STATE_RELEASE
+} adsr_state_t;
+
+typedef struct adsr_envelope_t
+{
+    bool            on;
+    bool            update_amplitude_event;
+    adsr_state_t    state;
+    uint8_t         attack;     // a
+    uint8_t         decay;      // d
+    uint8_t         substain;   // s
+    uint8_t         release;    // r
+    q16_16_t        amplitude_factor;
+    q16_16_t        substain_factor;
+    q16_16_t        attack_stepp;
+    q16_16_t        decay_stepp;
+    q16_16_t        release_stepp;
+} adsr_envelope_t;
+
+/*
+ * Vibrato
+ *
+ * (frequency modulation)
+ *
+ *           Frequency
+ *              ^       falling_edge           sampling frequency
+ *              |           !                        <->
+ *              |            ---                     ---
+ *              |  stepp -> |   |                   |   |
+ *              |        ---     ---             ---     ---
+ *              |-------|-----------|-----------|-----------|--------> Time
+ *              |    ---             ---     ---             ---
+ *              |   |           stepp-> |   |                   |
+ *  low_level-->|---                     ---                     ---
+ *              |<---------------------->
+ *                       period
+ */
+typedef struct vibrato_t
+{
+    bool on;
+    uint8_t     depth;
+    uint8_t     rate;
+    bool        rising;
+    q16_16_t    falling_edge;
+    q16_16_t    period;
+    q16_16_t    time;
+    q16_16_t    low_level;
+    q16_16_t    stepp;
+    q16_16_t    depth_factor;   // The relative period change of depth
+} vibrato_t;
+
+
+/*
+ * Portamento
+ *
+ *      Frequency
+ *          ^                 duration
+ *          |                  <---->
+ *          |                  .    /---------------- . . . target_frequency
+ *          |                  .   /
+ *          |                  .  /
+ *          |                  . /
+ *          |------------------./
+ *          |                  .
+ *          |------------------.--------------------------> time
+ *                             .
+ *                          note on
+ */
+typedef struct portamento_t
+{
+    bool        on;
+    bool        active;
+    q16_16_t    stepp;
+    q16_16_t    target_frequency;
+} portamento_t;
+
+/*
+ * Arpeggio
+ *
+ *      |----|)-------------6--------------------------6--------------
+ *      |----/-----mmmmmmmmmmmmmmmmmmmmm----mmmmmmmmmmmmmmmmmmmmm-----
+ *      |-- /|-----|---|---|---|---|---|----|---|---|---|---|---|-----
+ *      |--/(|,\---|---|--@----|---|--@-----|---|--@----|---|--@------
+ *      |--\_|_/---|--@--------|--@---------|--@--------|--@----------
+ *         (_|   -@-         -@-          -@-         -@-
+ */
+typedef struct arpeggio_t
+{
+    bool    on;
+    uint8_t speed;
+
+} arpeggio_t;
+
+
+/* Square wave type
+ *
+ *          Amplitude
+ *              ^    rising_edge
+ *              |        !
+ * high_level-->|. . . . .------------------          ------------------
+ *              |        |                  |        |                  |
+ *              |--------|------------------|--------|------------------|-> Time
+ *              |        |                  |        |                  |
+ * low_level--->|--------                    --------                    -----
+ *              |
+ *              |<------------------------->
+ *                         period
+ */
+typedef struct square_wave_ch_t
+{
+    bool            note_on;
+    uint8_t         note_nbr;
+    uint8_t         duty;
+    bool            is_high;
+    int16_t         high_level;
+    int16_t         low_level;
+    int16_t         high_level_limit;
+    int16_t         output;     // The last calculated sample
+    q16_16_t        rising_edge;
+    q16_16_t        period;
+    q16_16_t        time;
+    q16_16_t        time_step;  // Time per sample, bent by the pitch bend
+    vibrato_t       vibrato;
+    adsr_envelope_t envelope;
+} square_wave_ch_t;
+
+/*
+ * Triangle wave type
+ *
+ *          Amplitude
+ *              ^       falling_edge           sampling frequency
+ *              |           !                        <->
+ *              |            ---                     ---
+ *          up_step_size -> |   |                   |   |
+ *              |        ---     ---             ---     ---
+ *              |-------|-----------|-----------|-----------|---------> Time
+ *              |    ---             ---     ---             ---
+ *              |   |  down_step_size-> |   |                   |
+ *  low_level-->|---                     ---                     ---
+ *              |<---------------------->
+ *                       period
+ */
+typedef struct triangle_wave_ch_t
+{
+    bool            note_on;
+    uint8_t         note_nbr;
+    uint8_t         amplitude;
+    bool            is_rising;
+    uint8_t         duty;
+    int16_t         current_value;
+    int16_t         up_step_size;
+    int16_t         down_step_size;
+    int16_t         low_level;
+    bool            update_amplitude_event;
+    q16_16_t        time;
+    q16_16_t        time_step;  // Time per sample, bent by the pitch bend
+    q16_16_t        falling_edge;
+    q16_16_t        period;
+    vibrato_t       vibrato;
+} triangle_wave_ch_t;
+
+/* Noise wave type
+ *
+ *          Amplitude
+ *              ^
+ *              |
+ * high_level-->|. . . . .----   -----        --      ----
+ *              |        |    | |     |      |  |    |    |
+ *              |--------|----|-|-----|------|--|----|----|--------> Time
+ *              |        |    | |     |      |  |    |    |
+ * low_level--->|--------      -       ------    ----      --------                    -----
+ *              |
+ *              |
+ */
+typedef struct noise_wave_ch_t
+{
+    bool            note_on;
+    uint8_t         note_nbr;
+    uint8_t         prescaler;
+    uint8_t         counter;
+    bool            is_high;
+    uint16_t        amplitude;
+    uint16_t        current_amplitude;
+    int16_t         high_level;
+    int16_t         low_level;
+    int16_t         high_level_limit;
+    int16_t         output;     // The last calculated sample
+    q16_16_t        time;
+    q16_16_t        period;
+    adsr_envelope_t envelope;
+} noise_wave_ch_t;
+
+
+/*
+ * Channel gain
+ *
+ * The gain of a channel is the product of the channel volume and the master
+ * volume, or zero if the channel is muted or another channel is soloed.
+ * The gain is folded into the channel levels every time they are
+ * recalculated, so it costs nothing extra per sample. Changes are ramped
+ * over a few modulation ticks to avoid zipper noise.
+ */
+typedef struct channel_gain_t
+{
+    uint8_t     volume;
+    bool        mute;
+    bool        solo;
+    q16_16_t    gain;       // The current gain
+    q16_16_t    target;     // The gain to ramp towards
+    q16_16_t    stepp;      // Gain change per modulation tick
+} channel_gain_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* AUDIO_CHANNELS_H */
+
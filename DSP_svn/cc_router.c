@@ -0,0 +1,247 @@
+/*
+ * This file implements the routing of MIDI control changes to synthesis
+ * parameters.
+ *
+ * The latest value of each parameter is kept per channel together with a
+ * bit mask of the parameters which have changed since the last apply.
+ * Parameters which are configured together, like the four ADSR times, are
+ * read back from the engine so that changing one of them keeps the others.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cc_router.h"
+#include "audio.h"
+#include "midi.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+#define PARAM_BIT(param)        ((uint16_t)1 << (param))
+
+#define VIBRATO_PARAMS          (PARAM_BIT(CC_PARAM_VIBRATO_RATE) |         \
+                                 PARAM_BIT(CC_PARAM_VIBRATO_DEPTH))
+
+#define ADSR_PARAMS             (PARAM_BIT(CC_PARAM_ATTACK) |               \
+                                 PARAM_BIT(CC_PARAM_DECAY) |                \
+                                 PARAM_BIT(CC_PARAM_SUSTAIN) |              \
+                                 PARAM_BIT(CC_PARAM_RELEASE))
+
+static const char* const PARAM_NAMES[CC_NBR_OF_PARAMS] =
+{
+    "none",
+    "volume",
+    "duty",
+    "vibrato rate",
+    "vibrato depth",
+    "attack",
+    "decay",
+    "sustain",
+    "release"
+};
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static uint8_t control_map[CC_ROUTER_NBR_OF_CONTROLS];
+static uint8_t pending_values[AUDIO_CH_NBR_OF_CHANNELS][CC_NBR_OF_PARAMS];
+static uint16_t pending_params[AUDIO_CH_NBR_OF_CHANNELS];
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Applies the pending parameter changes of one channel.
+ * @param channel - The audio channel.
+ * @param params - Bit mask of the changed parameters.
+ * @return void
+ */
+static void apply_channel(audio_ch_nbr_t channel, uint16_t params);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void cc_router_init(void)
+{
+    memset(control_map, CC_PARAM_NONE, sizeof(control_map));
+    memset(pending_params, 0, sizeof(pending_params));
+
+    control_map[MIDI_CC_MODULATION]          = CC_PARAM_VIBRATO_DEPTH;
+    control_map[MIDI_CC_CHANNEL_VOLUME]      = CC_PARAM_VOLUME;
+    control_map[MIDI_CC_SOUND_VARIATION]     = CC_PARAM_DUTY;
+    control_map[MIDI_CC_RELEASE_TIME]        = CC_PARAM_RELEASE;
+    control_map[MIDI_CC_ATTACK_TIME]         = CC_PARAM_ATTACK;
+    control_map[MIDI_CC_DECAY_TIME]          = CC_PARAM_DECAY;
+    control_map[MIDI_CC_VIBRATO_RATE]        = CC_PARAM_VIBRATO_RATE;
+    control_map[MIDI_CC_VIBRATO_DEPTH]       = CC_PARAM_VIBRATO_DEPTH;
+    control_map[MIDI_CC_SOUND_CONTROLLER_10] = CC_PARAM_SUSTAIN;
+}
+
+void cc_router_handle(uint8_t channel, uint8_t control, uint8_t value)
+{
+    uint8_t param;
+
+    if ((channel >= AUDIO_CH_NBR_OF_CHANNELS) ||
+        (control >= CC_ROUTER_NBR_OF_CONTROLS))
+    {
+        return;
+    }
+
+    param = control_map[control];
+
+    if (CC_PARAM_NONE != param)
+    {
+        pending_values[channel][param] = value;
+        pending_params[channel] |= PARAM_BIT(param);
+    }
+}
+
+bool cc_router_set_param(uint8_t channel, cc_param_t param, uint8_t value)
+{
+    if ((channel >= AUDIO_CH_NBR_OF_CHANNELS) ||
+        (CC_PARAM_NONE == param) ||
+        (param >= CC_NBR_OF_PARAMS))
+    {
+        return false;
+    }
+
+    pending_values[channel][param] = value;
+    pending_params[channel] |= PARAM_BIT(param);
+
+    return true;
+}
+
+void cc_router_apply(void)
+{
+    uint8_t i;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        if (0 != pending_params[i])
+        {
+            apply_channel((audio_ch_nbr_t)i, pending_params[i]);
+            pending_params[i] = 0;
+        }
+    }
+}
+
+bool cc_router_set_map(uint8_t control, cc_param_t param)
+{
+    if ((control >= CC_ROUTER_NBR_OF_CONTROLS) ||
+        (param >= CC_NBR_OF_PARAMS))
+    {
+        return false;
+    }
+
+    control_map[control] = param;
+
+    return true;
+}
+
+cc_param_t cc_router_get_map(uint8_t control)
+{
+    if (control >= CC_ROUTER_NBR_OF_CONTROLS)
+    {
+        return CC_PARAM_NONE;
+    }
+
+    return (cc_param_t)control_map[control];
+}
+
+const char* cc_router_get_param_name(cc_param_t param)
+{
+    if (param >= CC_NBR_OF_PARAMS)
+    {
+        return PARAM_NAMES[CC_PARAM_NONE];
+    }
+
+    return PARAM_NAMES[param];
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void apply_channel(audio_ch_nbr_t channel, uint16_t params)
+{
+    const uint8_t* value = pending_values[channel];
+    uint8_t adsr[4];
+    uint8_t speed;
+    uint8_t amount;
+
+    if (params & PARAM_BIT(CC_PARAM_VOLUME))
+    {
+        audio_set_volume(&g_audio_engine, channel, value[CC_PARAM_VOLUME]);
+    }
+
+    if ((params & PARAM_BIT(CC_PARAM_DUTY)) &&
+        (AUDIO_CH_NOISE0 != channel))
+    {
+        // [0, 127] -> [0, 254]
+        audio_set_duty(&g_audio_engine, channel, value[CC_PARAM_DUTY] << 1);
+    }
+
+    if ((params & VIBRATO_PARAMS) &&
+        audio_get_vibrato(&g_audio_engine, channel, &speed, &amount))
+    {
+        if (params & PARAM_BIT(CC_PARAM_VIBRATO_RATE))
+        {
+            speed = value[CC_PARAM_VIBRATO_RATE];
+        }
+
+        if (params & PARAM_BIT(CC_PARAM_VIBRATO_DEPTH))
+        {
+            amount = value[CC_PARAM_VIBRATO_DEPTH];
+        }
+
+        audio_configure_vibrato(&g_audio_engine, channel, speed, amount);
+
+        if (0 == amount)
+        {
+            audio_vibrato_off(&g_audio_engine, channel);
+        }
+    }
+
+    if ((params & ADSR_PARAMS) &&
+        audio_get_amplitude_adsr(&g_audio_engine, channel, adsr))
+    {
+        if (params & PARAM_BIT(CC_PARAM_ATTACK))
+        {
+            adsr[0] = value[CC_PARAM_ATTACK];
+        }
+
+        if (params & PARAM_BIT(CC_PARAM_DECAY))
+        {
+            adsr[1] = value[CC_PARAM_DECAY];
+        }
+
+        if (params & PARAM_BIT(CC_PARAM_SUSTAIN))
+        {
+            adsr[2] = value[CC_PARAM_SUSTAIN];
+        }
+
+        if (params & PARAM_BIT(CC_PARAM_RELEASE))
+        {
+            adsr[3] = value[CC_PARAM_RELEASE];
+        }
+
+        audio_configure_amplitude_adsr(&g_audio_engine, channel,
+                                       adsr[0], adsr[1], adsr[2], adsr[3]);
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * File:   cc_router.h
+ * Author: Erik
+ *
+ * Maps MIDI control change messages to synthesis parameters.
+ *
+ * Each of the 128 control numbers maps to one parameter, or to none. The map
+ * is a lookup table, so routing a control change is a single array access.
+ *
+ * A control change only stores the new value and marks the parameter as
+ * changed. The audio engine is updated by cc_router_apply at the next
+ * modulation tick, so a burst of control changes costs one update per
+ * parameter instead of one per message.
+ */
+
+#ifndef CC_ROUTER_H
+#define	CC_ROUTER_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+typedef enum cc_param_t
+{
+    CC_PARAM_NONE           = 0,
+    CC_PARAM_VOLUME         = 1,    // Channel volume [0, 127]
+    CC_PARAM_DUTY           = 2,    // Duty cycle, 64 is 50 %
+    CC_PARAM_VIBRATO_RATE   = 3,    // Vibrato speed [0, 127]
+    CC_PARAM_VIBRATO_DEPTH  = 4,    // Vibrato amount [cents], 0 is off
+    CC_PARAM_ATTACK         = 5,    // ADSR attack time [10 ms]
+    CC_PARAM_DECAY          = 6,    // ADSR decay time [10 ms]
+    CC_PARAM_SUSTAIN        = 7,    // ADSR sustain level [0, 127]
+    CC_PARAM_RELEASE        = 8,    // ADSR release time [10 ms]
+    CC_NBR_OF_PARAMS
+} cc_param_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// The number of MIDI control numbers.
+#define CC_ROUTER_NBR_OF_CONTROLS   (128u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Sets the default control map and clears all pending changes.
+ * @param void
+ * @return void
+ */
+void cc_router_init(void);
+
+/**
+ * @brief Routes a control change to the parameter it is mapped to.
+ * @details The engine is not updated until cc_router_apply is called.
+ * @param channel - The audio channel.
+ * @param control - The MIDI control number [0, 127].
+ * @param value - The control value [0, 127].
+ * @return void
+ */
+void cc_router_handle(uint8_t channel, uint8_t control, uint8_t value);
+
+/**
+ * @brief Sets a parameter directly, without a control number.
+ * @details The engine is not updated until cc_router_apply is called.
+ * @param channel - The audio channel.
+ * @param param - The parameter.
+ * @param value - The parameter value [0, 127].
+ * @return True if the parameter was set, false if the arguments are not
+ *         valid.
+ */
+bool cc_router_set_param(uint8_t channel, cc_param_t param, uint8_t value);
+
+/**
+ * @brief Applies all pending parameter changes to the audio engine.
+ * @details Should be called once every modulation tick.
+ * @param void
+ * @return void
+ */
+void cc_router_apply(void);
+
+/**
+ * @brief Maps a control number to a parameter.
+ * @param control - The MIDI control number [0, 127].
+ * @param param - The parameter, CC_PARAM_NONE to remove the mapping.
+ * @return True if the mapping was changed, false if the arguments are not
+ *         valid.
+ */
+bool cc_router_set_map(uint8_t control, cc_param_t param);
+
+/**
+ * @brief Gets the parameter a control number is mapped to.
+ * @param control - The MIDI control number [0, 127].
+ * @return The parameter, CC_PARAM_NONE if the control is not mapped.
+ */
+cc_param_t cc_router_get_map(uint8_t control);
+
+/**
+ * @brief Gets the name of a parameter.
+ * @param param - The parameter.
+ * @return The name of the parameter.
+ */
+const char* cc_router_get_param_name(cc_param_t param);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* CC_ROUTER_H */
+
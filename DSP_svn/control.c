@@ -0,0 +1,255 @@
+/*
+ * This file implements the binary control protocol on the UART.
+ *
+ * The bytes of the frames are separated from the terminal text by the UART
+ * receive interrupt, see uart.h.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "control.h"
+#include "frame.h"
+#include "uart.h"
+#include "audio.h"
+#include "event_queue.h"
+#include "cc_router.h"
+#include "patch.h"
+#include "telemetry.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// The number of bytes read from the UART at a time.
+#define READ_CHUNK_SIZE         (16u)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static frame_decoder_t decoder;
+static control_stats_t stats;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Executes a received frame.
+ * @param frame - The frame to execute.
+ * @return void
+ */
+static void execute_frame(const frame_t* frame);
+
+/**
+ * @brief Pushes a note event which takes effect as soon as possible.
+ * @param frame - The note on or note off frame.
+ * @return void
+ */
+static void push_note_event(const frame_t* frame);
+
+/**
+ * @brief Sends the telemetry reply.
+ * @param void
+ * @return void
+ */
+static void send_telemetry(void);
+
+/**
+ * @brief Encodes and sends a reply frame.
+ * @param opcode - The opcode of the request.
+ * @param payload - The payload of the reply.
+ * @param length - The number of payload bytes.
+ * @return void
+ */
+static void send_reply(uint8_t opcode, const uint8_t* payload, uint8_t length);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void control_init(void)
+{
+    frame_decoder_init(&decoder);
+    memset(&stats, 0, sizeof(control_stats_t));
+}
+
+void control_process(uint16_t max_bytes)
+{
+    uint8_t chunk[READ_CHUNK_SIZE];
+    uint16_t nbr_of_bytes;
+    uint16_t i;
+
+    while (0 != max_bytes)
+    {
+        nbr_of_bytes = uart_read_frame_bytes(
+            chunk,
+            max_bytes < READ_CHUNK_SIZE ? max_bytes : READ_CHUNK_SIZE);
+
+        if (0 == nbr_of_bytes)
+        {
+            break;
+        }
+
+        max_bytes -= nbr_of_bytes;
+        stats.bytes += nbr_of_bytes;
+
+        for (i = 0; i != nbr_of_bytes; ++i)
+        {
+            if (frame_decode_byte(&decoder, chunk[i]))
+            {
+                ++stats.frames;
+                execute_frame(&decoder.frame);
+            }
+        }
+    }
+}
+
+void control_get_stats(control_stats_t* dst)
+{
+    memcpy(dst, &stats, sizeof(control_stats_t));
+    dst->crc_errors = decoder.crc_errors;
+    dst->length_errors += decoder.length_errors;
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void execute_frame(const frame_t* frame)
+{
+    switch (frame->opcode)
+    {
+    case CONTROL_OPCODE_PING:
+        send_reply(frame->opcode, frame->payload, frame->length);
+        break;
+
+    case CONTROL_OPCODE_NOTE_ON:
+        if (3 != frame->length)
+        {
+            ++stats.length_errors;
+        }
+        else
+        {
+            push_note_event(frame);
+        }
+        break;
+
+    case CONTROL_OPCODE_NOTE_OFF:
+        if (1 != frame->length)
+        {
+            ++stats.length_errors;
+        }
+        else
+        {
+            push_note_event(frame);
+        }
+        break;
+
+    case CONTROL_OPCODE_SET_PARAM:
+        if (3 != frame->length)
+        {
+            ++stats.length_errors;
+        }
+        else if (!cc_router_set_param(frame->payload[0],
+                                      (cc_param_t)frame->payload[1],
+                                      frame->payload[2]))
+        {
+            ++stats.argument_errors;
+        }
+        break;
+
+    case CONTROL_OPCODE_PROGRAM_CHANGE:
+        if (2 != frame->length)
+        {
+            ++stats.length_errors;
+        }
+        else if (!patch_program_change(frame->payload[0], frame->payload[1]))
+        {
+            ++stats.argument_errors;
+        }
+        break;
+
+    case CONTROL_OPCODE_GET_TELEMETRY:
+        send_telemetry();
+        break;
+
+    case CONTROL_OPCODE_SUBSCRIBE:
+        if (1 != frame->length)
+        {
+            ++stats.length_errors;
+        }
+        else
+        {
+            telemetry_set_period(frame->payload[0]);
+        }
+        break;
+
+    default:
+        ++stats.unknown_opcodes;
+        break;
+    }
+}
+
+static void push_note_event(const frame_t* frame)
+{
+    event_t event;
+
+    // The engine reports an invalid channel as text, which must not be mixed
+    // with the binary replies.
+    if ((frame->payload[0] >= AUDIO_CH_NBR_OF_CHANNELS) ||
+        ((CONTROL_OPCODE_NOTE_ON == frame->opcode) &&
+         ((frame->payload[1] > 127) || (frame->payload[2] > 127))))
+    {
+        ++stats.argument_errors;
+        return;
+    }
+
+    event.sample_index = audio_get_sample_index(&g_audio_engine);
+    event.channel = frame->payload[0];
+
+    if (CONTROL_OPCODE_NOTE_ON == frame->opcode)
+    {
+        event.type = EVENT_NOTE_ON;
+        event.data1 = frame->payload[1];
+        event.data2 = frame->payload[2];
+    }
+    else
+    {
+        event.type = EVENT_NOTE_OFF;
+        event.data1 = 0;
+        event.data2 = 0;
+    }
+
+    (void)event_queue_push(&event);
+}
+
+static void send_telemetry(void)
+{
+    uint8_t payload[TELEMETRY_SIZE];
+
+    telemetry_encode(payload);
+
+    send_reply(CONTROL_OPCODE_GET_TELEMETRY, payload, TELEMETRY_SIZE);
+}
+
+static void send_reply(uint8_t opcode, const uint8_t* payload, uint8_t length)
+{
+    uint8_t buff[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+    uint16_t size;
+
+    size = frame_encode(opcode | CONTROL_REPLY_FLAG, payload, length, buff);
+    uart_write_array(size, buff);
+}
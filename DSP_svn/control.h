@@ -0,0 +1,158 @@
+/*
+ * File:   control.h
+ * Author: Erik
+ *
+ * Binary control protocol on the UART.
+ *
+ * The protocol uses the same frames as the PIC32 link (see frame.h) and
+ * shares the UART with the text terminal. Every note, parameter and
+ * telemetry operation is one frame, which is parsed without any string
+ * handling. The frames are parsed in the main loop by control_process.
+ *
+ * Requests which return data are answered with a frame which has the opcode
+ * of the request with CONTROL_REPLY_FLAG set. Other requests are not
+ * answered, errors are only counted in the statistics. Multi byte values
+ * are little endian.
+ */
+
+#ifndef CONTROL_H
+#define	CONTROL_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+/*
+ * Frame opcodes
+ */
+typedef enum control_opcode_t
+{
+    // Any payload. Answered with the same payload.
+    CONTROL_OPCODE_PING = 0x01,
+
+    // The payload is the channel, the note number and the velocity.
+    CONTROL_OPCODE_NOTE_ON = 0x02,
+
+    // The payload is the channel.
+    CONTROL_OPCODE_NOTE_OFF = 0x03,
+
+    // The payload is the channel, the parameter (cc_param_t) and the value.
+    // The parameter is applied at the next modulation tick.
+    CONTROL_OPCODE_SET_PARAM = 0x04,
+
+    // The payload is the channel and the program number.
+    CONTROL_OPCODE_PROGRAM_CHANGE = 0x05,
+
+    // No payload. Answered with the telemetry since the last
+    // CONTROL_OPCODE_SUBSCRIBE frame, in the same format. Without a
+    // subscription the times are 0.
+    CONTROL_OPCODE_GET_TELEMETRY = 0x06,
+
+    // Never requested, sent by log_process with CONTROL_REPLY_FLAG set.
+    // The payload is log records of 7 bytes, the log_id_t and three
+    // uint16_t arguments, see log.h.
+    CONTROL_OPCODE_LOG = 0x07,
+
+    // The payload is the number of modulation ticks between the telemetry
+    // frames, 0 ends the subscription. A period shorter than the time the
+    // UART needs to send a frame is lengthened, and a frame which does not
+    // fit in the transmit buffer is skipped. The frames are sent with
+    // CONTROL_REPLY_FLAG set and hold the telemetry since the last frame:
+    //  uint32_t    timer tick count
+    //  uint16_t    samples in the sample buffer
+    //  uint16_t    lowest number of samples in the sample buffer
+    //  uint16_t    sample buffer depth
+    //  uint32_t    sample buffer underruns
+    //  uint16_t    render time, per mille
+    //  uint16_t    modulation time, per mille
+    //  uint16_t    control time, per mille
+    //  uint8_t     bit mask of the channels which are playing a note
+    //  uint8_t[4]  envelope state (adsr_state_t) of each channel
+    //  uint8_t     governor level
+    CONTROL_OPCODE_SUBSCRIBE = 0x08,
+
+    // Never requested, sent by the terminal command "get scope" with
+    // CONTROL_REPLY_FLAG set. A scope capture is sent in several frames:
+    //  uint16_t    index of the first sample of the frame
+    //  uint16_t    number of samples in the capture
+    //  int16_t[]   samples
+    CONTROL_OPCODE_SCOPE_DATA = 0x09,
+
+    // Never requested, sent by trace_send with CONTROL_REPLY_FLAG set. The
+    // trace ring buffer is sent in several frames:
+    //  uint16_t    index of the first record of the frame
+    //  uint16_t    number of records
+    //  uint16_t    timer counts per tick
+    // followed by records of 8 bytes, see trace.h:
+    //  uint8_t     trace_id_t | TRACE_PHASE_
+    //  uint8_t     first argument
+    //  uint16_t    second argument
+    //  uint16_t    the low 16 bits of the tick count
+    //  uint16_t    timer count within the tick
+    CONTROL_OPCODE_TRACE_DATA = 0x0A
+} control_opcode_t;
+
+typedef struct control_stats_t
+{
+    uint32_t bytes;             // Received bytes
+    uint32_t frames;            // Received frames with a valid CRC
+    uint16_t crc_errors;        // Frames with an invalid CRC
+    uint16_t length_errors;     // Frames with an invalid length
+    uint16_t argument_errors;   // Frames with an invalid channel or value
+    uint16_t unknown_opcodes;   // Frames with an unknown opcode
+} control_stats_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// Set in the opcode of a reply.
+#define CONTROL_REPLY_FLAG      (0x80u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Initializes the control protocol.
+ * @details The UART should be initialized before.
+ * @param void
+ * @return void
+ */
+void control_init(void);
+
+/**
+ * @brief Parses received bytes and executes the received frames.
+ * @details At most max_bytes bytes are parsed per call, so that the caller
+ *          keeps control over the time spent.
+ * @param max_bytes - The maximum number of bytes to parse.
+ * @return void
+ */
+void control_process(uint16_t max_bytes);
+
+/**
+ * @brief Gets the control protocol statistics.
+ * @param dst - Pointer to where the statistics will be copied.
+ * @return void
+ */
+void control_get_stats(control_stats_t* dst);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* CONTROL_H */
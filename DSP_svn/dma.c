@@ -19,6 +19,8 @@
 #include <xc.h>
 
 #include "audio.h"
+#include "uart.h"
+#include "trace.h"
 
 // =============================================================================
 // Private type definitions
@@ -33,11 +35,28 @@ volatile int16_t g_audio_tx_buff = 0;
 // Private constants
 // =============================================================================
 
+// The DMA may access the whole data RAM.
+#define DMA_RAM_START       (0x0800)
+#define DMA_RAM_END         (0x27FF)
+
+// SPI3 receive as DMA trigger source, see the DMA channel trigger sources
+// table in the datasheet.
+#define DMA_TRIGGER_SPI3_RX (0x3C)
+
+// UART1 transmit as DMA trigger source.
+#define DMA_TRIGGER_UART1_TX (0x0C)
+
 // =============================================================================
 // Private variables
 // =============================================================================
 static volatile int16_t dma_tx_buff = 0;
 
+// The link receive buffer and the number of times the link DMA channel has
+// wrapped around to its start.
+static uint16_t link_buff_start = 0;
+static uint16_t link_buff_size = 0;
+static volatile uint16_t link_laps = 0;
+
 // =============================================================================
 // Private function declarations
 // =============================================================================
@@ -86,6 +105,117 @@ void dma_i2s_ch_deinit(void)
     DMACH0bits.CHEN = 0;
 }
 
+void dma_link_ch_init(volatile uint8_t* buff, uint16_t size)
+{
+    dma_init();
+
+    DMACH1bits.CHEN = 0;    // Disable channel 1
+
+    DMASRC1 = (uint16_t)&SPI3BUFL;
+    DMADST1 = (uint16_t)buff;
+
+    link_buff_start = (uint16_t)buff;
+    link_buff_size = size;
+    link_laps = 0;
+
+    DMACNT1 = size;
+    DMACH1bits.SIZE = 1;    // 8 bit transfer
+    DMACH1bits.TRMODE = 3;  // Repeated continuous mode
+    DMACH1bits.SAMODE = 0;  // DMASRC unchanged after a transfer completion
+    DMACH1bits.DAMODE = 1;  // DMADST incremented after a transfer completion
+    DMACH1bits.RELOAD = 1;  // DMADST and DMACNT are reloaded at the end
+
+    DMAINT1bits.CHSEL = DMA_TRIGGER_SPI3_RX;
+
+    // The receiver polls the destination address. The CPU is only
+    // interrupted when the DMA wraps around, to count the laps.
+    IFS0bits.DMA1IF = 0;
+    IPC3bits.DMA1IP = 2;
+    IEC0bits.DMA1IE = 1;
+
+    DMACH1bits.CHEN = 1;
+}
+
+uint16_t dma_link_get_count(void)
+{
+    uint16_t laps;
+    uint16_t dst;
+    bool wrapped;
+
+    //
+    // A wrap around which has not been counted by the interrupt yet is seen
+    // in the interrupt flag. The flag is read before and after the
+    // destination address, so that the address is known to be on the same
+    // side of the wrap around as the flag.
+    //
+    __builtin_disi(0x3FFF);
+
+    do
+    {
+        wrapped = IFS0bits.DMA1IF;
+        dst = DMADST1;
+    } while (wrapped != IFS0bits.DMA1IF);
+
+    laps = link_laps + wrapped;
+
+    __builtin_disi(0x0000);
+
+    return laps * link_buff_size + (dst - link_buff_start);
+}
+
+void dma_uart_tx_ch_init(void)
+{
+    dma_init();
+
+    DMACH2bits.CHEN = 0;    // Disable channel 2
+
+    DMADST2 = (uint16_t)&U1TXREG;
+
+    DMACH2bits.SIZE = 1;    // 8 bit transfer
+    DMACH2bits.TRMODE = 0;  // One-shot mode, stops after DMACNT transfers
+    DMACH2bits.SAMODE = 1;  // DMASRC incremented after a transfer completion
+    DMACH2bits.DAMODE = 0;  // DMADST unchanged after a transfer completion
+    DMACH2bits.RELOAD = 0;
+
+    DMAINT2bits.CHSEL = DMA_TRIGGER_UART1_TX;
+
+    IFS1bits.DMA2IF = 0;
+    IPC6bits.DMA2IP = 2;
+    IEC1bits.DMA2IE = 1;
+}
+
+void dma_uart_tx_start(const volatile uint8_t* src, uint16_t nbr_of_bytes)
+{
+    DMASRC2 = (uint16_t)src;
+    DMACNT2 = nbr_of_bytes;
+
+    DMACH2bits.CHEN = 1;
+
+    // The transmit interrupt flag is only set when a byte has been moved to
+    // the shift register, so the first transfer is forced.
+    DMACH2bits.CHREQ = 1;
+}
+
+void dma_uart_tx_int_disable(void)
+{
+    IEC1bits.DMA2IE = 0;
+}
+
+void dma_uart_tx_int_enable(void)
+{
+    IEC1bits.DMA2IE = 1;
+}
+
+void dma_i2s_int_disable(void)
+{
+    IEC0bits.DMA0IE = 0;
+}
+
+void dma_i2s_int_enable(void)
+{
+    IEC0bits.DMA0IE = 1;
+}
+
 // =============================================================================
 // Private function definitions
 // =============================================================================
@@ -95,20 +225,49 @@ void dma_init(void)
     DMACONbits.DMAEN = 1;   // Enable the DMA
     DMACONbits.PRSSEL = 0;  // Fixed priority scheme
 
-    DMAL = (uint16_t)&dma_tx_buff - 4;
-    DMAH = (uint16_t)&dma_tx_buff + 4;
+    DMAL = DMA_RAM_START;
+    DMAH = DMA_RAM_END;
 }
 
 void __attribute((interrupt, no_auto_psv)) _DMA0Interrupt()
 {
-    if (false == audio_is_sample_buffer_empty())
+    uint8_t underrun = 0;
+
+    TRACE_BEGIN(TRACE_DMA0_ISR, 0, 0);
+
+    if (false == audio_is_sample_buffer_empty(&g_audio_engine))
+    {
+        dma_tx_buff = audio_pop_sample(&g_audio_engine);
+    }
+    else
     {
-        dma_tx_buff = audio_pop_sample();
+        // The previous sample is sent again
+        audio_register_underrun(&g_audio_engine);
+        underrun = 1;
     }
 
     DMAINT0 &= 0xFF00;      // Clear the interrupt flags
 
     IFS2bits.SPI2TXIF = 0;  // Clear the trigger source
     IFS0bits.DMA0IF = 0;
+
+    TRACE_END(TRACE_DMA0_ISR, underrun,
+              audio_get_sample_buff_size(&g_audio_engine));
+}
+
+void __attribute((interrupt, no_auto_psv)) _DMA1Interrupt()
+{
+    ++link_laps;
+
+    DMAINT1 &= 0xFF00;      // Clear the interrupt flags
+    IFS0bits.DMA1IF = 0;
+}
+
+void __attribute((interrupt, no_auto_psv)) _DMA2Interrupt()
+{
+    DMAINT2 &= 0xFF00;      // Clear the interrupt flags
+    IFS1bits.DMA2IF = 0;
+
+    uart_tx_segment_complete();
 }
 
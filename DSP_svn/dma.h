@@ -18,6 +18,7 @@
 // =============================================================================
 // Include statements
 // =============================================================================
+#include <stdint.h>
 
 // =============================================================================
 // Public type definitions
@@ -30,7 +31,6 @@
 // =============================================================================
 // Global constatants
 // =============================================================================
-#define SAMPLE_FREQ_HZ (48000)
 
 // =============================================================================
 // Public function declarations
@@ -48,6 +48,75 @@ void dma_i2s_ch_init(void);
  */
 void dma_i2s_ch_deinit(void);
 
+/**
+ * @brief Disables the interrupt which moves samples to the I2S module.
+ * @details While disabled the DMA keeps sending the last sample.
+ * @param void
+ * @return void
+ */
+void dma_i2s_int_disable(void);
+
+/**
+ * @brief Enables the interrupt which moves samples to the I2S module.
+ * @param void
+ * @return void
+ */
+void dma_i2s_int_enable(void);
+
+/**
+ * @brief Initializes the DMA channel which receives data from the PIC32 link.
+ * @details Every byte received by the SPI3 module is written to the buffer.
+ *          When the end of the buffer is reached the DMA starts over from
+ *          the beginning, so the buffer is used as a ring buffer.
+ * @param buff - The receive buffer.
+ * @param size - The size of the receive buffer in bytes.
+ * @return void
+ */
+void dma_link_ch_init(volatile uint8_t* buff, uint16_t size);
+
+/**
+ * @brief Gets the number of bytes received by the link DMA channel.
+ * @details The count wraps around at 2^16. The position in the buffer which
+ *          the next byte will be written to is the count modulo the size of
+ *          the buffer, if the size is a power of two.
+ * @param void
+ * @return The number of bytes written to the buffer since it was initialized.
+ */
+uint16_t dma_link_get_count(void);
+
+/**
+ * @brief Initializes the DMA channel which loads the UART transmit buffer.
+ * @details The channel is triggered by the UART transmit interrupt. When a
+ *          transfer started by dma_uart_tx_start has completed the DMA
+ *          interrupt calls uart_tx_segment_complete.
+ * @param void
+ * @return void
+ */
+void dma_uart_tx_ch_init(void);
+
+/**
+ * @brief Starts sending a block of bytes on the UART.
+ * @details The previous transfer must have completed.
+ * @param src - The first byte to send.
+ * @param nbr_of_bytes - The number of bytes to send, must not be 0.
+ * @return void
+ */
+void dma_uart_tx_start(const volatile uint8_t* src, uint16_t nbr_of_bytes);
+
+/**
+ * @brief Disables the interrupt which signals a completed UART transfer.
+ * @param void
+ * @return void
+ */
+void dma_uart_tx_int_disable(void);
+
+/**
+ * @brief Enables the interrupt which signals a completed UART transfer.
+ * @param void
+ * @return void
+ */
+void dma_uart_tx_int_enable(void);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -0,0 +1,186 @@
+/*
+ * This file implements the queue of timestamped audio events.
+ *
+ * Sample indexes wrap around, so they are compared by the sign of their
+ * difference. This works as long as no event is scheduled more than 2^31
+ * samples ahead.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "event_queue.h"
+#include "audio.h"
+#include "cc_router.h"
+#include "patch.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+#if (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) != 0
+#error EVENT_QUEUE_SIZE must be a power of two
+#endif
+
+#define EVENT_QUEUE_MASK        (EVENT_QUEUE_SIZE - 1)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static event_t queue[EVENT_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_tail = 0;
+static uint16_t overflows = 0;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Executes an event in the audio engine.
+ * @param event - The event to execute.
+ * @return void
+ */
+static void execute_event(const event_t* event);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void event_queue_init(void)
+{
+    queue_head = 0;
+    queue_tail = 0;
+    overflows = 0;
+}
+
+bool event_queue_push(const event_t* event)
+{
+    uint8_t index = queue_tail;
+    uint8_t prev;
+
+    if (((index + 1) & EVENT_QUEUE_MASK) == queue_head)
+    {
+        ++overflows;
+
+        return false;
+    }
+
+    //
+    // Insert the event after all events which are due at or before it, by
+    // moving the later events one step towards the tail. Events with the
+    // same sample index stay in the order they were pushed.
+    //
+    while (index != queue_head)
+    {
+        prev = (index - 1) & EVENT_QUEUE_MASK;
+
+        if ((int32_t)(queue[prev].sample_index - event->sample_index) <= 0)
+        {
+            break;
+        }
+
+        queue[index] = queue[prev];
+        index = prev;
+    }
+
+    queue[index] = *event;
+    queue_tail = (queue_tail + 1) & EVENT_QUEUE_MASK;
+
+    return true;
+}
+
+void event_queue_dispatch(uint32_t sample_index)
+{
+    uint8_t head = queue_head;
+
+    while ((head != queue_tail) &&
+           ((int32_t)(queue[head].sample_index - sample_index) <= 0))
+    {
+        execute_event(&queue[head]);
+        head = (head + 1) & EVENT_QUEUE_MASK;
+    }
+
+    queue_head = head;
+}
+
+uint16_t event_queue_samples_until_next(uint32_t sample_index,
+                                        uint16_t max_samples)
+{
+    int32_t diff;
+
+    if (queue_head == queue_tail)
+    {
+        return max_samples;
+    }
+
+    diff = (int32_t)(queue[queue_head].sample_index - sample_index);
+
+    if (diff <= 0)
+    {
+        return 0;
+    }
+    else if (diff < max_samples)
+    {
+        return (uint16_t)diff;
+    }
+    else
+    {
+        return max_samples;
+    }
+}
+
+uint16_t event_queue_get_overflows(void)
+{
+    return overflows;
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void execute_event(const event_t* event)
+{
+    audio_ch_nbr_t channel = (audio_ch_nbr_t)event->channel;
+
+    switch (event->type)
+    {
+    case EVENT_NOTE_ON:
+        audio_note_on(&g_audio_engine,
+                      channel,
+                      (midi_notes_t)event->data1,
+                      event->data2);
+        break;
+
+    case EVENT_NOTE_OFF:
+        audio_note_off(&g_audio_engine, channel);
+        break;
+
+    case EVENT_CONTROL_CHANGE:
+        cc_router_handle(channel, event->data1, event->data2);
+        break;
+
+    case EVENT_PITCH_BEND:
+        audio_set_pitch_bend(&g_audio_engine, channel,
+                             event->data1 | ((uint16_t)event->data2 << 7));
+        break;
+
+    case EVENT_PROGRAM_CHANGE:
+        patch_program_change(channel, event->data1);
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * File:   event_queue.h
+ * Author: Erik
+ *
+ * Queue of timestamped audio events.
+ *
+ * Each event carries the index of the sample at which it should take
+ * effect. The renderer in the main loop renders samples up to the next
+ * event, executes all events which are due and continues, so an event is
+ * applied at exactly the sample it was scheduled for.
+ *
+ * The events are kept sorted by sample index, so producers with different
+ * lead times (MIDI input stamped with the current sample, the sequencer and
+ * timed link messages stamped ahead) can share the queue.
+ *
+ * Pushing an event may move queued events, so events must only be pushed
+ * and dispatched from the main loop, never from an interrupt.
+ */
+
+#ifndef EVENT_QUEUE_H
+#define	EVENT_QUEUE_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+typedef enum event_type_t
+{
+    EVENT_NOTE_ON,          // data1: note, data2: velocity
+    EVENT_NOTE_OFF,         // data1, data2: not used
+    EVENT_CONTROL_CHANGE,   // data1: control number, data2: value
+    EVENT_PITCH_BEND,       // data1: bend LSB, data2: bend MSB (7 bits each)
+    EVENT_PROGRAM_CHANGE    // data1: patch number, data2: not used
+} event_type_t;
+
+typedef struct event_t
+{
+    uint32_t sample_index;  // The sample at which the event takes effect
+    uint8_t  type;          // event_type_t
+    uint8_t  channel;       // audio_ch_nbr_t
+    uint8_t  data1;
+    uint8_t  data2;
+} event_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// The number of events the queue can hold, must be a power of two.
+#define EVENT_QUEUE_SIZE        (32u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Empties the event queue.
+ * @param void
+ * @return void
+ */
+void event_queue_init(void);
+
+/**
+ * @brief Pushes an event to the queue.
+ * @details The event is inserted in sample index order. Events with the
+ *          same sample index are executed in the order they are pushed. An
+ *          event with a sample index which has already been rendered is
+ *          executed before the next sample.
+ *          If the queue is full the event is dropped and the overflow is
+ *          counted, so events are never executed out of order.
+ *          Must only be called from the main loop.
+ * @param event - The event to push.
+ * @return True if the event was queued, false if it was dropped.
+ */
+bool event_queue_push(const event_t* event);
+
+/**
+ * @brief Executes all events which are due.
+ * @param sample_index - The index of the next sample to render.
+ * @return void
+ */
+void event_queue_dispatch(uint32_t sample_index);
+
+/**
+ * @brief Gets the number of samples until the next queued event is due.
+ * @param sample_index - The index of the next sample to render.
+ * @param max_samples - The value to return if no event is due within
+ *        max_samples samples.
+ * @return The number of samples which can be rendered before the next
+ *         event should be dispatched, at most max_samples.
+ */
+uint16_t event_queue_samples_until_next(uint32_t sample_index,
+                                        uint16_t max_samples);
+
+/**
+ * @brief Gets the number of events which did not fit in the queue.
+ * @param void
+ * @return The number of overflows since the queue was initialized.
+ */
+uint16_t event_queue_get_overflows(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* EVENT_QUEUE_H */
+
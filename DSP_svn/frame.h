@@ -0,0 +1,135 @@
+/*
+ * File:   frame.h
+ * Author: Erik
+ *
+ * Framing of binary messages over a byte stream.
+ *
+ * A frame has the following layout:
+ *
+ *  +------+--------+--------+---------------------+------+
+ *  | SYNC | LENGTH | OPCODE | PAYLOAD (LENGTH)    | CRC8 |
+ *  +------+--------+--------+---------------------+------+
+ *
+ * SYNC is always FRAME_SYNC. LENGTH is the number of payload bytes.
+ * CRC8 (polynomial 0x07) is calculated over LENGTH, OPCODE and PAYLOAD.
+ * After a corrupt frame the decoder searches for the next SYNC byte.
+ */
+
+#ifndef FRAME_H
+#define	FRAME_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+#define FRAME_SYNC              (0xA5)
+#define FRAME_MAX_PAYLOAD       (64u)
+
+// The number of bytes in a frame in addition to the payload.
+#define FRAME_OVERHEAD          (4u)
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+typedef enum frame_decoder_state_t
+{
+    FRAME_STATE_SYNC,
+    FRAME_STATE_LENGTH,
+    FRAME_STATE_OPCODE,
+    FRAME_STATE_PAYLOAD,
+    FRAME_STATE_CRC
+} frame_decoder_state_t;
+
+typedef struct frame_t
+{
+    uint8_t opcode;
+    uint8_t length;
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+} frame_t;
+
+typedef struct frame_decoder_t
+{
+    frame_decoder_state_t   state;
+    uint8_t                 crc;
+    uint8_t                 index;
+    uint16_t                crc_errors;
+    uint16_t                length_errors;
+    frame_t                 frame;
+} frame_decoder_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Resets a frame decoder and its error counters.
+ * @param decoder - The decoder to reset.
+ * @return void
+ */
+void frame_decoder_init(frame_decoder_t* decoder);
+
+/**
+ * @brief Feeds one byte to a frame decoder.
+ * @param decoder - The decoder to feed.
+ * @param byte - The received byte.
+ * @return True if a complete frame with a valid CRC was received. The frame
+ *         is then available in decoder->frame until the next call.
+ */
+bool frame_decode_byte(frame_decoder_t* decoder, uint8_t byte);
+
+/**
+ * @brief Encodes a frame.
+ * @param opcode - The opcode of the frame.
+ * @param payload - The payload of the frame.
+ * @param length - The number of payload bytes, at most FRAME_MAX_PAYLOAD.
+ * @param dst - Buffer of at least length + FRAME_OVERHEAD bytes.
+ * @return The number of bytes written to dst.
+ */
+uint16_t frame_encode(uint8_t opcode,
+                      const uint8_t* payload,
+                      uint8_t length,
+                      uint8_t* dst);
+
+/**
+ * @brief Updates a CRC8 (polynomial 0x07) with one byte.
+ * @param crc - The current CRC, 0 for the first byte.
+ * @param byte - The byte to add to the CRC.
+ * @return The updated CRC.
+ */
+uint8_t frame_crc8(uint8_t crc, uint8_t byte);
+
+/**
+ * @brief Writes a 16 bit value to a payload, little endian.
+ * @param dst - Where to write the value.
+ * @param value - The value to write.
+ * @return The address after the value.
+ */
+uint8_t* frame_put_u16(uint8_t* dst, uint16_t value);
+
+/**
+ * @brief Writes a 32 bit value to a payload, little endian.
+ * @param dst - Where to write the value.
+ * @param value - The value to write.
+ * @return The address after the value.
+ */
+uint8_t* frame_put_u32(uint8_t* dst, uint32_t value);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* FRAME_H */
+
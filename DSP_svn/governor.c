@@ -0,0 +1,181 @@
+/*
+ * This file implements the automatic quality scaling of the audio engine.
+ *
+ * The sample FIFO low water mark is collected over a window of modulation
+ * ticks. If the buffer has been close to empty during a window the engine is
+ * stepped down one level. The engine is only stepped up again after several
+ * consecutive windows with plenty of headroom, to avoid oscillating between
+ * two levels.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "governor.h"
+#include "audio.h"
+#include "log.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// The number of modulation ticks (10 ms) in one observation window.
+#define GOVERNOR_WINDOW_TICKS       (10u)
+
+// Step down if the buffer level has been below this during a window.
+#define GOVERNOR_LOW_WATER_LIMIT \
+    (audio_get_sample_buff_depth(&g_audio_engine) / 8u)
+
+// A window has headroom if the buffer level never went below this.
+#define GOVERNOR_HEADROOM_LIMIT \
+    (audio_get_sample_buff_depth(&g_audio_engine) / 2u)
+
+// The number of consecutive windows with headroom before stepping up.
+#define GOVERNOR_STEP_UP_WINDOWS    (10u)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static bool governor_enabled = true;
+static governor_level_t current_level = GOVERNOR_LEVEL_FULL;
+static uint8_t window_ticks = 0;
+static uint16_t window_low_water = SAMPLE_BUFF_POOL_SIZE;
+static uint8_t headroom_windows = 0;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Configures the audio engine for a quality level.
+ * @param level - The level to apply.
+ * @return void
+ */
+static void apply_level(governor_level_t level);
+
+/**
+ * @brief Changes the quality level and logs the transition.
+ * @param level - The new level.
+ * @param low_water - The low water mark which caused the transition.
+ * @return void
+ */
+static void change_level(governor_level_t level, uint16_t low_water);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void governor_init(void)
+{
+    governor_enabled = true;
+    current_level = GOVERNOR_LEVEL_FULL;
+    window_ticks = 0;
+    window_low_water = SAMPLE_BUFF_POOL_SIZE;
+    headroom_windows = 0;
+
+    apply_level(current_level);
+}
+
+void governor_update(void)
+{
+    uint16_t low_water = audio_get_and_reset_low_water_mark(&g_audio_engine);
+
+    if (!governor_enabled)
+    {
+        return;
+    }
+
+    if (low_water < window_low_water)
+    {
+        window_low_water = low_water;
+    }
+
+    if (++window_ticks < GOVERNOR_WINDOW_TICKS)
+    {
+        return;
+    }
+
+    if (window_low_water < GOVERNOR_LOW_WATER_LIMIT)
+    {
+        headroom_windows = 0;
+
+        if (current_level < GOVERNOR_NBR_OF_LEVELS - 1)
+        {
+            change_level(current_level + 1, window_low_water);
+        }
+    }
+    else if (window_low_water >= GOVERNOR_HEADROOM_LIMIT)
+    {
+        if (++headroom_windows >= GOVERNOR_STEP_UP_WINDOWS)
+        {
+            headroom_windows = 0;
+
+            if (current_level > GOVERNOR_LEVEL_FULL)
+            {
+                change_level(current_level - 1, window_low_water);
+            }
+        }
+    }
+    else
+    {
+        headroom_windows = 0;
+    }
+
+    window_ticks = 0;
+    window_low_water = SAMPLE_BUFF_POOL_SIZE;
+}
+
+governor_level_t governor_get_level(void)
+{
+    return current_level;
+}
+
+void governor_set_enabled(bool enabled)
+{
+    governor_enabled = enabled;
+
+    window_ticks = 0;
+    window_low_water = SAMPLE_BUFF_POOL_SIZE;
+    headroom_windows = 0;
+
+    if (!enabled && (GOVERNOR_LEVEL_FULL != current_level))
+    {
+        change_level(GOVERNOR_LEVEL_FULL,
+                     audio_get_sample_buff_size(&g_audio_engine));
+    }
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void apply_level(governor_level_t level)
+{
+    audio_set_modulation_divider(&g_audio_engine,
+        (level >= GOVERNOR_LEVEL_SLOW_MODULATION) ? 2 : 1);
+
+    audio_set_channel_enabled(&g_audio_engine, AUDIO_CH_NOISE0,
+                              level < GOVERNOR_LEVEL_NO_NOISE);
+
+    audio_set_channel_enabled(&g_audio_engine, AUDIO_CH_SQUARE1,
+                              level < GOVERNOR_LEVEL_NO_SQUARE1);
+}
+
+static void change_level(governor_level_t level, uint16_t low_water)
+{
+    log_write(LOG_GOVERNOR_LEVEL_CHANGE, current_level, level, low_water);
+
+    current_level = level;
+    apply_level(level);
+}
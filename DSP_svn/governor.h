@@ -0,0 +1,90 @@
+/*
+ * File:   governor.h
+ * Author: Erik
+ *
+ * Automatic quality scaling of the audio engine.
+ *
+ * The governor watches the low water mark of the sample FIFO buffer. If the
+ * buffer runs low the engine is stepped down to cheaper modes, and when there
+ * is enough headroom again it is stepped back up.
+ */
+
+#ifndef GOVERNOR_H
+#define	GOVERNOR_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+/*
+ * The quality levels, from the most to the least expensive.
+ * Each level includes the reductions of the levels above it.
+ */
+typedef enum governor_level_t
+{
+    GOVERNOR_LEVEL_FULL             = 0,    // Full quality
+    GOVERNOR_LEVEL_SLOW_MODULATION  = 1,    // Modulation at half rate
+    GOVERNOR_LEVEL_NO_NOISE         = 2,    // Noise channel dropped
+    GOVERNOR_LEVEL_NO_SQUARE1       = 3,    // Square channel 1 dropped
+    GOVERNOR_NBR_OF_LEVELS
+} governor_level_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Initializes the governor and sets the full quality level.
+ * @param void
+ * @return void
+ */
+void governor_init(void);
+
+/**
+ * @brief Updates the governor.
+ * @details Should be called at the modulation rate, i.e. every timer event.
+ * @param void
+ * @return void
+ */
+void governor_update(void);
+
+/**
+ * @brief Gets the current quality level.
+ * @param void
+ * @return The current quality level.
+ */
+governor_level_t governor_get_level(void);
+
+/**
+ * @brief Enables or disables the governor.
+ * @details When the governor is disabled the engine is restored to full
+ *          quality.
+ * @param enabled - True to enable the governor, false to disable it.
+ * @return void
+ */
+void governor_set_enabled(bool enabled);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* GOVERNOR_H */
+
@@ -0,0 +1,98 @@
+/*
+ * This file implements host versions of the hardware modules used by the
+ * audio engine, for the programs in host_render which run the engine on the
+ * host.
+ *
+ * - The noise channel uses a seeded LFSR instead of the crypto module, so
+ *   the output is the same on every run.
+ * - The tick count is always 0, the host programs measure time themselves.
+ * - UART output and log entries are written to stderr.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "xc.h"
+#include "rng.h"
+#include "timer.h"
+#include "uart.h"
+#include "log.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+volatile iec0_bits_t IEC0bits;
+
+const uint32_t TIMER_FREQ_HZ = 100;
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static uint16_t lfsr = 0xACE1u;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void rng_init(void)
+{
+}
+
+void rng_deinit(void)
+{
+}
+
+bool rng_get_random(void)
+{
+    uint16_t bit = (lfsr ^ (lfsr >> 2) ^ (lfsr >> 3) ^ (lfsr >> 5)) & 1u;
+
+    lfsr = (lfsr >> 1) | (bit << 15);
+
+    return lfsr & 1u;
+}
+
+uint32_t timer_get_tick_count(void)
+{
+    return 0;
+}
+
+void uart_write(uint8_t data)
+{
+    fputc(data, stderr);
+}
+
+void uart_write_string(const char* data)
+{
+    fputs(data, stderr);
+}
+
+void uart_write_array(uint16_t nbr_of_bytes, const uint8_t* data)
+{
+    fwrite(data, 1, nbr_of_bytes, stderr);
+}
+
+void log_write(log_id_t id, uint16_t arg0, uint16_t arg1, uint16_t arg2)
+{
+    fprintf(stderr, "[LOG] id: %u args: %u %u %u\n", id, arg0, arg1, arg2);
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
@@ -0,0 +1,297 @@
+/*
+ * This file implements link_test, which feeds frames to the PIC32 link (see
+ * link.h) on the host through the loopback and checks the link statistics
+ * and the events queued by the frames.
+ *
+ * link.c is built with LINK_LOOPBACK defined, so the bytes are written into
+ * the receive buffer by link_loopback_write instead of the DMA.
+ *
+ * The cases are:
+ *  - A MIDI frame queues its note on at the current sample.
+ *  - A frame split over several calls of link_process and over the end of
+ *    the receive buffer is received whole.
+ *  - A frame with a bad CRC or a bad length is discarded and counted.
+ *  - A frame with an unknown opcode is counted.
+ *  - A timed MIDI frame queues its note on at the offset from the schedule
+ *    base, a too large offset is clamped and a too large byte count is
+ *    counted as a length error.
+ *  - Writing more than a whole receive buffer without parsing is counted as
+ *    an overrun and the next frame is received.
+ *
+ * Usage: link_test
+ *
+ * Writes each failed check to stderr and exits with EXIT_FAILURE if any
+ * check failed.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "xc.h"
+#include "audio.h"
+#include "event_queue.h"
+#include "cc_router.h"
+#include "patch.h"
+#include "sequencer.h"
+#include "songs.h"
+#include "frame.h"
+#include "link.h"
+#include "midi.h"
+#include "rng.h"
+#include "timer.h"
+#include "uart.h"
+#include "log.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// The sequencer is linked with the engine, but no song is played.
+const song_t g_songs[] =
+{
+    { NULL, 0 }
+};
+
+const uint8_t g_songs_nbr_of_songs = 0;
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// Returned by event_queue_samples_until_next when no event is queued.
+#define NO_EVENT                    (0xFFFFu)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static unsigned int failures = 0;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Encodes a frame and writes it to the link loopback.
+ * @param opcode - The opcode of the frame.
+ * @param payload - The payload of the frame.
+ * @param length - The number of payload bytes.
+ * @return void
+ */
+static void write_frame(uint8_t opcode, const uint8_t* payload, uint8_t length);
+
+/**
+ * @brief Parses all received bytes, max_bytes at a time.
+ * @param max_bytes - The number of bytes to parse per call of link_process.
+ * @return void
+ */
+static void process_all(uint16_t max_bytes);
+
+/**
+ * @brief Empties the event queue and gets the link statistics.
+ * @param stats - Pointer to where the statistics will be copied.
+ * @return void
+ */
+static void reset(link_stats_t* stats);
+
+/**
+ * @brief Gets the number of samples until the first queued event.
+ * @param void
+ * @return The number of samples, NO_EVENT if the queue is empty.
+ */
+static uint16_t samples_until_event(void);
+
+/**
+ * @brief Counts and reports a failed check.
+ * @param ok - The result of the check.
+ * @param name - The name of the check.
+ * @return void
+ */
+static void check(bool ok, const char* name);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+int main(void)
+{
+    static const uint8_t note_on[] = { 0x90, 60, 100 };
+    uint8_t buff[LINK_RX_BUFF_SIZE];
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    link_stats_t before;
+    link_stats_t after;
+    uint32_t base;
+    uint16_t length;
+    uint16_t i;
+
+    audio_init(&g_audio_engine);
+    patch_init();
+    event_queue_init();
+    cc_router_init();
+    sequencer_init();
+    link_init();
+
+    // Let the schedule base differ from the current sample
+    for (i = 0; i != 100; ++i)
+    {
+        audio_calc_sample(&g_audio_engine);
+    }
+
+    reset(&before);
+    write_frame(LINK_OPCODE_MIDI, note_on, sizeof(note_on));
+    process_all(LINK_RX_BUFF_SIZE);
+    link_get_stats(&after);
+    check(after.frames == before.frames + 1, "MIDI frame received");
+    check(0 == samples_until_event(), "MIDI note on queued now");
+
+    // Move the write position close to the end of the buffer, so that the
+    // next frame wraps around
+    reset(&before);
+    length = LINK_RX_BUFF_SIZE - 3 -
+             (uint16_t)(before.bytes % LINK_RX_BUFF_SIZE);
+    for (i = 0; i != length; ++i)
+    {
+        buff[i] = 0;
+    }
+    link_loopback_write(buff, length);
+    process_all(LINK_RX_BUFF_SIZE);
+    write_frame(LINK_OPCODE_MIDI, note_on, sizeof(note_on));
+    process_all(1);
+    link_get_stats(&after);
+    check(after.frames == before.frames + 1, "Split frame received");
+    check(0 == samples_until_event(), "Split frame note on queued");
+
+    reset(&before);
+    length = frame_encode(LINK_OPCODE_MIDI, note_on, sizeof(note_on), buff);
+    buff[length - 1] ^= 0x01;
+    link_loopback_write(buff, length);
+    process_all(LINK_RX_BUFF_SIZE);
+    link_get_stats(&after);
+    check(after.frames == before.frames, "Bad CRC frame discarded");
+    check(after.crc_errors == before.crc_errors + 1, "Bad CRC counted");
+    check(NO_EVENT == samples_until_event(), "Bad CRC nothing queued");
+
+    reset(&before);
+    buff[0] = FRAME_SYNC;
+    buff[1] = FRAME_MAX_PAYLOAD + 1;
+    link_loopback_write(buff, 2);
+    write_frame(LINK_OPCODE_MIDI, note_on, sizeof(note_on));
+    process_all(LINK_RX_BUFF_SIZE);
+    link_get_stats(&after);
+    check(after.length_errors == before.length_errors + 1,
+          "Bad length counted");
+    check(after.frames == before.frames + 1, "Frame after bad length");
+
+    reset(&before);
+    write_frame(0x7F, NULL, 0);
+    process_all(LINK_RX_BUFF_SIZE);
+    link_get_stats(&after);
+    check(after.unknown_opcodes == before.unknown_opcodes + 1,
+          "Unknown opcode counted");
+
+    reset(&before);
+    base = audio_get_schedule_base(&g_audio_engine);
+    payload[0] = 200;
+    payload[1] = 0;
+    payload[2] = sizeof(note_on);
+    payload[3] = note_on[0];
+    payload[4] = note_on[1];
+    payload[5] = note_on[2];
+    write_frame(LINK_OPCODE_TIMED_MIDI, payload, 6);
+    process_all(LINK_RX_BUFF_SIZE);
+    check(base + 200 - audio_get_sample_index(&g_audio_engine) ==
+          samples_until_event(), "Timed note on queued at offset");
+
+    reset(&before);
+    payload[0] = 0xFF;
+    payload[1] = 0xFF;
+    write_frame(LINK_OPCODE_TIMED_MIDI, payload, 6);
+    process_all(LINK_RX_BUFF_SIZE);
+    link_get_stats(&after);
+    check(after.clamped_offsets == before.clamped_offsets + 1,
+          "Large offset counted");
+    check(base + LINK_TIMED_MIDI_MAX_OFFSET -
+          audio_get_sample_index(&g_audio_engine) == samples_until_event(),
+          "Large offset clamped");
+
+    reset(&before);
+    payload[2] = sizeof(note_on) + 1;
+    write_frame(LINK_OPCODE_TIMED_MIDI, payload, 6);
+    process_all(LINK_RX_BUFF_SIZE);
+    link_get_stats(&after);
+    check(after.length_errors == before.length_errors + 1,
+          "Timed byte count counted");
+    check(NO_EVENT == samples_until_event(), "Timed byte count nothing queued");
+
+    reset(&before);
+    for (i = 0; i != LINK_RX_BUFF_SIZE; ++i)
+    {
+        buff[i] = 0;
+    }
+    link_loopback_write(buff, LINK_RX_BUFF_SIZE);
+    process_all(LINK_RX_BUFF_SIZE);
+    write_frame(LINK_OPCODE_MIDI, note_on, sizeof(note_on));
+    process_all(LINK_RX_BUFF_SIZE);
+    link_get_stats(&after);
+    check(after.overruns == before.overruns + 1, "Overrun counted");
+    check(after.frames == before.frames + 1, "Frame after overrun");
+    check(0 == samples_until_event(), "Frame after overrun note on queued");
+
+    if (0 != failures)
+    {
+        fprintf(stderr, "%u checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+
+    return EXIT_SUCCESS;
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void write_frame(uint8_t opcode, const uint8_t* payload, uint8_t length)
+{
+    uint8_t buff[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+
+    link_loopback_write(buff, frame_encode(opcode, payload, length, buff));
+}
+
+static void process_all(uint16_t max_bytes)
+{
+    while (link_has_received_bytes())
+    {
+        link_process(max_bytes);
+    }
+}
+
+static void reset(link_stats_t* stats)
+{
+    event_queue_init();
+    link_get_stats(stats);
+}
+
+static uint16_t samples_until_event(void)
+{
+    return event_queue_samples_until_next(
+        audio_get_sample_index(&g_audio_engine), NO_EVENT);
+}
+
+static void check(bool ok, const char* name)
+{
+    if (!ok)
+    {
+        fprintf(stderr, "Failed: %s\n", name);
+        ++failures;
+    }
+}
@@ -0,0 +1,628 @@
+/*
+ * This file implements midi_fuzz, which feeds bytes to the MIDI parser (see
+ * midi.h) on the host and checks the state of the parser and the events it
+ * pushes after every byte.
+ *
+ * The parser is linked without the event queue, the events are recorded by
+ * event_queue_push below instead. The recorded events are compared with the
+ * events of a reference decoder, which follows the MIDI 1.0 specification:
+ *  - Running status is kept for channel messages, and cancelled by system
+ *    common and system exclusive messages.
+ *  - Real-time bytes may appear anywhere, also in the middle of a message,
+ *    without affecting it. System reset turns off all channels.
+ *  - A note on with zero velocity is a note off.
+ *  - A system exclusive message is ended by any status byte which is not a
+ *    real-time byte, and its data bytes are skipped.
+ *
+ * First a set of known sequences with their expected events are checked,
+ * then random bytes are fed. The random bytes are drawn so that all kinds
+ * of input are frequent: data bytes, channel status bytes, system common
+ * and system exclusive bytes, real-time bytes interleaved anywhere, and
+ * fully random bytes.
+ *
+ * After every byte the parser must hold:
+ *  - data_count <= data_length, so the data bytes stay within data[].
+ *  - data_length <= the size of data[].
+ *  - status is 0 or a status byte.
+ *
+ * Usage: midi_fuzz [number of bytes] [seed]
+ *
+ * Exits with EXIT_FAILURE at the first byte which breaks the state or gives
+ * other events than the reference, after writing the byte and the state or
+ * the events to stderr.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "audio.h"
+#include "event_queue.h"
+#include "midi.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+/*
+ * Reference MIDI decoder, see the file header.
+ */
+typedef struct reference_t
+{
+    uint8_t status;         // Current (running) status, 0 if none
+    uint8_t data[2];
+    uint8_t data_count;
+    bool    in_sysex;
+    uint8_t notes[AUDIO_CH_NBR_OF_CHANNELS];    // Playing note, NO_NOTE if none
+} reference_t;
+
+/*
+ * A known byte sequence and the events it gives.
+ */
+typedef struct known_case_t
+{
+    const char*     name;
+    uint8_t         nbr_of_bytes;
+    uint8_t         bytes[8];
+    uint8_t         nbr_of_events;
+    event_t         events[4];
+} known_case_t;
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+#define DEFAULT_NBR_OF_BYTES        (10000000ul)
+#define DEFAULT_SEED                (1u)
+
+// The most events one byte gives, a system reset turns off all channels.
+#define MAX_EVENTS_PER_BYTE         (AUDIO_CH_NBR_OF_CHANNELS)
+
+#define NO_NOTE                     (0xFFu)
+
+static const known_case_t KNOWN_CASES[] =
+{
+    {
+        "Running status",
+        5, { 0x90, 60, 100, 62, 90 },
+        2, { { 0, EVENT_NOTE_ON, 0, 60, 100 }, { 0, EVENT_NOTE_ON, 0, 62, 90 } }
+    },
+    {
+        "Real-time bytes within a message",
+        5, { 0x91, 0xF8, 60, 0xFE, 100 },
+        1, { { 0, EVENT_NOTE_ON, 1, 60, 100 } }
+    },
+    {
+        "Zero velocity note on",
+        5, { 0x92, 60, 100, 60, 0 },
+        2, { { 0, EVENT_NOTE_ON, 2, 60, 100 }, { 0, EVENT_NOTE_OFF, 2, 0, 0 } }
+    },
+    {
+        "Note off of another note",
+        6, { 0x90, 60, 100, 0x80, 61, 0 },
+        1, { { 0, EVENT_NOTE_ON, 0, 60, 100 } }
+    },
+    {
+        "System exclusive ended by its end byte",
+        6, { 0x90, 0xF0, 60, 0xF7, 60, 100 },
+        0, { { 0 } }
+    },
+    {
+        "System exclusive ended by a status byte",
+        6, { 0xF0, 1, 2, 0xB3, 7, 64 },
+        1, { { 0, EVENT_CONTROL_CHANGE, 3, 7, 64 } }
+    },
+    {
+        "System reset",
+        1, { 0xFF },
+        4, { { 0, EVENT_NOTE_OFF, 0, 0, 0 }, { 0, EVENT_NOTE_OFF, 1, 0, 0 },
+             { 0, EVENT_NOTE_OFF, 2, 0, 0 }, { 0, EVENT_NOTE_OFF, 3, 0, 0 } }
+    },
+    {
+        "Channel without an audio channel",
+        3, { 0x94, 60, 100 },
+        0, { { 0 } }
+    },
+};
+
+#define NBR_OF_KNOWN_CASES (sizeof(KNOWN_CASES) / sizeof(KNOWN_CASES[0]))
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static uint32_t fuzz_state;
+
+// The events pushed by the parser and by the reference for the current byte.
+static event_t pushed[MAX_EVENTS_PER_BYTE];
+static uint8_t nbr_of_pushed;
+static event_t expected[MAX_EVENTS_PER_BYTE];
+static uint8_t nbr_of_expected;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Checks the known sequences.
+ * @param void
+ * @return True if all sequences gave the expected events.
+ */
+static bool check_known_cases(void);
+
+/**
+ * @brief Draws the next byte to feed to the parser.
+ * @param void
+ * @return The byte.
+ */
+static uint8_t next_byte(void);
+
+/**
+ * @brief Draws a random number, xorshift32.
+ * @param void
+ * @return The number.
+ */
+static uint32_t next_random(void);
+
+/**
+ * @brief Checks the state of the parser.
+ * @param parser - The parser.
+ * @return True if the state is valid.
+ */
+static bool is_valid(const midi_parser_t* parser);
+
+/**
+ * @brief Resets the reference decoder.
+ * @param ref - The reference decoder.
+ * @return void
+ */
+static void reference_init(reference_t* ref);
+
+/**
+ * @brief Feeds one byte to the reference decoder, its events are added to
+ *        expected.
+ * @param ref - The reference decoder.
+ * @param byte - The byte.
+ * @param sample_index - The sample index of the events.
+ * @return void
+ */
+static void reference_byte(reference_t* ref, uint8_t byte,
+                           uint32_t sample_index);
+
+/**
+ * @brief Adds a complete channel message to the expected events.
+ * @param ref - The reference decoder.
+ * @param sample_index - The sample index of the events.
+ * @return void
+ */
+static void reference_message(reference_t* ref, uint32_t sample_index);
+
+/**
+ * @brief Adds an event to the expected events.
+ * @param sample_index - The sample index of the event.
+ * @param type - The event type.
+ * @param channel - The audio channel.
+ * @param data1 - The first event data byte.
+ * @param data2 - The second event data byte.
+ * @return void
+ */
+static void expect(uint32_t sample_index, event_type_t type, uint8_t channel,
+                   uint8_t data1, uint8_t data2);
+
+/**
+ * @brief Compares two lists of events.
+ * @param a - The first list.
+ * @param nbr_of_a - The number of events in the first list.
+ * @param b - The second list.
+ * @param nbr_of_b - The number of events in the second list.
+ * @return True if the lists are equal.
+ */
+static bool events_equal(const event_t* a, uint8_t nbr_of_a,
+                         const event_t* b, uint8_t nbr_of_b);
+
+/**
+ * @brief Writes a list of events to stderr.
+ * @param name - The name of the list.
+ * @param events - The events.
+ * @param nbr_of_events - The number of events.
+ * @return void
+ */
+static void print_events(const char* name, const event_t* events,
+                         uint8_t nbr_of_events);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+int main(int argc, char** argv)
+{
+    midi_parser_t parser;
+    reference_t ref;
+    unsigned long nbr_of_bytes;
+    unsigned long i;
+    uint8_t byte;
+
+    if ((argc > 1) && ('-' == argv[1][0]))
+    {
+        fprintf(stderr, "Usage: %s [number of bytes] [seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    nbr_of_bytes = argc > 1 ? strtoul(argv[1], NULL, 10) :
+                              DEFAULT_NBR_OF_BYTES;
+    fuzz_state = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) :
+                            DEFAULT_SEED;
+
+    // xorshift32 never leaves 0
+    if (0 == fuzz_state)
+    {
+        fuzz_state = DEFAULT_SEED;
+    }
+
+    if (!check_known_cases())
+    {
+        return EXIT_FAILURE;
+    }
+
+    midi_parser_init(&parser);
+    reference_init(&ref);
+
+    for (i = 0; i != nbr_of_bytes; ++i)
+    {
+        byte = next_byte();
+
+        nbr_of_pushed = 0;
+        nbr_of_expected = 0;
+
+        parser.sample_index = (uint32_t)i;
+        midi_parse_byte(&parser, byte);
+        reference_byte(&ref, byte, (uint32_t)i);
+
+        if (!is_valid(&parser))
+        {
+            fprintf(stderr,
+                    "Invalid state after byte %lu (0x%02X): status: 0x%02X "
+                    "data_count: %u data_length: %u in_sysex: %u\n",
+                    i, byte, parser.status, parser.data_count,
+                    parser.data_length, parser.in_sysex);
+            return EXIT_FAILURE;
+        }
+
+        if (!events_equal(pushed, nbr_of_pushed, expected, nbr_of_expected))
+        {
+            fprintf(stderr, "Wrong events after byte %lu (0x%02X)\n",
+                    i, byte);
+            print_events("Pushed", pushed, nbr_of_pushed);
+            print_events("Expected", expected, nbr_of_expected);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("%u known cases passed, %lu bytes parsed\n",
+           (unsigned int)NBR_OF_KNOWN_CASES, nbr_of_bytes);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Records the events of the parser instead of queueing them.
+ */
+bool event_queue_push(const event_t* event)
+{
+    if (nbr_of_pushed == MAX_EVENTS_PER_BYTE)
+    {
+        fprintf(stderr, "More than %u events pushed by one byte\n",
+                MAX_EVENTS_PER_BYTE);
+        exit(EXIT_FAILURE);
+    }
+
+    pushed[nbr_of_pushed++] = *event;
+
+    return true;
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static bool check_known_cases(void)
+{
+    const known_case_t* known;
+    midi_parser_t parser;
+    event_t all_pushed[MAX_EVENTS_PER_BYTE];
+    uint8_t nbr_of_all_pushed;
+    uint8_t i;
+    uint8_t j;
+    bool ok = true;
+
+    for (i = 0; i != NBR_OF_KNOWN_CASES; ++i)
+    {
+        known = &KNOWN_CASES[i];
+        nbr_of_all_pushed = 0;
+
+        midi_parser_init(&parser);
+
+        for (j = 0; j != known->nbr_of_bytes; ++j)
+        {
+            nbr_of_pushed = 0;
+            midi_parse_byte(&parser, known->bytes[j]);
+
+            // Events which do not fit make the comparison fail anyway
+            if (nbr_of_all_pushed + nbr_of_pushed > MAX_EVENTS_PER_BYTE)
+            {
+                nbr_of_pushed = MAX_EVENTS_PER_BYTE - nbr_of_all_pushed;
+            }
+
+            memcpy(&all_pushed[nbr_of_all_pushed], pushed,
+                   nbr_of_pushed * sizeof(event_t));
+            nbr_of_all_pushed += nbr_of_pushed;
+        }
+
+        if (!events_equal(all_pushed, nbr_of_all_pushed,
+                          known->events, known->nbr_of_events))
+        {
+            fprintf(stderr, "Failed: %s\n", known->name);
+            print_events("Pushed", all_pushed, nbr_of_all_pushed);
+            print_events("Expected", known->events, known->nbr_of_events);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+static uint8_t next_byte(void)
+{
+    uint32_t r = next_random();
+    uint8_t value = (uint8_t)(r >> 8);
+
+    switch (r % 10u)
+    {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+        return value & 0x7F;                            // Data
+
+    case 4:
+    case 5:
+    case 6:
+        return MIDI_STATUS_NOTE_OFF + (value % 0x70);   // Channel status
+
+    case 7:
+        return MIDI_STATUS_SYSEX_START + (value & 0x07); // System common
+
+    case 8:
+        return MIDI_STATUS_TIMING_CLOCK + (value & 0x07); // Real-time
+
+    default:
+        return value;
+    }
+}
+
+static uint32_t next_random(void)
+{
+    fuzz_state ^= fuzz_state << 13;
+    fuzz_state ^= fuzz_state >> 17;
+    fuzz_state ^= fuzz_state << 5;
+
+    return fuzz_state;
+}
+
+static bool is_valid(const midi_parser_t* parser)
+{
+    return (parser->data_count <= parser->data_length) &&
+           (parser->data_length <= sizeof(parser->data)) &&
+           ((0 == parser->status) || (0 != (parser->status & 0x80)));
+}
+
+static void reference_init(reference_t* ref)
+{
+    memset(ref, 0, sizeof(reference_t));
+    memset(ref->notes, NO_NOTE, sizeof(ref->notes));
+}
+
+static void reference_byte(reference_t* ref, uint8_t byte,
+                           uint32_t sample_index)
+{
+    uint8_t needed;
+    uint8_t i;
+
+    if (MIDI_STATUS_RESET == byte)
+    {
+        for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+        {
+            expect(sample_index, EVENT_NOTE_OFF, i, 0, 0);
+            ref->notes[i] = NO_NOTE;
+        }
+        return;
+    }
+
+    if (byte >= MIDI_STATUS_TIMING_CLOCK)
+    {
+        return;
+    }
+
+    if (byte >= MIDI_STATUS_SYSEX_START)
+    {
+        // System common messages with data bytes are decoded so that their
+        // data bytes are not taken as running status data, the others
+        // cancel the running status at once
+        ref->in_sysex = (MIDI_STATUS_SYSEX_START == byte);
+        ref->data_count = 0;
+        ref->status = ((MIDI_STATUS_TIME_CODE == byte) ||
+                       (MIDI_STATUS_SONG_POSITION == byte) ||
+                       (MIDI_STATUS_SONG_SELECT == byte)) ? byte : 0;
+        return;
+    }
+
+    if (byte >= MIDI_STATUS_NOTE_OFF)
+    {
+        ref->in_sysex = false;
+        ref->data_count = 0;
+        ref->status = byte;
+        return;
+    }
+
+    if (ref->in_sysex || (0 == ref->status))
+    {
+        return;
+    }
+
+    switch (ref->status & 0xF0)
+    {
+    case MIDI_STATUS_PROGRAM_CHANGE:
+    case MIDI_STATUS_CHANNEL_PRESSURE:
+        needed = 1;
+        break;
+
+    case MIDI_STATUS_SYSEX_START:
+        needed = (MIDI_STATUS_SONG_POSITION == ref->status) ? 2 : 1;
+        break;
+
+    default:
+        needed = 2;
+        break;
+    }
+
+    ref->data[ref->data_count++] = byte;
+
+    if (ref->data_count < needed)
+    {
+        return;
+    }
+
+    ref->data_count = 0;
+
+    if (ref->status >= MIDI_STATUS_SYSEX_START)
+    {
+        ref->status = 0;
+    }
+    else
+    {
+        reference_message(ref, sample_index);
+    }
+}
+
+static void reference_message(reference_t* ref, uint32_t sample_index)
+{
+    uint8_t channel = ref->status & 0x0F;
+    uint8_t data1 = ref->data[0];
+    uint8_t data2 = ref->data[1];
+    uint8_t type = ref->status & 0xF0;
+
+    if (channel >= AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        return;
+    }
+
+    if ((MIDI_STATUS_NOTE_ON == type) && (0 == data2))
+    {
+        type = MIDI_STATUS_NOTE_OFF;
+    }
+
+    switch (type)
+    {
+    case MIDI_STATUS_NOTE_ON:
+        expect(sample_index, EVENT_NOTE_ON, channel, data1, data2);
+        ref->notes[channel] = data1;
+        break;
+
+    case MIDI_STATUS_NOTE_OFF:
+        if (ref->notes[channel] == data1)
+        {
+            expect(sample_index, EVENT_NOTE_OFF, channel, 0, 0);
+            ref->notes[channel] = NO_NOTE;
+        }
+        break;
+
+    case MIDI_STATUS_CONTROL_CHANGE:
+        if ((MIDI_CC_ALL_SOUND_OFF == data1) ||
+            (MIDI_CC_ALL_NOTES_OFF == data1))
+        {
+            expect(sample_index, EVENT_NOTE_OFF, channel, 0, 0);
+            ref->notes[channel] = NO_NOTE;
+        }
+        else if (MIDI_CC_RESET_ALL_CONTROLLERS == data1)
+        {
+            expect(sample_index, EVENT_PITCH_BEND, channel, 0, 64);
+        }
+        else
+        {
+            expect(sample_index, EVENT_CONTROL_CHANGE, channel, data1, data2);
+        }
+        break;
+
+    case MIDI_STATUS_PITCH_BEND:
+        expect(sample_index, EVENT_PITCH_BEND, channel, data1, data2);
+        break;
+
+    case MIDI_STATUS_PROGRAM_CHANGE:
+        expect(sample_index, EVENT_PROGRAM_CHANGE, channel, data1, 0);
+        break;
+
+    default:
+        // Pressure messages are not used
+        break;
+    }
+}
+
+static void expect(uint32_t sample_index, event_type_t type, uint8_t channel,
+                   uint8_t data1, uint8_t data2)
+{
+    event_t* event = &expected[nbr_of_expected++];
+
+    event->sample_index = sample_index;
+    event->type = type;
+    event->channel = channel;
+    event->data1 = data1;
+    event->data2 = data2;
+}
+
+static bool events_equal(const event_t* a, uint8_t nbr_of_a,
+                         const event_t* b, uint8_t nbr_of_b)
+{
+    uint8_t i;
+
+    if (nbr_of_a != nbr_of_b)
+    {
+        return false;
+    }
+
+    for (i = 0; i != nbr_of_a; ++i)
+    {
+        if ((a[i].sample_index != b[i].sample_index) ||
+            (a[i].type != b[i].type) ||
+            (a[i].channel != b[i].channel) ||
+            (a[i].data1 != b[i].data1) ||
+            (a[i].data2 != b[i].data2))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void print_events(const char* name, const event_t* events,
+                         uint8_t nbr_of_events)
+{
+    uint8_t i;
+
+    fprintf(stderr, "%s:\n", name);
+
+    for (i = 0; i != nbr_of_events; ++i)
+    {
+        fprintf(stderr, "\tsample: %u type: %u channel: %u data: %u %u\n",
+                (unsigned int)events[i].sample_index, events[i].type,
+                events[i].channel, events[i].data1, events[i].data2);
+    }
+}
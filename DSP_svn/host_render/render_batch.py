@@ -0,0 +1,159 @@
+# This script renders songs to WAV files with the audio engine running on
+# the host, for listening to songs exactly as the device plays them.
+#
+# Every song is compiled with song_compiler.py and rendered by song_render,
+# which is built from the engine sources on the first run. The songs are
+# rendered in parallel, one song_render process per core, so every worker
+# has its own engine instance.
+#
+# Usage:
+#   render_batch.py [-o out_dir] [-j jobs] [--seconds n] [--rate hz]
+#                   [--map 0:0,1:1,2:2,9:3] [--loop] songs...
+#
+# The render time of every song and the real-time factor of the whole batch
+# (seconds of audio rendered per second of wall time) are reported.
+
+import argparse
+import multiprocessing
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+ENGINE_DIR = os.path.dirname(SCRIPT_DIR)
+
+sys.path.insert(0, ENGINE_DIR)
+import song_compiler
+
+ENGINE_SOURCES = ["audio.c", "period_tables.c", "utilities.c", "fixed_point.c",
+                  "event_queue.c", "cc_router.c", "patch.c", "sequencer.c",
+                  "midi.c"]
+
+RENDERER = os.path.join(SCRIPT_DIR, "song_render")
+RENDERER_SOURCES = [os.path.join(SCRIPT_DIR, "song_render.c"),
+                    os.path.join(SCRIPT_DIR, "host_stubs.c")]
+
+DEFAULT_MAX_SECONDS = 600
+
+
+class Renderer_build:
+    # @brief Builds song_render if it is missing or older than its sources.
+    # @param compiler - The C compiler to use.
+    # @return True if song_render is up to date.
+    def build(self, compiler = "cc"):
+        sources = RENDERER_SOURCES + [os.path.join(ENGINE_DIR, s) for s in ENGINE_SOURCES]
+        headers = [os.path.join(ENGINE_DIR, f) for f in os.listdir(ENGINE_DIR) if f.endswith(".h")]
+
+        if os.path.exists(RENDERER) and \
+           os.path.getmtime(RENDERER) > max(os.path.getmtime(f) for f in sources + headers):
+            return True
+
+        command = [compiler, "-O2", "-I" + SCRIPT_DIR, "-I" + ENGINE_DIR,
+                   "-o", RENDERER] + sources + ["-lm"]
+        print("Building song_render")
+        return subprocess.call(command) == 0
+
+
+# @brief Compiles and renders one song.
+# @details Runs in a worker process.
+# @param job - (song file, wav file, options)
+# @return (song file, seconds of audio, render seconds, error or None)
+def render_song(job):
+    filename, wav_filename, options = job
+    start = time.perf_counter()
+
+    try:
+        if filename.lower().endswith((".mid", ".midi")):
+            song = song_compiler.Smf_parser(options.map).parse(filename, options.loop)
+        else:
+            song = song_compiler.Mml_parser().parse(filename, options.loop)
+        data = song_compiler.Song_compiler().compile(song)
+    except (song_compiler.Song_error, IndexError) as e:
+        return (filename, 0, 0, str(e))
+
+    with tempfile.NamedTemporaryFile(suffix = ".bin", delete = False) as f:
+        f.write(data)
+        song_filename = f.name
+
+    command = [RENDERER, song_filename, wav_filename, str(options.seconds)]
+    if options.rate:
+        command.append(str(options.rate))
+
+    result = subprocess.run(command, capture_output = True, text = True)
+    os.remove(song_filename)
+    render_time = time.perf_counter() - start
+
+    if result.returncode != 0:
+        return (filename, 0, render_time, result.stderr.strip())
+
+    nbr_of_samples, sample_freq = (int(v) for v in result.stdout.split())
+    return (filename, nbr_of_samples / sample_freq, render_time, None)
+
+
+class Batch_renderer:
+    # @brief Renders songs in parallel.
+    # @param filenames - The songs.
+    # @param options - The parsed command line.
+    # @return True if all songs were rendered.
+    def render(self, filenames, options):
+        os.makedirs(options.output, exist_ok = True)
+        jobs = []
+
+        for filename in filenames:
+            name = os.path.splitext(os.path.basename(filename))[0]
+            jobs.append((filename, os.path.join(options.output, name + ".wav"), options))
+
+        start = time.perf_counter()
+        total_audio = 0.0
+        failed = 0
+
+        with multiprocessing.Pool(options.jobs) as pool:
+            for filename, audio_time, render_time, error in \
+                pool.imap_unordered(render_song, jobs):
+                if error:
+                    failed += 1
+                    print("    %-32s error: %s" % (os.path.basename(filename), error))
+                    continue
+                total_audio += audio_time
+                print("    %-32s %7.1f s audio in %6.2f s, %6.1fx real time"
+                      % (os.path.basename(filename), audio_time, render_time,
+                         audio_time / render_time))
+
+        wall_time = time.perf_counter() - start
+        print("Rendered %u of %u songs, %.1f s of audio in %.2f s with %u workers"
+              % (len(jobs) - failed, len(jobs), total_audio, wall_time, options.jobs))
+        print("Real-time factor: %.1fx" % (total_audio / wall_time))
+
+        return failed == 0
+
+# ===============================================================================
+# Module test
+# ===============================================================================
+
+if __name__ == "__main__":
+    arg_parser = argparse.ArgumentParser(description = "Renders songs with the audio engine")
+    arg_parser.add_argument("songs", nargs = "+", help = "midi or mml files")
+    arg_parser.add_argument("-o", "--output", default = "render",
+                            help = "directory for the wav files")
+    arg_parser.add_argument("-j", "--jobs", type = int, default = os.cpu_count(),
+                            help = "number of worker processes")
+    arg_parser.add_argument("--seconds", type = int, default = DEFAULT_MAX_SECONDS,
+                            help = "maximum length of a song, for looping songs")
+    arg_parser.add_argument("--rate", type = int, default = 0,
+                            help = "sample rate, the engine default if not given")
+    arg_parser.add_argument("--map", type = song_compiler.parse_channel_map,
+                            default = song_compiler.DEFAULT_CHANNEL_MAP,
+                            help = "midi channel to audio channel map")
+    arg_parser.add_argument("--loop", action = "store_true",
+                            help = "loop songs without a loop point")
+    arg_parser.add_argument("--cc", default = "cc", help = "host C compiler")
+    options = arg_parser.parse_args()
+
+    print("Render batch started")
+    if not Renderer_build().build(options.cc):
+        sys.exit(1)
+    if not Batch_renderer().render(options.songs, options):
+        sys.exit(1)
+    print("Render batch complete")
@@ -0,0 +1,420 @@
+/*
+ * This file implements sched_sim, which runs the scheduler of the main loop
+ * (see sched.h) on the host against a simulated device.
+ *
+ * sched.c is compiled unchanged and the task table has the same order and
+ * uses the same render and modulation policy as main.c, but the tasks only
+ * advance a simulated timer by their configured run times:
+ *  - render: the run time per sample, at most SCHED_RENDER_BLOCK_SIZE
+ *    samples per run, in bursts from half a sample buffer until a block no
+ *    longer fits.
+ *  - modulation: a fixed run time once per tick.
+ *  - terminal: a command with TERMINAL_STEPS steps is received every
+ *    TERMINAL_PERIOD_MS, and each run does one step.
+ *  - control: a fixed run time, when a link frame is received every
+ *    CONTROL_PERIOD_MS.
+ * When no task is ready the CPU is in Idle until the next interrupt.
+ * While time passes the DMA pops one sample per sample period and the timer
+ * sets the modulation event once per tick. Both interrupts take time from
+ * the running task. An empty sample buffer when the DMA pops a sample is an
+ * underrun, which is heard as a click on the device.
+ *
+ * Usage: sched_sim [seconds] [render us/sample] [modulation us]
+ *                  [terminal step us] [sample rate]
+ *
+ * The statistics of each task and the duty cycle, as shown by the terminal
+ * command "get scheduler", and the number of underruns are written to stdout.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sched.h"
+#include "timer.h"
+#include "telemetry.h"
+#include "trace.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+const uint32_t TIMER_FREQ_HZ = 100;
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// Timer1 runs at Fosc / 2 / 8.
+#define COUNTS_PER_SECOND           (2000000u)
+#define COUNTS_PER_US               (COUNTS_PER_SECOND / 1000000u)
+
+// Same as in audio.h
+#define SAMPLE_BUFF_DEPTH           (128u)
+
+#define DEFAULT_SECONDS             (10u)
+#define DEFAULT_SAMPLE_FREQ         (48000u)
+
+// Default run times in microseconds.
+#define DEFAULT_RENDER_US           (12.0)
+#define DEFAULT_MODULATION_US       (400.0)
+#define DEFAULT_TERMINAL_STEP_US    (150.0)
+#define RENDER_OVERHEAD_US          (10.0)
+#define CONTROL_US                  (15.0)
+
+// The run times of the interrupts, taken from the running task.
+#define DMA0_ISR_US                 (2.0)
+#define T1_ISR_US                   (3.0)
+
+#define CONTROL_PERIOD_MS           (10u)
+#define TERMINAL_PERIOD_MS          (100u)
+#define TERMINAL_STEPS              (20u)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+
+// The simulated time in timer counts.
+static uint64_t now = 0;
+
+static uint32_t sample_freq = DEFAULT_SAMPLE_FREQ;
+static uint64_t nbr_of_samples = 0;     // Samples popped by the DMA
+static uint64_t next_sample = 0;        // The time of the next DMA interrupt
+static uint64_t next_tick = 0;          // The time of the next T1 interrupt
+static uint64_t next_command = 0;       // The time of the next command
+static uint64_t next_frame = 0;         // The time of the next link frame
+static uint64_t idle_time = 0;          // Time spent in Idle
+
+// The sample buffer is filled before the DMA is started.
+static uint16_t sample_buff_size = SAMPLE_BUFF_DEPTH;
+static uint32_t underruns = 0;
+static bool modulation_event = false;
+static uint16_t terminal_steps = 0;
+static bool control_frame = false;
+
+// The run times in timer counts.
+static uint32_t render_counts;
+static uint32_t render_overhead_counts;
+static uint32_t modulation_counts;
+static uint32_t terminal_step_counts;
+static uint32_t control_counts;
+static uint32_t dma0_isr_counts;
+static uint32_t t1_isr_counts;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Lets time pass while a task runs, and runs the interrupts which
+ *        occur meanwhile.
+ * @param counts - The run time of the task in timer counts.
+ * @return void
+ */
+static void run_for(uint32_t counts);
+
+/**
+ * @brief Converts microseconds to timer counts.
+ * @param us - The time in microseconds.
+ * @return The time in timer counts.
+ */
+static uint32_t us_to_counts(double us);
+
+/**
+ * @brief Converts timer counts to microseconds.
+ * @param counts - The time in timer counts.
+ * @return The time in microseconds.
+ */
+static unsigned long counts_to_us(uint64_t counts);
+
+static void render_samples(void);
+static bool render_is_ready(void);
+static bool render_is_late(void);
+static void run_modulation(void);
+static bool modulation_is_ready(void);
+static void run_terminal(void);
+static bool terminal_is_ready(void);
+static void run_control(void);
+static bool control_is_ready(void);
+static void idle(void);
+
+// The tasks in the same order as in main.c.
+static const sched_task_t TASKS[] =
+{
+    {
+        "render", render_is_ready, render_samples, render_is_late,
+        TELEMETRY_STAGE_RENDER, TRACE_RENDER
+    },
+    {
+        "modulation", modulation_is_ready, run_modulation,
+        sched_modulation_is_late,
+        TELEMETRY_STAGE_MODULATION, TRACE_MODULATION
+    },
+    {
+        "terminal", terminal_is_ready, run_terminal, NULL,
+        TELEMETRY_STAGE_CONTROL, TRACE_TERMINAL
+    },
+    {
+        "control", control_is_ready, run_control, NULL,
+        TELEMETRY_STAGE_CONTROL, TRACE_CONTROL
+    }
+};
+
+#define NBR_OF_TASKS (sizeof(TASKS) / sizeof(TASKS[0]))
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+int main(int argc, char** argv)
+{
+    uint64_t end;
+    sched_stats_t stats;
+    uint8_t i;
+
+    if ((argc > 1) && ('-' == argv[1][0]))
+    {
+        fprintf(stderr,
+                "Usage: %s [seconds] [render us/sample] [modulation us] "
+                "[terminal step us] [sample rate]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    end = (uint64_t)(argc > 1 ? (uint32_t)atoi(argv[1]) : DEFAULT_SECONDS) *
+          COUNTS_PER_SECOND;
+    render_counts = us_to_counts(argc > 2 ? atof(argv[2]) : DEFAULT_RENDER_US);
+    modulation_counts =
+        us_to_counts(argc > 3 ? atof(argv[3]) : DEFAULT_MODULATION_US);
+    terminal_step_counts =
+        us_to_counts(argc > 4 ? atof(argv[4]) : DEFAULT_TERMINAL_STEP_US);
+    sample_freq = argc > 5 ? (uint32_t)atoi(argv[5]) : DEFAULT_SAMPLE_FREQ;
+
+    if ((0 == end) || (0 == sample_freq))
+    {
+        fprintf(stderr, "The time and the sample rate must not be 0\n");
+        return EXIT_FAILURE;
+    }
+
+    render_overhead_counts = us_to_counts(RENDER_OVERHEAD_US);
+    control_counts = us_to_counts(CONTROL_US);
+    dma0_isr_counts = us_to_counts(DMA0_ISR_US);
+    t1_isr_counts = us_to_counts(T1_ISR_US);
+
+    next_sample = COUNTS_PER_SECOND / sample_freq;
+    next_tick = timer_get_counts_per_tick();
+    next_command = 0;
+    next_frame = 0;
+
+    sched_init(TASKS, NBR_OF_TASKS, idle);
+
+    while (now < end)
+    {
+        sched_run();
+    }
+
+    printf("Simulated %lu ms, %lu samples at %lu Hz\n",
+           (unsigned long)(now / (COUNTS_PER_SECOND / 1000u)),
+           (unsigned long)nbr_of_samples,
+           (unsigned long)sample_freq);
+    printf("Idle: %lu\tduty cycle: %u.%u %%, %.1f %% on average\n",
+           (unsigned long)sched_get_idle_count(),
+           sched_get_duty_cycle() / 10u,
+           sched_get_duty_cycle() % 10u,
+           100.0 - 100.0 * idle_time / now);
+
+    for (i = 0; i != sched_get_nbr_of_tasks(); ++i)
+    {
+        sched_get_stats(i, &stats);
+
+        printf("\t%-10s runs: %lu\tavg: %lu us\tmax: %lu us\tlate: %u"
+               "\tload: %.1f %%\n",
+               sched_get_task_name(i),
+               (unsigned long)stats.runs,
+               0 != stats.runs ?
+                   counts_to_us(stats.total_time / stats.runs) : 0,
+               counts_to_us(stats.max_time),
+               stats.deadline_misses,
+               100.0 * stats.total_time / now);
+    }
+
+    printf("Underruns: %lu\n", (unsigned long)underruns);
+
+    return 0 == underruns ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Host versions of the modules used by the scheduler.
+ */
+
+uint32_t timer_get_tick_count(void)
+{
+    return (uint32_t)(now / timer_get_counts_per_tick());
+}
+
+uint16_t timer_get_time(void)
+{
+    return (uint16_t)(now % timer_get_counts_per_tick());
+}
+
+uint16_t timer_get_elapsed(uint16_t start)
+{
+    uint16_t time = timer_get_time();
+
+    if (time >= start)
+    {
+        return time - start;
+    }
+
+    return time + timer_get_counts_per_tick() - start;
+}
+
+uint16_t timer_get_counts_per_tick(void)
+{
+    return COUNTS_PER_SECOND / TIMER_FREQ_HZ;
+}
+
+void telemetry_add_time(telemetry_stage_t stage, uint16_t counts)
+{
+    (void)stage;
+    (void)counts;
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void run_for(uint32_t counts)
+{
+    uint64_t done = now + counts;
+
+    while ((next_sample <= done) || (next_tick <= done))
+    {
+        if (next_sample <= next_tick)
+        {
+            if (0 != sample_buff_size)
+            {
+                --sample_buff_size;
+            }
+            else
+            {
+                ++underruns;
+            }
+
+            ++nbr_of_samples;
+            next_sample = (nbr_of_samples + 1) * COUNTS_PER_SECOND /
+                          sample_freq;
+            done += dma0_isr_counts;
+        }
+        else
+        {
+            modulation_event = true;
+            next_tick += timer_get_counts_per_tick();
+            done += t1_isr_counts;
+        }
+    }
+
+    if (next_frame <= done)
+    {
+        control_frame = true;
+        next_frame += (uint64_t)CONTROL_PERIOD_MS *
+                      (COUNTS_PER_SECOND / 1000u);
+    }
+
+    if (next_command <= done)
+    {
+        terminal_steps = TERMINAL_STEPS;
+        next_command += (uint64_t)TERMINAL_PERIOD_MS *
+                        (COUNTS_PER_SECOND / 1000u);
+    }
+
+    now = done;
+}
+
+static uint32_t us_to_counts(double us)
+{
+    return (uint32_t)(us * COUNTS_PER_US + 0.5);
+}
+
+static unsigned long counts_to_us(uint64_t counts)
+{
+    return (unsigned long)(counts / COUNTS_PER_US);
+}
+
+static void render_samples(void)
+{
+    uint16_t samples = sched_render_block(sample_buff_size, SAMPLE_BUFF_DEPTH);
+
+    run_for(render_overhead_counts);
+
+    while ((0 != samples--) && (sample_buff_size != SAMPLE_BUFF_DEPTH))
+    {
+        run_for(render_counts);
+        ++sample_buff_size;
+    }
+}
+
+static bool render_is_ready(void)
+{
+    return sched_render_is_ready(sample_buff_size, SAMPLE_BUFF_DEPTH);
+}
+
+static bool render_is_late(void)
+{
+    return sched_render_is_late(sample_buff_size, SAMPLE_BUFF_DEPTH);
+}
+
+static void run_modulation(void)
+{
+    modulation_event = false;
+
+    run_for(modulation_counts);
+}
+
+static bool modulation_is_ready(void)
+{
+    return modulation_event;
+}
+
+static void run_terminal(void)
+{
+    --terminal_steps;
+
+    run_for(terminal_step_counts);
+}
+
+static bool terminal_is_ready(void)
+{
+    return 0 != terminal_steps;
+}
+
+static void run_control(void)
+{
+    control_frame = false;
+
+    run_for(control_counts);
+}
+
+static bool control_is_ready(void)
+{
+    return control_frame;
+}
+
+static void idle(void)
+{
+    uint64_t start = now;
+
+    // Until the next interrupt, which runs before Idle returns
+    now = next_sample < next_tick ? next_sample : next_tick;
+    idle_time += now - start;
+
+    run_for(0);
+}
@@ -0,0 +1,278 @@
+/*
+ * This file implements song_render, which runs the audio engine on the host
+ * and renders a compiled song (see sequencer.h) to a WAV file.
+ *
+ * The engine sources are compiled unchanged. The main loop of main.c is
+ * replayed sample by sample: the DMA pops one sample per sample period, the
+ * sample buffer is refilled in blocks with the events of the event queue
+ * executed at their samples, and the modulation tick runs every
+ * sample rate / TIMER_FREQ_HZ samples. The output is thereby the same as
+ * the DAC input of the device, with two exceptions:
+ *  - The noise channel uses a seeded LFSR instead of the crypto module.
+ *  - The governor is not run, since the host has no CPU load to shed.
+ *
+ * Usage: song_render <song file> <wav file> [max seconds] [sample rate]
+ *
+ * On success the number of rendered samples and the sample rate are written
+ * to stdout, which is read by render_batch.py.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "xc.h"
+#include "audio.h"
+#include "event_queue.h"
+#include "cc_router.h"
+#include "patch.h"
+#include "sequencer.h"
+#include "songs.h"
+#include "rng.h"
+#include "timer.h"
+#include "uart.h"
+#include "log.h"
+#include "sched.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// The song is loaded into the buffer of the only song. The sequencer checks
+// that the song fits within the buffer.
+static uint8_t song_buff[0x10000u];
+
+const song_t g_songs[] =
+{
+    { song_buff, sizeof(song_buff) - 1 }
+};
+
+const uint8_t g_songs_nbr_of_songs = 1;
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// Samples rendered after the song has stopped, for the release of the notes.
+#define TAIL_SECONDS                (1u)
+
+#define DEFAULT_MAX_SECONDS         (600u)
+
+#define WAV_HEADER_SIZE             (44u)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Calculates a block of samples, as render_samples in main.c.
+ * @param void
+ * @return void
+ */
+static void render_samples(void);
+
+/**
+ * @brief Writes a 16 bit mono WAV header.
+ * @param f - The file, positioned at its start.
+ * @param sample_freq - The sample rate in Hz.
+ * @param nbr_of_samples - The number of samples which follow the header.
+ * @return void
+ */
+static void write_wav_header(FILE* f,
+                             uint32_t sample_freq,
+                             uint32_t nbr_of_samples);
+
+static void write_u16(FILE* f, uint16_t value);
+static void write_u32(FILE* f, uint32_t value);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+int main(int argc, char** argv)
+{
+    FILE* song_file;
+    FILE* wav_file;
+    uint32_t max_samples;
+    uint32_t tail_samples;
+    uint32_t nbr_of_samples = 0;
+    uint16_t samples_per_tick;
+    uint16_t tick_samples = 0;
+    int16_t sample;
+    uint8_t ch;
+
+    if (argc < 3)
+    {
+        fprintf(stderr,
+                "Usage: %s <song file> <wav file> [max seconds] [sample rate]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    song_file = fopen(argv[1], "rb");
+
+    if (NULL == song_file)
+    {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    (void)fread(song_buff, 1, sizeof(song_buff), song_file);
+    fclose(song_file);
+
+    audio_init(&g_audio_engine);
+
+    if ((argc > 4) &&
+        !audio_set_sample_freq(&g_audio_engine, (uint16_t)atoi(argv[4])))
+    {
+        return EXIT_FAILURE;
+    }
+
+    patch_init();
+    event_queue_init();
+    cc_router_init();
+    sequencer_init();
+
+    // Silence the start up chord of audio_init
+    for (ch = 0; ch != AUDIO_CH_NBR_OF_CHANNELS; ++ch)
+    {
+        audio_note_off(&g_audio_engine, (audio_ch_nbr_t)ch);
+    }
+
+    if (!sequencer_play(0))
+    {
+        fprintf(stderr, "%s is not a valid song\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    wav_file = fopen(argv[2], "wb");
+
+    if (NULL == wav_file)
+    {
+        fprintf(stderr, "Cannot open %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    max_samples = (argc > 3 ? (uint32_t)atoi(argv[3]) : DEFAULT_MAX_SECONDS) *
+                  audio_get_sample_freq(&g_audio_engine);
+    tail_samples = TAIL_SECONDS * audio_get_sample_freq(&g_audio_engine);
+    samples_per_tick = audio_get_sample_freq(&g_audio_engine) / TIMER_FREQ_HZ;
+
+    write_wav_header(wav_file, audio_get_sample_freq(&g_audio_engine), 0);
+    render_samples();
+
+    while ((nbr_of_samples < max_samples) && (0 != tail_samples))
+    {
+        sample = audio_pop_sample(&g_audio_engine);
+        write_u16(wav_file, (uint16_t)sample);
+        ++nbr_of_samples;
+
+        if (!sequencer_is_playing())
+        {
+            --tail_samples;
+        }
+
+        if (samples_per_tick == ++tick_samples)
+        {
+            tick_samples = 0;
+
+            sequencer_tick();
+            patch_apply();
+            cc_router_apply();
+            audio_apply_modulation(&g_audio_engine);
+        }
+
+        if (audio_get_sample_buff_size(&g_audio_engine) <=
+            audio_get_sample_buff_depth(&g_audio_engine) -
+            SCHED_RENDER_BLOCK_SIZE)
+        {
+            render_samples();
+        }
+    }
+
+    fseek(wav_file, 0, SEEK_SET);
+    write_wav_header(wav_file,
+                     audio_get_sample_freq(&g_audio_engine),
+                     nbr_of_samples);
+    fclose(wav_file);
+
+    printf("%lu %u\n",
+           (unsigned long)nbr_of_samples,
+           audio_get_sample_freq(&g_audio_engine));
+
+    return EXIT_SUCCESS;
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void render_samples(void)
+{
+    uint16_t samples;
+    uint16_t block;
+
+    samples = audio_get_sample_buff_depth(&g_audio_engine) -
+              audio_get_sample_buff_size(&g_audio_engine);
+
+    if (samples > SCHED_RENDER_BLOCK_SIZE)
+    {
+        samples = SCHED_RENDER_BLOCK_SIZE;
+    }
+
+    while (0 != samples)
+    {
+        event_queue_dispatch(audio_get_sample_index(&g_audio_engine));
+
+        block = event_queue_samples_until_next(
+                    audio_get_sample_index(&g_audio_engine),
+                    samples);
+        samples -= block;
+
+        audio_calc_samples(&g_audio_engine, block);
+    }
+}
+
+static void write_wav_header(FILE* f,
+                             uint32_t sample_freq,
+                             uint32_t nbr_of_samples)
+{
+    uint32_t data_size = nbr_of_samples * sizeof(int16_t);
+
+    fwrite("RIFF", 1, 4, f);
+    write_u32(f, WAV_HEADER_SIZE - 8 + data_size);
+    fwrite("WAVEfmt ", 1, 8, f);
+    write_u32(f, 16);                       // Format chunk size
+    write_u16(f, 1);                        // PCM
+    write_u16(f, 1);                        // Mono
+    write_u32(f, sample_freq);
+    write_u32(f, sample_freq * sizeof(int16_t));
+    write_u16(f, sizeof(int16_t));          // Block align
+    write_u16(f, 16);                       // Bits per sample
+    fwrite("data", 1, 4, f);
+    write_u32(f, data_size);
+}
+
+static void write_u16(FILE* f, uint16_t value)
+{
+    fputc(value & 0xFF, f);
+    fputc(value >> 8, f);
+}
+
+static void write_u32(FILE* f, uint32_t value)
+{
+    write_u16(f, value & 0xFFFF);
+    write_u16(f, value >> 16);
+}
@@ -0,0 +1,54 @@
+/*
+ * File:   xc.h
+ * Author: Erik
+ *
+ * Stand in for the XC16 device header when the audio engine is built for
+ * the host by the programs in host_render. Only the registers used by
+ * inline functions in the engine headers are declared, they are defined in
+ * host_stubs.c.
+ */
+
+#ifndef XC_H
+#define	XC_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+typedef struct iec0_bits_t
+{
+    unsigned U1RXIE:1;
+    unsigned U1TXIE:1;
+} iec0_bits_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+extern volatile iec0_bits_t IEC0bits;
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+#define ClrWdt()
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* XC_H */
+
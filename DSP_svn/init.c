@@ -11,6 +11,16 @@
 #include "pcm1774.h"
 #include "uart.h"
 #include "audio.h"
+#include "governor.h"
+#include "event_queue.h"
+#include "cc_router.h"
+#include "patch.h"
+#include "link.h"
+#include "sequencer.h"
+#include "control.h"
+#include "log.h"
+#include "telemetry.h"
+#include "terminal.h"
 
 // =============================================================================
 // Private type definitions
@@ -42,12 +52,22 @@
 
 void init_system(void)
 {
+    log_init();
     gpio_init();
     uart_init();    // Start the UART interface
     mcu_init();
 
-    audio_init();   // Start the audio engine
+    audio_init(&g_audio_engine);   // Start the audio engine
+    patch_init();
+    governor_init();
     pcm1774_init(); // Set up the audio interfaces
+    event_queue_init();
+    cc_router_init();
+    sequencer_init();
+    link_init();    // Start receiving commands from the PIC32
+    control_init(); // Start receiving binary commands on the UART
+    telemetry_init();
+    terminal_init();
     timer_start();  // Start the audio modulation timer
 }
 
@@ -0,0 +1,257 @@
+/*
+ * This file implements the command link from the PIC32 game CPU.
+ *
+ * The DMA writes the received bytes into rx_buff and wraps around at the
+ * end. The number of written bytes is read from the DMA channel and the
+ * number of parsed bytes is counted here, all bytes in between are unparsed.
+ * The counts wrap around at 2^16, which is a multiple of the buffer size, so
+ * the position in rx_buff is the count modulo the buffer size.
+ *
+ * If the DMA has written a whole buffer more than has been parsed, the
+ * unparsed bytes have been overwritten. The bytes are then dropped, the
+ * decoders are resynchronized and the overrun is counted.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "link.h"
+#include "frame.h"
+#include "midi.h"
+#include "audio.h"
+#include "sequencer.h"
+
+#ifndef LINK_LOOPBACK
+#include "spi.h"
+#include "dma.h"
+#endif
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+#if (LINK_RX_BUFF_SIZE & (LINK_RX_BUFF_SIZE - 1)) != 0
+#error LINK_RX_BUFF_SIZE must be a power of two
+#endif
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static volatile uint8_t rx_buff[LINK_RX_BUFF_SIZE];
+static uint16_t rx_read_count = 0;
+
+#ifdef LINK_LOOPBACK
+static uint16_t rx_write_count = 0;
+#endif
+
+static frame_decoder_t decoder;
+static midi_parser_t midi_parser;
+static link_stats_t stats;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Gets the number of bytes written to rx_buff.
+ * @param void
+ * @return The write count, wraps around at 2^16.
+ */
+static inline uint16_t get_write_count(void);
+
+/**
+ * @brief Executes a received frame.
+ * @param frame - The frame to execute.
+ * @return void
+ */
+static void execute_frame(const frame_t* frame);
+
+/**
+ * @brief Executes the payload of a timed MIDI frame.
+ * @param frame - The frame to execute.
+ * @return void
+ */
+static void execute_timed_midi(const frame_t* frame);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void link_init(void)
+{
+    rx_read_count = 0;
+
+    frame_decoder_init(&decoder);
+    midi_parser_init(&midi_parser);
+    memset(&stats, 0, sizeof(link_stats_t));
+
+#ifdef LINK_LOOPBACK
+    rx_write_count = 0;
+#else
+    spi_init(SPI_DEVICE_PIC32);
+    dma_link_ch_init(rx_buff, LINK_RX_BUFF_SIZE);
+#endif
+}
+
+void link_process(uint16_t max_bytes)
+{
+    uint16_t write_count = get_write_count();
+
+    if ((uint16_t)(write_count - rx_read_count) >= LINK_RX_BUFF_SIZE)
+    {
+        ++stats.overruns;
+
+        rx_read_count = write_count;
+        decoder.state = FRAME_STATE_SYNC;
+        midi_parser_init(&midi_parser);
+
+        return;
+    }
+
+    while ((rx_read_count != write_count) && (0 != max_bytes--))
+    {
+        ++stats.bytes;
+
+        if (frame_decode_byte(&decoder,
+                              rx_buff[rx_read_count & (LINK_RX_BUFF_SIZE - 1)]))
+        {
+            ++stats.frames;
+            execute_frame(&decoder.frame);
+        }
+
+        ++rx_read_count;
+    }
+}
+
+bool link_has_received_bytes(void)
+{
+    return rx_read_count != get_write_count();
+}
+
+void link_get_stats(link_stats_t* dst)
+{
+    memcpy(dst, &stats, sizeof(link_stats_t));
+    dst->crc_errors = decoder.crc_errors;
+    dst->length_errors += decoder.length_errors;
+}
+
+#ifdef LINK_LOOPBACK
+void link_loopback_write(const uint8_t* data, uint16_t length)
+{
+    while (length--)
+    {
+        rx_buff[rx_write_count & (LINK_RX_BUFF_SIZE - 1)] = *data++;
+        ++rx_write_count;
+    }
+}
+#endif
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static inline uint16_t get_write_count(void)
+{
+#ifdef LINK_LOOPBACK
+    return rx_write_count;
+#else
+    return dma_link_get_count();
+#endif
+}
+
+static void execute_frame(const frame_t* frame)
+{
+    uint8_t i;
+
+    switch (frame->opcode)
+    {
+    case LINK_OPCODE_MIDI:
+        midi_parser.sample_index = audio_get_sample_index(&g_audio_engine);
+
+        for (i = 0; i != frame->length; ++i)
+        {
+            midi_parse_byte(&midi_parser, frame->payload[i]);
+        }
+        break;
+
+    case LINK_OPCODE_TIMED_MIDI:
+        execute_timed_midi(frame);
+        break;
+
+    case LINK_OPCODE_SONG_PLAY:
+        if (0 == frame->length)
+        {
+            ++stats.length_errors;
+        }
+        else
+        {
+            (void)sequencer_play(frame->payload[0]);
+        }
+        break;
+
+    case LINK_OPCODE_SONG_STOP:
+        sequencer_stop();
+        break;
+
+    case LINK_OPCODE_SONG_TEMPO:
+        if (0 == frame->length)
+        {
+            ++stats.length_errors;
+        }
+        else
+        {
+            sequencer_set_tempo(frame->payload[0]);
+        }
+        break;
+
+    default:
+        ++stats.unknown_opcodes;
+        break;
+    }
+}
+
+static void execute_timed_midi(const frame_t* frame)
+{
+    uint32_t base = audio_get_schedule_base(&g_audio_engine);
+    uint16_t offset;
+    uint8_t count;
+    uint8_t i = 0;
+
+    while (i + 3 <= frame->length)
+    {
+        offset = frame->payload[i] | ((uint16_t)frame->payload[i + 1] << 8);
+        count = frame->payload[i + 2];
+        i += 3;
+
+        if (count > frame->length - i)
+        {
+            ++stats.length_errors;
+            return;
+        }
+
+        if (offset > LINK_TIMED_MIDI_MAX_OFFSET)
+        {
+            ++stats.clamped_offsets;
+            offset = LINK_TIMED_MIDI_MAX_OFFSET;
+        }
+
+        midi_parser.sample_index = base + offset;
+
+        while (0 != count--)
+        {
+            midi_parse_byte(&midi_parser, frame->payload[i++]);
+        }
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * File:   link.h
+ * Author: Erik
+ *
+ * Command link from the PIC32 game CPU.
+ *
+ * The PIC32 is the SPI master and sends frames (see frame.h) to the DSP.
+ * The bytes are received by SPI3 and moved by DMA into a ring buffer, so no
+ * interrupt is taken per byte. The frames are parsed in the main loop by
+ * link_process.
+ *
+ * If LINK_LOOPBACK is defined as a project macro, the SPI and DMA registers
+ * are not used. Instead bytes are written into the ring buffer with
+ * link_loopback_write, which makes the link testable without hardware.
+ */
+
+#ifndef LINK_H
+#define	LINK_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+/*
+ * Frame opcodes
+ */
+typedef enum link_opcode_t
+{
+    // The payload is a stream of raw MIDI bytes. Several MIDI messages may
+    // be batched in one frame and running status is kept between frames.
+    // The messages take effect as soon as possible.
+    LINK_OPCODE_MIDI = 0x01,
+
+    // The payload is a sequence of timed entries. Each entry is a 16 bit
+    // little endian offset in samples, the number of MIDI bytes N and N
+    // MIDI bytes. The bytes take effect at the offset from the time the
+    // frame was parsed plus one sample buffer, which gives a constant
+    // latency. Offsets above LINK_TIMED_MIDI_MAX_OFFSET are clamped, so
+    // that queued events are never held for long.
+    LINK_OPCODE_TIMED_MIDI = 0x02,
+
+    // The payload is one byte, the number of the song to start playing.
+    LINK_OPCODE_SONG_PLAY = 0x03,
+
+    // Stops the playing song. No payload.
+    LINK_OPCODE_SONG_STOP = 0x04,
+
+    // The payload is one byte, the new tempo in beats per minute.
+    LINK_OPCODE_SONG_TEMPO = 0x05
+} link_opcode_t;
+
+typedef struct link_stats_t
+{
+    uint32_t bytes;             // Received bytes
+    uint32_t frames;            // Received frames with a valid CRC
+    uint16_t crc_errors;        // Frames with an invalid CRC
+    uint16_t length_errors;     // Frames with an invalid length
+    uint16_t unknown_opcodes;   // Frames with an unknown opcode
+    uint16_t overruns;          // Times unparsed bytes were overwritten
+    uint16_t clamped_offsets;   // Timed MIDI offsets which were clamped
+} link_stats_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// The size of the receive ring buffer in bytes, must be a power of two.
+#define LINK_RX_BUFF_SIZE       (512u)
+
+// The largest offset of a timed MIDI entry in samples, 0.1 s at 48 kHz.
+#define LINK_TIMED_MIDI_MAX_OFFSET  (4800u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Initializes the link, SPI3 and the link DMA channel.
+ * @param void
+ * @return void
+ */
+void link_init(void);
+
+/**
+ * @brief Parses received bytes and executes the received frames.
+ * @details At most max_bytes bytes are parsed per call, so that the caller
+ *          keeps control over the time spent.
+ * @param max_bytes - The maximum number of bytes to parse.
+ * @return void
+ */
+void link_process(uint16_t max_bytes);
+
+/**
+ * @brief Checks if there are received bytes which have not been parsed.
+ * @param void
+ * @return True if link_process has bytes to parse.
+ */
+bool link_has_received_bytes(void);
+
+/**
+ * @brief Gets the link statistics.
+ * @param dst - Pointer to where the statistics will be copied.
+ * @return void
+ */
+void link_get_stats(link_stats_t* dst);
+
+#ifdef LINK_LOOPBACK
+/**
+ * @brief Writes bytes into the receive buffer as if they were received.
+ * @param data - The bytes to write.
+ * @param length - The number of bytes.
+ * @return void
+ */
+void link_loopback_write(const uint8_t* data, uint16_t length);
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LINK_H */
+
@@ -0,0 +1,213 @@
+/*
+ * This file implements the deferred binary log.
+ *
+ * The ring buffer has one slot per record. A writer reserves a slot with the
+ * interrupts disabled for a few instructions, fills it and then marks it as
+ * complete. log_process, which is the only reader, stops at the first slot
+ * which is not complete, so a record which is interrupted while it is written
+ * is sent when the writer has completed it.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <xc.h>
+
+#include "log.h"
+#include "frame.h"
+#include "control.h"
+#include "uart.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+typedef struct log_record_t
+{
+    uint8_t id;
+    volatile bool complete;
+    uint16_t args[3];
+} log_record_t;
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+#if (LOG_BUFF_SIZE & (LOG_BUFF_SIZE - 1)) != 0
+#error LOG_BUFF_SIZE must be a power of two
+#endif
+
+#define LOG_BUFF_MASK           (LOG_BUFF_SIZE - 1)
+
+// The id and the arguments, little endian.
+#define RECORD_SIZE             (7u)
+
+#define RECORDS_PER_FRAME       (FRAME_MAX_PAYLOAD / RECORD_SIZE)
+
+// The size of a frame with one record, the least which is worth sending.
+#define MIN_FRAME_SIZE          (RECORD_SIZE + FRAME_OVERHEAD)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static log_record_t records[LOG_BUFF_SIZE];
+static volatile uint16_t write_index = 0;   // The next slot to reserve
+static uint16_t read_index = 0;             // Written by log_process only
+static volatile uint16_t dropped = 0;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Copies a record to a frame payload.
+ * @param dst - Where to write the record.
+ * @param record - The record to copy.
+ * @return The address after the record.
+ */
+static uint8_t* put_record(uint8_t* dst, const log_record_t* record);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void log_init(void)
+{
+    uint16_t i;
+
+    for (i = 0; i != LOG_BUFF_SIZE; ++i)
+    {
+        records[i].complete = false;
+    }
+
+    write_index = 0;
+    read_index = 0;
+    dropped = 0;
+}
+
+void log_write(log_id_t id, uint16_t arg0, uint16_t arg1, uint16_t arg2)
+{
+    log_record_t* record;
+    uint16_t index;
+
+    __builtin_disi(0x3FFF);
+
+    index = write_index;
+
+    if ((uint16_t)(index - read_index) >= LOG_BUFF_SIZE)
+    {
+        ++dropped;
+        __builtin_disi(0x0000);
+
+        return;
+    }
+
+    write_index = index + 1;
+
+    __builtin_disi(0x0000);
+
+    record = &records[index & LOG_BUFF_MASK];
+    record->id = id;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+    record->args[2] = arg2;
+    record->complete = true;
+}
+
+void log_process(void)
+{
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint8_t buff[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+    uint8_t* p = payload;
+    uint8_t nbr_of_records = 0;
+    log_record_t* record;
+    log_record_t dropped_record;
+    uint16_t size;
+    uint16_t tx_free;
+    uint16_t max_records;
+
+    //
+    // Only the records which fit in the transmit buffer are taken, the
+    // others stay queued until there is room for them.
+    //
+    tx_free = uart_get_tx_free();
+
+    if (tx_free < MIN_FRAME_SIZE)
+    {
+        return;
+    }
+
+    max_records = (tx_free - FRAME_OVERHEAD) / RECORD_SIZE;
+
+    if (max_records > RECORDS_PER_FRAME)
+    {
+        max_records = RECORDS_PER_FRAME;
+    }
+
+    if (0 != dropped)
+    {
+        __builtin_disi(0x3FFF);
+        dropped_record.args[0] = dropped;
+        dropped = 0;
+        __builtin_disi(0x0000);
+
+        dropped_record.id = LOG_DROPPED;
+        dropped_record.args[1] = 0;
+        dropped_record.args[2] = 0;
+        p = put_record(p, &dropped_record);
+        ++nbr_of_records;
+    }
+
+    while (nbr_of_records != max_records)
+    {
+        record = &records[read_index & LOG_BUFF_MASK];
+
+        if ((read_index == write_index) || !record->complete)
+        {
+            break;
+        }
+
+        p = put_record(p, record);
+        ++nbr_of_records;
+
+        record->complete = false;
+        ++read_index;
+    }
+
+    if (0 != nbr_of_records)
+    {
+        size = frame_encode(CONTROL_OPCODE_LOG | CONTROL_REPLY_FLAG,
+                            payload, p - payload, buff);
+        uart_write_array(size, buff);
+    }
+}
+
+bool log_has_records(void)
+{
+    return ((read_index != write_index) || (0 != dropped)) &&
+           (uart_get_tx_free() >= MIN_FRAME_SIZE);
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static uint8_t* put_record(uint8_t* dst, const log_record_t* record)
+{
+    uint8_t i;
+
+    *dst++ = record->id;
+
+    for (i = 0; i != 3; ++i)
+    {
+        dst = frame_put_u16(dst, record->args[i]);
+    }
+
+    return dst;
+}
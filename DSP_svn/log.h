@@ -0,0 +1,144 @@
+/*
+ * File:   log.h
+ * Author: Erik
+ *
+ * Deferred binary logging.
+ *
+ * A log record is the id of a format string and up to three 16 bit
+ * arguments. Writing a record only copies these to a ring buffer, so it may
+ * be done from any context, including interrupts. The records are sent on
+ * the UART by log_process in the main loop, packed in frames (see frame.h)
+ * with the opcode CONTROL_OPCODE_LOG | CONTROL_REPLY_FLAG.
+ *
+ * The format strings are never stored on the device. They are the comments
+ * of log_id_t below which start with , and are read by log_decode.py to
+ * print the records as text. The formats may contain %u, %d and %x, one
+ * per argument.
+ */
+
+#ifndef LOG_H
+#define	LOG_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+/*
+ * Log record ids. Add new ids at the end, log_decode.py numbers the ids in
+ * the order they are listed.
+ */
+typedef enum log_id_t
+{
+    /* [LOG] %u records were dropped */
+    LOG_DROPPED = 0,
+
+    /* [WARNING] Invalid sample buffer depth: %u */
+    LOG_AUDIO_INVALID_BUFF_DEPTH,
+
+    /* [WARNING] Sample rate %u Hz is not supported */
+    LOG_AUDIO_INVALID_SAMPLE_RATE,
+
+    /* [WARNING] Channel %u does not exist. (Note on: note: %u, vel: %u) */
+    LOG_AUDIO_NOTE_ON_INVALID_CH,
+
+    /* [WARNING] Channel %u does not exist. (Note off) */
+    LOG_AUDIO_NOTE_OFF_INVALID_CH,
+
+    /* [WARNING] Channel %u does not exist. (Set duty) */
+    LOG_AUDIO_SET_DUTY_INVALID_CH,
+
+    /* [WARNING] Vibrato not supported on channel %u. (speed: %u amount: %u) */
+    LOG_AUDIO_VIBRATO_CONFIG_NOT_SUPPORTED,
+
+    /* [WARNING] Vibrato not supported on channel %u. (vibrato off) */
+    LOG_AUDIO_VIBRATO_OFF_NOT_SUPPORTED,
+
+    /* [WARNING] Vibrato not supported on channel %u. (vibrato on) */
+    LOG_AUDIO_VIBRATO_ON_NOT_SUPPORTED,
+
+    /* [WARNING] Cannot configure adsr envelope on ch %u (not supported) */
+    LOG_AUDIO_ADSR_CONFIG_NOT_SUPPORTED,
+
+    /* [WARNING] Cannot activate adsr envelope on ch %u (not supported) */
+    LOG_AUDIO_ADSR_ON_NOT_SUPPORTED,
+
+    /* [WARNING] Cannot deactivate adsr envelope on ch %u (not supported) */
+    LOG_AUDIO_ADSR_OFF_NOT_SUPPORTED,
+
+    /* [WARNING] Invalid adsr envelope state on ch %u: %u */
+    LOG_AUDIO_INVALID_ADSR_STATE,
+
+    /* [GOVERNOR] Level %u -> %u (low water: %u) */
+    LOG_GOVERNOR_LEVEL_CHANGE,
+
+    LOG_NBR_OF_IDS
+} log_id_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// The number of records which can wait to be sent, must be a power of two.
+#define LOG_BUFF_SIZE           (32u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Initializes the log.
+ * @param void
+ * @return void
+ */
+void log_init(void);
+
+/**
+ * @brief Writes a log record.
+ * @details Safe to call from any context. If the buffer is full the record
+ *          is dropped and counted. Arguments which are not used by the
+ *          format of the id are ignored.
+ * @param id - The id of the format string.
+ * @param arg0 - The first argument.
+ * @param arg1 - The second argument.
+ * @param arg2 - The third argument.
+ * @return void
+ */
+void log_write(log_id_t id, uint16_t arg0, uint16_t arg1, uint16_t arg2);
+
+/**
+ * @brief Sends the written log records on the UART.
+ * @details At most one frame is sent per call, with the records which fit
+ *          in the free space of the UART transmit buffer. The other records
+ *          stay queued. Should only be called from the main loop.
+ * @param void
+ * @return void
+ */
+void log_process(void);
+
+/**
+ * @brief Checks if there are log records, or dropped records, to send.
+ * @param void
+ * @return True if log_process has records to send and the UART has room
+ *         for at least one record.
+ */
+bool log_has_records(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LOG_H */
@@ -0,0 +1,170 @@
+# This script decodes the binary log records in the UART output of the dsp
+# (see log.h) into text.
+#
+# The UART output is read from a file, or from stdin if no file is given,
+# e.g. a capture of the serial port. Terminal text is written unchanged to
+# stdout, and every log record is written as one line of text. Other frames,
+# like the replies of the control protocol, are skipped.
+#
+# The format strings are read from log.h, so the script should be run with
+# the log.h of the firmware which produced the output.
+#
+# Usage:
+#   log_decode.py [-l log.h] [capture file]
+
+import argparse
+import os
+import re
+import sys
+
+# Must be the same as in frame.h and control.h
+FRAME_SYNC = 0xA5
+CONTROL_OPCODE_LOG = 0x07
+CONTROL_REPLY_FLAG = 0x80
+
+# Must be the same as in log.c
+RECORD_SIZE = 7
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+class Log_format_parser:
+    formats = []
+
+    # @brief Reads the format strings of the log ids.
+    # @param filename - The log.h to read.
+    # @details A format is a comment starting with /*§, and belongs to the
+    #          next LOG_ id. The ids are numbered in the order they are listed.
+    def parse(self, filename):
+        with open(filename, encoding = "latin-1") as f:
+            lines = f.readlines()
+
+        self.formats = []
+        fmt = None
+        for line in lines:
+            match = re.match(r"\s*/\*§\s*(.*?)\s*\*/", line)
+            if match:
+                fmt = match.group(1)
+            elif fmt is not None and re.match(r"\s*LOG_\w+", line):
+                self.formats.append(fmt)
+                fmt = None
+
+        return self.formats
+
+class Frame_reader:
+    crc_table = []
+    pending = b""
+
+    def __init__(self):
+        self.pending = b""
+        self.crc_table = []
+        for i in range(256):
+            crc = i
+            for bit in range(8):
+                crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+            self.crc_table.append(crc)
+
+    def crc8(self, data):
+        crc = 0
+        for byte in data:
+            crc = self.crc_table[crc ^ byte]
+        return crc
+
+    # @brief Splits received bytes into text and frames.
+    # @param data - The received bytes. A frame which is not complete is kept
+    #               until the next call.
+    # @return A list of (None, text) for text and (opcode, payload) for
+    #         frames, in the order they were received.
+    def feed(self, data):
+        data = self.pending + data
+        items = []
+        text = bytearray()
+        i = 0
+        while i < len(data):
+            if data[i] != FRAME_SYNC:
+                text.append(data[i])
+                i += 1
+                continue
+
+            if i + 3 >= len(data) or i + 4 + data[i + 1] > len(data):
+                break
+
+            length = data[i + 1]
+            if self.crc8(data[i + 1:i + 3 + length]) != data[i + 3 + length]:
+                # Not a frame, search for the next sync byte
+                i += 1
+                continue
+
+            if text:
+                items.append((None, bytes(text)))
+                text = bytearray()
+            items.append((data[i + 2], data[i + 3:i + 3 + length]))
+            i += 4 + length
+
+        if text:
+            items.append((None, bytes(text)))
+        self.pending = data[i:]
+        return items
+
+class Log_decoder:
+    formats = []
+    reader = None
+
+    def __init__(self, formats):
+        self.formats = formats
+        self.reader = Frame_reader()
+
+    # @brief Formats one record.
+    # @param record - The id and the little endian arguments.
+    # @return The record as text.
+    def format_record(self, record):
+        log_id = record[0]
+        args = [record[1 + 2 * i] | (record[2 + 2 * i] << 8) for i in range(3)]
+
+        if log_id >= len(self.formats):
+            return "[LOG] Unknown id %u, args: %u %u %u" % (log_id, args[0], args[1], args[2])
+
+        text = ""
+        fmt = self.formats[log_id]
+        arg_index = 0
+        for part in re.split(r"(%[udx])", fmt):
+            if re.match(r"%[udx]$", part) and arg_index < len(args):
+                value = args[arg_index]
+                arg_index += 1
+                if part == "%d" and value >= 0x8000:
+                    value -= 0x10000
+                text += ("%x" if part == "%x" else "%d") % value
+            else:
+                text += part
+        return text
+
+    # @brief Decodes a capture of the UART output.
+    # @param data - The received bytes.
+    # @param out - Where the text is written.
+    def decode(self, data, out):
+        for opcode, payload in self.reader.feed(data):
+            if opcode is None:
+                out.write(payload.decode("latin-1"))
+            elif opcode == CONTROL_OPCODE_LOG | CONTROL_REPLY_FLAG:
+                for r in range(0, len(payload) - RECORD_SIZE + 1, RECORD_SIZE):
+                    out.write(self.format_record(payload[r:r + RECORD_SIZE]) + "\r\n")
+
+
+# ===============================================================================
+# Module test
+# ===============================================================================
+
+if __name__ == "__main__":
+    arg_parser = argparse.ArgumentParser(description = "Decodes the binary log of the dsp")
+    arg_parser.add_argument("capture", nargs = "?", help = "UART output, stdin if omitted")
+    arg_parser.add_argument("-l", "--log-header", default = os.path.join(SCRIPT_DIR, "log.h"))
+    args = arg_parser.parse_args()
+
+    formats = Log_format_parser().parse(args.log_header)
+
+    if args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    Log_decoder(formats).decode(data, sys.stdout)
@@ -18,6 +18,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "pinmap.h"
 #include "init.h"
@@ -26,7 +27,17 @@
 #include "terminal.h"
 #include "dma.h"
 #include "audio.h"
+#include "governor.h"
 #include "timer.h"
+#include "link.h"
+#include "cc_router.h"
+#include "patch.h"
+#include "sequencer.h"
+#include "control.h"
+#include "log.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "sched.h"
 
 // =============================================================================
 // Private type definitions
@@ -40,6 +51,13 @@
 // Private constants
 // =============================================================================
 
+// The maximum number of link bytes parsed per main loop iteration.
+#define LINK_BYTES_PER_ITERATION    (32u)
+
+// The maximum number of control protocol bytes parsed per main loop
+// iteration.
+#define CONTROL_BYTES_PER_ITERATION (32u)
+
 // =============================================================================
 // Private variables
 // =============================================================================
@@ -48,6 +66,114 @@
 // Private function declarations
 // =============================================================================
 
+/**
+ * @brief Calculates a block of samples and executes the events in the event
+ *        queue at the samples they are scheduled for.
+ * @details The block is split at each event, so that the samples before the
+ *          event are calculated with the old settings and the samples after
+ *          it with the new.
+ * @param void
+ * @return void
+ */
+static void render_samples(void);
+
+/**
+ * @brief Checks if a render burst is ongoing, or should be started, see
+ *        sched_render_is_ready.
+ * @param void
+ * @return True if samples should be rendered.
+ */
+static bool render_is_ready(void);
+
+/**
+ * @brief Checks if the sample buffer is close to running empty.
+ * @param void
+ * @return True if the rendering is late.
+ */
+static bool render_is_late(void);
+
+/**
+ * @brief Runs the modulation tick of the sequencer, the patches, the CC
+ *        router and the audio engine.
+ * @param void
+ * @return void
+ */
+static void run_modulation(void);
+
+/**
+ * @brief Checks if a modulation tick has occurred.
+ * @param void
+ * @return True if the modulation should run.
+ */
+static bool modulation_is_ready(void);
+
+/**
+ * @brief Runs the terminal.
+ * @param void
+ * @return void
+ */
+static void run_terminal(void);
+
+/**
+ * @brief Checks if characters have been received or a terminal command
+ *        can continue.
+ * @param void
+ * @return True if the terminal should run.
+ */
+static bool terminal_is_ready(void);
+
+/**
+ * @brief Parses the PIC32 link and the control protocol, and sends the log.
+ * @param void
+ * @return void
+ */
+static void run_control(void);
+
+/**
+ * @brief Checks if link or control protocol bytes have been received, or
+ *        if there are log records to send.
+ * @param void
+ * @return True if the control task should run.
+ */
+static bool control_is_ready(void);
+
+/**
+ * @brief Puts the CPU in Idle until the next interrupt.
+ * @details The DMA, the timer and the UARTs keep running in Idle. An event
+ *          which is set by an interrupt after the tasks were checked is
+ *          seen after the next interrupt, which is at most one sample
+ *          period later since the DMA interrupt occurs for every sample.
+ *          The same holds for link bytes, which are received by the DMA
+ *          without an interrupt.
+ * @param void
+ * @return void
+ */
+static void idle(void);
+
+// The tasks of the main loop in priority order.
+static const sched_task_t TASKS[] =
+{
+    {
+        "render", render_is_ready, render_samples, render_is_late,
+        TELEMETRY_STAGE_RENDER, TRACE_RENDER
+    },
+    {
+        "modulation", modulation_is_ready, run_modulation,
+        sched_modulation_is_late,
+        TELEMETRY_STAGE_MODULATION, TRACE_MODULATION
+    },
+    {
+        "terminal", terminal_is_ready, run_terminal, NULL,
+        TELEMETRY_STAGE_CONTROL, TRACE_TERMINAL
+    },
+    {
+        "control", control_is_ready, run_control, NULL,
+        TELEMETRY_STAGE_CONTROL, TRACE_CONTROL
+    }
+};
+
+#define NBR_OF_TASKS (sizeof(TASKS) / sizeof(TASKS[0]))
+
 // =============================================================================
 // Public function definitions
 // =============================================================================
@@ -56,31 +182,17 @@ int main(void)
 {
     init_system();
 
+    sched_init(TASKS, NBR_OF_TASKS, idle);
+
     while (1)
     {
         // Clear the WatchDog Timer
         ClrWdt();
 
-        if (false == audio_is_sample_buff_full())
-        {
-            audio_calc_sample();
-        }
-
-        if (g_timer_modulation_event)
-        {
-            g_timer_modulation_event = false;
-
-            audio_apply_modulation();
-        }
-        else if (g_uart_receive_event)
-        {
-            g_uart_receive_event = false;
-
-            terminal_check_access();
-        }
+        sched_run();
 
 #ifdef DEBUG
-        if (audio_get_sample_buff_size() < SAMPLE_BUFF_HALF_SIZE)
+        if (render_is_late())
         {
             RED_LED_ON;
         }
@@ -98,3 +210,86 @@ int main(void)
 // Private function definitions
 // =============================================================================
 
+static void render_samples(void)
+{
+    uint16_t samples;
+    uint16_t block;
+
+    samples = sched_render_block(audio_get_sample_buff_size(&g_audio_engine),
+                                 audio_get_sample_buff_depth(&g_audio_engine));
+
+    while (0 != samples)
+    {
+        event_queue_dispatch(audio_get_sample_index(&g_audio_engine));
+
+        block = event_queue_samples_until_next(
+                    audio_get_sample_index(&g_audio_engine),
+                    samples);
+        samples -= block;
+
+        audio_calc_samples(&g_audio_engine, block);
+    }
+}
+
+static bool render_is_ready(void)
+{
+    return sched_render_is_ready(
+        audio_get_sample_buff_size(&g_audio_engine),
+        audio_get_sample_buff_depth(&g_audio_engine));
+}
+
+static bool render_is_late(void)
+{
+    return sched_render_is_late(
+        audio_get_sample_buff_size(&g_audio_engine),
+        audio_get_sample_buff_depth(&g_audio_engine));
+}
+
+static void run_modulation(void)
+{
+    g_timer_modulation_event = false;
+
+    sequencer_tick();
+    patch_apply();
+    cc_router_apply();
+    audio_apply_modulation(&g_audio_engine);
+    telemetry_update();
+    audio_update_stats(&g_audio_engine);
+    governor_update();
+}
+
+static bool modulation_is_ready(void)
+{
+    return g_timer_modulation_event;
+}
+
+static void run_terminal(void)
+{
+    g_uart_receive_event = false;
+
+    terminal_process();
+}
+
+static bool terminal_is_ready(void)
+{
+    return g_uart_receive_event || terminal_is_busy();
+}
+
+static void run_control(void)
+{
+    link_process(LINK_BYTES_PER_ITERATION);
+    control_process(CONTROL_BYTES_PER_ITERATION);
+    log_process();
+}
+
+static bool control_is_ready(void)
+{
+    return link_has_received_bytes() ||
+           uart_has_frame_bytes() ||
+           log_has_records();
+}
+
+static void idle(void)
+{
+    Idle();
+}
@@ -4,8 +4,11 @@
 // =============================================================================
 #include <math.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "midi.h"
+#include "audio.h"
+#include "event_queue.h"
 
 // =============================================================================
 // Private type definitions
@@ -20,6 +23,9 @@ double g_midi_frequencies[MIDI_FREQUENCIES_SIZE];
 // Private constants
 // =============================================================================
 
+// Marks that no note is playing on a channel.
+#define NO_NOTE (0xFF)
+
 // =============================================================================
 // Private variables
 // =============================================================================
@@ -28,6 +34,83 @@ double g_midi_frequencies[MIDI_FREQUENCIES_SIZE];
 // Private function declarations
 // =============================================================================
 
+/**
+ * @brief Gets the number of data bytes of a message.
+ * @param status - The status byte of the message. Must not be a real-time
+ *        status.
+ * @return The number of data bytes following the status byte.
+ */
+static uint8_t message_length(uint8_t status);
+
+/**
+ * @brief Dispatches a complete channel message to the audio engine.
+ * @param parser - The parser which received the message.
+ * @param status - The status byte, including the channel.
+ * @param data1 - The first data byte.
+ * @param data2 - The second data byte, not used by one byte messages.
+ * @return void
+ */
+static void dispatch_channel_message(midi_parser_t* parser,
+                                     uint8_t status,
+                                     uint8_t data1,
+                                     uint8_t data2);
+
+/**
+ * @brief Dispatches a real-time message.
+ * @param parser - The parser which received the message.
+ * @param status - The real-time status byte.
+ * @return void
+ */
+static void dispatch_realtime_message(midi_parser_t* parser, uint8_t status);
+
+/**
+ * @brief Handles a control change message.
+ * @param parser - The parser which received the message.
+ * @param channel - The audio channel.
+ * @param control - The control number.
+ * @param value - The control value.
+ * @return void
+ */
+static void handle_control_change(midi_parser_t* parser,
+                                  audio_ch_nbr_t channel,
+                                  uint8_t control,
+                                  uint8_t value);
+
+/**
+ * @brief Turns a note off, if it is the note currently playing.
+ * @param parser - The parser which received the message.
+ * @param channel - The audio channel.
+ * @param note - The note to turn off.
+ * @return void
+ */
+static void note_off(midi_parser_t* parser,
+                     audio_ch_nbr_t channel,
+                     uint8_t note);
+
+/**
+ * @brief Turns the note off on a channel, whatever note is playing.
+ * @param parser - The parser which received the message.
+ * @param channel - The audio channel.
+ * @return void
+ */
+static void channel_off(midi_parser_t* parser, audio_ch_nbr_t channel);
+
+/**
+ * @brief Pushes an event to the event queue, scheduled at the sample index
+ *        of the parser which created it.
+ * @param parser - The parser which received the message.
+ * @param type - The event type.
+ * @param channel - The audio channel.
+ * @param data1 - The first event data byte.
+ * @param data2 - The second event data byte.
+ * @return void
+ */
+static void push_event(const midi_parser_t* parser,
+                       event_type_t type,
+                       audio_ch_nbr_t channel,
+                       uint8_t data1,
+                       uint8_t data2);
+
 // =============================================================================
 // Public function definitions
 // =============================================================================
@@ -44,8 +127,255 @@ void midi_freq_table_init(void)
     }
 }
 
+void midi_parser_init(midi_parser_t* parser)
+{
+    uint8_t i;
+
+    parser->status = 0;
+    parser->data[0] = 0;
+    parser->data[1] = 0;
+    parser->data_count = 0;
+    parser->data_length = 0;
+    parser->in_sysex = false;
+    parser->sample_index = 0;
+
+    for (i = 0; i != MIDI_NBR_OF_CHANNELS; ++i)
+    {
+        parser->active_notes[i] = NO_NOTE;
+    }
+}
+
+void midi_parse_byte(midi_parser_t* parser, uint8_t byte)
+{
+    if (byte >= MIDI_STATUS_TIMING_CLOCK)
+    {
+        //
+        // Real-time messages are single bytes which may appear anywhere,
+        // they do not affect the state of the parser.
+        //
+        dispatch_realtime_message(parser, byte);
+    }
+    else if (byte & 0x80)
+    {
+        //
+        // Status byte. Any status byte ends a system exclusive message.
+        //
+        parser->in_sysex = (MIDI_STATUS_SYSEX_START == byte);
+        parser->data_count = 0;
+        parser->data_length = message_length(byte);
+
+        if ((byte < MIDI_STATUS_SYSEX_START) || (0 != parser->data_length))
+        {
+            parser->status = byte;
+        }
+        else
+        {
+            // System messages without data cancel the running status
+            parser->status = 0;
+        }
+    }
+    else if ((false == parser->in_sysex) && (0 != parser->status))
+    {
+        //
+        // Data byte
+        //
+        parser->data[parser->data_count++] = byte;
+
+        if (parser->data_count == parser->data_length)
+        {
+            parser->data_count = 0;
+
+            if (parser->status < MIDI_STATUS_SYSEX_START)
+            {
+                dispatch_channel_message(parser,
+                                         parser->status,
+                                         parser->data[0],
+                                         parser->data[1]);
+            }
+            else
+            {
+                // System common messages do not use running status
+                parser->status = 0;
+            }
+        }
+    }
+    else
+    {
+        // System exclusive data or a data byte without a status
+    }
+}
+
 // =============================================================================
 // Private function definitions
 // =============================================================================
 
+static uint8_t message_length(uint8_t status)
+{
+    uint8_t length;
+
+    switch (status & 0xF0)
+    {
+    case MIDI_STATUS_PROGRAM_CHANGE:
+    case MIDI_STATUS_CHANNEL_PRESSURE:
+        length = 1;
+        break;
+
+    case MIDI_STATUS_NOTE_OFF:
+    case MIDI_STATUS_NOTE_ON:
+    case MIDI_STATUS_POLY_PRESSURE:
+    case MIDI_STATUS_CONTROL_CHANGE:
+    case MIDI_STATUS_PITCH_BEND:
+        length = 2;
+        break;
+
+    default:
+        //
+        // System common messages
+        //
+        switch (status)
+        {
+        case MIDI_STATUS_TIME_CODE:
+        case MIDI_STATUS_SONG_SELECT:
+            length = 1;
+            break;
+
+        case MIDI_STATUS_SONG_POSITION:
+            length = 2;
+            break;
+
+        default:
+            length = 0;
+            break;
+        }
+        break;
+    }
+
+    return length;
+}
+
+static void dispatch_channel_message(midi_parser_t* parser,
+                                     uint8_t status,
+                                     uint8_t data1,
+                                     uint8_t data2)
+{
+    audio_ch_nbr_t channel = (audio_ch_nbr_t)(status & 0x0F);
+
+    if (channel >= AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        return;
+    }
+
+    switch (status & 0xF0)
+    {
+    case MIDI_STATUS_NOTE_ON:
+        if (0 != data2)
+        {
+            push_event(parser, EVENT_NOTE_ON, channel, data1, data2);
+            parser->active_notes[channel] = data1;
+        }
+        else
+        {
+            // A note on with zero velocity is a note off
+            note_off(parser, channel, data1);
+        }
+        break;
+
+    case MIDI_STATUS_NOTE_OFF:
+        note_off(parser, channel, data1);
+        break;
+
+    case MIDI_STATUS_CONTROL_CHANGE:
+        handle_control_change(parser, channel, data1, data2);
+        break;
+
+    case MIDI_STATUS_PITCH_BEND:
+        push_event(parser, EVENT_PITCH_BEND, channel, data1, data2);
+        break;
+
+    case MIDI_STATUS_PROGRAM_CHANGE:
+        push_event(parser, EVENT_PROGRAM_CHANGE, channel, data1, 0);
+        break;
+
+    default:
+        // Not supported by the audio engine
+        break;
+    }
+}
+
+static void dispatch_realtime_message(midi_parser_t* parser, uint8_t status)
+{
+    uint8_t i;
+
+    switch (status)
+    {
+    case MIDI_STATUS_RESET:
+        for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+        {
+            channel_off(parser, (audio_ch_nbr_t)i);
+        }
+        break;
+
+    default:
+        // Timing clock, start, stop etc. are not used
+        break;
+    }
+}
+
+static void handle_control_change(midi_parser_t* parser,
+                                  audio_ch_nbr_t channel,
+                                  uint8_t control,
+                                  uint8_t value)
+{
+    switch (control)
+    {
+    case MIDI_CC_ALL_SOUND_OFF:
+    case MIDI_CC_ALL_NOTES_OFF:
+        channel_off(parser, channel);
+        break;
+
+    case MIDI_CC_RESET_ALL_CONTROLLERS:
+        // Center the pitch bend, 8192 = (64 << 7) | 0
+        push_event(parser, EVENT_PITCH_BEND, channel, 0, 64);
+        break;
+
+    default:
+        // Mapped to a synthesis parameter by the CC router
+        push_event(parser, EVENT_CONTROL_CHANGE, channel, control, value);
+        break;
+    }
+}
+
+static void note_off(midi_parser_t* parser,
+                     audio_ch_nbr_t channel,
+                     uint8_t note)
+{
+    if (parser->active_notes[channel] == note)
+    {
+        channel_off(parser, channel);
+    }
+}
+
+static void channel_off(midi_parser_t* parser, audio_ch_nbr_t channel)
+{
+    push_event(parser, EVENT_NOTE_OFF, channel, 0, 0);
+    parser->active_notes[channel] = NO_NOTE;
+}
+
+static void push_event(const midi_parser_t* parser,
+                       event_type_t type,
+                       audio_ch_nbr_t channel,
+                       uint8_t data1,
+                       uint8_t data2)
+{
+    event_t event;
+
+    event.sample_index = parser->sample_index;
+    event.type = type;
+    event.channel = channel;
+    event.data1 = data1;
+    event.data2 = data2;
+
+    event_queue_push(&event);
+}
+
 
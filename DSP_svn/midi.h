@@ -15,10 +15,47 @@
 // =============================================================================
 // Include statements
 // =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
 
 // =============================================================================
 // Public type definitions
 // =============================================================================
+
+// The number of MIDI channels.
+#define MIDI_NBR_OF_CHANNELS    (16u)
+
+/*
+ * MIDI 1.0 byte stream parser.
+ *
+ * The parser is fed one byte at a time and keeps all its state in this
+ * struct, so it does not allocate any memory and several streams can be
+ * parsed independently.
+ *
+ * - Running status is supported for channel messages.
+ * - Real-time bytes (0xF8 - 0xFF) may be interleaved anywhere, also in the
+ *   middle of a message, without breaking it.
+ * - System exclusive messages are skipped.
+ * - Data bytes without a valid status are discarded.
+ *
+ * The parsed messages are pushed to the event queue, scheduled at
+ * sample_index. The owner of the parser sets sample_index before feeding
+ * the bytes of a message, see audio_get_sample_index.
+ *
+ * The note playing on each channel is tracked per parser, so that a note
+ * off only stops the note if it was started by the same stream.
+ */
+typedef struct midi_parser_t
+{
+    uint8_t status;         // Current (running) status, 0 if none
+    uint8_t data[2];        // Data bytes of the current message
+    uint8_t data_count;     // The number of data bytes received
+    uint8_t data_length;    // The number of data bytes the message has
+    bool    in_sysex;       // True while skipping a system exclusive message
+    uint32_t sample_index;  // The sample at which parsed messages take effect
+    uint8_t active_notes[MIDI_NBR_OF_CHANNELS]; // The playing note per channel
+} midi_parser_t;
+
 typedef enum midi_notes_t
 {
     MIDI_NOTE_CMINUS1, MIDI_NOTE_CMINUS1_SHARP,
@@ -113,6 +150,41 @@ typedef enum midi_notes_t
 // =============================================================================
 #define MIDI_FREQUENCIES_SIZE   (128)
 
+// Status bytes
+#define MIDI_STATUS_NOTE_OFF            (0x80)
+#define MIDI_STATUS_NOTE_ON             (0x90)
+#define MIDI_STATUS_POLY_PRESSURE       (0xA0)
+#define MIDI_STATUS_CONTROL_CHANGE      (0xB0)
+#define MIDI_STATUS_PROGRAM_CHANGE      (0xC0)
+#define MIDI_STATUS_CHANNEL_PRESSURE    (0xD0)
+#define MIDI_STATUS_PITCH_BEND          (0xE0)
+#define MIDI_STATUS_SYSEX_START         (0xF0)
+#define MIDI_STATUS_TIME_CODE           (0xF1)
+#define MIDI_STATUS_SONG_POSITION       (0xF2)
+#define MIDI_STATUS_SONG_SELECT         (0xF3)
+#define MIDI_STATUS_TUNE_REQUEST        (0xF6)
+#define MIDI_STATUS_SYSEX_END           (0xF7)
+#define MIDI_STATUS_TIMING_CLOCK        (0xF8)
+#define MIDI_STATUS_START               (0xFA)
+#define MIDI_STATUS_CONTINUE            (0xFB)
+#define MIDI_STATUS_STOP                (0xFC)
+#define MIDI_STATUS_ACTIVE_SENSING      (0xFE)
+#define MIDI_STATUS_RESET               (0xFF)
+
+// Control change numbers
+#define MIDI_CC_MODULATION              (1)
+#define MIDI_CC_CHANNEL_VOLUME          (7)
+#define MIDI_CC_SOUND_VARIATION         (70)
+#define MIDI_CC_RELEASE_TIME            (72)
+#define MIDI_CC_ATTACK_TIME             (73)
+#define MIDI_CC_DECAY_TIME              (75)
+#define MIDI_CC_VIBRATO_RATE            (76)
+#define MIDI_CC_VIBRATO_DEPTH           (77)
+#define MIDI_CC_SOUND_CONTROLLER_10     (79)
+#define MIDI_CC_ALL_SOUND_OFF           (120)
+#define MIDI_CC_RESET_ALL_CONTROLLERS   (121)
+#define MIDI_CC_ALL_NOTES_OFF           (123)
+
 // =============================================================================
 // Global variable declarations
 // =============================================================================
@@ -127,6 +199,26 @@ extern double g_midi_frequencies[MIDI_FREQUENCIES_SIZE];
  */
 void midi_freq_table_init(void);
 
+/**
+ * @brief Resets a MIDI parser.
+ * @param parser - The parser to reset.
+ * @return void
+ */
+void midi_parser_init(midi_parser_t* parser);
+
+/**
+ * @brief Feeds one byte to a MIDI parser.
+ * @details Complete messages are dispatched to the audio engine.
+ *          MIDI channel n is played on audio channel n, messages on channels
+ *          without an audio channel are ignored. The function does not
+ *          block. Must only be called from the main loop, since the
+ *          messages are pushed to the event queue.
+ * @param parser - The parser to feed.
+ * @param byte - The received byte.
+ * @return void
+ */
+void midi_parse_byte(midi_parser_t* parser, uint8_t byte);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -45,17 +45,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=main.c gpio.c configuration_bits.c source_template.c init.c uart.c event_queue.c spi.c pcm1774.c mcu.c terminal.c audio.c dma.c timer.c utilities.c midi.c fixed_point.c rng.c terminal_help.c
+SOURCEFILES_QUOTED_IF_SPACED=main.c gpio.c configuration_bits.c source_template.c init.c uart.c event_queue.c spi.c pcm1774.c mcu.c terminal.c audio.c dma.c timer.c utilities.c midi.c fixed_point.c rng.c period_tables.c governor.c frame.c link.c cc_router.c patch.c sequencer.c songs.c control.c log.c telemetry.c trace.c sched.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/main.o ${OBJECTDIR}/gpio.o ${OBJECTDIR}/configuration_bits.o ${OBJECTDIR}/source_template.o ${OBJECTDIR}/init.o ${OBJECTDIR}/uart.o ${OBJECTDIR}/event_queue.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/pcm1774.o ${OBJECTDIR}/mcu.o ${OBJECTDIR}/terminal.o ${OBJECTDIR}/audio.o ${OBJECTDIR}/dma.o ${OBJECTDIR}/timer.o ${OBJECTDIR}/utilities.o ${OBJECTDIR}/midi.o ${OBJECTDIR}/fixed_point.o ${OBJECTDIR}/rng.o ${OBJECTDIR}/terminal_help.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/main.o.d ${OBJECTDIR}/gpio.o.d ${OBJECTDIR}/configuration_bits.o.d ${OBJECTDIR}/source_template.o.d ${OBJECTDIR}/init.o.d ${OBJECTDIR}/uart.o.d ${OBJECTDIR}/event_queue.o.d ${OBJECTDIR}/spi.o.d ${OBJECTDIR}/pcm1774.o.d ${OBJECTDIR}/mcu.o.d ${OBJECTDIR}/terminal.o.d ${OBJECTDIR}/audio.o.d ${OBJECTDIR}/dma.o.d ${OBJECTDIR}/timer.o.d ${OBJECTDIR}/utilities.o.d ${OBJECTDIR}/midi.o.d ${OBJECTDIR}/fixed_point.o.d ${OBJECTDIR}/rng.o.d ${OBJECTDIR}/terminal_help.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/main.o ${OBJECTDIR}/gpio.o ${OBJECTDIR}/configuration_bits.o ${OBJECTDIR}/source_template.o ${OBJECTDIR}/init.o ${OBJECTDIR}/uart.o ${OBJECTDIR}/event_queue.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/pcm1774.o ${OBJECTDIR}/mcu.o ${OBJECTDIR}/terminal.o ${OBJECTDIR}/audio.o ${OBJECTDIR}/dma.o ${OBJECTDIR}/timer.o ${OBJECTDIR}/utilities.o ${OBJECTDIR}/midi.o ${OBJECTDIR}/fixed_point.o ${OBJECTDIR}/rng.o ${OBJECTDIR}/period_tables.o ${OBJECTDIR}/governor.o ${OBJECTDIR}/frame.o ${OBJECTDIR}/link.o ${OBJECTDIR}/cc_router.o ${OBJECTDIR}/patch.o ${OBJECTDIR}/sequencer.o ${OBJECTDIR}/songs.o ${OBJECTDIR}/control.o ${OBJECTDIR}/log.o ${OBJECTDIR}/telemetry.o ${OBJECTDIR}/trace.o ${OBJECTDIR}/sched.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/main.o.d ${OBJECTDIR}/gpio.o.d ${OBJECTDIR}/configuration_bits.o.d ${OBJECTDIR}/source_template.o.d ${OBJECTDIR}/init.o.d ${OBJECTDIR}/uart.o.d ${OBJECTDIR}/event_queue.o.d ${OBJECTDIR}/spi.o.d ${OBJECTDIR}/pcm1774.o.d ${OBJECTDIR}/mcu.o.d ${OBJECTDIR}/terminal.o.d ${OBJECTDIR}/audio.o.d ${OBJECTDIR}/dma.o.d ${OBJECTDIR}/timer.o.d ${OBJECTDIR}/utilities.o.d ${OBJECTDIR}/midi.o.d ${OBJECTDIR}/fixed_point.o.d ${OBJECTDIR}/rng.o.d ${OBJECTDIR}/period_tables.o.d ${OBJECTDIR}/governor.o.d ${OBJECTDIR}/frame.o.d ${OBJECTDIR}/link.o.d ${OBJECTDIR}/cc_router.o.d ${OBJECTDIR}/patch.o.d ${OBJECTDIR}/sequencer.o.d ${OBJECTDIR}/songs.o.d ${OBJECTDIR}/control.o.d ${OBJECTDIR}/log.o.d ${OBJECTDIR}/telemetry.o.d ${OBJECTDIR}/trace.o.d ${OBJECTDIR}/sched.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/main.o ${OBJECTDIR}/gpio.o ${OBJECTDIR}/configuration_bits.o ${OBJECTDIR}/source_template.o ${OBJECTDIR}/init.o ${OBJECTDIR}/uart.o ${OBJECTDIR}/event_queue.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/pcm1774.o ${OBJECTDIR}/mcu.o ${OBJECTDIR}/terminal.o ${OBJECTDIR}/audio.o ${OBJECTDIR}/dma.o ${OBJECTDIR}/timer.o ${OBJECTDIR}/utilities.o ${OBJECTDIR}/midi.o ${OBJECTDIR}/fixed_point.o ${OBJECTDIR}/rng.o ${OBJECTDIR}/terminal_help.o
+OBJECTFILES=${OBJECTDIR}/main.o ${OBJECTDIR}/gpio.o ${OBJECTDIR}/configuration_bits.o ${OBJECTDIR}/source_template.o ${OBJECTDIR}/init.o ${OBJECTDIR}/uart.o ${OBJECTDIR}/event_queue.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/pcm1774.o ${OBJECTDIR}/mcu.o ${OBJECTDIR}/terminal.o ${OBJECTDIR}/audio.o ${OBJECTDIR}/dma.o ${OBJECTDIR}/timer.o ${OBJECTDIR}/utilities.o ${OBJECTDIR}/midi.o ${OBJECTDIR}/fixed_point.o ${OBJECTDIR}/rng.o ${OBJECTDIR}/period_tables.o ${OBJECTDIR}/governor.o ${OBJECTDIR}/frame.o ${OBJECTDIR}/link.o ${OBJECTDIR}/cc_router.o ${OBJECTDIR}/patch.o ${OBJECTDIR}/sequencer.o ${OBJECTDIR}/songs.o ${OBJECTDIR}/control.o ${OBJECTDIR}/log.o ${OBJECTDIR}/telemetry.o ${OBJECTDIR}/trace.o ${OBJECTDIR}/sched.o
 
 # Source Files
-SOURCEFILES=main.c gpio.c configuration_bits.c source_template.c init.c uart.c event_queue.c spi.c pcm1774.c mcu.c terminal.c audio.c dma.c timer.c utilities.c midi.c fixed_point.c rng.c terminal_help.c
+SOURCEFILES=main.c gpio.c configuration_bits.c source_template.c init.c uart.c event_queue.c spi.c pcm1774.c mcu.c terminal.c audio.c dma.c timer.c utilities.c midi.c fixed_point.c rng.c period_tables.c governor.c frame.c link.c cc_router.c patch.c sequencer.c songs.c control.c log.c telemetry.c trace.c sched.c
 
 
 CFLAGS=
@@ -221,12 +221,68 @@ ${OBJECTDIR}/rng.o: rng.c  nbproject/Makefile-${CND_CONF}.mk
 	${MP_CC} $(MP_EXTRA_CC_PRE)  rng.c  -o ${OBJECTDIR}/rng.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/rng.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
 	@${FIXDEPS} "${OBJECTDIR}/rng.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
-${OBJECTDIR}/terminal_help.o: terminal_help.c  nbproject/Makefile-${CND_CONF}.mk
+${OBJECTDIR}/control.o: control.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}" 
-	@${RM} ${OBJECTDIR}/terminal_help.o.d 
-	@${RM} ${OBJECTDIR}/terminal_help.o 
-	${MP_CC} $(MP_EXTRA_CC_PRE)  terminal_help.c  -o ${OBJECTDIR}/terminal_help.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/terminal_help.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
-	@${FIXDEPS} "${OBJECTDIR}/terminal_help.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	@${RM} ${OBJECTDIR}/control.o.d 
+	@${RM} ${OBJECTDIR}/control.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  control.c  -o ${OBJECTDIR}/control.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/control.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/control.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/songs.o: songs.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/songs.o.d 
+	@${RM} ${OBJECTDIR}/songs.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  songs.c  -o ${OBJECTDIR}/songs.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/songs.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/songs.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/sequencer.o: sequencer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sequencer.o.d 
+	@${RM} ${OBJECTDIR}/sequencer.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  sequencer.c  -o ${OBJECTDIR}/sequencer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/sequencer.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/sequencer.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/patch.o: patch.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/patch.o.d 
+	@${RM} ${OBJECTDIR}/patch.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  patch.c  -o ${OBJECTDIR}/patch.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/patch.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/patch.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/cc_router.o: cc_router.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/cc_router.o.d 
+	@${RM} ${OBJECTDIR}/cc_router.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  cc_router.c  -o ${OBJECTDIR}/cc_router.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/cc_router.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/cc_router.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/link.o: link.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/link.o.d 
+	@${RM} ${OBJECTDIR}/link.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  link.c  -o ${OBJECTDIR}/link.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/link.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/link.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/frame.o: frame.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/frame.o.d 
+	@${RM} ${OBJECTDIR}/frame.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  frame.c  -o ${OBJECTDIR}/frame.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/frame.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/frame.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/governor.o: governor.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/governor.o.d 
+	@${RM} ${OBJECTDIR}/governor.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  governor.c  -o ${OBJECTDIR}/governor.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/governor.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/governor.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/period_tables.o: period_tables.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/period_tables.o.d 
+	@${RM} ${OBJECTDIR}/period_tables.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  period_tables.c  -o ${OBJECTDIR}/period_tables.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/period_tables.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_SIMULATOR=1  -mno-eds-warn  -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/period_tables.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
 else
 ${OBJECTDIR}/main.o: main.c  nbproject/Makefile-${CND_CONF}.mk
@@ -355,12 +411,68 @@ ${OBJECTDIR}/rng.o: rng.c  nbproject/Makefile-${CND_CONF}.mk
 	${MP_CC} $(MP_EXTRA_CC_PRE)  rng.c  -o ${OBJECTDIR}/rng.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/rng.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
 	@${FIXDEPS} "${OBJECTDIR}/rng.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
-${OBJECTDIR}/terminal_help.o: terminal_help.c  nbproject/Makefile-${CND_CONF}.mk
+${OBJECTDIR}/control.o: control.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/control.o.d 
+	@${RM} ${OBJECTDIR}/control.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  control.c  -o ${OBJECTDIR}/control.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/control.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/control.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/songs.o: songs.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/songs.o.d 
+	@${RM} ${OBJECTDIR}/songs.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  songs.c  -o ${OBJECTDIR}/songs.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/songs.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/songs.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/sequencer.o: sequencer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sequencer.o.d 
+	@${RM} ${OBJECTDIR}/sequencer.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  sequencer.c  -o ${OBJECTDIR}/sequencer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/sequencer.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/sequencer.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/patch.o: patch.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/patch.o.d 
+	@${RM} ${OBJECTDIR}/patch.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  patch.c  -o ${OBJECTDIR}/patch.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/patch.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/patch.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/cc_router.o: cc_router.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/cc_router.o.d 
+	@${RM} ${OBJECTDIR}/cc_router.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  cc_router.c  -o ${OBJECTDIR}/cc_router.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/cc_router.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/cc_router.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/link.o: link.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/link.o.d 
+	@${RM} ${OBJECTDIR}/link.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  link.c  -o ${OBJECTDIR}/link.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/link.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/link.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/frame.o: frame.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/frame.o.d 
+	@${RM} ${OBJECTDIR}/frame.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  frame.c  -o ${OBJECTDIR}/frame.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/frame.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/frame.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/governor.o: governor.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/governor.o.d 
+	@${RM} ${OBJECTDIR}/governor.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  governor.c  -o ${OBJECTDIR}/governor.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/governor.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/governor.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/period_tables.o: period_tables.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}" 
-	@${RM} ${OBJECTDIR}/terminal_help.o.d 
-	@${RM} ${OBJECTDIR}/terminal_help.o 
-	${MP_CC} $(MP_EXTRA_CC_PRE)  terminal_help.c  -o ${OBJECTDIR}/terminal_help.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/terminal_help.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
-	@${FIXDEPS} "${OBJECTDIR}/terminal_help.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	@${RM} ${OBJECTDIR}/period_tables.o.d 
+	@${RM} ${OBJECTDIR}/period_tables.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  period_tables.c  -o ${OBJECTDIR}/period_tables.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/period_tables.o.d"      -mno-eds-warn  -g -omf=elf -O0 -fomit-frame-pointer -DDEBUG -msmart-io=1 -Wall -msfr-warn=on
+	@${FIXDEPS} "${OBJECTDIR}/period_tables.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
 endif
 
@@ -0,0 +1,166 @@
+/*
+ * This file implements the patch bank.
+ *
+ * The first four patches are the settings the channels used to get from
+ * audio_init: two square leads with vibrato, a plain triangle bass and a
+ * short noise burst.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "patch.h"
+#include "audio.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// Marks that no program change is pending on a channel.
+#define NO_PROGRAM              (0xFF)
+
+static const patch_preset_t PATCH_BANK[PATCH_BANK_SIZE] =
+{
+    {
+        "square lead",
+        { 64,  AUDIO_PATCH_VIBRATO(115, 30),
+               AUDIO_PATCH_ADSR(false, 0, 10, 5, 50) }
+    },
+    {
+        "hollow lead",
+        { 127, AUDIO_PATCH_VIBRATO(115, 30),
+               AUDIO_PATCH_ADSR(false, 0, 10, 5, 50) }
+    },
+    {
+        "bass",
+        { 32,  AUDIO_PATCH_NO_VIBRATO,
+               AUDIO_PATCH_ADSR(false, 0, 0, 127, 0) }
+    },
+    {
+        "snare",
+        { 0,   AUDIO_PATCH_NO_VIBRATO,
+               AUDIO_PATCH_ADSR(true, 2, 6, 0, 0) }
+    },
+    {
+        "pluck",
+        { 64,  AUDIO_PATCH_NO_VIBRATO,
+               AUDIO_PATCH_ADSR(true, 0, 20, 0, 10) }
+    },
+    {
+        "organ",
+        { 128, AUDIO_PATCH_NO_VIBRATO,
+               AUDIO_PATCH_ADSR(true, 1, 0, 127, 5) }
+    },
+    {
+        "brass",
+        { 96,  AUDIO_PATCH_VIBRATO(100, 15),
+               AUDIO_PATCH_ADSR(true, 8, 20, 90, 15) }
+    },
+    {
+        "bell",
+        { 16,  AUDIO_PATCH_NO_VIBRATO,
+               AUDIO_PATCH_ADSR(true, 0, 80, 20, 60) }
+    }
+};
+
+// The patch each channel gets at start up.
+static const uint8_t DEFAULT_PROGRAMS[AUDIO_CH_NBR_OF_CHANNELS] =
+{
+    0,  // AUDIO_CH_SQUARE0
+    1,  // AUDIO_CH_SQUARE1
+    2,  // AUDIO_CH_TRIANGLE0
+    3   // AUDIO_CH_NOISE0
+};
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static uint8_t current_programs[AUDIO_CH_NBR_OF_CHANNELS];
+static uint8_t pending_programs[AUDIO_CH_NBR_OF_CHANNELS];
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void patch_init(void)
+{
+    uint8_t i;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        current_programs[i] = DEFAULT_PROGRAMS[i];
+        pending_programs[i] = NO_PROGRAM;
+
+        audio_set_patch(&g_audio_engine, (audio_ch_nbr_t)i,
+                        &PATCH_BANK[DEFAULT_PROGRAMS[i]].patch);
+    }
+}
+
+bool patch_program_change(uint8_t channel, uint8_t program)
+{
+    if ((channel >= AUDIO_CH_NBR_OF_CHANNELS) || (program >= PATCH_BANK_SIZE))
+    {
+        return false;
+    }
+
+    pending_programs[channel] = program;
+
+    return true;
+}
+
+void patch_apply(void)
+{
+    uint8_t i;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        if (NO_PROGRAM != pending_programs[i])
+        {
+            current_programs[i] = pending_programs[i];
+            pending_programs[i] = NO_PROGRAM;
+
+            audio_set_patch(&g_audio_engine, (audio_ch_nbr_t)i,
+                            &PATCH_BANK[current_programs[i]].patch);
+        }
+    }
+}
+
+uint8_t patch_get_program(uint8_t channel)
+{
+    if (channel >= AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        return 0;
+    }
+
+    return current_programs[channel];
+}
+
+const char* patch_get_name(uint8_t program)
+{
+    if (program >= PATCH_BANK_SIZE)
+    {
+        return NULL;
+    }
+
+    return PATCH_BANK[program].name;
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
@@ -0,0 +1,97 @@
+/*
+ * File:   patch.h
+ * Author: Erik
+ *
+ * Bank of preset patches (instruments) and program change handling.
+ *
+ * The bank is placed in flash. A program change only records the selected
+ * patch, the patch is loaded into the channel by patch_apply at the next
+ * modulation tick. All settings of the voice are changed at the same time.
+ */
+
+#ifndef PATCH_H
+#define	PATCH_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio.h"
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+typedef struct patch_preset_t
+{
+    const char*     name;
+    audio_patch_t   patch;
+} patch_preset_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// The number of patches in the bank.
+#define PATCH_BANK_SIZE         (8u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Loads the default patch of each channel.
+ * @details The patches are loaded at once, not at the next tick.
+ * @param void
+ * @return void
+ */
+void patch_init(void);
+
+/**
+ * @brief Selects the patch of one channel.
+ * @details The patch is loaded at the next call to patch_apply.
+ * @param channel - The audio channel.
+ * @param program - The patch number within [0, PATCH_BANK_SIZE).
+ * @return True if the patch was selected, false if the arguments are not
+ *         valid.
+ */
+bool patch_program_change(uint8_t channel, uint8_t program);
+
+/**
+ * @brief Loads the patches which have been selected since the last call.
+ * @details Should be called once every modulation tick.
+ * @param void
+ * @return void
+ */
+void patch_apply(void);
+
+/**
+ * @brief Gets the patch number which is selected for one channel.
+ * @param channel - The audio channel.
+ * @return The patch number.
+ */
+uint8_t patch_get_program(uint8_t channel);
+
+/**
+ * @brief Gets the name of a patch.
+ * @param program - The patch number.
+ * @return The name of the patch, or NULL if there is no such patch.
+ */
+const char* patch_get_name(uint8_t program);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* PATCH_H */
+
@@ -9,6 +9,7 @@
 // Include statements
 // =============================================================================
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "pcm1774.h"
 #include "pcm1774_defs.h"
@@ -32,6 +33,9 @@
 // Private variables
 // =============================================================================
 
+// The sampling rate selection (MSR) used when in master mode.
+static uint8_t master_sample_rate = 2;  // 48kHz
+
 // =============================================================================
 // Private function declarations
 // =============================================================================
@@ -101,9 +105,10 @@ void pcm1774_init(void)
     // Analog input (MUX3, MUX4) select. Analog input (MUX1, MUX2) select
     pcm1774_write_reg(PCM1774_REG_AIN_SEL, 0x11);
 
-    // 48kHz sampling rate
+    // Sampling rate (48kHz by default)
     pcm1774_write_reg(PCM1774_REG_BCK_CNFG_SAMP_CTRL_ZCROSS,
-                      (2 << PCM1774_BITS_MSR_POS) | PCM1774_BITS_ZCRS_MASK);
+                      (master_sample_rate << PCM1774_BITS_MSR_POS) |
+                      PCM1774_BITS_ZCRS_MASK);
     // I2S master mode
     pcm1774_write_reg(PCM1774_REG_MSTR_MODE,
                       PCM1774_BITS_MSTR_MASK | PCM1774_BITS_BIT0_MASK);
@@ -140,6 +145,55 @@ void pcm1774_set_volume(uint8_t volume)
     pcm1774_write_reg(PCM1774_REG_HPA_VOL_RCH, volume & 0x3F);
 }
 
+/**
+ * From the PCM1774 datasheet
+ * Register 86, MSR[2:0] - Sampling rate selection in master mode.
+ */
+bool pcm1774_set_sample_freq(uint16_t sample_freq_hz)
+{
+    bool supported = true;
+
+    switch (sample_freq_hz)
+    {
+    case 16000:
+        master_sample_rate = 0;
+        break;
+
+    case 32000:
+        master_sample_rate = 1;
+        break;
+
+    case 48000:
+        master_sample_rate = 2;
+        break;
+
+    case 22050:
+        master_sample_rate = 3;
+        break;
+
+    case 44100:
+        master_sample_rate = 4;
+        break;
+
+    case 24000:
+        master_sample_rate = 5;
+        break;
+
+    default:
+        supported = false;
+        break;
+    }
+
+    if (supported)
+    {
+        pcm1774_write_reg(PCM1774_REG_BCK_CNFG_SAMP_CTRL_ZCROSS,
+                          (master_sample_rate << PCM1774_BITS_MSR_POS) |
+                          PCM1774_BITS_ZCRS_MASK);
+    }
+
+    return supported;
+}
+
 /**
  * @details
  * Register writes are done by sending a word where the 8 most
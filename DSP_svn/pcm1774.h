@@ -18,6 +18,7 @@
 // Include statements
 // =============================================================================
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "pcm1774_defs.h"
 
@@ -59,6 +60,14 @@ void pcm1774_analog_to_analog_mode(void);
  */
 void pcm1774_set_volume(uint8_t volume);
 
+/**
+ * @brief Sets the sampling rate of the DAC when it is in I2S master mode.
+ * @param sample_freq_hz - The new sampling rate. Must be one of
+ *        16000, 22050, 24000, 32000, 44100 or 48000.
+ * @return True if the sampling rate is supported, false otherwise.
+ */
+bool pcm1774_set_sample_freq(uint16_t sample_freq_hz);
+
 /**
  * @brief Writes a byte of data to a register on the PCM1774.
  * @param reg_index - The index of the register to write to.
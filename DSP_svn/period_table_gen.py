@@ -0,0 +1,96 @@
+# This script generates the note period tables used by the audio engine.
+#
+# One table with the period (in samples, q16_16_t) of every midi note is
+# generated for each supported sample rate. The tables are placed in flash so
+# that the sample rate can be switched at runtime without recalculating them.
+#
+# The frequency ratio tables used for pitch bend are generated into the same
+# file. A bend of s semitones and c cents is the product of one entry from
+# each table.
+
+A4_FREQ_HZ = 440.0
+MIDI_NOTE_A4 = 69
+MIDI_FREQUENCIES_SIZE = 128
+
+# Must be kept in the same order as in period_tables.h
+SAMPLE_FREQS_HZ = [16000, 22050, 24000, 32000, 44100, 48000]
+
+# Must be the same as PERIOD_TABLES_MAX_BEND_SEMITONES in period_tables.h
+MAX_BEND_SEMITONES = 24
+
+class Period_table_gen:
+
+    # @brief Converts a floating point number to the q16_16_t format.
+    # @details Uses the same conversion as double_to_q16_16 in fixed_point.h
+    # @param d - The number to convert.
+    # @return The q16_16_t representation of d.
+    def double_to_q16_16(self, d):
+        return int(d * 0xFFFF) & 0xFFFFFFFF
+
+    # @brief Converts a frequency ratio to the q16_16_t format.
+    # @details Unlike double_to_q16_16 the ratio 1.0 is converted exactly to
+    #          Q16_16_T_ONE, so that a centered bend does not detune the note.
+    # @param d - The ratio to convert.
+    # @return The q16_16_t representation of d.
+    def ratio_to_q16_16(self, d):
+        return int(round(d * 0x10000)) & 0xFFFFFFFF
+
+    # @brief Calculates the frequency of a midi note.
+    # @param note - The midi note number.
+    # @return The frequency in Hz.
+    def note_freq(self, note):
+        return A4_FREQ_HZ * pow(2, (note - MIDI_NOTE_A4) / 12.0)
+
+    def create_period_tables(self, filename = "period_tables.c"):
+        with open(filename, 'w') as f:
+            print("/*", file=f)
+            print("This file is an auto generated file.", file=f)
+            print("Do not modify its contents manually!", file=f)
+            print("*/", file=f)
+            print("#include <stdint.h>", file=f)
+            print("#include \"period_tables.h\"", file=f)
+            print("", file=f)
+
+            print("const uint16_t g_period_tables_sample_freqs_hz[PERIOD_TABLES_NBR_OF_SAMPLE_RATES] =", file=f)
+            print("{", file=f)
+            print("    " + ", ".join(str(fs) for fs in SAMPLE_FREQS_HZ), file=f)
+            print("};", file=f)
+            print("", file=f)
+
+            print("const q16_16_t g_period_tables_note_periods[PERIOD_TABLES_NBR_OF_SAMPLE_RATES][MIDI_FREQUENCIES_SIZE] =", file=f)
+            print("{", file=f)
+            for fs in SAMPLE_FREQS_HZ:
+                print("    {   // " + str(fs) + " Hz", file=f)
+                periods = [self.double_to_q16_16(fs / self.note_freq(note))
+                           for note in range(MIDI_FREQUENCIES_SIZE)]
+                for i in range(0, MIDI_FREQUENCIES_SIZE, 8):
+                    print("        " + ", ".join("0x%08X" % p for p in periods[i:i + 8]) + ",", file=f)
+                print("    },", file=f)
+            print("};", file=f)
+            print("", file=f)
+
+            print("const q16_16_t g_period_tables_semitone_ratios[2 * PERIOD_TABLES_MAX_BEND_SEMITONES + 1] =", file=f)
+            print("{", file=f)
+            ratios = [self.ratio_to_q16_16(pow(2, s / 12.0))
+                      for s in range(-MAX_BEND_SEMITONES, MAX_BEND_SEMITONES + 1)]
+            for i in range(0, len(ratios), 8):
+                print("    " + ", ".join("0x%08X" % r for r in ratios[i:i + 8]) + ",", file=f)
+            print("};", file=f)
+            print("", file=f)
+
+            print("const q16_16_t g_period_tables_cent_ratios[PERIOD_TABLES_CENTS_PER_SEMITONE] =", file=f)
+            print("{", file=f)
+            ratios = [self.ratio_to_q16_16(pow(2, c / 1200.0)) for c in range(100)]
+            for i in range(0, len(ratios), 8):
+                print("    " + ", ".join("0x%08X" % r for r in ratios[i:i + 8]) + ",", file=f)
+            print("};", file=f)
+
+# ===============================================================================
+# Module test
+# ===============================================================================
+
+if __name__ == "__main__":
+    print("Period table gen started")
+    gen = Period_table_gen()
+    gen.create_period_tables()
+    print("Period table gen complete")
@@ -0,0 +1,151 @@
+/*
+This file is an auto generated file.
+Do not modify its contents manually!
+*/
+#include <stdint.h>
+#include "period_tables.h"
+
+const uint16_t g_period_tables_sample_freqs_hz[PERIOD_TABLES_NBR_OF_SAMPLE_RATES] =
+{
+    16000, 22050, 24000, 32000, 44100, 48000
+};
+
+const q16_16_t g_period_tables_note_periods[PERIOD_TABLES_NBR_OF_SAMPLE_RATES][MIDI_FREQUENCIES_SIZE] =
+{
+    {   // 16000 Hz
+        0x07A4F726, 0x07372120, 0x06CF753F, 0x066D9AEF, 0x06113E97, 0x05BA114C, 0x0567C895, 0x051A1E23,
+        0x04D0CF9B, 0x048B9E5D, 0x044A4F49, 0x040CAA94, 0x03D27B93, 0x039B9090, 0x0367BA9F, 0x0336CD77,
+        0x03089F4B, 0x02DD08A6, 0x02B3E44A, 0x028D0F11, 0x026867CD, 0x0245CF2E, 0x022527A4, 0x0206554A,
+        0x01E93DC9, 0x01CDC848, 0x01B3DD4F, 0x019B66BB, 0x01844FA5, 0x016E8453, 0x0159F225, 0x01468788,
+        0x013433E6, 0x0122E797, 0x011293D2, 0x01032AA5, 0x00F49EE4, 0x00E6E424, 0x00D9EEA7, 0x00CDB35D,
+        0x00C227D2, 0x00B74229, 0x00ACF912, 0x00A343C4, 0x009A19F3, 0x009173CB, 0x008949E9, 0x00819552,
+        0x007A4F72, 0x00737212, 0x006CF753, 0x0066D9AE, 0x006113E9, 0x005BA114, 0x00567C89, 0x0051A1E2,
+        0x004D0CF9, 0x0048B9E5, 0x0044A4F4, 0x0040CAA9, 0x003D27B9, 0x0039B909, 0x00367BA9, 0x00336CD7,
+        0x003089F4, 0x002DD08A, 0x002B3E44, 0x0028D0F1, 0x0026867C, 0x00245CF2, 0x0022527A, 0x00206554,
+        0x001E93DC, 0x001CDC84, 0x001B3DD4, 0x0019B66B, 0x001844FA, 0x0016E845, 0x00159F22, 0x00146878,
+        0x0013433E, 0x00122E79, 0x0011293D, 0x001032AA, 0x000F49EE, 0x000E6E42, 0x000D9EEA, 0x000CDB35,
+        0x000C227D, 0x000B7422, 0x000ACF91, 0x000A343C, 0x0009A19F, 0x0009173C, 0x0008949E, 0x00081955,
+        0x0007A4F7, 0x00073721, 0x0006CF75, 0x00066D9A, 0x0006113E, 0x0005BA11, 0x000567C8, 0x00051A1E,
+        0x0004D0CF, 0x00048B9E, 0x00044A4F, 0x00040CAA, 0x0003D27B, 0x00039B90, 0x000367BA, 0x000336CD,
+        0x0003089F, 0x0002DD08, 0x0002B3E4, 0x00028D0F, 0x00026867, 0x000245CF, 0x00022527, 0x00020655,
+        0x0001E93D, 0x0001CDC8, 0x0001B3DD, 0x00019B66, 0x0001844F, 0x00016E84, 0x000159F2, 0x00014687,
+    },
+    {   // 22050 Hz
+        0x0A88F167, 0x09F19340, 0x0962B3FB, 0x08DBD985, 0x085C90A8, 0x07E46CA4, 0x077306D4, 0x0707FE55,
+        0x06A2F7B5, 0x06439CA5, 0x05E99BAA, 0x0594A7E1, 0x054478B3, 0x04F8C9A0, 0x04B159FD, 0x046DECC2,
+        0x042E4854, 0x03F23652, 0x03B9836A, 0x0383FF2A, 0x03517BDA, 0x0321CE52, 0x02F4CDD5, 0x02CA53F0,
+        0x02A23C59, 0x027C64D0, 0x0258ACFE, 0x0236F661, 0x0217242A, 0x01F91B29, 0x01DCC1B5, 0x01C1FF95,
+        0x01A8BDED, 0x0190E729, 0x017A66EA, 0x016529F8, 0x01511E2C, 0x013E3268, 0x012C567F, 0x011B7B30,
+        0x010B9215, 0x00FC8D94, 0x00EE60DA, 0x00E0FFCA, 0x00D45EF6, 0x00C87394, 0x00BD3375, 0x00B294FC,
+        0x00A88F16, 0x009F1934, 0x00962B3F, 0x008DBD98, 0x0085C90A, 0x007E46CA, 0x0077306D, 0x00707FE5,
+        0x006A2F7B, 0x006439CA, 0x005E99BA, 0x00594A7E, 0x0054478B, 0x004F8C9A, 0x004B159F, 0x0046DECC,
+        0x0042E485, 0x003F2365, 0x003B9836, 0x00383FF2, 0x003517BD, 0x00321CE5, 0x002F4CDD, 0x002CA53F,
+        0x002A23C5, 0x0027C64D, 0x00258ACF, 0x00236F66, 0x00217242, 0x001F91B2, 0x001DCC1B, 0x001C1FF9,
+        0x001A8BDE, 0x00190E72, 0x0017A66E, 0x0016529F, 0x001511E2, 0x0013E326, 0x0012C567, 0x0011B7B3,
+        0x0010B921, 0x000FC8D9, 0x000EE60D, 0x000E0FFC, 0x000D45EF, 0x000C8739, 0x000BD337, 0x000B294F,
+        0x000A88F1, 0x0009F193, 0x000962B3, 0x0008DBD9, 0x00085C90, 0x0007E46C, 0x00077306, 0x000707FE,
+        0x0006A2F7, 0x0006439C, 0x0005E99B, 0x000594A7, 0x00054478, 0x0004F8C9, 0x0004B159, 0x00046DEC,
+        0x00042E48, 0x0003F236, 0x0003B983, 0x000383FF, 0x0003517B, 0x000321CE, 0x0002F4CD, 0x0002CA53,
+        0x0002A23C, 0x00027C64, 0x000258AC, 0x000236F6, 0x00021724, 0x0001F91B, 0x0001DCC1, 0x0001C1FF,
+    },
+    {   // 24000 Hz
+        0x0B7772B9, 0x0AD2B1B0, 0x0A372FDE, 0x09A46867, 0x0919DDE2, 0x089719F3, 0x081BACDF, 0x07A72D34,
+        0x07393769, 0x06D16D8B, 0x066F76EE, 0x0612FFDE, 0x05BBB95C, 0x056958D8, 0x051B97EF, 0x04D23433,
+        0x048CEEF1, 0x044B8CF9, 0x040DD66F, 0x03D3969A, 0x039C9BB4, 0x0368B6C5, 0x0337BB77, 0x03097FEF,
+        0x02DDDCAE, 0x02B4AC6C, 0x028DCBF7, 0x02691A19, 0x02467778, 0x0225C67C, 0x0206EB37, 0x01E9CB4D,
+        0x01CE4DDA, 0x01B45B62, 0x019BDDBB, 0x0184BFF7, 0x016EEE57, 0x015A5636, 0x0146E5FB, 0x01348D0C,
+        0x01233BBC, 0x0112E33E, 0x0103759B, 0x00F4E5A6, 0x00E726ED, 0x00DA2DB1, 0x00CDEEDD, 0x00C25FFB,
+        0x00B7772B, 0x00AD2B1B, 0x00A372FD, 0x009A4686, 0x00919DDE, 0x0089719F, 0x0081BACD, 0x007A72D3,
+        0x00739376, 0x006D16D8, 0x0066F76E, 0x00612FFD, 0x005BBB95, 0x0056958D, 0x0051B97E, 0x004D2343,
+        0x0048CEEF, 0x0044B8CF, 0x0040DD66, 0x003D3969, 0x0039C9BB, 0x00368B6C, 0x00337BB7, 0x003097FE,
+        0x002DDDCA, 0x002B4AC6, 0x0028DCBF, 0x002691A1, 0x00246777, 0x00225C67, 0x00206EB3, 0x001E9CB4,
+        0x001CE4DD, 0x001B45B6, 0x0019BDDB, 0x00184BFF, 0x0016EEE5, 0x0015A563, 0x00146E5F, 0x001348D0,
+        0x001233BB, 0x00112E33, 0x00103759, 0x000F4E5A, 0x000E726E, 0x000DA2DB, 0x000CDEED, 0x000C25FF,
+        0x000B7772, 0x000AD2B1, 0x000A372F, 0x0009A468, 0x000919DD, 0x00089719, 0x00081BAC, 0x0007A72D,
+        0x00073937, 0x0006D16D, 0x00066F76, 0x000612FF, 0x0005BBB9, 0x00056958, 0x00051B97, 0x0004D234,
+        0x00048CEE, 0x00044B8C, 0x00040DD6, 0x0003D396, 0x00039C9B, 0x000368B6, 0x000337BB, 0x0003097F,
+        0x0002DDDC, 0x0002B4AC, 0x00028DCB, 0x0002691A, 0x00024677, 0x000225C6, 0x000206EB, 0x0001E9CB,
+    },
+    {   // 32000 Hz
+        0x0F49EE4D, 0x0E6E4241, 0x0D9EEA7E, 0x0CDB35DE, 0x0C227D2E, 0x0B742299, 0x0ACF912A, 0x0A343C46,
+        0x09A19F37, 0x09173CBA, 0x08949E92, 0x08195528, 0x07A4F726, 0x07372120, 0x06CF753F, 0x066D9AEF,
+        0x06113E97, 0x05BA114C, 0x0567C895, 0x051A1E23, 0x04D0CF9B, 0x048B9E5D, 0x044A4F49, 0x040CAA94,
+        0x03D27B93, 0x039B9090, 0x0367BA9F, 0x0336CD77, 0x03089F4B, 0x02DD08A6, 0x02B3E44A, 0x028D0F11,
+        0x026867CD, 0x0245CF2E, 0x022527A4, 0x0206554A, 0x01E93DC9, 0x01CDC848, 0x01B3DD4F, 0x019B66BB,
+        0x01844FA5, 0x016E8453, 0x0159F225, 0x01468788, 0x013433E6, 0x0122E797, 0x011293D2, 0x01032AA5,
+        0x00F49EE4, 0x00E6E424, 0x00D9EEA7, 0x00CDB35D, 0x00C227D2, 0x00B74229, 0x00ACF912, 0x00A343C4,
+        0x009A19F3, 0x009173CB, 0x008949E9, 0x00819552, 0x007A4F72, 0x00737212, 0x006CF753, 0x0066D9AE,
+        0x006113E9, 0x005BA114, 0x00567C89, 0x0051A1E2, 0x004D0CF9, 0x0048B9E5, 0x0044A4F4, 0x0040CAA9,
+        0x003D27B9, 0x0039B909, 0x00367BA9, 0x00336CD7, 0x003089F4, 0x002DD08A, 0x002B3E44, 0x0028D0F1,
+        0x0026867C, 0x00245CF2, 0x0022527A, 0x00206554, 0x001E93DC, 0x001CDC84, 0x001B3DD4, 0x0019B66B,
+        0x001844FA, 0x0016E845, 0x00159F22, 0x00146878, 0x0013433E, 0x00122E79, 0x0011293D, 0x001032AA,
+        0x000F49EE, 0x000E6E42, 0x000D9EEA, 0x000CDB35, 0x000C227D, 0x000B7422, 0x000ACF91, 0x000A343C,
+        0x0009A19F, 0x0009173C, 0x0008949E, 0x00081955, 0x0007A4F7, 0x00073721, 0x0006CF75, 0x00066D9A,
+        0x0006113E, 0x0005BA11, 0x000567C8, 0x00051A1E, 0x0004D0CF, 0x00048B9E, 0x00044A4F, 0x00040CAA,
+        0x0003D27B, 0x00039B90, 0x000367BA, 0x000336CD, 0x0003089F, 0x0002DD08, 0x0002B3E4, 0x00028D0F,
+    },
+    {   // 44100 Hz
+        0x1511E2CF, 0x13E32681, 0x12C567F6, 0x11B7B30A, 0x10B92150, 0x0FC8D948, 0x0EE60DA8, 0x0E0FFCAA,
+        0x0D45EF6B, 0x0C87394A, 0x0BD33755, 0x0B294FC2, 0x0A88F167, 0x09F19340, 0x0962B3FB, 0x08DBD985,
+        0x085C90A8, 0x07E46CA4, 0x077306D4, 0x0707FE55, 0x06A2F7B5, 0x06439CA5, 0x05E99BAA, 0x0594A7E1,
+        0x054478B3, 0x04F8C9A0, 0x04B159FD, 0x046DECC2, 0x042E4854, 0x03F23652, 0x03B9836A, 0x0383FF2A,
+        0x03517BDA, 0x0321CE52, 0x02F4CDD5, 0x02CA53F0, 0x02A23C59, 0x027C64D0, 0x0258ACFE, 0x0236F661,
+        0x0217242A, 0x01F91B29, 0x01DCC1B5, 0x01C1FF95, 0x01A8BDED, 0x0190E729, 0x017A66EA, 0x016529F8,
+        0x01511E2C, 0x013E3268, 0x012C567F, 0x011B7B30, 0x010B9215, 0x00FC8D94, 0x00EE60DA, 0x00E0FFCA,
+        0x00D45EF6, 0x00C87394, 0x00BD3375, 0x00B294FC, 0x00A88F16, 0x009F1934, 0x00962B3F, 0x008DBD98,
+        0x0085C90A, 0x007E46CA, 0x0077306D, 0x00707FE5, 0x006A2F7B, 0x006439CA, 0x005E99BA, 0x00594A7E,
+        0x0054478B, 0x004F8C9A, 0x004B159F, 0x0046DECC, 0x0042E485, 0x003F2365, 0x003B9836, 0x00383FF2,
+        0x003517BD, 0x00321CE5, 0x002F4CDD, 0x002CA53F, 0x002A23C5, 0x0027C64D, 0x00258ACF, 0x00236F66,
+        0x00217242, 0x001F91B2, 0x001DCC1B, 0x001C1FF9, 0x001A8BDE, 0x00190E72, 0x0017A66E, 0x0016529F,
+        0x001511E2, 0x0013E326, 0x0012C567, 0x0011B7B3, 0x0010B921, 0x000FC8D9, 0x000EE60D, 0x000E0FFC,
+        0x000D45EF, 0x000C8739, 0x000BD337, 0x000B294F, 0x000A88F1, 0x0009F193, 0x000962B3, 0x0008DBD9,
+        0x00085C90, 0x0007E46C, 0x00077306, 0x000707FE, 0x0006A2F7, 0x0006439C, 0x0005E99B, 0x000594A7,
+        0x00054478, 0x0004F8C9, 0x0004B159, 0x00046DEC, 0x00042E48, 0x0003F236, 0x0003B983, 0x000383FF,
+    },
+    {   // 48000 Hz
+        0x16EEE573, 0x15A56361, 0x146E5FBD, 0x1348D0CE, 0x1233BBC5, 0x112E33E6, 0x103759BF, 0x0F4E5A69,
+        0x0E726ED3, 0x0DA2DB17, 0x0CDEEDDC, 0x0C25FFBD, 0x0B7772B9, 0x0AD2B1B0, 0x0A372FDE, 0x09A46867,
+        0x0919DDE2, 0x089719F3, 0x081BACDF, 0x07A72D34, 0x07393769, 0x06D16D8B, 0x066F76EE, 0x0612FFDE,
+        0x05BBB95C, 0x056958D8, 0x051B97EF, 0x04D23433, 0x048CEEF1, 0x044B8CF9, 0x040DD66F, 0x03D3969A,
+        0x039C9BB4, 0x0368B6C5, 0x0337BB77, 0x03097FEF, 0x02DDDCAE, 0x02B4AC6C, 0x028DCBF7, 0x02691A19,
+        0x02467778, 0x0225C67C, 0x0206EB37, 0x01E9CB4D, 0x01CE4DDA, 0x01B45B62, 0x019BDDBB, 0x0184BFF7,
+        0x016EEE57, 0x015A5636, 0x0146E5FB, 0x01348D0C, 0x01233BBC, 0x0112E33E, 0x0103759B, 0x00F4E5A6,
+        0x00E726ED, 0x00DA2DB1, 0x00CDEEDD, 0x00C25FFB, 0x00B7772B, 0x00AD2B1B, 0x00A372FD, 0x009A4686,
+        0x00919DDE, 0x0089719F, 0x0081BACD, 0x007A72D3, 0x00739376, 0x006D16D8, 0x0066F76E, 0x00612FFD,
+        0x005BBB95, 0x0056958D, 0x0051B97E, 0x004D2343, 0x0048CEEF, 0x0044B8CF, 0x0040DD66, 0x003D3969,
+        0x0039C9BB, 0x00368B6C, 0x00337BB7, 0x003097FE, 0x002DDDCA, 0x002B4AC6, 0x0028DCBF, 0x002691A1,
+        0x00246777, 0x00225C67, 0x00206EB3, 0x001E9CB4, 0x001CE4DD, 0x001B45B6, 0x0019BDDB, 0x00184BFF,
+        0x0016EEE5, 0x0015A563, 0x00146E5F, 0x001348D0, 0x001233BB, 0x00112E33, 0x00103759, 0x000F4E5A,
+        0x000E726E, 0x000DA2DB, 0x000CDEED, 0x000C25FF, 0x000B7772, 0x000AD2B1, 0x000A372F, 0x0009A468,
+        0x000919DD, 0x00089719, 0x00081BAC, 0x0007A72D, 0x00073937, 0x0006D16D, 0x00066F76, 0x000612FF,
+        0x0005BBB9, 0x00056958, 0x00051B97, 0x0004D234, 0x00048CEE, 0x00044B8C, 0x00040DD6, 0x0003D396,
+    },
+};
+
+const q16_16_t g_period_tables_semitone_ratios[2 * PERIOD_TABLES_MAX_BEND_SEMITONES + 1] =
+{
+    0x00004000, 0x000043CE, 0x000047D6, 0x00004C1C, 0x000050A3, 0x0000556E, 0x00005A82, 0x00005FE4,
+    0x00006598, 0x00006BA2, 0x00007209, 0x000078D1, 0x00008000, 0x0000879C, 0x00008FAD, 0x00009838,
+    0x0000A145, 0x0000AADC, 0x0000B505, 0x0000BFC9, 0x0000CB30, 0x0000D745, 0x0000E412, 0x0000F1A2,
+    0x00010000, 0x00010F39, 0x00011F5A, 0x00013070, 0x0001428A, 0x000155B8, 0x00016A0A, 0x00017F91,
+    0x00019660, 0x0001AE8A, 0x0001C824, 0x0001E343, 0x00020000, 0x00021E72, 0x00023EB3, 0x000260E0,
+    0x00028514, 0x0002AB70, 0x0002D414, 0x0002FF22, 0x00032CC0, 0x00035D14, 0x00039048, 0x0003C687,
+    0x00040000,
+};
+
+const q16_16_t g_period_tables_cent_ratios[PERIOD_TABLES_CENTS_PER_SEMITONE] =
+{
+    0x00010000, 0x00010026, 0x0001004C, 0x00010072, 0x00010098, 0x000100BE, 0x000100E4, 0x0001010A,
+    0x00010130, 0x00010156, 0x0001017C, 0x000101A2, 0x000101C8, 0x000101EE, 0x00010214, 0x0001023A,
+    0x00010260, 0x00010287, 0x000102AD, 0x000102D3, 0x000102F9, 0x00010320, 0x00010346, 0x0001036C,
+    0x00010393, 0x000103B9, 0x000103E0, 0x00010406, 0x0001042D, 0x00010453, 0x0001047A, 0x000104A0,
+    0x000104C7, 0x000104ED, 0x00010514, 0x0001053A, 0x00010561, 0x00010588, 0x000105AE, 0x000105D5,
+    0x000105FC, 0x00010623, 0x00010649, 0x00010670, 0x00010697, 0x000106BE, 0x000106E5, 0x0001070C,
+    0x00010732, 0x00010759, 0x00010780, 0x000107A7, 0x000107CE, 0x000107F5, 0x0001081C, 0x00010843,
+    0x0001086B, 0x00010892, 0x000108B9, 0x000108E0, 0x00010907, 0x0001092E, 0x00010956, 0x0001097D,
+    0x000109A4, 0x000109CB, 0x000109F3, 0x00010A1A, 0x00010A41, 0x00010A69, 0x00010A90, 0x00010AB8,
+    0x00010ADF, 0x00010B07, 0x00010B2E, 0x00010B56, 0x00010B7D, 0x00010BA5, 0x00010BCC, 0x00010BF4,
+    0x00010C1B, 0x00010C43, 0x00010C6B, 0x00010C93, 0x00010CBA, 0x00010CE2, 0x00010D0A, 0x00010D32,
+    0x00010D59, 0x00010D81, 0x00010DA9, 0x00010DD1, 0x00010DF9, 0x00010E21, 0x00010E49, 0x00010E71,
+    0x00010E99, 0x00010EC1, 0x00010EE9, 0x00010F11,
+};
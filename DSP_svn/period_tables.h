@@ -0,0 +1,74 @@
+/*
+ * File:   period_tables.h
+ * Author: Erik
+ *
+ * Precomputed note period tables, one for each supported sample rate.
+ * The tables are generated by period_table_gen.py into period_tables.c.
+ */
+
+#ifndef PERIOD_TABLES_H
+#define	PERIOD_TABLES_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+
+#include "midi.h"
+#include "fixed_point.h"
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// The number of sample rates which period tables are generated for.
+#define PERIOD_TABLES_NBR_OF_SAMPLE_RATES   (6)
+
+// The index of the default sample rate (48 kHz) in the tables.
+#define PERIOD_TABLES_DEFAULT_RATE_INDEX    (5)
+
+// The largest pitch bend, in semitones, covered by the ratio tables.
+#define PERIOD_TABLES_MAX_BEND_SEMITONES    (24)
+
+#define PERIOD_TABLES_CENTS_PER_SEMITONE    (100)
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// The supported sample rates in Hz, in ascending order.
+extern const uint16_t
+    g_period_tables_sample_freqs_hz[PERIOD_TABLES_NBR_OF_SAMPLE_RATES];
+
+// The period, in samples, of each midi note for each supported sample rate.
+extern const q16_16_t
+    g_period_tables_note_periods[PERIOD_TABLES_NBR_OF_SAMPLE_RATES]
+                                [MIDI_FREQUENCIES_SIZE];
+
+// The frequency ratio 2^(s/12) for s in [-24, 24] semitones, s = 0 at index
+// PERIOD_TABLES_MAX_BEND_SEMITONES.
+extern const q16_16_t
+    g_period_tables_semitone_ratios[2 * PERIOD_TABLES_MAX_BEND_SEMITONES + 1];
+
+// The frequency ratio 2^(c/1200) for c in [0, 99] cents.
+extern const q16_16_t
+    g_period_tables_cent_ratios[PERIOD_TABLES_CENTS_PER_SEMITONE];
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* PERIOD_TABLES_H */
+
@@ -0,0 +1,268 @@
+/*
+ * This file implements the cooperative scheduler of the main loop.
+ *
+ * The tasks are checked in priority order on every call, so a high priority
+ * task which becomes ready is started as soon as the running task returns.
+ * The statistics are only accessed from the main loop.
+ *
+ * The duty cycle is measured as the time spent outside the idle function
+ * over a window of whole ticks, which includes the overhead of the
+ * scheduler itself. The interrupt which ends the Idle runs before the idle
+ * function returns, so it is counted as idle time.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "sched.h"
+#include "timer.h"
+#include "telemetry.h"
+#include "trace.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static const sched_task_t* tasks = NULL;
+static uint8_t task_count = 0;
+
+static void (*idle_function)(void) = NULL;
+
+static sched_stats_t stats[SCHED_MAX_TASKS];
+static uint32_t idle_count = 0;
+
+static uint32_t window_start = 0;       // The tick count at the window start
+static uint32_t window_idle_time = 0;   // Timer counts spent idle
+static uint16_t duty_cycle = 1000u;     // In tenths of a percent
+
+static bool render_burst = false;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Runs a task and updates its statistics.
+ * @param index - The index of the task in the task table.
+ * @return void
+ */
+static void run_task(uint8_t index);
+
+/**
+ * @brief Runs the idle function and counts the time spent in it.
+ * @param void
+ * @return void
+ */
+static void run_idle(void);
+
+/**
+ * @brief Calculates the duty cycle when the measurement window has ended,
+ *        and starts a new window.
+ * @param void
+ * @return void
+ */
+static void update_duty_cycle(void);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void sched_init(const sched_task_t* task_table,
+                uint8_t nbr_of_tasks,
+                void (*idle)(void))
+{
+    tasks = task_table;
+    task_count = nbr_of_tasks;
+    idle_function = idle;
+
+    if (task_count > SCHED_MAX_TASKS)
+    {
+        task_count = SCHED_MAX_TASKS;
+    }
+
+    render_burst = false;
+
+    sched_clear_stats();
+}
+
+bool sched_run(void)
+{
+    uint8_t i;
+
+    update_duty_cycle();
+
+    for (i = 0; i != task_count; ++i)
+    {
+        if ((NULL == tasks[i].is_ready) || tasks[i].is_ready())
+        {
+            run_task(i);
+
+            return true;
+        }
+    }
+
+    ++idle_count;
+    run_idle();
+
+    return false;
+}
+
+uint8_t sched_get_nbr_of_tasks(void)
+{
+    return task_count;
+}
+
+const char* sched_get_task_name(uint8_t task)
+{
+    return tasks[task].name;
+}
+
+void sched_get_stats(uint8_t task, sched_stats_t* dst)
+{
+    *dst = stats[task];
+}
+
+uint32_t sched_get_idle_count(void)
+{
+    return idle_count;
+}
+
+uint16_t sched_get_duty_cycle(void)
+{
+    return duty_cycle;
+}
+
+void sched_clear_stats(void)
+{
+    memset(stats, 0, sizeof(stats));
+    idle_count = 0;
+
+    window_start = timer_get_tick_count();
+    window_idle_time = 0;
+}
+
+uint16_t sched_render_block(uint16_t size, uint16_t depth)
+{
+    uint16_t samples = depth - size;
+
+    if (samples > SCHED_RENDER_BLOCK_SIZE)
+    {
+        samples = SCHED_RENDER_BLOCK_SIZE;
+    }
+
+    return samples;
+}
+
+bool sched_render_is_ready(uint16_t size, uint16_t depth)
+{
+    if (size <= (depth / SCHED_RENDER_BURST_DIVIDER))
+    {
+        render_burst = true;
+    }
+    else if (size + SCHED_RENDER_BLOCK_SIZE > depth)
+    {
+        render_burst = false;
+    }
+
+    return render_burst;
+}
+
+bool sched_render_is_late(uint16_t size, uint16_t depth)
+{
+    return size < (depth / SCHED_RENDER_DEADLINE_DIVIDER);
+}
+
+bool sched_modulation_is_late(void)
+{
+    return timer_get_time() >
+           (timer_get_counts_per_tick() / SCHED_MODULATION_DEADLINE_DIVIDER);
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void run_task(uint8_t index)
+{
+    const sched_task_t* task = &tasks[index];
+    sched_stats_t* task_stats = &stats[index];
+    uint16_t start;
+    uint16_t elapsed;
+
+    if ((NULL != task->is_late) && task->is_late())
+    {
+        ++task_stats->deadline_misses;
+    }
+
+    TRACE_BEGIN(task->trace_id, 0, 0);
+    start = timer_get_time();
+
+    task->run();
+
+    elapsed = timer_get_elapsed(start);
+    TRACE_END(task->trace_id, 0, 0);
+
+    telemetry_add_time(task->stage, elapsed);
+
+    ++task_stats->runs;
+    task_stats->total_time += elapsed;
+
+    if (elapsed > task_stats->max_time)
+    {
+        task_stats->max_time = elapsed;
+    }
+}
+
+static void run_idle(void)
+{
+    uint16_t start;
+
+    if (NULL == idle_function)
+    {
+        return;
+    }
+
+    start = timer_get_time();
+
+    idle_function();
+
+    window_idle_time += timer_get_elapsed(start);
+}
+
+static void update_duty_cycle(void)
+{
+    uint32_t ticks = timer_get_tick_count() - window_start;
+    uint32_t counts_per_permille;
+    uint32_t idle_permille;
+
+    if (ticks < SCHED_DUTY_CYCLE_TICKS)
+    {
+        return;
+    }
+
+    counts_per_permille = ticks * timer_get_counts_per_tick() / 1000u;
+    idle_permille = window_idle_time / counts_per_permille;
+
+    // The window ends on the first call after the tick, so the idle time
+    // may be slightly longer than the window.
+    duty_cycle = idle_permille < 1000u ? 1000u - (uint16_t)idle_permille : 0;
+
+    window_start += ticks;
+    window_idle_time = 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * File:   sched.h
+ * Author: Erik
+ *
+ * Cooperative run-to-completion scheduler for the main loop.
+ *
+ * The tasks are listed in a table in priority order, the first task has the
+ * highest priority. Every call of sched_run starts the first task which is
+ * ready, and the task runs to completion. A task which takes long should
+ * therefore do its work in parts, like the terminal does.
+ *
+ * When no task is ready the idle function is called, which puts the CPU in
+ * Idle until the next interrupt. The time spent in it gives the duty cycle,
+ * the part of the time the CPU is awake.
+ *
+ * A task may have a deadline, which is checked when the task is started.
+ * For the rendering the deadline is a sample buffer level and for the
+ * modulation a time within the tick. The run time and the missed deadlines
+ * of each task are counted.
+ *
+ * The policy of the render and modulation tasks is also implemented here,
+ * so that main.c and the host programs use the same one.
+ *
+ * The scheduler does not use any peripherals, only timer.h and telemetry.h,
+ * so it can be run on the host with a simulated timer, see
+ * host_render/sched_sim.c.
+ */
+
+#ifndef SCHED_H
+#define	SCHED_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "telemetry.h"
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+typedef struct sched_task_t
+{
+    const char* name;
+
+    // Checks if the task has work to do, NULL if it always has.
+    bool (*is_ready)(void);
+
+    // Does the work of the task.
+    void (*run)(void);
+
+    // Checks if the task has missed its deadline, called when the task is
+    // started. NULL if the task has no deadline.
+    bool (*is_late)(void);
+
+    // The main loop stage which the run time is added to.
+    telemetry_stage_t stage;
+
+    // The trace_id_t of the task.
+    uint8_t trace_id;
+} sched_task_t;
+
+typedef struct sched_stats_t
+{
+    uint32_t runs;              // The number of times the task has run
+    uint32_t total_time;        // The total run time in timer counts
+    uint16_t max_time;          // The longest run time in timer counts
+    uint16_t deadline_misses;   // The number of starts after the deadline
+} sched_stats_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// The maximum number of tasks.
+#define SCHED_MAX_TASKS         (8u)
+
+// The duty cycle is measured over this many ticks.
+#define SCHED_DUTY_CYCLE_TICKS  (100u)
+
+// The maximum number of samples calculated per run of the render task.
+#define SCHED_RENDER_BLOCK_SIZE             (16u)
+
+// A render burst is started when the sample buffer is filled to
+// 1 / SCHED_RENDER_BURST_DIVIDER of its depth, and lasts until a block no
+// longer fits. Rendering in bursts gives fewer and longer periods in Idle
+// than rendering whenever a block fits. The last few samples are not topped
+// up, since that would take as long as it takes the DMA to pop them.
+#define SCHED_RENDER_BURST_DIVIDER          (2u)
+
+// The rendering is late if the sample buffer is filled to less than
+// 1 / SCHED_RENDER_DEADLINE_DIVIDER of its depth when it is started.
+#define SCHED_RENDER_DEADLINE_DIVIDER       (4u)
+
+// The modulation is late if it is started after
+// 1 / SCHED_MODULATION_DEADLINE_DIVIDER of the tick.
+#define SCHED_MODULATION_DEADLINE_DIVIDER   (2u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Initializes the scheduler and clears the statistics.
+ * @param task_table - The tasks in priority order, highest first. The table
+ *                     is used by the scheduler and must not be modified.
+ * @param nbr_of_tasks - The number of tasks, at most SCHED_MAX_TASKS.
+ * @param idle - Called when no task is ready, should return after the next
+ *               interrupt. NULL to return at once.
+ * @return void
+ */
+void sched_init(const sched_task_t* task_table,
+                uint8_t nbr_of_tasks,
+                void (*idle)(void));
+
+/**
+ * @brief Runs the ready task with the highest priority, or the idle
+ *        function if no task is ready.
+ * @param void
+ * @return True if a task was run, false if no task was ready.
+ */
+bool sched_run(void);
+
+/**
+ * @brief Gets the number of tasks.
+ * @param void
+ * @return The number of tasks.
+ */
+uint8_t sched_get_nbr_of_tasks(void);
+
+/**
+ * @brief Gets the name of a task.
+ * @param task - The index of the task in the task table.
+ * @return The name of the task.
+ */
+const char* sched_get_task_name(uint8_t task);
+
+/**
+ * @brief Gets the statistics of a task.
+ * @param task - The index of the task in the task table.
+ * @param dst - Where to write the statistics.
+ * @return void
+ */
+void sched_get_stats(uint8_t task, sched_stats_t* dst);
+
+/**
+ * @brief Gets the number of calls of sched_run when no task was ready.
+ * @param void
+ * @return The number of idle calls.
+ */
+uint32_t sched_get_idle_count(void);
+
+/**
+ * @brief Gets the duty cycle, measured over the latest
+ *        SCHED_DUTY_CYCLE_TICKS ticks.
+ * @param void
+ * @return The part of the time spent outside the idle function, in tenths
+ *         of a percent.
+ */
+uint16_t sched_get_duty_cycle(void);
+
+/**
+ * @brief Clears the statistics of all tasks.
+ * @param void
+ * @return void
+ */
+void sched_clear_stats(void);
+
+/**
+ * @brief Gets the number of samples to calculate in a run of the render
+ *        task.
+ * @param size - The number of samples in the sample buffer.
+ * @param depth - The depth of the sample buffer.
+ * @return The free space in the sample buffer, at most
+ *         SCHED_RENDER_BLOCK_SIZE.
+ */
+uint16_t sched_render_block(uint16_t size, uint16_t depth);
+
+/**
+ * @brief Checks if a render burst is ongoing, or should be started.
+ *        Rendering single samples as soon as the DMA has popped one would
+ *        keep the lower priority tasks from ever running, and the CPU from
+ *        staying in Idle.
+ * @param size - The number of samples in the sample buffer.
+ * @param depth - The depth of the sample buffer.
+ * @return True if samples should be rendered.
+ */
+bool sched_render_is_ready(uint16_t size, uint16_t depth);
+
+/**
+ * @brief Checks if the sample buffer is close to running empty.
+ * @param size - The number of samples in the sample buffer.
+ * @param depth - The depth of the sample buffer.
+ * @return True if the rendering is late.
+ */
+bool sched_render_is_late(uint16_t size, uint16_t depth);
+
+/**
+ * @brief Checks if the modulation is started late in the tick.
+ * @param void
+ * @return True if the modulation is late.
+ */
+bool sched_modulation_is_late(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SCHED_H */
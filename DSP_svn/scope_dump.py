@@ -0,0 +1,89 @@
+# This script extracts a scope capture from the UART output of the dsp.
+#
+# The capture is armed with the terminal command "set scope" and sent by
+# "get scope" as binary frames (see CONTROL_OPCODE_SCOPE_DATA in control.h).
+# The UART output is read from a file, or from stdin if no file is given,
+# and the samples of the last complete capture are written as CSV, or as a
+# WAV file with --wav.
+#
+# Usage:
+#   scope_dump.py [--wav file] [--rate sample rate] [capture file]
+
+import argparse
+import os
+import struct
+import sys
+import wave
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+sys.path.insert(0, SCRIPT_DIR)
+import log_decode
+
+# Must be the same as in control.h
+CONTROL_OPCODE_SCOPE_DATA = 0x09
+
+# Must be the same as AUDIO_SCOPE_PRE_TRIGGER / AUDIO_SCOPE_SIZE in audio.h
+PRE_TRIGGER_FRACTION = 0.5
+
+DEFAULT_SAMPLE_RATE = 32000
+
+# @brief Collects the samples of the scope frames.
+# @param data - The UART output.
+# @return The samples of the last complete capture, None if there is none.
+def read_capture(data):
+    capture = None
+    last = None
+    for opcode, payload in log_decode.Frame_reader().feed(data):
+        if opcode != CONTROL_OPCODE_SCOPE_DATA | log_decode.CONTROL_REPLY_FLAG:
+            continue
+
+        first, size = struct.unpack_from("<HH", payload)
+        samples = struct.unpack_from("<%uh" % ((len(payload) - 4) // 2), payload, 4)
+
+        if first == 0:
+            capture = [None] * size
+        if capture is None or len(capture) != size:
+            continue
+
+        capture[first:first + len(samples)] = samples
+        if None not in capture:
+            last = list(capture)
+
+    return last
+
+
+# ===============================================================================
+# Module test
+# ===============================================================================
+
+if __name__ == "__main__":
+    arg_parser = argparse.ArgumentParser(description = "Extracts a scope capture of the dsp")
+    arg_parser.add_argument("capture", nargs = "?", help = "UART output, stdin if omitted")
+    arg_parser.add_argument("--wav", help = "write the samples to a WAV file")
+    arg_parser.add_argument("--rate", type = int, default = DEFAULT_SAMPLE_RATE,
+                            help = "sample rate of the WAV file")
+    args = arg_parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    samples = read_capture(data)
+    if samples is None:
+        print("No complete scope capture found", file = sys.stderr)
+        sys.exit(1)
+
+    if args.wav:
+        with wave.open(args.wav, "wb") as wav:
+            wav.setnchannels(1)
+            wav.setsampwidth(2)
+            wav.setframerate(args.rate)
+            wav.writeframes(struct.pack("<%uh" % len(samples), *samples))
+    else:
+        trigger = int(len(samples) * PRE_TRIGGER_FRACTION)
+        print("sample,value")
+        for i, value in enumerate(samples):
+            print("%d,%d" % (i - trigger, value))
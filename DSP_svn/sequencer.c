@@ -0,0 +1,513 @@
+/*
+ * This file implements the song sequencer.
+ *
+ * The song position advances by tick_step every modulation tick, where one
+ * sequencer tick is Q16_16_T_ONE. At most two sequencer ticks fall within
+ * one modulation tick at the highest tempo, and each track executes at most
+ * SEQUENCER_MAX_EVENTS_PER_TICK events per sequencer tick, which bounds the
+ * time spent per modulation tick.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sequencer.h"
+#include "songs.h"
+#include "event_queue.h"
+#include "audio.h"
+#include "timer.h"
+#include "fixed_point.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+typedef struct pattern_call_t
+{
+    const uint8_t*  start;      // First event of the pattern
+    const uint8_t*  ret;        // Where to continue after the pattern
+    uint8_t         repeats;    // Remaining plays of the pattern
+} pattern_call_t;
+
+typedef struct track_t
+{
+    bool            active;
+    uint8_t         channel;
+    uint8_t         depth;      // The number of active pattern calls
+    uint16_t        wait;       // Sequencer ticks until the next event
+    const uint8_t*  pos;        // The next byte of the event stream
+    const uint8_t*  loop;       // The loop point, NULL if none
+    pattern_call_t  calls[SEQUENCER_CALL_DEPTH];
+} track_t;
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+#define HEADER_SIZE             (4u)
+#define TRACK_ENTRY_SIZE        (3u)
+#define PATTERN_ENTRY_SIZE      (2u)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static bool playing = false;
+static const uint8_t* song_data = NULL;
+static uint8_t nbr_of_tracks = 0;
+static uint8_t nbr_of_patterns = 0;
+static track_t tracks[SEQUENCER_MAX_TRACKS];
+
+static q16_16_t tick_step = 0;      // Sequencer ticks per modulation tick
+static q16_16_t to_next_tick = 0;   // Position left until the next tick
+
+static uint16_t overruns = 0;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Reads a little endian 16 bit value.
+ * @param p - Pointer to the first byte.
+ * @return The value.
+ */
+static inline uint16_t read_u16(const uint8_t* p);
+
+/**
+ * @brief Reads a variable length delta time.
+ * @param pos - Pointer to the read position, which is advanced.
+ * @return The delta time in sequencer ticks.
+ */
+static uint16_t read_delta(const uint8_t** pos);
+
+/**
+ * @brief Advances all tracks by one sequencer tick.
+ * @param sample_index - The sample at which the tick starts.
+ * @return void
+ */
+static void advance_tracks(uint32_t sample_index);
+
+/**
+ * @brief Executes the events of a track which are due.
+ * @param track - The track.
+ * @param sample_index - The sample at which the events take effect.
+ * @return void
+ */
+static void run_track(track_t* track, uint32_t sample_index);
+
+/**
+ * @brief Executes the next event of a track.
+ * @param track - The track.
+ * @param sample_index - The sample at which the event takes effect.
+ * @return void
+ */
+static void execute_event(track_t* track, uint32_t sample_index);
+
+/**
+ * @brief Stops a track and turns its note off.
+ * @param track - The track.
+ * @param sample_index - The sample at which the note is turned off.
+ * @return void
+ */
+static void stop_track(track_t* track, uint32_t sample_index);
+
+/**
+ * @brief Pushes an event for the channel of a track to the event queue.
+ * @param track - The track.
+ * @param sample_index - The sample at which the event takes effect.
+ * @param type - The event type.
+ * @param data1 - The first event data byte.
+ * @param data2 - The second event data byte.
+ * @return void
+ */
+static void push_event(const track_t* track,
+                       uint32_t sample_index,
+                       event_type_t type,
+                       uint8_t data1,
+                       uint8_t data2);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void sequencer_init(void)
+{
+    uint8_t i;
+
+    playing = false;
+    song_data = NULL;
+    nbr_of_tracks = 0;
+    nbr_of_patterns = 0;
+    overruns = 0;
+
+    for (i = 0; i != SEQUENCER_MAX_TRACKS; ++i)
+    {
+        tracks[i].active = false;
+    }
+
+    sequencer_set_tempo(120);
+}
+
+bool sequencer_play(uint8_t song)
+{
+    const uint8_t* data;
+    uint16_t size;
+    uint16_t header_size;
+    uint16_t offset;
+    uint8_t i;
+
+    if (song >= g_songs_nbr_of_songs)
+    {
+        return false;
+    }
+
+    data = g_songs[song].data;
+    size = g_songs[song].size;
+
+    if ((size < HEADER_SIZE) ||
+        (SEQUENCER_FORMAT_VERSION != data[0]) ||
+        (data[2] > SEQUENCER_MAX_TRACKS))
+    {
+        return false;
+    }
+
+    header_size = HEADER_SIZE + data[2] * TRACK_ENTRY_SIZE +
+                  data[3] * PATTERN_ENTRY_SIZE;
+
+    if (header_size > size)
+    {
+        return false;
+    }
+
+    for (i = 0; i != data[2] + data[3]; ++i)
+    {
+        offset = (i < data[2]) ?
+            read_u16(&data[HEADER_SIZE + i * TRACK_ENTRY_SIZE + 1]) :
+            read_u16(&data[HEADER_SIZE + data[2] * TRACK_ENTRY_SIZE +
+                           (i - data[2]) * PATTERN_ENTRY_SIZE]);
+
+        if ((offset < header_size) || (offset >= size))
+        {
+            return false;
+        }
+    }
+
+    sequencer_stop();
+
+    song_data = data;
+    nbr_of_tracks = data[2];
+    nbr_of_patterns = data[3];
+    overruns = 0;
+
+    for (i = 0; i != nbr_of_tracks; ++i)
+    {
+        track_t* track = &tracks[i];
+        const uint8_t* entry = &data[HEADER_SIZE + i * TRACK_ENTRY_SIZE];
+
+        track->channel = entry[0];
+        track->active = (track->channel < AUDIO_CH_NBR_OF_CHANNELS);
+        track->depth = 0;
+        track->pos = &data[read_u16(&entry[1])];
+        track->loop = NULL;
+        track->wait = read_delta(&track->pos);
+    }
+
+    sequencer_set_tempo(data[1]);
+    to_next_tick = 0;
+    playing = true;
+
+    return true;
+}
+
+void sequencer_stop(void)
+{
+    uint8_t i;
+
+    for (i = 0; i != nbr_of_tracks; ++i)
+    {
+        if (tracks[i].active)
+        {
+            stop_track(&tracks[i], audio_get_sample_index(&g_audio_engine));
+        }
+    }
+
+    playing = false;
+}
+
+void sequencer_set_tempo(uint8_t bpm)
+{
+    if (bpm < SEQUENCER_MIN_TEMPO)
+    {
+        bpm = SEQUENCER_MIN_TEMPO;
+    }
+    else if (bpm > SEQUENCER_MAX_TEMPO)
+    {
+        bpm = SEQUENCER_MAX_TEMPO;
+    }
+
+    // Sequencer ticks per second divided by modulation ticks per second
+    tick_step = ((uint32_t)bpm * SEQUENCER_TICKS_PER_QUARTER * Q16_16_T_ONE) /
+                (60 * TIMER_FREQ_HZ);
+}
+
+void sequencer_tick(void)
+{
+    uint32_t base;
+    uint16_t samples_per_tick;
+    uint16_t offset;
+
+    if (!playing)
+    {
+        return;
+    }
+
+    base = audio_get_schedule_base(&g_audio_engine);
+    samples_per_tick = audio_get_sample_freq(&g_audio_engine) / TIMER_FREQ_HZ;
+
+    //
+    // Run every sequencer tick which starts within this modulation tick,
+    // at the sample where it starts.
+    //
+    while (playing && (to_next_tick < tick_step))
+    {
+        offset = ((uint32_t)to_next_tick * samples_per_tick) / tick_step;
+        advance_tracks(base + offset);
+        to_next_tick += Q16_16_T_ONE;
+    }
+
+    to_next_tick -= tick_step;
+}
+
+bool sequencer_is_playing(void)
+{
+    return playing;
+}
+
+uint16_t sequencer_get_overruns(void)
+{
+    return overruns;
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static inline uint16_t read_u16(const uint8_t* p)
+{
+    return p[0] | ((uint16_t)p[1] << 8);
+}
+
+static uint16_t read_delta(const uint8_t** pos)
+{
+    const uint8_t* p = *pos;
+    uint16_t delta = 0;
+
+    while (*p & 0x80)
+    {
+        delta = (delta << 7) | (*p++ & 0x7F);
+    }
+
+    delta = (delta << 7) | *p++;
+    *pos = p;
+
+    return delta;
+}
+
+static void advance_tracks(uint32_t sample_index)
+{
+    uint8_t i;
+    bool any_active = false;
+
+    for (i = 0; i != nbr_of_tracks; ++i)
+    {
+        track_t* track = &tracks[i];
+
+        if (!track->active)
+        {
+            continue;
+        }
+
+        if (0 == track->wait)
+        {
+            run_track(track, sample_index);
+        }
+
+        if (0 != track->wait)
+        {
+            --track->wait;
+        }
+
+        any_active |= track->active;
+    }
+
+    playing = any_active;
+}
+
+static void run_track(track_t* track, uint32_t sample_index)
+{
+    uint8_t nbr_of_events = 0;
+
+    while (track->active)
+    {
+        if (SEQUENCER_MAX_EVENTS_PER_TICK == nbr_of_events++)
+        {
+            // Continue at the next tick
+            ++overruns;
+            return;
+        }
+
+        execute_event(track, sample_index);
+
+        if (track->active)
+        {
+            track->wait = read_delta(&track->pos);
+
+            if (0 != track->wait)
+            {
+                return;
+            }
+        }
+    }
+}
+
+static void execute_event(track_t* track, uint32_t sample_index)
+{
+    const uint8_t* p = track->pos;
+    pattern_call_t* call;
+    uint8_t event = *p++;
+
+    if (event < SEQUENCER_EVENT_NOTE_OFF)
+    {
+        if (0 != p[0])
+        {
+            push_event(track, sample_index, EVENT_NOTE_ON, event, p[0]);
+        }
+        else
+        {
+            push_event(track, sample_index, EVENT_NOTE_OFF, 0, 0);
+        }
+
+        track->pos = p + 1;
+        return;
+    }
+
+    switch (event)
+    {
+    case SEQUENCER_EVENT_NOTE_OFF:
+        push_event(track, sample_index, EVENT_NOTE_OFF, 0, 0);
+        break;
+
+    case SEQUENCER_EVENT_PATCH:
+        push_event(track, sample_index, EVENT_PROGRAM_CHANGE, p[0], 0);
+        p += 1;
+        break;
+
+    case SEQUENCER_EVENT_CONTROL:
+        push_event(track, sample_index, EVENT_CONTROL_CHANGE, p[0], p[1]);
+        p += 2;
+        break;
+
+    case SEQUENCER_EVENT_PITCH_BEND:
+        push_event(track, sample_index, EVENT_PITCH_BEND, p[0], p[1]);
+        p += 2;
+        break;
+
+    case SEQUENCER_EVENT_PATTERN:
+        if ((track->depth < SEQUENCER_CALL_DEPTH) &&
+            (p[0] < nbr_of_patterns) &&
+            (0 != p[1]))
+        {
+            call = &track->calls[track->depth++];
+            call->start = &song_data[read_u16(&song_data[HEADER_SIZE +
+                nbr_of_tracks * TRACK_ENTRY_SIZE +
+                p[0] * PATTERN_ENTRY_SIZE])];
+            call->ret = p + 2;
+            call->repeats = p[1];
+            p = call->start;
+        }
+        else
+        {
+            p += 2;
+        }
+        break;
+
+    case SEQUENCER_EVENT_PATTERN_END:
+        if (0 == track->depth)
+        {
+            stop_track(track, sample_index);
+            break;
+        }
+
+        call = &track->calls[track->depth - 1];
+
+        if (0 != --call->repeats)
+        {
+            p = call->start;
+        }
+        else
+        {
+            p = call->ret;
+            --track->depth;
+        }
+        break;
+
+    case SEQUENCER_EVENT_LOOP_POINT:
+        track->loop = p;
+        break;
+
+    case SEQUENCER_EVENT_TRACK_END:
+        if (NULL != track->loop)
+        {
+            p = track->loop;
+            track->depth = 0;
+        }
+        else
+        {
+            stop_track(track, sample_index);
+        }
+        break;
+
+    case SEQUENCER_EVENT_TEMPO:
+        sequencer_set_tempo(p[0]);
+        p += 1;
+        break;
+
+    default:
+        // Not a valid event, the rest of the track cannot be parsed
+        stop_track(track, sample_index);
+        break;
+    }
+
+    track->pos = p;
+}
+
+static void stop_track(track_t* track, uint32_t sample_index)
+{
+    push_event(track, sample_index, EVENT_NOTE_OFF, 0, 0);
+    track->active = false;
+}
+
+static void push_event(const track_t* track,
+                       uint32_t sample_index,
+                       event_type_t type,
+                       uint8_t data1,
+                       uint8_t data2)
+{
+    event_t event;
+
+    event.sample_index = sample_index;
+    event.type = type;
+    event.channel = track->channel;
+    event.data1 = data1;
+    event.data2 = data2;
+
+    event_queue_push(&event);
+}
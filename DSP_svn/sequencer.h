@@ -0,0 +1,171 @@
+/*
+ * File:   sequencer.h
+ * Author: Erik
+ *
+ * Song sequencer.
+ *
+ * Plays songs stored in flash (see songs.h) without help from the game CPU,
+ * which only has to start and stop songs and change the tempo.
+ *
+ * The sequencer is advanced once every modulation tick. The song position is
+ * kept in sequencer ticks, 24 per quarter note. The events of a sequencer
+ * tick are pushed to the event queue at the sample where the tick starts, so
+ * the timing does not depend on the modulation tick rate.
+ *
+ * Song format
+ * -----------
+ * All multi byte values are little endian. Offsets are counted from the
+ * first byte of the song.
+ *
+ *  Header:
+ *      u8  version             SEQUENCER_FORMAT_VERSION
+ *      u8  tempo               Beats per minute
+ *      u8  nbr_of_tracks       At most SEQUENCER_MAX_TRACKS
+ *      u8  nbr_of_patterns
+ *      Per track:
+ *          u8  channel         audio_ch_nbr_t the track plays on
+ *          u16 offset          Start of the track event stream
+ *      Per pattern:
+ *          u16 offset          Start of the pattern event stream
+ *
+ *  Event stream:
+ *      Tracks and patterns are streams of events. Every event is preceded
+ *      by a delta time, the number of sequencer ticks since the previous
+ *      event, encoded as a MIDI variable length quantity (7 bits per byte,
+ *      most significant first, bit 7 set on all but the last byte).
+ *
+ *      0x00 - 0x7F n v     Note on, note n with velocity v. Velocity 0 is
+ *                          note off.
+ *      0x80                Note off
+ *      0x81 p              Patch change to patch p
+ *      0x82 c v            Control change, control c to value v
+ *      0x83 l m            Pitch bend, 7 bit LSB and MSB
+ *      0x84 p r            Play pattern p r times, then continue
+ *      0x85                End of pattern
+ *      0x86                Loop point, where the track restarts at its end
+ *      0x87                End of track
+ *      0x88 t              Tempo change to t beats per minute
+ *
+ *  Patterns may call other patterns, at most SEQUENCER_CALL_DEPTH levels
+ *  deep. A track without a loop point stops at its end, the song stops when
+ *  all tracks have stopped.
+ */
+
+#ifndef SEQUENCER_H
+#define	SEQUENCER_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+typedef enum sequencer_event_t
+{
+    SEQUENCER_EVENT_NOTE_OFF        = 0x80,
+    SEQUENCER_EVENT_PATCH           = 0x81,
+    SEQUENCER_EVENT_CONTROL         = 0x82,
+    SEQUENCER_EVENT_PITCH_BEND      = 0x83,
+    SEQUENCER_EVENT_PATTERN         = 0x84,
+    SEQUENCER_EVENT_PATTERN_END     = 0x85,
+    SEQUENCER_EVENT_LOOP_POINT      = 0x86,
+    SEQUENCER_EVENT_TRACK_END       = 0x87,
+    SEQUENCER_EVENT_TEMPO           = 0x88
+} sequencer_event_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+#define SEQUENCER_FORMAT_VERSION        (1u)
+
+// The number of sequencer ticks per quarter note.
+#define SEQUENCER_TICKS_PER_QUARTER     (24u)
+
+#define SEQUENCER_MAX_TRACKS            (4u)
+
+// The maximum nesting of pattern calls.
+#define SEQUENCER_CALL_DEPTH            (2u)
+
+// The maximum number of events a track may execute per modulation tick.
+// Events which do not fit are executed at the next tick.
+#define SEQUENCER_MAX_EVENTS_PER_TICK   (8u)
+
+#define SEQUENCER_MIN_TEMPO             (20u)
+#define SEQUENCER_MAX_TEMPO             (250u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Stops any song and resets the sequencer.
+ * @param void
+ * @return void
+ */
+void sequencer_init(void);
+
+/**
+ * @brief Starts playing a song from the beginning.
+ * @param song - The song number, see songs.h.
+ * @return True if the song was started, false if it does not exist or is
+ *         not valid.
+ */
+bool sequencer_play(uint8_t song);
+
+/**
+ * @brief Stops the song and turns off the notes of its tracks.
+ * @param void
+ * @return void
+ */
+void sequencer_stop(void);
+
+/**
+ * @brief Changes the tempo of the playing song.
+ * @param bpm - The tempo in beats per minute, limited to
+ *        [SEQUENCER_MIN_TEMPO, SEQUENCER_MAX_TEMPO].
+ * @return void
+ */
+void sequencer_set_tempo(uint8_t bpm);
+
+/**
+ * @brief Advances the song by one modulation tick.
+ * @details Should be called once every modulation tick.
+ * @param void
+ * @return void
+ */
+void sequencer_tick(void);
+
+/**
+ * @brief Checks if a song is playing.
+ * @param void
+ * @return True if a song is playing.
+ */
+bool sequencer_is_playing(void);
+
+/**
+ * @brief Gets the number of times a track had more events in one tick than
+ *        SEQUENCER_MAX_EVENTS_PER_TICK.
+ * @param void
+ * @return The number of overruns since the song was started.
+ */
+uint16_t sequencer_get_overruns(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SEQUENCER_H */
+
@@ -0,0 +1,885 @@
+# This script compiles songs into the binary song format played by the
+# sequencer (see sequencer.h) and generates songs.c.
+#
+# Songs are read from Standard MIDI Files (.mid) or MML text (.mml). Every
+# song becomes one track per used audio channel. Sequences of events which
+# repeat, within a track or between tracks, are moved into patterns which are
+# stored once and called from where they are used.
+#
+# Usage:
+#   song_compiler.py [-o songs.c] [--map 0:0,1:1,2:2,9:3] [--loop] [songs...]
+#
+# Without song arguments all songs in the songs directory are compiled, in
+# alphabetical order, which gives their song numbers.
+#
+# MML
+# ---
+# Each line starts with the track letter of the channel it plays on, A for
+# square 0, B for square 1, C for triangle 0 and D for noise 0. Lines of the
+# same track are joined. Lines starting with # set song properties:
+#   #TEMPO n        Initial tempo in beats per minute
+#
+# Track commands:
+#   c d e f g a b   Note, optionally followed by + or # (sharp) or - (flat),
+#                   a length and dots. o4 c is midi note 60.
+#   r               Rest, with optional length and dots
+#   ^n              Tie, extends the previous note or rest by length n
+#   l n             Default length, 4 is a quarter note
+#   o n             Octave
+#   < >             Octave down, octave up
+#   v n             Velocity [0, 127]
+#   q n             Gate, notes sound for n/8 of their length, q8 is legato
+#   @n              Patch change
+#   t n             Tempo change
+#   y c,v           Control change
+#   L               Loop point
+#   [ ... ]n        Repeat the enclosed commands n times
+#   ;               Comment until the end of the line
+
+import argparse
+import os
+import struct
+import sys
+
+# Must be the same as in sequencer.h
+SEQUENCER_FORMAT_VERSION = 1
+SEQUENCER_TICKS_PER_QUARTER = 24
+SEQUENCER_MAX_TRACKS = 4
+SEQUENCER_MAX_EVENTS_PER_TICK = 8
+SEQUENCER_MIN_TEMPO = 20
+SEQUENCER_MAX_TEMPO = 250
+
+EVENT_NOTE_OFF = 0x80
+EVENT_PATCH = 0x81
+EVENT_CONTROL = 0x82
+EVENT_PITCH_BEND = 0x83
+EVENT_PATTERN = 0x84
+EVENT_PATTERN_END = 0x85
+EVENT_LOOP_POINT = 0x86
+EVENT_TRACK_END = 0x87
+EVENT_TEMPO = 0x88
+
+# Must be the same as EVENT_QUEUE_SIZE in event_queue.h
+EVENT_QUEUE_SIZE = 32
+
+# Must be the same as PATCH_BANK_SIZE in patch.h
+PATCH_BANK_SIZE = 8
+
+# audio_ch_nbr_t
+AUDIO_CH_NBR_OF_CHANNELS = 4
+AUDIO_CH_NAMES = ["square 0", "square 1", "triangle 0", "noise 0"]
+
+# Maps midi channels (0 based) to audio channels.
+DEFAULT_CHANNEL_MAP = {0: 0, 1: 1, 2: 2, 9: 3}
+
+DEFAULT_TEMPO = 120
+SONGS_DIR = "songs"
+MAX_DELTA = 0xFFFF
+MAX_PATTERNS = 255
+MAX_PATTERN_REPEATS = 255
+MAX_PATTERN_LENGTH = 64
+
+# Bytes used by a pattern besides its events: the first delta, the pattern
+# end and the offset in the header.
+PATTERN_OVERHEAD = 1 + 1 + 2
+
+# Bytes used by a pattern call: the event and the delta after it.
+PATTERN_CALL_SIZE = 3 + 1
+
+
+class Song_error(Exception):
+    pass
+
+
+# @brief Encodes a value as a midi variable length quantity.
+# @param value - The value to encode.
+# @return The encoded bytes.
+def vlq(value):
+    data = [value & 0x7F]
+    value >>= 7
+    while value:
+        data.insert(0, 0x80 | (value & 0x7F))
+        value >>= 7
+    return bytes(data)
+
+
+class Track:
+    # @brief Creates an empty track.
+    # @param channel - The audio channel the track plays on.
+    def __init__(self, channel):
+        self.channel = channel
+        self.events = []        # (tick, order, sequence number, event bytes)
+        self.loop_tick = None
+
+    # @brief Adds an event.
+    # @details Events at the same tick are played in order of the order
+    #          argument, then in the order they were added.
+    def add(self, tick, event, order = 1):
+        self.events.append((tick, order, len(self.events), bytes(event)))
+
+
+class Song:
+    # @brief Creates an empty song.
+    # @param name - The name of the song.
+    def __init__(self, name):
+        self.name = name
+        self.tempo = DEFAULT_TEMPO
+        self.tracks = {}        # audio channel: Track
+        self.end_tick = 0
+        self.tempo_changes = [] # (tick, bpm)
+        self.source_size = 0
+        self.warnings = []
+
+    def track(self, channel):
+        if channel not in self.tracks:
+            self.tracks[channel] = Track(channel)
+        return self.tracks[channel]
+
+    def warn(self, text):
+        self.warnings.append(text)
+
+
+class Smf_parser:
+    # @brief Creates a parser for Standard MIDI Files.
+    # @param channel_map - Maps midi channels to audio channels.
+    def __init__(self, channel_map = DEFAULT_CHANNEL_MAP):
+        self.channel_map = channel_map
+
+    # @brief Reads a Standard MIDI File.
+    # @param filename - The file to read.
+    # @param loop - True if the song should loop from its beginning when it
+    #               has no loop marker.
+    # @return The song.
+    def parse(self, filename, loop = False):
+        with open(filename, 'rb') as f:
+            data = f.read()
+
+        song = Song(os.path.splitext(os.path.basename(filename))[0])
+        song.source_size = len(data)
+
+        if data[0:4] != b"MThd":
+            raise Song_error("%s: not a midi file" % filename)
+
+        header_length = struct.unpack(">I", data[4:8])[0]
+        smf_format, nbr_of_chunks, division = struct.unpack(">HHH", data[8:14])
+
+        if division & 0x8000:
+            raise Song_error("%s: SMPTE time division is not supported" % filename)
+
+        pos = 8 + header_length
+        events = []             # (smf tick, status, data)
+        end = 0
+
+        for _ in range(nbr_of_chunks):
+            chunk_type = data[pos:pos + 4]
+            chunk_length = struct.unpack(">I", data[pos + 4:pos + 8])[0]
+            chunk = data[pos + 8:pos + 8 + chunk_length]
+            pos += 8 + chunk_length
+
+            if chunk_type == b"MTrk":
+                end = max(end, self.parse_track(chunk, events))
+
+        self.convert(song, events, end, division, loop)
+        return song
+
+    # @brief Reads the events of one track chunk.
+    # @param chunk - The data of the chunk.
+    # @param events - The list to add the events to.
+    # @return The tick of the end of the track.
+    def parse_track(self, chunk, events):
+        i = 0
+        tick = 0
+        status = 0
+
+        while i < len(chunk):
+            delta = 0
+            while True:
+                b = chunk[i]
+                i += 1
+                delta = (delta << 7) | (b & 0x7F)
+                if not (b & 0x80):
+                    break
+            tick += delta
+
+            if chunk[i] & 0x80:
+                status = chunk[i]
+                i += 1
+
+            if status == 0xFF:
+                meta_type = chunk[i]
+                i += 1
+                length, i = self.read_length(chunk, i)
+                events.append((tick, 0xFF, (meta_type, chunk[i:i + length])))
+                i += length
+                status = 0
+                if meta_type == 0x2F:
+                    break
+            elif status in (0xF0, 0xF7):
+                length, i = self.read_length(chunk, i)
+                i += length
+                status = 0
+            elif (status & 0xF0) in (0xC0, 0xD0):
+                events.append((tick, status, (chunk[i],)))
+                i += 1
+            else:
+                events.append((tick, status, (chunk[i], chunk[i + 1])))
+                i += 2
+
+        return tick
+
+    def read_length(self, chunk, i):
+        length = 0
+        while True:
+            b = chunk[i]
+            i += 1
+            length = (length << 7) | (b & 0x7F)
+            if not (b & 0x80):
+                return length, i
+
+    # @brief Converts midi events to song events.
+    # @details The audio channels play one note at a time, so a note off
+    #          only ends the note if no other note has been started since.
+    def convert(self, song, events, end, division, loop):
+        def to_tick(t):
+            return (t * SEQUENCER_TICKS_PER_QUARTER + division // 2) // division
+
+        events.sort(key = lambda e: e[0])
+        playing = {}
+        unmapped = set()
+        overlaps = 0
+        loop_tick = 0 if loop else None
+
+        for smf_tick, status, data in events:
+            tick = to_tick(smf_tick)
+
+            if status == 0xFF:
+                meta_type, payload = data
+                if meta_type == 0x51:
+                    bpm = round(60000000 / int.from_bytes(payload, "big"))
+                    bpm = self.limit_tempo(song, bpm)
+                    if tick == 0:
+                        song.tempo = bpm
+                    else:
+                        song.tempo_changes.append((tick, bpm))
+                elif meta_type == 0x06:
+                    marker = payload.decode("latin-1").strip().lower()
+                    if marker in ("loop", "loopstart", "loop start"):
+                        loop_tick = tick
+                    elif marker in ("loopend", "loop end"):
+                        end = smf_tick
+                continue
+
+            midi_channel = status & 0x0F
+            kind = status & 0xF0
+
+            if midi_channel not in self.channel_map:
+                unmapped.add(midi_channel + 1)
+                continue
+
+            channel = self.channel_map[midi_channel]
+            track = song.track(channel)
+
+            if kind == 0x90 and data[1] != 0:
+                if playing.get(channel) is not None:
+                    overlaps += 1
+                playing[channel] = data[0]
+                track.add(tick, [data[0], data[1]], 2)
+            elif kind == 0x80 or kind == 0x90:
+                if playing.get(channel) == data[0]:
+                    playing[channel] = None
+                    track.add(tick, [EVENT_NOTE_OFF], 0)
+            elif kind == 0xB0:
+                track.add(tick, [EVENT_CONTROL, data[0], data[1]])
+            elif kind == 0xC0:
+                if data[0] >= PATCH_BANK_SIZE:
+                    song.warn("patch %u on %s is outside the patch bank"
+                              % (data[0], AUDIO_CH_NAMES[channel]))
+                track.add(tick, [EVENT_PATCH, data[0]])
+            elif kind == 0xE0:
+                track.add(tick, [EVENT_PITCH_BEND, data[0], data[1]])
+
+        if unmapped:
+            song.warn("ignored midi channels " +
+                      ", ".join(str(c) for c in sorted(unmapped)))
+        if overlaps:
+            song.warn("%u overlapping notes were cut" % overlaps)
+
+        song.end_tick = to_tick(end)
+
+        if song.tracks:
+            first_track = song.tracks[min(song.tracks)]
+            for tick, bpm in song.tempo_changes:
+                first_track.add(tick, [EVENT_TEMPO, bpm])
+
+        if loop_tick is not None:
+            for track in song.tracks.values():
+                track.loop_tick = loop_tick
+
+    def limit_tempo(self, song, bpm):
+        if bpm < SEQUENCER_MIN_TEMPO or bpm > SEQUENCER_MAX_TEMPO:
+            song.warn("tempo %u is limited to [%u, %u]"
+                      % (bpm, SEQUENCER_MIN_TEMPO, SEQUENCER_MAX_TEMPO))
+        return min(max(bpm, SEQUENCER_MIN_TEMPO), SEQUENCER_MAX_TEMPO)
+
+
+class Mml_parser:
+    TRACK_LETTERS = "ABCD"
+    NOTE_SEMITONES = {'c': 0, 'd': 2, 'e': 4, 'f': 5, 'g': 7, 'a': 9, 'b': 11}
+    WHOLE_NOTE = 4 * SEQUENCER_TICKS_PER_QUARTER
+
+    # @brief Reads an MML file.
+    # @param filename - The file to read.
+    # @param loop - True if tracks without a loop point should loop from
+    #               their beginning.
+    # @return The song.
+    def parse(self, filename, loop = False):
+        with open(filename, encoding = "latin-1") as f:
+            text = f.read()
+
+        song = Song(os.path.splitext(os.path.basename(filename))[0])
+        song.source_size = len(text)
+        sources = {}
+
+        for line_nbr, line in enumerate(text.splitlines(), 1):
+            line = line.split(';')[0].strip()
+            if not line:
+                continue
+
+            if line.startswith('#'):
+                words = line[1:].split()
+                if words[0].upper() == "TEMPO":
+                    song.tempo = int(words[1])
+                else:
+                    raise Song_error("%s:%u: unknown property %s"
+                                     % (filename, line_nbr, words[0]))
+            elif line[0] in self.TRACK_LETTERS:
+                channel = self.TRACK_LETTERS.index(line[0])
+                sources.setdefault(channel, []).append(line[1:])
+            else:
+                raise Song_error("%s:%u: unknown track %s"
+                                 % (filename, line_nbr, line[0]))
+
+        for channel in sorted(sources):
+            track = song.track(channel)
+            self.mml = " ".join(sources[channel])
+            self.pos = 0
+            end = self.parse_track(song, track)
+            song.end_tick = max(song.end_tick, end)
+
+            if loop and track.loop_tick is None:
+                track.loop_tick = 0
+
+        return song
+
+    # @brief Converts the commands of one track to events.
+    # @return The tick of the end of the track.
+    def parse_track(self, song, track):
+        tick = 0
+        octave = 4
+        length = self.WHOLE_NOTE // 4
+        velocity = 100
+        gate = 8
+        sounding = False
+        repeats = []            # (position after [, remaining plays)
+        last_note_end = None    # Index of the note off of the last note
+
+        while True:
+            c = self.next_char()
+            if c is None:
+                break
+
+            if c in self.NOTE_SEMITONES or c == 'r':
+                note = None
+                if c != 'r':
+                    note = 12 * (octave + 1) + self.NOTE_SEMITONES[c]
+                    while self.peek() in ('+', '#', '-'):
+                        note += -1 if self.next_char() == '-' else 1
+                    if not 0 <= note <= 127:
+                        raise self.error("note out of range")
+                duration = self.read_length(length)
+                while self.peek() == '^':
+                    self.next_char()
+                    duration += self.read_length(length)
+
+                if note is None:
+                    if sounding:
+                        track.add(tick, [EVENT_NOTE_OFF])
+                        sounding = False
+                else:
+                    track.add(tick, [note, velocity])
+                    sounding = True
+                    if gate < 8:
+                        off = tick + max(1, duration * gate // 8)
+                        track.add(off, [EVENT_NOTE_OFF])
+                        sounding = False
+                tick += duration
+            elif c == 'l':
+                length = self.read_length(length, False)
+            elif c == 'o':
+                octave = self.read_number()
+            elif c == '<':
+                octave -= 1
+            elif c == '>':
+                octave += 1
+            elif c == 'v':
+                velocity = self.read_number(0, 127)
+            elif c == 'q':
+                gate = self.read_number(1, 8)
+            elif c == '@':
+                patch = self.read_number(0, 127)
+                if patch >= PATCH_BANK_SIZE:
+                    song.warn("patch %u on %s is outside the patch bank"
+                              % (patch, AUDIO_CH_NAMES[track.channel]))
+                track.add(tick, [EVENT_PATCH, patch])
+            elif c == 't':
+                bpm = self.read_number(SEQUENCER_MIN_TEMPO, SEQUENCER_MAX_TEMPO)
+                track.add(tick, [EVENT_TEMPO, bpm])
+            elif c == 'y':
+                control = self.read_number(0, 127)
+                if self.next_char() != ',':
+                    raise self.error("expected ,")
+                value = self.read_number(0, 127)
+                track.add(tick, [EVENT_CONTROL, control, value])
+            elif c == 'L':
+                track.add(tick, [EVENT_LOOP_POINT])
+                track.loop_tick = tick
+            elif c == '[':
+                repeats.append([self.pos, None])
+            elif c == ']':
+                if not repeats:
+                    raise self.error("] without [")
+                count = self.read_number(1, 255) if self.peek_digit() else 2
+                if repeats[-1][1] is None:
+                    repeats[-1][1] = count
+                repeats[-1][1] -= 1
+                if repeats[-1][1] > 0:
+                    self.pos = repeats[-1][0]
+                else:
+                    repeats.pop()
+            else:
+                raise self.error("unknown command %s" % c)
+
+        if repeats:
+            raise self.error("[ without ]")
+
+        return tick
+
+    def next_char(self):
+        while self.pos < len(self.mml) and self.mml[self.pos].isspace():
+            self.pos += 1
+        if self.pos == len(self.mml):
+            return None
+        self.pos += 1
+        return self.mml[self.pos - 1]
+
+    def peek(self):
+        while self.pos < len(self.mml) and self.mml[self.pos].isspace():
+            self.pos += 1
+        return self.mml[self.pos] if self.pos < len(self.mml) else None
+
+    def peek_digit(self):
+        c = self.peek()
+        return c is not None and c.isdigit()
+
+    def read_number(self, minimum = None, maximum = None):
+        if not self.peek_digit():
+            raise self.error("expected a number")
+        value = 0
+        while self.peek_digit():
+            value = value * 10 + int(self.next_char())
+        if (minimum is not None and value < minimum) or \
+           (maximum is not None and value > maximum):
+            raise self.error("%u is outside [%u, %u]" % (value, minimum, maximum))
+        return value
+
+    # @brief Reads a note length with dots.
+    # @param default - The length in ticks if no length is given.
+    # @param dots - True if dots are allowed.
+    # @return The length in sequencer ticks.
+    def read_length(self, default, dots = True):
+        ticks = default
+        if self.peek_digit():
+            n = self.read_number(1)
+            if self.WHOLE_NOTE % n:
+                raise self.error("length %u is not a whole number of ticks" % n)
+            ticks = self.WHOLE_NOTE // n
+        added = ticks
+        while dots and self.peek() == '.':
+            self.next_char()
+            added //= 2
+            ticks += added
+        return ticks
+
+    def error(self, text):
+        return Song_error("mml position %u: %s" % (self.pos, text))
+
+
+class Song_compiler:
+    # @brief Compiles a song to the binary song format.
+    # @param song - The song.
+    # @param use_patterns - False to store all events in the tracks.
+    # @return The binary song.
+    def compile(self, song, use_patterns = True):
+        if not song.tracks:
+            raise Song_error("%s: the song has no notes" % song.name)
+        if len(song.tracks) > SEQUENCER_MAX_TRACKS:
+            raise Song_error("%s: more than %u tracks"
+                             % (song.name, SEQUENCER_MAX_TRACKS))
+
+        self.song = song
+        self.tracks = [self.tokenize(song.tracks[c]) for c in sorted(song.tracks)]
+        self.channels = sorted(song.tracks)
+        self.patterns = []
+        self.flat = self.decode(self.serialize())
+
+        if use_patterns:
+            self.extract_patterns()
+
+        data = self.serialize()
+
+        if self.decode(data) != self.flat:
+            raise Song_error("%s: the compiled song does not play the "
+                             "same events" % song.name)
+
+        return data
+
+    # @brief Converts the events of a track to tokens.
+    # @details A token is an event and the delta time to the next event.
+    #          Sequences of tokens can be moved to patterns without changing
+    #          the delta times around them.
+    # @return (delta to the first token, tokens)
+    def tokenize(self, track):
+        timed = list(track.events)
+        loop_event = bytes([EVENT_LOOP_POINT])
+
+        if track.loop_tick is not None and \
+           not any(e[3] == loop_event for e in timed):
+            timed.append((track.loop_tick, -1, -1, loop_event))
+
+        timed.sort(key = lambda e: e[0:3])
+        timed = [(e[0], e[3]) for e in timed]
+        last_tick = timed[-1][0] if timed else 0
+        timed.append((max(self.song.end_tick, last_tick),
+                      bytes([EVENT_TRACK_END])))
+
+        tokens = []
+        for i in range(len(timed) - 1):
+            delta = timed[i + 1][0] - timed[i][0]
+            if delta > MAX_DELTA:
+                raise Song_error("%s: a delta time is longer than %u ticks"
+                                 % (self.song.name, MAX_DELTA))
+            tokens.append((timed[i][1], delta))
+        tokens.append((timed[-1][1], None))
+
+        return (timed[0][0], tokens)
+
+    # @brief Checks if a token may be moved to a pattern.
+    def movable(self, token):
+        return token[0][0] not in (EVENT_PATTERN, EVENT_LOOP_POINT,
+                                   EVENT_TRACK_END)
+
+    def token_size(self, token):
+        return len(token[0]) + len(vlq(token[1]))
+
+    # @brief Moves repeated token sequences to patterns.
+    # @details Greedily picks the sequence which saves the most bytes, until
+    #          no sequence saves any. Sequences which would make a track
+    #          exceed SEQUENCER_MAX_EVENTS_PER_TICK are not used.
+    def extract_patterns(self):
+        rejected = set()
+
+        while len(self.patterns) < MAX_PATTERNS:
+            best = None
+
+            for candidate, sites in self.find_candidates().items():
+                if candidate in rejected:
+                    continue
+                size = sum(self.token_size(t) for t in candidate)
+                uses = sum(repeats for _, _, repeats in sites)
+                saving = uses * size - len(sites) * PATTERN_CALL_SIZE - \
+                         (size + PATTERN_OVERHEAD)
+                if saving > 0 and (best is None or
+                                   (saving, len(candidate)) > best[0]):
+                    best = ((saving, len(candidate)), candidate, sites)
+
+            if best is None:
+                return
+
+            _, candidate, sites = best
+            old_tracks = list(self.tracks)
+            self.apply_pattern(candidate, sites)
+
+            if self.peak_events_per_tick(self.serialize())[0] > \
+               SEQUENCER_MAX_EVENTS_PER_TICK:
+                self.tracks = old_tracks
+                self.patterns.pop()
+                rejected.add(candidate)
+
+    # @brief Finds the token sequences which occur more than once.
+    # @return {sequence: [(track, index, repeats)]} where consecutive uses
+    #         are counted as one site with several repeats.
+    def find_candidates(self):
+        positions = {}
+
+        for track_nbr, (_, tokens) in enumerate(self.tracks):
+            for i in range(len(tokens)):
+                for n in range(2, MAX_PATTERN_LENGTH + 1):
+                    if i + n > len(tokens) or not self.movable(tokens[i + n - 1]):
+                        break
+                    if not self.movable(tokens[i]):
+                        break
+                    positions.setdefault(tuple(tokens[i:i + n]), []).append(
+                        (track_nbr, i))
+
+        candidates = {}
+
+        for candidate, uses in positions.items():
+            if len(uses) < 2:
+                continue
+            n = len(candidate)
+            sites = []
+            for track_nbr, i in uses:
+                if sites and sites[-1][0] == track_nbr:
+                    last_track, last_i, repeats = sites[-1]
+                    if i < last_i + n * repeats:
+                        continue    # Overlaps the previous use
+                    if i == last_i + n * repeats and \
+                       repeats < MAX_PATTERN_REPEATS:
+                        sites[-1] = (last_track, last_i, repeats + 1)
+                        continue
+                sites.append((track_nbr, i, 1))
+            if sum(repeats for _, _, repeats in sites) >= 2:
+                candidates[candidate] = sites
+
+        return candidates
+
+    def apply_pattern(self, candidate, sites):
+        pattern_nbr = len(self.patterns)
+        self.patterns.append(list(candidate))
+        n = len(candidate)
+
+        for track_nbr, i, repeats in reversed(sites):
+            first_delta, tokens = self.tracks[track_nbr]
+            call = (bytes([EVENT_PATTERN, pattern_nbr, repeats]), 0)
+            tokens = tokens[:i] + [call] + tokens[i + n * repeats:]
+            self.tracks[track_nbr] = (first_delta, tokens)
+
+    # @brief Creates the binary song.
+    def serialize(self):
+        header = bytes([SEQUENCER_FORMAT_VERSION, self.song.tempo,
+                        len(self.tracks), len(self.patterns)])
+        table_size = len(self.tracks) * 3 + len(self.patterns) * 2
+        streams = []
+
+        for first_delta, tokens in self.tracks:
+            stream = vlq(first_delta)
+            for event, delta in tokens:
+                stream += event + (vlq(delta) if delta is not None else b"")
+            streams.append(stream)
+
+        for tokens in self.patterns:
+            stream = vlq(0)
+            for event, delta in tokens:
+                stream += event + vlq(delta)
+            streams.append(stream + bytes([EVENT_PATTERN_END]))
+
+        offset = len(header) + table_size
+        table = b""
+
+        for i, stream in enumerate(streams):
+            if i < len(self.tracks):
+                table += bytes([self.channels[i]])
+            table += struct.pack("<H", offset)
+            offset += len(stream)
+
+        if offset > 0xFFFF:
+            raise Song_error("%s: the song is larger than 64 kB" % self.song.name)
+
+        return header + table + b"".join(streams)
+
+    # @brief Plays a binary song once, until the end of its tracks.
+    # @details Follows the same rules as sequencer.c.
+    # @return One list per track of (tick, event) for the events pushed to
+    #         the event queue.
+    def decode(self, data):
+        return [events for events, _ in self.play(data)]
+
+    # @brief Finds the largest number of events run in one sequencer tick.
+    # @return (peak for one track, peak for all tracks together)
+    def peak_events_per_tick(self, data):
+        counts = [count for _, count in self.play(data)]
+        track_peak = max(max(c.values()) for c in counts)
+        ticks = set(t for c in counts for t in c)
+        song_peak = max(sum(c.get(t, 0) for c in counts) for t in ticks)
+        return (track_peak, song_peak)
+
+    def play(self, data):
+        nbr_of_tracks = data[2]
+        patterns = 4 + nbr_of_tracks * 3
+        results = []
+
+        for track_nbr in range(nbr_of_tracks):
+            pos = struct.unpack_from("<H", data, 4 + track_nbr * 3 + 1)[0]
+            calls = []
+            tick = 0
+            events = []
+            counts = {}
+
+            while True:
+                delta, pos = self.read_vlq(data, pos)
+                tick += delta
+                counts[tick] = counts.get(tick, 0) + 1
+                event = data[pos]
+
+                if event < EVENT_NOTE_OFF:
+                    events.append((tick, data[pos:pos + 2]))
+                    pos += 2
+                elif event == EVENT_PATTERN:
+                    start = struct.unpack_from("<H", data,
+                                               patterns + data[pos + 1] * 2)[0]
+                    calls.append([start, pos + 3, data[pos + 2]])
+                    pos = start
+                elif event == EVENT_PATTERN_END:
+                    calls[-1][2] -= 1
+                    if calls[-1][2]:
+                        pos = calls[-1][0]
+                    else:
+                        pos = calls.pop()[1]
+                elif event == EVENT_TRACK_END:
+                    break
+                else:
+                    size = {EVENT_NOTE_OFF: 1, EVENT_PATCH: 2, EVENT_CONTROL: 3,
+                            EVENT_PITCH_BEND: 3, EVENT_LOOP_POINT: 1,
+                            EVENT_TEMPO: 2}[event]
+                    if event != EVENT_LOOP_POINT:
+                        events.append((tick, data[pos:pos + size]))
+                    pos += size
+
+            results.append((events, counts))
+
+        return results
+
+    def read_vlq(self, data, pos):
+        value = 0
+        while data[pos] & 0x80:
+            value = (value << 7) | (data[pos] & 0x7F)
+            pos += 1
+        return (value << 7) | data[pos], pos + 1
+
+
+class Songs_file:
+    # @brief Compiles songs and writes them to a C file.
+    # @param filenames - The songs, in song number order.
+    # @param channel_map - Maps midi channels to audio channels.
+    # @param loop - True if songs without a loop point should loop.
+    # @return True if all songs were compiled.
+    def create(self, filenames, output = "songs.c",
+               channel_map = DEFAULT_CHANNEL_MAP, loop = False):
+        compiler = Song_compiler()
+        songs = []
+
+        for filename in filenames:
+            try:
+                if filename.lower().endswith((".mid", ".midi")):
+                    song = Smf_parser(channel_map).parse(filename, loop)
+                else:
+                    song = Mml_parser().parse(filename, loop)
+
+                flat_size = len(compiler.compile(song, False))
+                data = compiler.compile(song)
+                peaks = compiler.peak_events_per_tick(data)
+            except (Song_error, IndexError, struct.error) as e:
+                print("error: %s: %s" % (filename, e), file = sys.stderr)
+                return False
+
+            self.report(len(songs), song, data, flat_size,
+                        len(compiler.patterns), peaks)
+            songs.append((song, data))
+
+        with open(output, 'w') as f:
+            print("/*", file=f)
+            print("This file is an auto generated file.", file=f)
+            print("Do not modify its contents manually!", file=f)
+            print("Generated by song_compiler.py", file=f)
+            print("*/", file=f)
+            print("#include <stdint.h>", file=f)
+            print("#include \"songs.h\"", file=f)
+            print("", file=f)
+
+            for nbr, (song, data) in enumerate(songs):
+                print("// Song %u: %s, %u bytes" % (nbr, song.name, len(data)), file=f)
+                print("static const uint8_t " + self.array_name(song) + "[] =", file=f)
+                print("{", file=f)
+                for i in range(0, len(data), 12):
+                    print("    " + ", ".join("0x%02X" % b for b in data[i:i + 12]) + ",", file=f)
+                print("};", file=f)
+                print("", file=f)
+
+            print("const song_t g_songs[] =", file=f)
+            print("{", file=f)
+            for song, _ in songs:
+                name = self.array_name(song)
+                print("    { " + name + ", sizeof(" + name + ") },", file=f)
+            print("};", file=f)
+            print("", file=f)
+            print("const uint8_t g_songs_nbr_of_songs = sizeof(g_songs) / sizeof(song_t);", file=f)
+
+        return True
+
+    def array_name(self, song):
+        return "SONG_" + "".join(c if c.isalnum() else '_' for c in song.name).upper()
+
+    def report(self, nbr, song, data, flat_size, nbr_of_patterns, peaks):
+        print("Song %u: %s" % (nbr, song.name))
+        print("    tracks:           " + ", ".join(AUDIO_CH_NAMES[c] for c in sorted(song.tracks)))
+        print("    source:           %u bytes" % song.source_size)
+        print("    without patterns: %u bytes" % flat_size)
+        print("    compiled:         %u bytes, %u patterns, %.1f%% of the source"
+              % (len(data), nbr_of_patterns, 100.0 * len(data) / song.source_size))
+        print("    peak events/tick: %u per track, %u per song" % peaks)
+
+        if peaks[0] > SEQUENCER_MAX_EVENTS_PER_TICK:
+            song.warn("more than %u events in one tick on one track, "
+                      "the sequencer delays the rest" % SEQUENCER_MAX_EVENTS_PER_TICK)
+        # The queue keeps one slot free, so it holds EVENT_QUEUE_SIZE - 1 events
+        if peaks[1] >= EVENT_QUEUE_SIZE:
+            song.warn("more than %u events in one tick, the event queue "
+                      "overflows" % (EVENT_QUEUE_SIZE - 1))
+
+        for warning in song.warnings:
+            print("    warning: " + warning)
+
+
+# @brief Parses a channel map such as 0:0,1:1,2:2,9:3.
+# @details Midi channels are counted from 0, as in the status byte.
+def parse_channel_map(text):
+    channel_map = {}
+    for pair in text.split(','):
+        midi_channel, channel = (int(v) for v in pair.split(':'))
+        if not 0 <= midi_channel < 16 or not 0 <= channel < AUDIO_CH_NBR_OF_CHANNELS:
+            raise argparse.ArgumentTypeError("invalid channel pair " + pair)
+        channel_map[midi_channel] = channel
+    return channel_map
+
+# ===============================================================================
+# Module test
+# ===============================================================================
+
+if __name__ == "__main__":
+    arg_parser = argparse.ArgumentParser(description = "Compiles songs for the sequencer")
+    arg_parser.add_argument("songs", nargs = "*", help = "midi or mml files")
+    arg_parser.add_argument("-o", "--output", default = "songs.c")
+    arg_parser.add_argument("--map", type = parse_channel_map, default = DEFAULT_CHANNEL_MAP,
+                            help = "midi channel to audio channel map, e.g. 0:0,1:1,2:2,9:3")
+    arg_parser.add_argument("--loop", action = "store_true",
+                            help = "loop songs without a loop point from their beginning")
+    args = arg_parser.parse_args()
+
+    filenames = args.songs
+    if not filenames:
+        filenames = [os.path.join(SONGS_DIR, f) for f in sorted(os.listdir(SONGS_DIR))]
+
+    print("Song compiler started")
+    if not Songs_file().create(filenames, args.output, args.map, args.loop):
+        sys.exit(1)
+    print("Song compiler complete")
@@ -0,0 +1,25 @@
+/*
+This file is an auto generated file.
+Do not modify its contents manually!
+Generated by song_compiler.py
+*/
+#include <stdint.h>
+#include "songs.h"
+
+// Song 0: test_loop, 68 bytes
+static const uint8_t SONG_TEST_LOOP[] =
+{
+    0x01, 0x78, 0x02, 0x01, 0x00, 0x0C, 0x00, 0x02, 0x17, 0x00, 0x2A, 0x00,
+    0x00, 0x81, 0x00, 0x00, 0x86, 0x00, 0x84, 0x00, 0x02, 0x00, 0x87, 0x00,
+    0x81, 0x02, 0x00, 0x86, 0x00, 0x30, 0x70, 0x30, 0x2B, 0x70, 0x30, 0x30,
+    0x70, 0x30, 0x2B, 0x70, 0x30, 0x87, 0x00, 0x48, 0x60, 0x0C, 0x4C, 0x60,
+    0x0C, 0x4F, 0x60, 0x0C, 0x4C, 0x60, 0x0C, 0x48, 0x60, 0x0C, 0x4C, 0x60,
+    0x0C, 0x4F, 0x60, 0x0C, 0x54, 0x60, 0x0C, 0x85,
+};
+
+const song_t g_songs[] =
+{
+    { SONG_TEST_LOOP, sizeof(SONG_TEST_LOOP) },
+};
+
+const uint8_t g_songs_nbr_of_songs = sizeof(g_songs) / sizeof(song_t);
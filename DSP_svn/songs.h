@@ -1,5 +1,13 @@
-#ifndef TERMINAL_HELP_H
-#define	TERMINAL_HELP_H
+/*
+ * File:   songs.h
+ * Author: Erik
+ *
+ * The songs played by the sequencer, stored in flash in the format which is
+ * described in sequencer.h.
+ */
+
+#ifndef SONGS_H
+#define	SONGS_H
 
 #ifdef	__cplusplus
 //extern "C" {
@@ -8,15 +16,27 @@
 // =============================================================================
 // Include statements
 // =============================================================================
+#include <stdint.h>
 
 // =============================================================================
 // Public type definitions
 // =============================================================================
 
+typedef struct song_t
+{
+    const uint8_t*  data;
+    uint16_t        size;   // [bytes]
+} song_t;
+
 // =============================================================================
 // Global variable declarations
 // =============================================================================
 
+// The number of songs in g_songs.
+extern const uint8_t g_songs_nbr_of_songs;
+
+extern const song_t g_songs[];
+
 // =============================================================================
 // Global constatants
 // =============================================================================
@@ -25,15 +45,9 @@
 // Public function declarations
 // =============================================================================
 
-/*
- * @brief Prints help information to the terminal given a command.
- * @param help_command - the command to give help for.
- */
-void terminal_help(char* help_command);
-
 #ifdef	__cplusplus
 }
 #endif
 
-#endif	/* TERMINAL_HELP_H */
+#endif	/* SONGS_H */
 
@@ -63,6 +63,16 @@ void spi2_init(void);
  */
 void spi3_init(void);
 
+/**
+ * @brief Queues data to be sent to the PIC32 through the SPI3 module.
+ * @details The SPI3 module is a slave, the data is sent the next time
+ *          the PIC32 clocks the bus. Data is dropped if the transmit
+ *          buffer is full.
+ * @param data - The data to send, only the lower 8 bits are used.
+ * @return void
+ */
+void spi3_write(uint16_t data);
+
 
 // =============================================================================
 // Public function definitions
@@ -121,7 +131,7 @@ void spi_write(spi_device_t device, uint16_t data)
         break;
 
     case SPI_DEVICE_PIC32:
-        // TODO Add PIC32 SPI function call
+        spi3_write(data);
         break;
 
     case SPI_DEVICE_PCM1774:
@@ -292,8 +302,7 @@ void spi2_init(void)
 
 
 /*
- * TODO add doc ref to spi3 init
- *
+ * From PIC24FJ128GA202 datasheet, document number DS30010038C
  *
 16.4 Enhanced Slave Mode
 To set up the SPIx module for the Enhanced Buffer
@@ -320,7 +329,7 @@ ENHBUF bit (SPIxCON1L<0>).
  */
 void spi3_init(void)
 {
-if (false == spi3_initialized)
+    if (false == spi3_initialized)
     {
         // Unlock PPS registers
         __builtin_write_OSCCONL(OSCCON & 0xbf);
@@ -345,48 +354,38 @@ if (false == spi3_initialized)
         IFS5bits.SPI3TXIF = 0;
         IFS5bits.SPI3IF = 0;
 
-        // Enable interrup souce
-        IEC3bits.SPI3RXIE = 1;
-
-        // TODO Implement the spi3_init function
-        //IPC22bits.SPI3IP
-#ifdef UNIMPLEMENTED
-
-        // SPI1 control register 1 low
-        SPI1CON1L = 0x0000;
-
-        // 16 bit mode
-        SPI1CON1Lbits.MODE16 = 1;
-        SPI1CON1Lbits.MODE32 = 0;
-        // Input data is sampled at the middle of data output time
-        SPI1CON1Lbits.SMP = 0;
-        // Transmit happens on transition from active clock state to Idle clock state
-        SPI1CON1Lbits.CKE = 1;
-        // SSx pin is not used by the macro (SSx pin will be controlled by the port I/O)
-        SPI1CON1Lbits.SSEN = 0;
-        // Idle state for clock is a low level; active state is a high level
-        SPI1CON1Lbits.CKP = 0;
-        // Master mode
-        SPI1CON1Lbits.MSTEN = 1;
-        // SDI1 pin is controlled by the module
-        SPI1CON1Lbits.DISSDI = 1;
-        // SCK1 pin is controlled by the module
-        SPI1CON1Lbits.DISSCK = 0;
-        // Peripheral Clock (PBCLK) ? FCY is used by the BRG
-        SPI1CON1Lbits.MCLKEN = 0;
-        // Enhanced Buffer Mode is disabled
-        SPI1CON1Lbits.ENHBUF = 0;
-
-        SPI1CON2Lbits.WLENGTH = 0x0F; // 16-bit data length
+        // The received bytes are moved by the DMA, the CPU is not interrupted
+        IEC3bits.SPI3RXIE = 0;
+
+        SPI3CON1Lbits.SPIEN = 0;
+        SPI3CON1L = 0x0000;
+        SPI3CON1H = 0x0000;
+
+        // 8 bit mode
+        SPI3CON1Lbits.MODE16 = 0;
+        SPI3CON1Lbits.MODE32 = 0;
+        // SMP must be cleared in slave mode
+        SPI3CON1Lbits.SMP = 0;
+        // SPI mode 1, data is sampled on the falling clock edge. With CKE = 0
+        // the SS pin is not required, the frame sync byte is used to find
+        // the start of a message instead.
+        SPI3CON1Lbits.CKE = 0;
+        SPI3CON1Lbits.CKP = 0;
+        SPI3CON1Lbits.SSEN = 0;
+        // Slave mode
+        SPI3CON1Lbits.MSTEN = 0;
+        // SDI3 pin is controlled by the module
+        SPI3CON1Lbits.DISSDI = 0;
+        // Use the FIFO so that no bytes are lost while the DMA is busy
+        SPI3CON1Lbits.ENHBUF = 1;
+
+        // SPIx receive buffer full generates an event, this triggers the DMA
+        SPI3IMSKLbits.SPIRBFEN = 1;
+
+        SPI3STATLbits.SPIROV = 0;
+
+        SPI3CON1Lbits.SPIEN = 1;
 
-        // The SCK frequency is:
-        // FSCK = F_PB / (2 * (SPI1BRG + 1)) = 16MHz / (2 * (7 + 1)) = 1MHz
-        SPI1BRGL = 7;
-
-        SPI1STATLbits.SPIROV = 0;
-
-        SPI1CON1Lbits.SPIEN = 1;
-#endif
         spi3_initialized = true;
     }
 }
@@ -404,4 +403,12 @@ void spi1_write(uint16_t data)
     {
         ; // Wait for the transmit buffer to be empty
     }
+}
+
+void spi3_write(uint16_t data)
+{
+    if (0 == SPI3STATLbits.SPITBF)
+    {
+        SPI3BUFL = data & 0xFF;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+/*
+ * This file implements the periodic telemetry frames.
+ *
+ * The stage times are summed in timer counts between two frames and sent
+ * as per mille of the time of the ticks in between.
+ *
+ * At 9600 baud the UART carries 960 bytes per second, so a frame every tick
+ * would need three times the UART. The shortest period is therefore the
+ * number of ticks it takes to send one frame.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "telemetry.h"
+#include "frame.h"
+#include "control.h"
+#include "uart.h"
+#include "audio.h"
+#include "governor.h"
+#include "timer.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static uint8_t period = 0;
+static uint8_t ticks = 0;
+static uint16_t min_fill = SAMPLE_BUFF_POOL_SIZE;
+static uint32_t stage_time[TELEMETRY_NBR_OF_STAGES];
+static uint16_t skipped_frames = 0;
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+/**
+ * @brief Sends a telemetry frame and starts a new period.
+ * @param void
+ * @return void
+ */
+static void send_telemetry(void);
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void telemetry_init(void)
+{
+    telemetry_set_period(0);
+    skipped_frames = 0;
+}
+
+void telemetry_set_period(uint8_t new_period)
+{
+    uint8_t min_period =
+        ((TELEMETRY_SIZE + FRAME_OVERHEAD) * UART_BITS_PER_BYTE *
+         TIMER_FREQ_HZ + UART_BAUD - 1) / UART_BAUD;
+
+    if ((0 != new_period) && (new_period < min_period))
+    {
+        new_period = min_period;
+    }
+
+    period = new_period;
+    ticks = 0;
+    min_fill = SAMPLE_BUFF_POOL_SIZE;
+    memset(stage_time, 0, sizeof(stage_time));
+}
+
+uint8_t telemetry_get_period(void)
+{
+    return period;
+}
+
+uint16_t telemetry_get_skipped_frames(void)
+{
+    return skipped_frames;
+}
+
+void telemetry_encode(uint8_t* dst)
+{
+    uint8_t* p = dst;
+    audio_stats_t audio_stats;
+    uint32_t counts_per_mille;
+    uint8_t voices = 0;
+    uint8_t i;
+
+    audio_get_stats(&g_audio_engine, &audio_stats);
+
+    counts_per_mille = ((uint32_t)ticks * timer_get_counts_per_tick()) / 1000;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        if (audio_is_note_on(&g_audio_engine, (audio_ch_nbr_t)i) ||
+            (ADSR_STATE_OFF !=
+             audio_get_envelope_state(&g_audio_engine, (audio_ch_nbr_t)i)))
+        {
+            voices |= 1 << i;
+        }
+    }
+
+    p = frame_put_u32(p, timer_get_tick_count());
+    p = frame_put_u16(p, audio_get_sample_buff_size(&g_audio_engine));
+    p = frame_put_u16(p, min_fill);
+    p = frame_put_u16(p, audio_get_sample_buff_depth(&g_audio_engine));
+    p = frame_put_u32(p, audio_stats.underruns);
+
+    for (i = 0; i != TELEMETRY_NBR_OF_STAGES; ++i)
+    {
+        p = frame_put_u16(p, (0 != counts_per_mille) ?
+                             stage_time[i] / counts_per_mille : 0);
+    }
+
+    *p++ = voices;
+
+    for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
+    {
+        *p++ = audio_get_envelope_state(&g_audio_engine, (audio_ch_nbr_t)i);
+    }
+
+    *p++ = (uint8_t)governor_get_level();
+}
+
+void telemetry_add_time(telemetry_stage_t stage, uint16_t counts)
+{
+    if ((0 != period) && (stage < TELEMETRY_NBR_OF_STAGES))
+    {
+        stage_time[stage] += counts;
+    }
+}
+
+void telemetry_update(void)
+{
+    uint16_t tick_min_fill;
+
+    if (0 == period)
+    {
+        return;
+    }
+
+    tick_min_fill = audio_get_tick_min_fill(&g_audio_engine);
+
+    if (tick_min_fill < min_fill)
+    {
+        min_fill = tick_min_fill;
+    }
+
+    if (++ticks >= period)
+    {
+        if (uart_get_tx_free() < TELEMETRY_SIZE + FRAME_OVERHEAD)
+        {
+            ++skipped_frames;
+            telemetry_set_period(period);
+        }
+        else
+        {
+            send_telemetry();
+        }
+    }
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void send_telemetry(void)
+{
+    uint8_t payload[TELEMETRY_SIZE];
+    uint8_t buff[TELEMETRY_SIZE + FRAME_OVERHEAD];
+    uint16_t size;
+
+    telemetry_encode(payload);
+
+    size = frame_encode(CONTROL_OPCODE_SUBSCRIBE | CONTROL_REPLY_FLAG,
+                        payload, TELEMETRY_SIZE, buff);
+    uart_write_array(size, buff);
+
+    telemetry_set_period(period);
+}
@@ -0,0 +1,125 @@
+/*
+ * File:   telemetry.h
+ * Author: Erik
+ *
+ * Periodic telemetry frames on the UART.
+ *
+ * When subscribed, a telemetry frame (see CONTROL_OPCODE_SUBSCRIBE in
+ * control.h) is sent every n:th modulation tick. Besides the sample buffer
+ * state it holds the share of the time spent in each stage of the main loop
+ * and the state of the voices, so that transients can be followed on the
+ * host with telemetry_view.py.
+ *
+ * The same telemetry answers CONTROL_OPCODE_GET_TELEMETRY, so that there is
+ * one telemetry format. A periodic frame which does not fit in the UART
+ * transmit buffer is skipped and counted.
+ */
+
+#ifndef TELEMETRY_H
+#define	TELEMETRY_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+/*
+ * The stages of the main loop which are timed.
+ */
+typedef enum telemetry_stage_t
+{
+    TELEMETRY_STAGE_RENDER,         // Calculation of samples
+    TELEMETRY_STAGE_MODULATION,     // The modulation tick
+    TELEMETRY_STAGE_CONTROL,        // Terminal, link, control and log
+    TELEMETRY_NBR_OF_STAGES
+} telemetry_stage_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// The size of the telemetry payload in bytes.
+#define TELEMETRY_SIZE          (26u)
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Initializes the telemetry, without any subscription.
+ * @param void
+ * @return void
+ */
+void telemetry_init(void);
+
+/**
+ * @brief Sets how often telemetry frames are sent.
+ * @details A period shorter than the time the UART needs to send a frame
+ *          is lengthened to that time.
+ * @param new_period - The number of modulation ticks between the frames,
+ *                     0 stops the frames.
+ * @return void
+ */
+void telemetry_set_period(uint8_t new_period);
+
+/**
+ * @brief Gets how often telemetry frames are sent.
+ * @param void
+ * @return The number of modulation ticks between the frames, 0 if no frames
+ *         are sent.
+ */
+uint8_t telemetry_get_period(void);
+
+/**
+ * @brief Gets the number of periodic frames which were skipped since the
+ *        UART transmit buffer was full.
+ * @param void
+ * @return The number of skipped frames since telemetry_init.
+ */
+uint16_t telemetry_get_skipped_frames(void);
+
+/**
+ * @brief Encodes the telemetry since the last periodic frame.
+ * @details The payload layout is described at CONTROL_OPCODE_SUBSCRIBE in
+ *          control.h. Without a subscription the stage times are 0.
+ * @param dst - Buffer of at least TELEMETRY_SIZE bytes.
+ * @return void
+ */
+void telemetry_encode(uint8_t* dst);
+
+/**
+ * @brief Adds the time spent in a stage of the main loop.
+ * @details The time includes the interrupts which occurred in the stage.
+ * @param stage - The stage.
+ * @param counts - The time in timer counts, see timer_get_elapsed.
+ * @return void
+ */
+void telemetry_add_time(telemetry_stage_t stage, uint16_t counts);
+
+/**
+ * @brief Collects the telemetry of one tick and sends a frame when the
+ *        period has passed.
+ * @details Should be called every modulation tick, before
+ *          audio_update_stats.
+ * @param void
+ * @return void
+ */
+void telemetry_update(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* TELEMETRY_H */
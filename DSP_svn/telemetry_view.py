@@ -0,0 +1,170 @@
+# This script shows the telemetry frames of the dsp (see telemetry.h).
+#
+# The UART output is read from a serial port, a capture file or stdin. Every
+# telemetry frame is written as one line, or as one row of a CSV file. With
+# --plot the sample buffer level and the load of the main loop stages are
+# plotted with matplotlib, updated while the frames arrive.
+#
+# When reading from a serial port the subscription is started by sending a
+# CONTROL_OPCODE_SUBSCRIBE frame. The port should already be configured,
+# e.g. with stty.
+#
+# Usage:
+#   telemetry_view.py [--port /dev/ttyUSB0] [--period ticks] [--csv file]
+#                     [--plot] [capture file]
+
+import argparse
+import os
+import struct
+import sys
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+sys.path.insert(0, SCRIPT_DIR)
+import log_decode
+
+# Must be the same as in control.h
+CONTROL_OPCODE_SUBSCRIBE = 0x08
+
+# Must be the same as TIMER_FREQ_HZ in timer.c
+TIMER_FREQ_HZ = 100
+
+# The telemetry frame, see CONTROL_OPCODE_SUBSCRIBE in control.h
+TELEMETRY_FORMAT = "<IHHHIHHHB4BB"
+
+FIELDS = ["tick", "fill", "min_fill", "depth", "underruns", "render", "modulation",
+          "control", "voices", "env0", "env1", "env2", "env3", "governor"]
+
+ENVELOPE_STATES = "-ADSR"
+
+PLOT_INTERVAL = 10
+
+class Telemetry_view:
+    rows = []
+    csv_file = None
+    figure = None
+
+    def __init__(self, csv_file = None, plot = False):
+        self.rows = []
+        self.csv_file = csv_file
+        if self.csv_file:
+            self.csv_file.write(",".join(FIELDS) + "\n")
+        if plot:
+            import matplotlib.pyplot as plt
+            plt.ion()
+            self.figure, self.axes = plt.subplots(2, 1, sharex = True)
+
+    # @brief Formats a telemetry frame as one line of text.
+    # @param row - The fields of the frame.
+    def format_row(self, row):
+        t = dict(zip(FIELDS, row))
+        voices = "".join(str(ch) if t["voices"] & (1 << ch) else "." for ch in range(4))
+        envelopes = "".join(ENVELOPE_STATES[t["env%u" % ch]] if t["env%u" % ch] < len(ENVELOPE_STATES)
+                            else "?" for ch in range(4))
+        return ("%9.2f s  fill %4u/%-4u min %4u  underruns %6u  "
+                "render %5.1f%%  mod %5.1f%%  ctrl %5.1f%%  voices %s  env %s  gov %u" %
+                (t["tick"] / TIMER_FREQ_HZ, t["fill"], t["depth"], t["min_fill"], t["underruns"],
+                 t["render"] / 10.0, t["modulation"] / 10.0, t["control"] / 10.0,
+                 voices, envelopes, t["governor"]))
+
+    def add_frame(self, payload):
+        if len(payload) != struct.calcsize(TELEMETRY_FORMAT):
+            return
+
+        row = struct.unpack(TELEMETRY_FORMAT, payload)
+        self.rows.append(row)
+
+        if self.csv_file:
+            self.csv_file.write(",".join(str(v) for v in row) + "\n")
+        else:
+            print(self.format_row(row))
+
+        if self.figure and len(self.rows) % PLOT_INTERVAL == 0:
+            self.plot()
+
+    def plot(self):
+        import matplotlib.pyplot as plt
+
+        t = [row[0] / TIMER_FREQ_HZ for row in self.rows]
+        buffer_axes, load_axes = self.axes
+
+        buffer_axes.clear()
+        buffer_axes.plot(t, [row[1] for row in self.rows], label = "fill")
+        buffer_axes.plot(t, [row[2] for row in self.rows], label = "min fill")
+        buffer_axes.plot(t, [row[3] for row in self.rows], label = "depth")
+        buffer_axes.set_ylabel("samples")
+        buffer_axes.legend(loc = "upper left")
+
+        load_axes.clear()
+        for i, name in enumerate(["render", "modulation", "control"]):
+            load_axes.plot(t, [row[5 + i] / 10.0 for row in self.rows], label = name)
+        load_axes.set_ylabel("time %")
+        load_axes.set_xlabel("s")
+        load_axes.legend(loc = "upper left")
+
+        plt.pause(0.001)
+
+# @brief Reads the UART output and shows the telemetry frames.
+# @param stream - The UART output.
+# @param view - The Telemetry_view which shows the frames.
+def read_frames(stream, view):
+    reader = log_decode.Frame_reader()
+    while True:
+        data = stream.read1(256) if hasattr(stream, "read1") else stream.read(256)
+        if not data:
+            break
+        for opcode, payload in reader.feed(data):
+            if opcode == CONTROL_OPCODE_SUBSCRIBE | log_decode.CONTROL_REPLY_FLAG:
+                view.add_frame(payload)
+
+# @brief Encodes a subscription request.
+# @param period - The number of modulation ticks between the frames.
+def subscribe_frame(period):
+    crc = log_decode.Frame_reader().crc8(bytes([1, CONTROL_OPCODE_SUBSCRIBE, period]))
+    return bytes([log_decode.FRAME_SYNC, 1, CONTROL_OPCODE_SUBSCRIBE, period, crc])
+
+
+# ===============================================================================
+# Module test
+# ===============================================================================
+
+if __name__ == "__main__":
+    arg_parser = argparse.ArgumentParser(description = "Shows the telemetry of the dsp")
+    arg_parser.add_argument("capture", nargs = "?", help = "UART output, stdin if omitted")
+    arg_parser.add_argument("--port", help = "serial port to subscribe on and read from")
+    arg_parser.add_argument("--period", type = int, default = 10,
+                            help = "modulation ticks between the frames, 10 ms each")
+    arg_parser.add_argument("--csv", help = "write the frames to a CSV file")
+    arg_parser.add_argument("--plot", action = "store_true", help = "plot the frames")
+    args = arg_parser.parse_args()
+
+    if not 1 <= args.period <= 255:
+        arg_parser.error("the period must be in range [1, 255]")
+
+    csv_file = open(args.csv, "w") if args.csv else None
+    view = Telemetry_view(csv_file, args.plot)
+
+    try:
+        if args.port:
+            with open(args.port, "r+b", buffering = 0) as port:
+                port.write(subscribe_frame(args.period))
+                try:
+                    read_frames(port, view)
+                finally:
+                    port.write(subscribe_frame(0))
+        elif args.capture:
+            with open(args.capture, "rb") as f:
+                read_frames(f, view)
+        else:
+            read_frames(sys.stdin.buffer, view)
+    except KeyboardInterrupt:
+        pass
+
+    if csv_file:
+        csv_file.close()
+
+    if view.figure:
+        import matplotlib.pyplot as plt
+        view.plot()
+        plt.ioff()
+        plt.show()
@@ -15,16 +15,37 @@
 #include <stdio.h>
 
 #include "terminal.h"
-#include "terminal_help.h"
 #include "utilities.h"
 #include "uart.h"
 #include "pcm1774.h"
 #include "audio.h"
+#include "governor.h"
+#include "timer.h"
+#include "dma.h"
+#include "midi.h"
+#include "link.h"
+#include "event_queue.h"
+#include "cc_router.h"
+#include "patch.h"
+#include "sequencer.h"
+#include "control.h"
+#include "telemetry.h"
+#include "frame.h"
+#include "trace.h"
+#include "sched.h"
 
 // =============================================================================
 // Private type definitions
 // =============================================================================
 
+typedef struct terminal_command_t
+{
+    const char* name;
+    uint8_t     min_args;   // The number of mandatory parameters
+    void        (*handler)(char* cmd_buff);
+    const char* help;
+} terminal_command_t;
+
 // =============================================================================
 // Global variables
 // =============================================================================
@@ -38,12 +59,24 @@ static const char TERMINAL_PASSWORD[] = "open terminal";
 #define CMD_BUFFER_SIZE (128)
 static const char COMMAND_TERMINATION_CHARACTER = '\n';
 
+// Ctrl-C, aborts the running command.
+static const char COMMAND_ABORT_CHARACTER = 0x03;
+
 static const char TERMINAL_OPEN[]   = "\tTerminal is now open.\r\n";
 static const char COMMAND_ENTER[]   = "Command: ";
 static const char SYNTAX_ERROR[]    = "\t[Syntax error]\r\n";
+static const char COMMAND_ABORTED[] = "\t[Aborted]\r\n";
+
+// The main loop time which the commands may use per call of
+// terminal_process. A step which is started always runs to completion.
+static const uint16_t STEP_TIME_BUDGET_US = 500;
 
-static const char SET[]             = "set ";
-static const char GET[]             = "get ";
+// The most bytes a command step writes to the UART. A step is only started
+// when there is room for them in the transmit buffer.
+#define STEP_MAX_OUTPUT (320u)
+
+// The number of scope samples per frame, after the index and the count.
+#define SCOPE_SAMPLES_PER_FRAME ((FRAME_MAX_PAYLOAD - 4) / 2)
 
 //
 // Commands
@@ -82,7 +115,7 @@ static const char CMD_NOTE_ON[]         = "note on";
 
 /*
  Turns one note off.
- Parameters: <channel number> <note number>
+ Parameters: <channel number>
  */
 static const char CMD_NOTE_OFF[]        = "note off";
 
@@ -91,6 +124,37 @@ static const char CMD_NOTE_OFF[]        = "note off";
  */
 static const char CMD_ALL_NOTES_OFF[]   = "all notes off";
 
+/*
+ Resets the sample buffer statistics.
+ */
+static const char CMD_CLEAR_AUDIO_STATS[] = "clear audio stats";
+
+/*
+ Feeds raw MIDI bytes to the MIDI parser.
+ Parameters: <byte in hex> [<byte in hex> ...]
+ */
+static const char CMD_MIDI[]            = "midi";
+
+/*
+ Starts playing a song from the beginning.
+ Parameters: <song number>
+ */
+static const char CMD_PLAY_SONG[]       = "play song";
+
+/*
+ Stops the playing song.
+ */
+static const char CMD_STOP_SONG[]       = "stop song";
+
+/*
+ Resets the run time statistics of the main loop tasks.
+ */
+static const char CMD_CLEAR_SCHED_STATS[] = "clear scheduler stats";
+
+/*
+ Lists the commands, or describes one command.
+ Parameters: [<command>]
+ */
 static const char CMD_HELP[]            = "help";
 
 //
@@ -132,6 +196,75 @@ static const char GET_SQ1_CH_STAT[]     = "get square1 status";
  */
 static const char GET_TRI0_CH_STAT[]    = "get triangle0 status";
 
+/*
+ Gets the sample rate of the audio engine.
+ */
+static const char GET_SAMPLE_RATE[]     = "get sample rate";
+
+/*
+ Gets the current quality level of the audio governor.
+ */
+static const char GET_GOVERNOR[]        = "get governor level";
+
+/*
+ Gets the sample buffer underrun and overrun counters, the time of the
+ last underrun, the number of event queue overflows and the min fill
+ histogram of the sample buffer.
+ */
+static const char GET_AUDIO_STATS[]     = "get audio stats";
+
+/*
+ Gets the depth of the sample buffer and the resulting latency from a
+ note on until the note reaches the DAC.
+ */
+static const char GET_AUDIO_LATENCY[]   = "get audio latency";
+
+/*
+ Gets the number of received bytes and frames on the PIC32 link, the
+ number of discarded frames, the number of receive buffer overruns and the
+ number of clamped timed MIDI offsets.
+ */
+static const char GET_LINK_STATUS[]     = "get link status";
+
+/*
+ Lists the MIDI control numbers which are mapped to a synthesis parameter.
+ */
+static const char GET_CC_MAP[]          = "get cc map";
+
+/*
+ Lists the patches in the patch bank and the patch of each channel.
+ */
+static const char GET_PATCHES[]         = "get patches";
+
+/*
+ Gets the number of received bytes and frames of the binary control
+ protocol on the UART and the number of discarded frames.
+ */
+static const char GET_CONTROL_STATUS[]  = "get control status";
+
+/*
+ Gets the state of the scope. A completed capture is sent as binary
+ frames, which are decoded by scope_dump.py.
+ */
+static const char GET_SCOPE[]           = "get scope";
+
+/*
+ Sends the trace ring buffer as binary frames, which are converted to
+ a timeline by trace_decode.py, and empties it. The firmware must be
+ built with TRACE_ENABLED. Nothing is traced while the frames are sent.
+ If the command is aborted with Ctrl-C the trace mask is restored and
+ the records are kept.
+ */
+static const char GET_TRACE[]           = "get trace";
+
+/*
+ Gets the run time statistics of the main loop tasks: the number of
+ runs, the average and longest run time and the number of missed
+ deadlines. Also gets the duty cycle, the part of the latest second the
+ CPU was not in Idle.
+ */
+static const char GET_SCHEDULER[]       = "get scheduler";
+
 //
 // Set commands
 //
@@ -143,7 +276,7 @@ static const char SET_PCM1774_REG[]     = "set pcm1774 reg";
 
 /*
  Sets the main volume of the headphone amplifier.
- Paramters: <volume setting in range [0, 63]>
+ Parameters: <volume setting in range [0, 63]>
  */
 static const char SET_PCM1774_VOL[]     = "set main volume";
 
@@ -171,6 +304,108 @@ static const char SET_VIBRATO_ON[]      = "set vibrato on";
  */
 static const char SET_VIBRATO_OFF[]     = "set vibrato off";
 
+/*
+ Sets the sample rate of the DAC and the audio engine.
+ Parameters: <16000, 22050, 24000, 32000, 44100 or 48000>
+ */
+static const char SET_SAMPLE_RATE[]     = "set sample rate";
+
+/*
+ Enables or disables the automatic quality scaling of the audio engine.
+ Parameters: <1 = on, 0 = off>
+ */
+static const char SET_GOVERNOR[]        = "set governor";
+
+/*
+ Sets the depth of the sample buffer. A smaller buffer gives a lower
+ latency but is more sensitive to load spikes.
+ Parameters: <power of two in range [16, 256]>
+ */
+static const char SET_SAMPLE_BUFF_DEPTH[] = "set sample buffer depth";
+
+/*
+ Sets the volume of one audio channel in the digital mix.
+ Parameters: <audio channel number> <volume in range [0, 127]>
+ */
+static const char SET_VOLUME[]          = "set volume";
+
+/*
+ Sets the master volume of the digital mix.
+ Parameters: <volume in range [0, 127]>
+ */
+static const char SET_MASTER_VOLUME[]   = "set master volume";
+
+/*
+ Mutes or unmutes one audio channel.
+ Parameters: <audio channel number> <1 = mute, 0 = unmute>
+ */
+static const char SET_MUTE[]            = "set mute";
+
+/*
+ Solos or unsolos one audio channel. While any channel is soloed only
+ the soloed channels are heard.
+ Parameters: <audio channel number> <1 = solo, 0 = unsolo>
+ */
+static const char SET_SOLO[]            = "set solo";
+
+/*
+ Maps a MIDI control number to a synthesis parameter.
+ Parameters: <control number [0, 127]> <parameter>
+ where parameter is 0 = none, 1 = volume, 2 = duty, 3 = vibrato rate,
+ 4 = vibrato depth, 5 = attack, 6 = decay, 7 = sustain, 8 = release
+ */
+static const char SET_CC_MAP[]          = "set cc map";
+
+/*
+ Bends the pitch of a square or triangle channel.
+ Parameters: <audio channel number> <bend value [0, 16383]>
+ 8192 gives no bend.
+ */
+static const char SET_PITCH_BEND[]      = "set pitch bend";
+
+/*
+ Sets the pitch bend range of a square or triangle channel.
+ Parameters: <audio channel number> <range in semitones [0, 24]>
+ */
+static const char SET_BEND_RANGE[]      = "set bend range";
+
+/*
+ Selects the patch of one audio channel.
+ The patch is loaded at the next modulation tick.
+ Parameters: <audio channel number> <patch number>
+ */
+static const char SET_PATCH[]           = "set patch";
+
+/*
+ Sets the tempo of the playing song.
+ Parameters: <beats per minute>
+ */
+static const char SET_TEMPO[]           = "set tempo";
+
+/*
+ Sends a binary telemetry frame every n:th modulation tick, see
+ control.h and telemetry_view.py. Prints the period which is used, which
+ is at least the time the UART needs to send a frame, and the number of
+ frames skipped since the UART was full.
+ Parameters: <ticks between the frames [0, 255], 0 = off>
+ */
+static const char SET_TELEMETRY[]       = "set telemetry";
+
+/*
+ Arms the scope, which records the samples around the next trigger.
+ Parameters: <source> <trigger> [<level>]
+ where source is the audio channel number, or 4 for the mix, and
+ trigger is 0 = now, 1 = note on, 2 = underrun, 3 = level. The level
+ trigger fires when |sample| >= level.
+ */
+static const char SET_SCOPE[]           = "set scope";
+
+/*
+ Selects the traced events, one bit per trace_id_t in trace.h.
+ Parameters: <mask in hex>
+ */
+static const char SET_TRACE[]           = "set trace";
+
 // =============================================================================
 // Private variables
 // =============================================================================
@@ -179,16 +414,30 @@ static bool command_received_event = false;
 static bool terminal_open = false;
 static char* reply_buff;
 
+static char cmd_buff[CMD_BUFFER_SIZE] = {0};
+static uint16_t cmd_buff_len = 0;
+
+// The command which is being executed, NULL if none. A handler which has
+// more to do calls continue_command, and is called again with command_step
+// set to the step it passed.
+static const terminal_command_t* running_command = NULL;
+static char* running_line;
+static uint16_t command_step = 0;
+static bool command_continues = false;
+
+// Parser for the MIDI bytes fed through the terminal.
+static midi_parser_t midi_parser;
+
 // =============================================================================
 // Private function declarations
 // =============================================================================
 
 /**
- * @brief Runs the terminal mode.
+ * @brief Opens the terminal if the password has been received.
  * @param void
  * @return void
  */
-void terminal_mode_run(void);
+static void check_password(void);
 
 /**
  * @brief Updates the command buffer with any received characters.
@@ -201,45 +450,198 @@ void update_cmd_buffer(char* cmd_buff,
                        uint16_t buffer_size);
 
 /**
- * @brief Executes the command stored in the command buffer.
+ * @brief Starts the command stored in the command buffer.
+ * @details The command is executed by run_command_step.
  * @param cmd_buff - The command buffer in which the command is stored.
- * @param cmd_buff_len - A pointer to the number of char's in the cmd buffer.
- * @param buffer_size - The maximum size of the buffer.
  */
-void execute_command(char* cmd_buff,
-                     uint16_t* cmd_buff_len,
-                     uint16_t buffer_size);
+static void start_command(char* cmd_buff);
+
+/**
+ * @brief Calls the handler of the running command once.
+ * @param void
+ * @return void
+ */
+static void run_command_step(void);
+
+/**
+ * @brief Ends the running command and clears the command buffer.
+ * @param void
+ * @return void
+ */
+static void end_command(void);
+
+/**
+ * @brief Aborts the running command if Ctrl-C has been received.
+ * @details The characters received while a command is running are kept
+ *          for the next command, unless the command is aborted. A command
+ *          which has started a multi step operation in another module,
+ *          such as the sending of the trace, is ended there.
+ * @param void
+ * @return void
+ */
+static void check_abort(void);
+
+/**
+ * @brief Called by a command handler which has more to do. The handler is
+ *        called again at a later step, so that the audio rendering is not
+ *        delayed by long commands.
+ * @param step - The value of command_step at the next call.
+ * @return void
+ */
+static void continue_command(uint16_t step);
+
+/**
+ * @brief Checks if a command step may be started now.
+ * @details There must be room for the output of the step, and enough
+ *          samples in the sample buffer to cover the time of the step.
+ * @param void
+ * @return True if a step may be started.
+ */
+static bool can_run_step(void);
 
 /* **********************************************
  *  Commands
  ***********************************************/
 // Get commands
-static void get_spi1_stat(void);
-static void get_spi2_stat(void);
-static void get_dma0_stat(void);
-static void get_sample_buffer_size(void);
-static void get_sq0_stat(void);
-static void get_sq1_stat(void);
-static void get_tri0_stat(void);
+static void get_spi1_stat(char* cmd_buff);
+static void get_spi2_stat(char* cmd_buff);
+static void get_dma0_stat(char* cmd_buff);
+static void get_sample_buff_size(char* cmd_buff);
+static void get_sq0_ch_stat(char* cmd_buff);
+static void get_sq1_ch_stat(char* cmd_buff);
+static void get_tri0_ch_stat(char* cmd_buff);
+static void get_sample_rate(char* cmd_buff);
+static void get_governor(char* cmd_buff);
+static void get_audio_stats(char* cmd_buff);
+static void get_audio_latency(char* cmd_buff);
+static void get_link_status(char* cmd_buff);
+static void get_cc_map(char* cmd_buff);
+static void get_patches(char* cmd_buff);
+static void get_control_status(char* cmd_buff);
+static void get_scope(char* cmd_buff);
+static void get_trace(char* cmd_buff);
+static void get_scheduler(char* cmd_buff);
 
 // Set commands
 static void set_pcm1774_reg(char* cmd_buff);
-static void set_volume(char* cmd_buff);
+static void set_pcm1774_vol(char* cmd_buff);
 static void set_duty(char* cmd_buff);
 static void set_vibrato_conf(char* cmd_buff);
 static void set_vibrato_on(char* cmd_buff);
 static void set_vibrato_off(char* cmd_buff);
+static void set_sample_rate(char* cmd_buff);
+static void set_governor(char* cmd_buff);
+static void set_sample_buff_depth(char* cmd_buff);
+static void set_volume(char* cmd_buff);
+static void set_master_volume(char* cmd_buff);
+static void set_mute(char* cmd_buff);
+static void set_solo(char* cmd_buff);
+static void set_cc_map(char* cmd_buff);
+static void set_pitch_bend(char* cmd_buff);
+static void set_bend_range(char* cmd_buff);
+static void set_patch(char* cmd_buff);
+static void set_tempo(char* cmd_buff);
+static void set_telemetry(char* cmd_buff);
+static void set_scope(char* cmd_buff);
+static void set_trace(char* cmd_buff);
 
 // Commands
 static void cmd_note_on(char* cmd_buff);
 static void cmd_note_off(char* cmd_buff);
-static void cmd_all_notes_off(void);
+static void cmd_all_notes_off(char* cmd_buff);
+static void cmd_clear_audio_stats(char* cmd_buff);
+static void cmd_midi(char* cmd_buff);
+static void cmd_play_song(char* cmd_buff);
+static void cmd_stop_song(char* cmd_buff);
+static void cmd_help(char* cmd_buff);
+static void cmd_exit(char* cmd_buff);
+static void cmd_system_reset(char* cmd_buff);
+static void cmd_pcm1774_analog(char* cmd_buff);
+static void cmd_pcm1774_init(char* cmd_buff);
+static void cmd_trigger_dma0(char* cmd_buff);
+static void cmd_clear_sched_stats(char* cmd_buff);
+
+/**
+ * @brief Finds the command which a command line starts with.
+ * @param line - The command line.
+ * @return The command, or NULL if the line does not start with a command.
+ */
+static const terminal_command_t* find_command(const char* line);
+
+/**
+ * @brief Counts the parameters of a command.
+ * @param params - The part of the command line after the command.
+ * @return The number of space separated parameters.
+ */
+static uint8_t count_params(const char* params);
+
+static inline bool is_space(char c);
+
+// The command table, generated by terminal_doc_gen.py from the command
+// documentation above.
+#include "terminal_commands.h"
 
 // =============================================================================
 // Public function definitions
 // =============================================================================
 
-void terminal_check_access(void)
+void terminal_init(void)
+{
+    midi_parser_init(&midi_parser);
+}
+
+void terminal_process(void)
+{
+    char reply_buffer[128];
+    uint16_t start = timer_get_time();
+    uint16_t budget;
+
+    if (!terminal_open)
+    {
+        check_password();
+
+        return;
+    }
+
+    reply_buff = reply_buffer;
+
+    if (NULL == running_command)
+    {
+        update_cmd_buffer(cmd_buff, &cmd_buff_len, CMD_BUFFER_SIZE);
+
+        if (command_received_event)
+        {
+            command_received_event = false;
+
+            start_command(cmd_buff);
+        }
+    }
+    else
+    {
+        check_abort();
+    }
+
+    budget = ((uint32_t)STEP_TIME_BUDGET_US * TIMER_FREQ_HZ *
+              timer_get_counts_per_tick()) / 1000000ul;
+
+    while ((NULL != running_command) &&
+           (timer_get_elapsed(start) < budget) &&
+           can_run_step())
+    {
+        run_command_step();
+    }
+}
+
+bool terminal_is_busy(void)
+{
+    return (NULL != running_command) && can_run_step();
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
+static void check_password(void)
 {
     uint16_t bytes_received;
     uint16_t index;
@@ -267,39 +669,12 @@ void terminal_check_access(void)
         if (password_ok)
         {
             uart_clear_receive_buffer();
-            terminal_mode_run();
-        }
-    }
-}
-
-// =============================================================================
-// Private function definitions
-// =============================================================================
-
-
-void terminal_mode_run(void)
-{
-    terminal_open = true;
 
-    char cmd_buff[CMD_BUFFER_SIZE] = {0};
-    uint16_t cmd_buff_len = 0;
-
-    uart_write_string(NEWLINE);
-    uart_write_string(TERMINAL_OPEN);
-    uart_write_string(COMMAND_ENTER);
-
-    while (terminal_open)
-    {
-        // Clear the WatchDog Timer
-        ClrWdt();
-
-        update_cmd_buffer(cmd_buff, &cmd_buff_len, CMD_BUFFER_SIZE);
-
-        if (command_received_event)
-        {
-            command_received_event = false;
+            terminal_open = true;
 
-            execute_command(cmd_buff, &cmd_buff_len, CMD_BUFFER_SIZE);
+            uart_write_string(NEWLINE);
+            uart_write_string(TERMINAL_OPEN);
+            uart_write_string(COMMAND_ENTER);
         }
     }
 }
@@ -312,10 +687,8 @@ void update_cmd_buffer(char* cmd_buff,
     uint16_t index;
     uint16_t cmd_buff_start;
 
-    if (g_uart_receive_event)
+    if (!uart_is_receive_buffer_empty())
     {
-        g_uart_receive_event = false;
-
         uart_disable_rx_interrupt();
 
         bytes_received = uart_get_receive_buffer_size();
@@ -352,122 +725,49 @@ void update_cmd_buffer(char* cmd_buff,
     }
 }
 
-void execute_command(char* cmd_buff,
-                     uint16_t* cmd_buff_len,
-                     uint16_t buffer_size)
+static void start_command(char* cmd_buff)
 {
-    uint16_t i = 0;
-    bool syntax_error = false;
-    char reply_buffer[128];
-    reply_buff = reply_buffer;
+    const terminal_command_t* command;
+    char* line = cmd_buff;
 
-
-    if (NULL != strstr(cmd_buff, CMD_HELP))
-    {
-        terminal_help(cmd_buff);
-    }
-    else if (NULL != strstr(cmd_buff, GET))
-    {
-        //
-        // GET
-        //
-        if  (NULL != strstr(cmd_buff, GET_SPI1_STAT))
-            get_spi1_stat();
-        else if (NULL != strstr(cmd_buff, GET_SPI2_STAT))
-            get_spi2_stat();
-        else if (NULL != strstr(cmd_buff, GET_DMA0_STAT))
-            get_dma0_stat();
-        else if (NULL != strstr(cmd_buff, GET_SAMPLE_BUFF_SIZE))
-            get_sample_buffer_size();
-        else if (NULL != strstr(cmd_buff, GET_SQ0_CH_STAT))
-            get_sq0_stat();
-        else if (NULL != strstr(cmd_buff, GET_SQ1_CH_STAT))
-            get_sq1_stat();
-        else if (NULL != strstr(cmd_buff, GET_TRI0_CH_STAT))
-            get_tri0_stat();
-        else
-        {
-            syntax_error = true;
-        }
-        
+    while (is_space(*line))
+    {
+        ++line;
     }
-    else if (NULL != strstr(cmd_buff, SET))
-    {
-        //
-        // SET
-        //
-
-        if (NULL != strstr(cmd_buff, SET_PCM1774_REG))
-            set_pcm1774_reg(cmd_buff);
-        else if (NULL != strstr(cmd_buff, SET_PCM1774_VOL))
-            set_volume(cmd_buff);
-        else if (NULL != strstr(cmd_buff, SET_DUTY))
-            set_duty(cmd_buff);
-        else if (NULL != strstr(cmd_buff, SET_VIBRATO_CONF))
-            set_vibrato_conf(cmd_buff);
-        else if (NULL != strstr(cmd_buff, SET_VIBRATO_ON))
-            set_vibrato_on(cmd_buff);
-        else if (NULL != strstr(cmd_buff, SET_VIBRATO_OFF))
-            set_vibrato_off(cmd_buff);
-        else
-        {
-            syntax_error = true;
-        }
-        
+
+    command = find_command(line);
+
+    if ((NULL == command) ||
+        (count_params(line + strlen(command->name)) < command->min_args))
+    {
+        uart_write_string(SYNTAX_ERROR);
+        end_command();
     }
     else
     {
-        //
-        // CMD
-        //
-        if (NULL != strstr(cmd_buff, CMD_NOTE_ON))
-            cmd_note_on(cmd_buff);
-        else if (NULL != strstr(cmd_buff, CMD_NOTE_OFF))
-            cmd_note_off(cmd_buff);
-        else if (NULL != strstr(cmd_buff, CMD_ALL_NOTES_OFF))
-            cmd_all_notes_off();
-        else if (NULL != strstr(cmd_buff, CMD_EXIT))
-        {
-            terminal_open = false;
-
-            uart_write_string("\tTerminal closed.");
-            uart_write_string(NEWLINE);
-        }
-        else if (NULL != strstr(cmd_buff, CMD_SYSTEM_RESET))
-        {
-            __asm__ volatile ("reset");
-        }
-        else if (NULL != strstr(cmd_buff, CMD_PCM1774_ANALOG))
-        {
-            uart_write_string("\tSetting the PCM1774 in analog to analog mode");
-            uart_write_string(NEWLINE);
-
-            pcm1774_analog_to_analog_mode();
-        }
-        else if (NULL != strstr(cmd_buff, CMD_PCM1774_INIT))
-        {
-            uart_write_string("\tInitializing the PCM1774");
-            uart_write_string(NEWLINE);
+        running_command = command;
+        running_line = line;
+        command_step = 0;
+    }
+}
 
-            pcm1774_init();
-        }
-        else if (NULL != strstr(cmd_buff, CMD_TRIGGER_DMA0))
-        {
-            uart_write_string("\tDMA0 triggered");
-            uart_write_string(NEWLINE);
+static void run_command_step(void)
+{
+    command_continues = false;
 
-            DMACH0bits.CHREQ = 1;
-        }
-        else
-        {
-            syntax_error = true;
-        }
-    }
+    running_command->handler(running_line);
 
-    if (syntax_error)
+    if (!command_continues)
     {
-        uart_write_string(SYNTAX_ERROR);
+        end_command();
     }
+}
+
+static void end_command(void)
+{
+    uint16_t i;
+
+    running_command = NULL;
 
     if (terminal_open)
     {
@@ -480,24 +780,74 @@ void execute_command(char* cmd_buff,
         cmd_buff[i] = 0;
     }
 
-    *cmd_buff_len = 0;
-
-    
+    cmd_buff_len = 0;
 }
 
-/* *******************************************************
- * Command help functions
- *********************************************************/
-
-static void get_spi1_stat(void)
+static void check_abort(void)
 {
-    sprintf(reply_buff, "\tSPI1STATH: %4.4x SPI1STATL: %4.4x%s",
-            SPI1STATH, SPI1STATL, NEWLINE);
-    uart_write_string(reply_buff);
+    uint16_t bytes_received;
+    uint16_t index;
+    bool abort = false;
 
-    sprintf(reply_buff, "\tSPI1CON1L: %4.4x SPI1CON1H: %4.4x%s",
-            SPI1CON1L, SPI1CON1H, NEWLINE);
-    uart_write_string(reply_buff);
+    if (uart_is_receive_buffer_empty())
+    {
+        return;
+    }
+
+    uart_disable_rx_interrupt();
+
+    bytes_received = uart_get_receive_buffer_size();
+
+    for (index = 0; index != bytes_received; ++index)
+    {
+        if (COMMAND_ABORT_CHARACTER == uart_get(index))
+        {
+            abort = true;
+        }
+    }
+
+    if (abort)
+    {
+        uart_clear_receive_buffer();
+    }
+
+    uart_enable_rx_interrupt();
+
+    if (abort)
+    {
+        trace_send_abort();
+
+        uart_write_string(COMMAND_ABORTED);
+        end_command();
+    }
+}
+
+static void continue_command(uint16_t step)
+{
+    command_step = step;
+    command_continues = true;
+}
+
+static bool can_run_step(void)
+{
+    return (uart_get_tx_free() >= STEP_MAX_OUTPUT) &&
+           (audio_get_sample_buff_size(&g_audio_engine) >=
+            (audio_get_sample_buff_depth(&g_audio_engine) / 2));
+}
+
+/* *******************************************************
+ * Command help functions
+ *********************************************************/
+
+static void get_spi1_stat(char* cmd_buff)
+{
+    sprintf(reply_buff, "\tSPI1STATH: %4.4x SPI1STATL: %4.4x%s",
+            SPI1STATH, SPI1STATL, NEWLINE);
+    uart_write_string(reply_buff);
+
+    sprintf(reply_buff, "\tSPI1CON1L: %4.4x SPI1CON1H: %4.4x%s",
+            SPI1CON1L, SPI1CON1H, NEWLINE);
+    uart_write_string(reply_buff);
 
     sprintf(reply_buff, "\tSPI1IMSKL: %4.4x SPI1IMASKH: %4.4x%s",
             SPI1IMSKL, SPI1IMSKH, NEWLINE);
@@ -508,7 +858,7 @@ static void get_spi1_stat(void)
     uart_write_string(reply_buff);
 }
 
-static void get_spi2_stat(void)
+static void get_spi2_stat(char* cmd_buff)
 {
     sprintf(reply_buff, "\tSPI2STATH: %4.4x SPI2STATL: %4.4x%s",
             SPI2STATH, SPI2STATL, NEWLINE);
@@ -527,7 +877,7 @@ static void get_spi2_stat(void)
     uart_write_string(reply_buff);
 }
 
-static void get_dma0_stat(void)
+static void get_dma0_stat(char* cmd_buff)
 {
     sprintf(reply_buff, "\tDMACON: %4.4x%s",
             DMACON, NEWLINE);
@@ -550,10 +900,10 @@ static void get_dma0_stat(void)
     uart_write_string(reply_buff);
 }
 
-static void get_sample_buffer_size(void)
+static void get_sample_buff_size(char* cmd_buff)
 {
     sprintf(reply_buff, "\tSample buffer size: %d%s",
-            audio_get_sample_buff_size(), NEWLINE);
+            audio_get_sample_buff_size(&g_audio_engine), NEWLINE);
     uart_write_string(reply_buff);
 }
 
@@ -573,7 +923,7 @@ static void set_pcm1774_reg(char* cmd_buff)
     pcm1774_write_reg((uint8_t)arg1, (uint8_t)arg2);
 }
 
-static void set_volume(char* cmd_buff)
+static void set_pcm1774_vol(char* cmd_buff)
 {
     char* p = cmd_buff;
     uint8_t vol = 0;
@@ -586,19 +936,28 @@ static void set_volume(char* cmd_buff)
     pcm1774_set_volume(vol);
 }
 
-static void get_sq0_stat(void)
+static void get_sq0_ch_stat(char* cmd_buff)
 {
-    audio_print_channel_status(AUDIO_CH_SQUARE0);
+    if (audio_print_channel_status(&g_audio_engine, AUDIO_CH_SQUARE0, command_step))
+    {
+        continue_command(command_step + 1);
+    }
 }
 
-static void get_sq1_stat(void)
+static void get_sq1_ch_stat(char* cmd_buff)
 {
-    audio_print_channel_status(AUDIO_CH_SQUARE1);
+    if (audio_print_channel_status(&g_audio_engine, AUDIO_CH_SQUARE1, command_step))
+    {
+        continue_command(command_step + 1);
+    }
 }
 
-static void get_tri0_stat(void)
+static void get_tri0_ch_stat(char* cmd_buff)
 {
-    audio_print_channel_status(AUDIO_CH_TRIANGLE0);
+    if (audio_print_channel_status(&g_audio_engine, AUDIO_CH_TRIANGLE0, command_step))
+    {
+        continue_command(command_step + 1);
+    }
 }
 
 static void cmd_note_on(char* cmd_buff)
@@ -617,7 +976,7 @@ static void cmd_note_on(char* cmd_buff)
     ++p; // for space
     velocity = strtol(p, &p, 10);
 
-    audio_note_on((audio_ch_nbr_t)channel, note, velocity);
+    audio_note_on(&g_audio_engine, (audio_ch_nbr_t)channel, note, velocity);
 
     sprintf(reply_buff, "\tNote on channel %u, note: %u, velocity: %u%s",
             channel, note, velocity, NEWLINE);
@@ -634,20 +993,20 @@ static void cmd_note_off(char* cmd_buff)
 
     channel = strtol(p, &p, 10);
 
-    audio_note_off((audio_ch_nbr_t)channel);
+    audio_note_off(&g_audio_engine, (audio_ch_nbr_t)channel);
 
     sprintf(reply_buff, "\tNote off channel %u%s",
             channel, NEWLINE);
     uart_write_string(reply_buff);
 }
 
-static void cmd_all_notes_off(void)
+static void cmd_all_notes_off(char* cmd_buff)
 {
     uint16_t i;
 
     for (i = 0; i != AUDIO_CH_NBR_OF_CHANNELS; ++i)
     {
-        audio_note_off((audio_ch_nbr_t)i);
+        audio_note_off(&g_audio_engine, (audio_ch_nbr_t)i);
     }
 
     sprintf(reply_buff, "\tNote off on all channels%s", NEWLINE);
@@ -667,7 +1026,7 @@ static void set_duty(char* cmd_buff)
     ++p;
     duty = strtol(p, &p, 10);
 
-    audio_set_duty((audio_ch_nbr_t)channel, duty);
+    audio_set_duty(&g_audio_engine, (audio_ch_nbr_t)channel, duty);
 
     sprintf(reply_buff, "\tSet duty channel %u, duty: %u%s",
             channel, duty, NEWLINE);
@@ -690,7 +1049,10 @@ static void set_vibrato_conf(char* cmd_buff)
     ++p;    // for space
     depth = strtol(p, &p, 10);
 
-    audio_configure_vibrato((audio_ch_nbr_t)channel, rate, depth);
+    audio_configure_vibrato(&g_audio_engine,
+                            (audio_ch_nbr_t)channel,
+                            rate,
+                            depth);
 
     sprintf(reply_buff,
             "\tSet vibrato config channel: %u, rate: %u, depth: %u%s",
@@ -708,7 +1070,7 @@ static void set_vibrato_on(char* cmd_buff)
 
     channel = strtol(p, &p, 10);
 
-    audio_vibrato_on((audio_ch_nbr_t)channel);
+    audio_vibrato_on(&g_audio_engine, (audio_ch_nbr_t)channel);
 
     sprintf(reply_buff, "\tSet vibrato on channel: %u%s",
             channel, NEWLINE);
@@ -725,9 +1087,873 @@ static void set_vibrato_off(char* cmd_buff)
 
     channel = strtol(p, &p, 10);
 
-    audio_vibrato_off((audio_ch_nbr_t)channel);
+    audio_vibrato_off(&g_audio_engine, (audio_ch_nbr_t)channel);
 
     sprintf(reply_buff, "\tSet vibrato off channel: %u%s",
             channel, NEWLINE);
     uart_write_string(reply_buff);
+}
+
+static void get_sample_rate(char* cmd_buff)
+{
+    sprintf(reply_buff, "\tSample rate: %u Hz%s",
+            audio_get_sample_freq(&g_audio_engine), NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_sample_rate(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint16_t sample_freq = 0;
+    bool rate_ok;
+
+    p = strstr(cmd_buff, SET_SAMPLE_RATE);
+    p += strlen(SET_SAMPLE_RATE) + 1;   // +1 for space
+
+    sample_freq = strtol(p, &p, 10);
+
+    // The engine is switched first, and the samples in the sample buffer
+    // are dropped since they were calculated for the old rate. Played at
+    // the new rate they would be a short glitch in pitch, now there is a
+    // short gap instead. The DAC supports the same rates as the engine.
+    dma_i2s_int_disable();
+    rate_ok = audio_set_sample_freq(&g_audio_engine, sample_freq);
+
+    if (rate_ok)
+    {
+        audio_set_sample_buff_depth(
+            &g_audio_engine,
+            audio_get_sample_buff_depth(&g_audio_engine));
+    }
+
+    dma_i2s_int_enable();
+
+    if (rate_ok && pcm1774_set_sample_freq(sample_freq))
+    {
+        sprintf(reply_buff, "\tSet sample rate: %u Hz%s",
+                sample_freq, NEWLINE);
+    }
+    else
+    {
+        sprintf(reply_buff, "\tSample rate %u Hz is not supported%s",
+                sample_freq, NEWLINE);
+    }
+
+    uart_write_string(reply_buff);
+}
+
+static void get_governor(char* cmd_buff)
+{
+    sprintf(reply_buff, "\tGovernor level: %u%s",
+            governor_get_level(), NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_governor(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t enabled = 0;
+
+    p = strstr(cmd_buff, SET_GOVERNOR);
+    p += strlen(SET_GOVERNOR) + 1;   // +1 for space
+
+    enabled = strtol(p, &p, 10);
+
+    governor_set_enabled(0 != enabled);
+
+    sprintf(reply_buff, "\tSet governor: %u%s",
+            (0 != enabled), NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void get_audio_stats(char* cmd_buff)
+{
+    audio_stats_t stats;
+    uint16_t bin_size;
+    uint8_t i;
+
+    audio_get_stats(&g_audio_engine, &stats);
+    bin_size = audio_get_sample_buff_depth(&g_audio_engine) /
+               AUDIO_STATS_HISTOGRAM_SIZE;
+
+    if (0 == command_step)
+    {
+        sprintf(reply_buff, "\tUnderruns: %lu%s\tOverruns: %lu%s",
+                stats.underruns, NEWLINE, stats.overruns, NEWLINE);
+        uart_write_string(reply_buff);
+
+        sprintf(reply_buff, "\tLast underrun: %lu ms\t(now: %lu ms)%s",
+                stats.last_underrun_tick * (1000 / TIMER_FREQ_HZ),
+                timer_get_tick_count() * (1000 / TIMER_FREQ_HZ), NEWLINE);
+        uart_write_string(reply_buff);
+
+        sprintf(reply_buff, "\tEvent queue overflows: %u%s",
+                event_queue_get_overflows(), NEWLINE);
+        uart_write_string(reply_buff);
+
+        uart_write_string("\tMin fill histogram:");
+        uart_write_string(NEWLINE);
+
+        continue_command(1);
+
+        return;
+    }
+
+    // One histogram bin per step
+    i = command_step - 1;
+
+    sprintf(reply_buff, "\t\t[%3u, %3u]: %lu%s",
+            i * bin_size, (i + 1) * bin_size - 1,
+            stats.min_fill_histogram[i], NEWLINE);
+    uart_write_string(reply_buff);
+
+    if (i + 1 < AUDIO_STATS_HISTOGRAM_SIZE)
+    {
+        continue_command(command_step + 1);
+    }
+}
+
+static void cmd_clear_audio_stats(char* cmd_buff)
+{
+    audio_reset_stats(&g_audio_engine);
+
+    uart_write_string("\tAudio stats cleared");
+    uart_write_string(NEWLINE);
+}
+
+static void get_audio_latency(char* cmd_buff)
+{
+    sprintf(reply_buff, "\tSample buffer depth: %u (pool: %u)%s",
+            audio_get_sample_buff_depth(&g_audio_engine),
+            SAMPLE_BUFF_POOL_SIZE,
+            NEWLINE);
+    uart_write_string(reply_buff);
+
+    sprintf(reply_buff, "\tLatency: %lu us at %u Hz%s",
+            audio_get_latency_us(&g_audio_engine),
+            audio_get_sample_freq(&g_audio_engine),
+            NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_sample_buff_depth(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint16_t depth = 0;
+    bool depth_ok;
+
+    p = strstr(cmd_buff, SET_SAMPLE_BUFF_DEPTH);
+    p += strlen(SET_SAMPLE_BUFF_DEPTH) + 1;   // +1 for space
+
+    depth = strtol(p, &p, 10);
+
+    dma_i2s_int_disable();
+    depth_ok = audio_set_sample_buff_depth(&g_audio_engine, depth);
+    dma_i2s_int_enable();
+
+    if (depth_ok)
+    {
+        sprintf(reply_buff, "\tSet sample buffer depth: %u (%lu us)%s",
+                depth, audio_get_latency_us(&g_audio_engine), NEWLINE);
+        uart_write_string(reply_buff);
+    }
+}
+
+static void set_volume(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t channel = 255;
+    uint8_t value = 0;
+
+    p = strstr(cmd_buff, SET_VOLUME);
+    p += strlen(SET_VOLUME) + 1; // +1 for space
+
+    channel = strtol(p, &p, 10);
+    ++p;
+    value = strtol(p, &p, 10);
+
+    audio_set_volume(&g_audio_engine, (audio_ch_nbr_t)channel, value);
+
+    sprintf(reply_buff, "\tSet volume channel %u, volume: %u%s",
+            channel, value, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_master_volume(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t volume = 0;
+
+    p = strstr(cmd_buff, SET_MASTER_VOLUME);
+    p += strlen(SET_MASTER_VOLUME) + 1; // +1 for space
+
+    volume = strtol(p, &p, 10);
+
+    audio_set_master_volume(&g_audio_engine, volume);
+
+    sprintf(reply_buff, "\tSet master volume: %u%s", volume, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_mute(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t channel = 255;
+    uint8_t value = 0;
+
+    p = strstr(cmd_buff, SET_MUTE);
+    p += strlen(SET_MUTE) + 1; // +1 for space
+
+    channel = strtol(p, &p, 10);
+    ++p;
+    value = strtol(p, &p, 10);
+
+    audio_set_mute(&g_audio_engine, (audio_ch_nbr_t)channel, 0 != value);
+
+    sprintf(reply_buff, "\tSet mute channel %u, mute: %u%s",
+            channel, value, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_solo(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t channel = 255;
+    uint8_t value = 0;
+
+    p = strstr(cmd_buff, SET_SOLO);
+    p += strlen(SET_SOLO) + 1; // +1 for space
+
+    channel = strtol(p, &p, 10);
+    ++p;
+    value = strtol(p, &p, 10);
+
+    audio_set_solo(&g_audio_engine, (audio_ch_nbr_t)channel, 0 != value);
+
+    sprintf(reply_buff, "\tSet solo channel %u, solo: %u%s",
+            channel, value, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void cmd_midi(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    char* end;
+    uint8_t byte;
+    uint16_t nbr_of_bytes = 0;
+
+    p = strstr(cmd_buff, CMD_MIDI);
+    p += strlen(CMD_MIDI);
+
+    midi_parser.sample_index = audio_get_sample_index(&g_audio_engine);
+
+    while (1)
+    {
+        byte = strtol(p, &end, 16);
+
+        if (end == p)
+        {
+            break;
+        }
+
+        midi_parse_byte(&midi_parser, byte);
+        ++nbr_of_bytes;
+        p = end;
+    }
+
+    sprintf(reply_buff, "\tParsed %u MIDI bytes%s", nbr_of_bytes, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void get_link_status(char* cmd_buff)
+{
+    link_stats_t stats;
+
+    link_get_stats(&stats);
+
+    sprintf(reply_buff, "\tBytes: %lu%s\tFrames: %lu%s",
+            stats.bytes, NEWLINE, stats.frames, NEWLINE);
+    uart_write_string(reply_buff);
+
+    sprintf(reply_buff, "\tCRC errors: %u%s\tLength errors: %u%s",
+            stats.crc_errors, NEWLINE, stats.length_errors, NEWLINE);
+    uart_write_string(reply_buff);
+
+    sprintf(reply_buff, "\tUnknown opcodes: %u%s\tOverruns: %u%s",
+            stats.unknown_opcodes, NEWLINE, stats.overruns, NEWLINE);
+    uart_write_string(reply_buff);
+
+    sprintf(reply_buff, "\tClamped offsets: %u%s",
+            stats.clamped_offsets, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void get_cc_map(char* cmd_buff)
+{
+    uint8_t control;
+    cc_param_t param;
+
+    // One mapped control per step, the step is the control to search from
+    for (control = command_step;
+         control < CC_ROUTER_NBR_OF_CONTROLS;
+         ++control)
+    {
+        param = cc_router_get_map(control);
+
+        if (CC_PARAM_NONE != param)
+        {
+            sprintf(reply_buff, "\tCC %3u: %s%s",
+                    control, cc_router_get_param_name(param), NEWLINE);
+            uart_write_string(reply_buff);
+
+            continue_command(control + 1);
+
+            break;
+        }
+    }
+}
+
+static void set_cc_map(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t control = 0;
+    uint8_t param = 0;
+
+    p = strstr(cmd_buff, SET_CC_MAP);
+    p += strlen(SET_CC_MAP) + 1; // +1 for space
+
+    control = strtol(p, &p, 10);
+    ++p;
+    param = strtol(p, &p, 10);
+
+    if (cc_router_set_map(control, (cc_param_t)param))
+    {
+        sprintf(reply_buff, "\tMapped CC %u to %s%s",
+                control, cc_router_get_param_name((cc_param_t)param),
+                NEWLINE);
+    }
+    else
+    {
+        sprintf(reply_buff, "\tInvalid CC map: %u %u%s",
+                control, param, NEWLINE);
+    }
+
+    uart_write_string(reply_buff);
+}
+
+static void set_pitch_bend(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t channel = 255;
+    uint16_t bend = AUDIO_PITCH_BEND_CENTER;
+
+    p = strstr(cmd_buff, SET_PITCH_BEND);
+    p += strlen(SET_PITCH_BEND) + 1; // +1 for space
+
+    channel = strtol(p, &p, 10);
+    ++p;
+    bend = strtol(p, &p, 10);
+
+    audio_set_pitch_bend(&g_audio_engine, (audio_ch_nbr_t)channel, bend);
+
+    sprintf(reply_buff, "\tSet pitch bend channel %u, bend: %u%s",
+            channel, bend, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_bend_range(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t channel = 255;
+    uint8_t range = 0;
+
+    p = strstr(cmd_buff, SET_BEND_RANGE);
+    p += strlen(SET_BEND_RANGE) + 1; // +1 for space
+
+    channel = strtol(p, &p, 10);
+    ++p;
+    range = strtol(p, &p, 10);
+
+    audio_set_pitch_bend_range(&g_audio_engine, (audio_ch_nbr_t)channel, range);
+
+    sprintf(reply_buff, "\tSet pitch bend range channel %u, range: %u%s",
+            channel, range, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void get_patches(char* cmd_buff)
+{
+    uint8_t i;
+
+    // One line per step, first the patches and then the channels
+    if (command_step < PATCH_BANK_SIZE)
+    {
+        i = command_step;
+
+        sprintf(reply_buff, "\t%u: %s%s", i, patch_get_name(i), NEWLINE);
+    }
+    else
+    {
+        i = command_step - PATCH_BANK_SIZE;
+
+        sprintf(reply_buff, "\tChannel %u: patch %u%s",
+                i, patch_get_program(i), NEWLINE);
+    }
+
+    uart_write_string(reply_buff);
+
+    if (command_step + 1 < PATCH_BANK_SIZE + AUDIO_CH_NBR_OF_CHANNELS)
+    {
+        continue_command(command_step + 1);
+    }
+}
+
+static void set_patch(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t channel = 255;
+    uint8_t program = 0;
+
+    p = strstr(cmd_buff, SET_PATCH);
+    p += strlen(SET_PATCH) + 1; // +1 for space
+
+    channel = strtol(p, &p, 10);
+    ++p;
+    program = strtol(p, &p, 10);
+
+    if (patch_program_change(channel, program))
+    {
+        sprintf(reply_buff, "\tSet patch channel %u, patch: %u%s",
+                channel, program, NEWLINE);
+    }
+    else
+    {
+        sprintf(reply_buff, "\tInvalid patch: %u %u%s",
+                channel, program, NEWLINE);
+    }
+
+    uart_write_string(reply_buff);
+}
+
+static void cmd_play_song(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t song = 0;
+
+    p = strstr(cmd_buff, CMD_PLAY_SONG);
+    p += strlen(CMD_PLAY_SONG) + 1; // +1 for space
+
+    song = strtol(p, &p, 10);
+
+    if (sequencer_play(song))
+    {
+        sprintf(reply_buff, "\tPlaying song %u%s", song, NEWLINE);
+    }
+    else
+    {
+        sprintf(reply_buff, "\tInvalid song: %u%s", song, NEWLINE);
+    }
+
+    uart_write_string(reply_buff);
+}
+
+static void cmd_stop_song(char* cmd_buff)
+{
+    sequencer_stop();
+
+    sprintf(reply_buff, "\tSong stopped, overruns: %u%s",
+            sequencer_get_overruns(), NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void cmd_help(char* cmd_buff)
+{
+    const terminal_command_t* command;
+    const char* p = cmd_buff + strlen(CMD_HELP);
+    uint8_t i;
+
+    while (is_space(*p))
+    {
+        ++p;
+    }
+
+    command = find_command(p);
+
+    if (NULL != command)
+    {
+        uart_write_string("\t");
+        uart_write_string(command->help);
+        uart_write_string("\n\r");
+    }
+    else if (0 == command_step)
+    {
+        uart_write_string("\tType \"help <command>\" for more info\n\r");
+        uart_write_string("\tAvailible commands:\n\r");
+        uart_write_string("\t------------------------------------\n\r");
+
+        continue_command(1);
+    }
+    else
+    {
+        // One command per step, so that the list fits in the UART buffer
+        i = command_step - 1;
+
+        uart_write_string("\t");
+        uart_write_string(COMMANDS[i].name);
+        uart_write_string("\n\r");
+
+        if (i + 1 < NBR_OF_COMMANDS)
+        {
+            continue_command(command_step + 1);
+        }
+    }
+}
+
+static void cmd_exit(char* cmd_buff)
+{
+    terminal_open = false;
+
+    uart_write_string("\tTerminal closed.");
+    uart_write_string(NEWLINE);
+}
+
+static void cmd_system_reset(char* cmd_buff)
+{
+    __asm__ volatile ("reset");
+}
+
+static void cmd_pcm1774_analog(char* cmd_buff)
+{
+    uart_write_string("\tSetting the PCM1774 in analog to analog mode");
+    uart_write_string(NEWLINE);
+
+    pcm1774_analog_to_analog_mode();
+}
+
+static void cmd_pcm1774_init(char* cmd_buff)
+{
+    uart_write_string("\tInitializing the PCM1774");
+    uart_write_string(NEWLINE);
+
+    pcm1774_init();
+}
+
+static void cmd_trigger_dma0(char* cmd_buff)
+{
+    uart_write_string("\tDMA0 triggered");
+    uart_write_string(NEWLINE);
+
+    DMACH0bits.CHREQ = 1;
+}
+
+static void set_tempo(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t bpm = 0;
+
+    p = strstr(cmd_buff, SET_TEMPO);
+    p += strlen(SET_TEMPO) + 1; // +1 for space
+
+    bpm = strtol(p, &p, 10);
+
+    sequencer_set_tempo(bpm);
+
+    sprintf(reply_buff, "\tSet tempo: %u bpm%s", bpm, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void get_control_status(char* cmd_buff)
+{
+    control_stats_t stats;
+
+    control_get_stats(&stats);
+
+    sprintf(reply_buff, "\tBytes: %lu%s\tFrames: %lu%s",
+            stats.bytes, NEWLINE, stats.frames, NEWLINE);
+    uart_write_string(reply_buff);
+
+    sprintf(reply_buff, "\tCRC errors: %u%s\tLength errors: %u%s",
+            stats.crc_errors, NEWLINE, stats.length_errors, NEWLINE);
+    uart_write_string(reply_buff);
+
+    sprintf(reply_buff, "\tArgument errors: %u%s\tUnknown opcodes: %u%s",
+            stats.argument_errors, NEWLINE, stats.unknown_opcodes, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_telemetry(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint16_t period = 0;
+
+    p = strstr(cmd_buff, SET_TELEMETRY);
+    p += strlen(SET_TELEMETRY) + 1;   // +1 for space
+
+    period = strtol(p, &p, 10);
+
+    if (period > 255)
+    {
+        sprintf(reply_buff, "\tInvalid telemetry period: %u%s",
+                period, NEWLINE);
+        uart_write_string(reply_buff);
+
+        return;
+    }
+
+    telemetry_set_period(period);
+
+    sprintf(reply_buff, "\tSet telemetry period: %u ticks%s"
+            "\tSkipped frames: %u%s",
+            telemetry_get_period(), NEWLINE,
+            telemetry_get_skipped_frames(), NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void set_scope(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint8_t source = 0;
+    uint8_t trigger = 0;
+    int16_t level = 0;
+
+    p = strstr(cmd_buff, SET_SCOPE);
+    p += strlen(SET_SCOPE) + 1;   // +1 for space
+
+    source = strtol(p, &p, 10);
+    trigger = strtol(p, &p, 10);
+    level = strtol(p, &p, 10);
+
+    if (audio_scope_arm(&g_audio_engine,
+                        source,
+                        (audio_scope_trigger_t)trigger,
+                        level))
+    {
+        sprintf(reply_buff, "\tScope armed: source %u, trigger %u%s",
+                source, trigger, NEWLINE);
+    }
+    else
+    {
+        sprintf(reply_buff, "\tInvalid scope setting: %u %u%s",
+                source, trigger, NEWLINE);
+    }
+
+    uart_write_string(reply_buff);
+}
+
+static void get_scope(char* cmd_buff)
+{
+    static const char* const STATE_NAMES[] =
+    {
+        "idle", "done", "armed", "triggered"
+    };
+
+    int16_t samples[SCOPE_SAMPLES_PER_FRAME];
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint8_t buff[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+    uint8_t* p;
+    uint16_t first;
+    uint16_t nbr_of_samples;
+    uint16_t i;
+    uint16_t size;
+
+    if (0 == command_step)
+    {
+        sprintf(reply_buff, "\tScope: %s%s",
+                STATE_NAMES[audio_scope_get_state(&g_audio_engine)], NEWLINE);
+        uart_write_string(reply_buff);
+    }
+
+    // One frame per step
+    first = command_step * SCOPE_SAMPLES_PER_FRAME;
+
+    nbr_of_samples = audio_scope_read(&g_audio_engine,
+                                      first,
+                                      SCOPE_SAMPLES_PER_FRAME,
+                                      samples);
+
+    if (0 == nbr_of_samples)
+    {
+        return;
+    }
+
+    p = frame_put_u16(payload, first);
+    p = frame_put_u16(p, AUDIO_SCOPE_SIZE);
+
+    for (i = 0; i != nbr_of_samples; ++i)
+    {
+        p = frame_put_u16(p, samples[i]);
+    }
+
+    size = frame_encode(CONTROL_OPCODE_SCOPE_DATA | CONTROL_REPLY_FLAG,
+                        payload, p - payload, buff);
+    uart_write_array(size, buff);
+
+    if (first + nbr_of_samples < AUDIO_SCOPE_SIZE)
+    {
+        continue_command(command_step + 1);
+    }
+}
+
+static void get_trace(char* cmd_buff)
+{
+#ifdef TRACE_ENABLED
+    uint16_t next;
+
+    if (0 == command_step)
+    {
+        sprintf(reply_buff, "\tTrace mask: %04X%s", trace_get_mask(), NEWLINE);
+        uart_write_string(reply_buff);
+    }
+
+    // One frame per step, the step is the first record of the frame
+    next = trace_send(command_step);
+
+    if (0 != next)
+    {
+        continue_command(next);
+
+        return;
+    }
+
+    sprintf(reply_buff, "\tTrace sent%s", NEWLINE);
+#else
+    sprintf(reply_buff, "\tThe trace is not enabled in this build%s",
+            NEWLINE);
+#endif
+    uart_write_string(reply_buff);
+}
+
+static void set_trace(char* cmd_buff)
+{
+    char* p = cmd_buff;
+    uint16_t mask = 0;
+
+    p = strstr(cmd_buff, SET_TRACE);
+    p += strlen(SET_TRACE) + 1;   // +1 for space
+
+    mask = strtol(p, &p, 16) & TRACE_MASK_ALL;
+
+    trace_set_mask(mask);
+
+    sprintf(reply_buff, "\tSet trace mask: %04X%s", mask, NEWLINE);
+    uart_write_string(reply_buff);
+}
+
+static void get_scheduler(char* cmd_buff)
+{
+    sched_stats_t stats;
+    uint32_t us_per_tick = 1000000ul / TIMER_FREQ_HZ;
+    uint16_t counts_per_tick = timer_get_counts_per_tick();
+    uint32_t average = 0;
+    uint16_t duty_cycle;
+    uint8_t task;
+
+    if (0 == command_step)
+    {
+        duty_cycle = sched_get_duty_cycle();
+
+        sprintf(reply_buff, "\tIdle: %lu\tduty cycle: %u.%u %%%s",
+                sched_get_idle_count(),
+                duty_cycle / 10u, duty_cycle % 10u, NEWLINE);
+        uart_write_string(reply_buff);
+    }
+
+    // One task per step
+    task = command_step;
+
+    sched_get_stats(task, &stats);
+
+    if (0 != stats.runs)
+    {
+        average = stats.total_time / stats.runs;
+    }
+
+    sprintf(reply_buff,
+            "\t%-10s runs: %lu\tavg: %lu us\tmax: %lu us\tlate: %u%s",
+            sched_get_task_name(task), stats.runs,
+            (average * us_per_tick) / counts_per_tick,
+            (stats.max_time * us_per_tick) / counts_per_tick,
+            stats.deadline_misses, NEWLINE);
+    uart_write_string(reply_buff);
+
+    if (task + 1 < sched_get_nbr_of_tasks())
+    {
+        continue_command(command_step + 1);
+    }
+}
+
+static void cmd_clear_sched_stats(char* cmd_buff)
+{
+    sched_clear_stats();
+
+    uart_write_string("\tScheduler stats cleared");
+    uart_write_string(NEWLINE);
+}
+
+static const terminal_command_t* find_command(const char* line)
+{
+    const terminal_command_t* command = NULL;
+    int16_t first = 0;
+    int16_t last = NBR_OF_COMMANDS - 1;
+    int16_t middle;
+    uint8_t length;
+
+    // Find the last command which is not greater than the line. No command
+    // is the beginning of another command, so if the line starts with a
+    // command it is that one.
+    while (first <= last)
+    {
+        middle = (first + last) / 2;
+
+        if (strcmp(COMMANDS[middle].name, line) <= 0)
+        {
+            command = &COMMANDS[middle];
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle - 1;
+        }
+    }
+
+    if (NULL != command)
+    {
+        length = strlen(command->name);
+
+        if ((0 != strncmp(command->name, line, length)) ||
+            (('\0' != line[length]) && !is_space(line[length])))
+        {
+            command = NULL;
+        }
+    }
+
+    return command;
+}
+
+static uint8_t count_params(const char* params)
+{
+    uint8_t count = 0;
+    bool in_param = false;
+
+    while ('\0' != *params)
+    {
+        if (is_space(*params))
+        {
+            in_param = false;
+        }
+        else if (!in_param)
+        {
+            in_param = true;
+            ++count;
+        }
+
+        ++params;
+    }
+
+    return count;
+}
+
+static inline bool is_space(char c)
+{
+    return (' ' == c) || ('\t' == c) || ('\r' == c) || ('\n' == c);
 }
\ No newline at end of file
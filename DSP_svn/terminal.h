@@ -16,6 +16,7 @@
 // =============================================================================
 // Include statements
 // =============================================================================
+#include <stdbool.h>
 
 // =============================================================================
 // Public type definitions
@@ -34,12 +35,30 @@
 // =============================================================================
 
 /**
- * @brief Sets the device in terminal mode if the
- *        correct password has been received.
+ * @brief Initializes the terminal.
  * @param void
  * @return void
  */
-void terminal_check_access(void);
+void terminal_init(void);
+
+/**
+ * @brief Runs the terminal from the main loop.
+ * @details Opens the terminal when the password has been received. When
+ *          the terminal is open the received command lines are executed.
+ *          A long command is executed in steps over several calls, so that
+ *          each call only takes a short time and the sample buffer is never
+ *          emptied while a command runs.
+ * @param void
+ * @return void
+ */
+void terminal_process(void);
+
+/**
+ * @brief Checks if a command is being executed and can continue.
+ * @param void
+ * @return True if terminal_process should be called.
+ */
+bool terminal_is_busy(void);
 
 
 #ifdef	__cplusplus
@@ -0,0 +1,224 @@
+/*
+This file is an auto generated file.
+Do not modify its contents manually!
+
+The commands of the terminal sorted by command. Only included by
+terminal.c.
+*/
+#define NBR_OF_COMMANDS (53u)
+
+static const terminal_command_t COMMANDS[NBR_OF_COMMANDS] =
+{
+    {
+        CMD_ALL_NOTES_OFF, 0, cmd_all_notes_off,
+        "Turns all notes off.\n\r\t"
+    },
+    {
+        CMD_PCM1774_ANALOG, 0, cmd_pcm1774_analog,
+        "Activates the analog inputs of the DAC.\n\r\t"
+    },
+    {
+        CMD_CLEAR_AUDIO_STATS, 0, cmd_clear_audio_stats,
+        "Resets the sample buffer statistics.\n\r\t"
+    },
+    {
+        CMD_CLEAR_SCHED_STATS, 0, cmd_clear_sched_stats,
+        "Resets the run time statistics of the main loop tasks.\n\r\t"
+    },
+    {
+        CMD_EXIT, 0, cmd_exit,
+        "Exits the terminal and resumes normal program operation.\n\r\t"
+    },
+    {
+        GET_AUDIO_LATENCY, 0, get_audio_latency,
+        "Gets the depth of the sample buffer and the resulting latency from a\n\r\tnote on until the note reaches the DAC.\n\r\t"
+    },
+    {
+        GET_AUDIO_STATS, 0, get_audio_stats,
+        "Gets the sample buffer underrun and overrun counters, the time of the\n\r\tlast underrun, the number of event queue overflows and the min fill\n\r\thistogram of the sample buffer.\n\r\t"
+    },
+    {
+        GET_CC_MAP, 0, get_cc_map,
+        "Lists the MIDI control numbers which are mapped to a synthesis parameter.\n\r\t"
+    },
+    {
+        GET_CONTROL_STATUS, 0, get_control_status,
+        "Gets the number of received bytes and frames of the binary control\n\r\tprotocol on the UART and the number of discarded frames.\n\r\t"
+    },
+    {
+        GET_DMA0_STAT, 0, get_dma0_stat,
+        "Gets register states from the DMA0 module.\n\r\t"
+    },
+    {
+        GET_GOVERNOR, 0, get_governor,
+        "Gets the current quality level of the audio governor.\n\r\t"
+    },
+    {
+        GET_LINK_STATUS, 0, get_link_status,
+        "Gets the number of received bytes and frames on the PIC32 link, the\n\r\tnumber of discarded frames, the number of receive buffer overruns and the\n\r\tnumber of clamped timed MIDI offsets.\n\r\t"
+    },
+    {
+        GET_PATCHES, 0, get_patches,
+        "Lists the patches in the patch bank and the patch of each channel.\n\r\t"
+    },
+    {
+        GET_SAMPLE_BUFF_SIZE, 0, get_sample_buff_size,
+        "Gets the size of the sample buffer.\n\r\t"
+    },
+    {
+        GET_SAMPLE_RATE, 0, get_sample_rate,
+        "Gets the sample rate of the audio engine.\n\r\t"
+    },
+    {
+        GET_SCHEDULER, 0, get_scheduler,
+        "Gets the run time statistics of the main loop tasks: the number of\n\r\truns, the average and longest run time and the number of missed\n\r\tdeadlines. Also gets the duty cycle, the part of the latest second the\n\r\tCPU was not in Idle.\n\r\t"
+    },
+    {
+        GET_SCOPE, 0, get_scope,
+        "Gets the state of the scope. A completed capture is sent as binary\n\r\tframes, which are decoded by scope_dump.py.\n\r\t"
+    },
+    {
+        GET_SPI1_STAT, 0, get_spi1_stat,
+        "Gets register states from the SPI1 module.\n\r\t"
+    },
+    {
+        GET_SPI2_STAT, 0, get_spi2_stat,
+        "Gets register states from the SPI2 module.\n\r\t"
+    },
+    {
+        GET_SQ0_CH_STAT, 0, get_sq0_ch_stat,
+        "Gets the current status of the audio channel square0.\n\r\t"
+    },
+    {
+        GET_SQ1_CH_STAT, 0, get_sq1_ch_stat,
+        "Gets the current status of the audio channel square1.\n\r\t"
+    },
+    {
+        GET_TRACE, 0, get_trace,
+        "Sends the trace ring buffer as binary frames, which are converted to\n\r\ta timeline by trace_decode.py, and empties it. The firmware must be\n\r\tbuilt with TRACE_ENABLED. Nothing is traced while the frames are sent.\n\r\tIf the command is aborted with Ctrl-C the trace mask is restored and\n\r\tthe records are kept.\n\r\t"
+    },
+    {
+        GET_TRI0_CH_STAT, 0, get_tri0_ch_stat,
+        "Gets the current status of the audio channel triangle0.\n\r\t"
+    },
+    {
+        CMD_HELP, 0, cmd_help,
+        "Lists the commands, or describes one command.\n\r\tParameters: [<command>]\n\r\t"
+    },
+    {
+        CMD_MIDI, 1, cmd_midi,
+        "Feeds raw MIDI bytes to the MIDI parser.\n\r\tParameters: <byte in hex> [<byte in hex> ...]\n\r\t"
+    },
+    {
+        CMD_NOTE_OFF, 1, cmd_note_off,
+        "Turns one note off.\n\r\tParameters: <channel number>\n\r\t"
+    },
+    {
+        CMD_NOTE_ON, 3, cmd_note_on,
+        "Turns one note on.\n\r\tParmeters: <channel number> <note number> <velocity>\n\r\t"
+    },
+    {
+        CMD_PCM1774_INIT, 0, cmd_pcm1774_init,
+        "Performs the intitialization rutine for the DAC.\n\r\t"
+    },
+    {
+        CMD_PLAY_SONG, 1, cmd_play_song,
+        "Starts playing a song from the beginning.\n\r\tParameters: <song number>\n\r\t"
+    },
+    {
+        SET_BEND_RANGE, 2, set_bend_range,
+        "Sets the pitch bend range of a square or triangle channel.\n\r\tParameters: <audio channel number> <range in semitones [0, 24]>\n\r\t"
+    },
+    {
+        SET_CC_MAP, 2, set_cc_map,
+        "Maps a MIDI control number to a synthesis parameter.\n\r\tParameters: <control number [0, 127]> <parameter>\n\r\twhere parameter is 0 = none, 1 = volume, 2 = duty, 3 = vibrato rate,\n\r\t4 = vibrato depth, 5 = attack, 6 = decay, 7 = sustain, 8 = release\n\r\t"
+    },
+    {
+        SET_DUTY, 2, set_duty,
+        "Sets the duty cycle of a square or trangle audio channel.\n\r\tParameters: <audio channel number> <duty cycle in range [0, 255]>\n\r\t"
+    },
+    {
+        SET_GOVERNOR, 1, set_governor,
+        "Enables or disables the automatic quality scaling of the audio engine.\n\r\tParameters: <1 = on, 0 = off>\n\r\t"
+    },
+    {
+        SET_PCM1774_VOL, 1, set_pcm1774_vol,
+        "Sets the main volume of the headphone amplifier.\n\r\tParameters: <volume setting in range [0, 63]>\n\r\t"
+    },
+    {
+        SET_MASTER_VOLUME, 1, set_master_volume,
+        "Sets the master volume of the digital mix.\n\r\tParameters: <volume in range [0, 127]>\n\r\t"
+    },
+    {
+        SET_MUTE, 2, set_mute,
+        "Mutes or unmutes one audio channel.\n\r\tParameters: <audio channel number> <1 = mute, 0 = unmute>\n\r\t"
+    },
+    {
+        SET_PATCH, 2, set_patch,
+        "Selects the patch of one audio channel.\n\r\tThe patch is loaded at the next modulation tick.\n\r\tParameters: <audio channel number> <patch number>\n\r\t"
+    },
+    {
+        SET_PCM1774_REG, 2, set_pcm1774_reg,
+        "Sets the contents of a register in the DAC.\n\r\tParameters: <register index in hex> <register value in hex>\n\r\t"
+    },
+    {
+        SET_PITCH_BEND, 2, set_pitch_bend,
+        "Bends the pitch of a square or triangle channel.\n\r\tParameters: <audio channel number> <bend value [0, 16383]>\n\r\t8192 gives no bend.\n\r\t"
+    },
+    {
+        SET_SAMPLE_BUFF_DEPTH, 1, set_sample_buff_depth,
+        "Sets the depth of the sample buffer. A smaller buffer gives a lower\n\r\tlatency but is more sensitive to load spikes.\n\r\tParameters: <power of two in range [16, 256]>\n\r\t"
+    },
+    {
+        SET_SAMPLE_RATE, 1, set_sample_rate,
+        "Sets the sample rate of the DAC and the audio engine.\n\r\tParameters: <16000, 22050, 24000, 32000, 44100 or 48000>\n\r\t"
+    },
+    {
+        SET_SCOPE, 2, set_scope,
+        "Arms the scope, which records the samples around the next trigger.\n\r\tParameters: <source> <trigger> [<level>]\n\r\twhere source is the audio channel number, or 4 for the mix, and\n\r\ttrigger is 0 = now, 1 = note on, 2 = underrun, 3 = level. The level\n\r\ttrigger fires when |sample| >= level.\n\r\t"
+    },
+    {
+        SET_SOLO, 2, set_solo,
+        "Solos or unsolos one audio channel. While any channel is soloed only\n\r\tthe soloed channels are heard.\n\r\tParameters: <audio channel number> <1 = solo, 0 = unsolo>\n\r\t"
+    },
+    {
+        SET_TELEMETRY, 1, set_telemetry,
+        "Sends a binary telemetry frame every n:th modulation tick, see\n\r\tcontrol.h and telemetry_view.py. Prints the period which is used, which\n\r\tis at least the time the UART needs to send a frame, and the number of\n\r\tframes skipped since the UART was full.\n\r\tParameters: <ticks between the frames [0, 255], 0 = off>\n\r\t"
+    },
+    {
+        SET_TEMPO, 1, set_tempo,
+        "Sets the tempo of the playing song.\n\r\tParameters: <beats per minute>\n\r\t"
+    },
+    {
+        SET_TRACE, 1, set_trace,
+        "Selects the traced events, one bit per trace_id_t in trace.h.\n\r\tParameters: <mask in hex>\n\r\t"
+    },
+    {
+        SET_VIBRATO_CONF, 3, set_vibrato_conf,
+        "Configures the vibrato of one square/triangle channel.\n\r\tParameters: <audio channel number> <vibrato rate> <vibrato depth>\n\r\t"
+    },
+    {
+        SET_VIBRATO_OFF, 1, set_vibrato_off,
+        "Turns the vibrato off for one audio channel.\n\r\tParameters: <audio channel number>\n\r\t"
+    },
+    {
+        SET_VIBRATO_ON, 1, set_vibrato_on,
+        "Turns the vibrato on for one audio channel.\n\r\tParameters: <audio channel number>\n\r\t"
+    },
+    {
+        SET_VOLUME, 2, set_volume,
+        "Sets the volume of one audio channel in the digital mix.\n\r\tParameters: <audio channel number> <volume in range [0, 127]>\n\r\t"
+    },
+    {
+        CMD_STOP_SONG, 0, cmd_stop_song,
+        "Stops the playing song.\n\r\t"
+    },
+    {
+        CMD_SYSTEM_RESET, 0, cmd_system_reset,
+        "Forces a software reset.\n\r\t"
+    },
+    {
+        CMD_TRIGGER_DMA0, 0, cmd_trigger_dma0,
+        "Triggers a DMA transfer on the DMA0 channel.\n\r\t"
+    }
+};
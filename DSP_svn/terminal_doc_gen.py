@@ -1,27 +1,66 @@
-# This script generates documentation which can be seen in the dsp terminal.
+# This script generates the command table of the dsp terminal from the
+# documentation of the commands in terminal.c.
+#
+# Every command constant in terminal.c is preceded by a /*§ */ comment. The
+# comment is the help text of the command. A "Parameters:" line lists the
+# parameters, <name> for a mandatory parameter and [<name>] for an optional
+# one. The handler of a command is the name of the constant in lower case,
+# e.g. cmd_note_on for CMD_NOTE_ON.
+#
+# The table is written to terminal_commands.h, sorted by command, so that
+# terminal.c can look up a command with a binary search. The help text, the
+# number of mandatory parameters and the handler all come from the same
+# comment, so they can not drift apart.
+
+import re
+import sys
 
 class Command_doc:
     tag = ""
     cmd = ""
     doc = ""
+    handler = ""
+    min_args = 0
 
     # @brief Creates a command documentation for one command
     # @param tag - The name of the C string constant
     # @param cmd - The command to create a Command_doc for
     # @param doc - The documentation text of the command
-    def __init__(self, command_tag = "", command = "", documentation = ""):
+    # @param min_args - The number of mandatory parameters
+    def __init__(self, command_tag = "", command = "", documentation = "",
+                 min_args = 0):
         self.tag = command_tag
         self.cmd = command
         self.doc = documentation
+        self.handler = command_tag.lower()
+        self.min_args = min_args
 
 class Cmd_parser:
     commands = []
-    
+
+    # @brief Counts the mandatory parameters on a "Parameters:" line.
+    # @param line - A line of the documentation.
+    # @return The number of mandatory parameters, 0 if the line does not
+    #         list parameters.
+    def count_mandatory_params(self, line):
+        if not re.match(r"\s*Par\w*meters:", line):
+            return 0
+
+        # Drop the optional parameters, possibly nested
+        params = line
+        while True:
+            stripped = re.sub(r"\[[^\[\]]*\]", "", params)
+            if stripped == params:
+                break
+            params = stripped
+
+        return params.count("<")
+
     def parse_command_doc(self, filename = "terminal.c"):
         start_tag = "/*§"
         end_tag = "*/"
-        
-        with open(filename) as src_file:
+
+        with open(filename, encoding = "latin-1") as src_file:
             lines = src_file.readlines()
 
         parsing_doc = False
@@ -29,6 +68,7 @@ class Cmd_parser:
         doc = ""
         tag = ""
         cmd = ""
+        min_args = 0
         for line in lines:
             if parse_cmd:
                 parse_cmd = False
@@ -37,65 +77,62 @@ class Cmd_parser:
                 start_of_cmd = line.index('"') + 1
                 end_of_cmd = start_of_cmd + 1 + line[start_of_cmd + 1:].index('"')
                 cmd = line[start_of_cmd:end_of_cmd]
-                self.commands.append(Command_doc(tag, cmd, doc))
+                self.commands.append(Command_doc(tag, cmd, doc, min_args))
 
             if start_tag in line:
                 parsing_doc = True
                 doc = ""
                 tag = ""
                 cmd = ""
+                min_args = 0
             elif parsing_doc and end_tag in line:
                 parsing_doc = False
                 parse_cmd = True
             elif parsing_doc:
-                doc += line.strip() + "\\n\\r\\t"
+                text = line.strip().replace("\\", "\\\\").replace('"', '\\"')
+                doc += text + "\\n\\r\\t"
+                min_args += self.count_mandatory_params(line)
+
+        self.commands.sort(key = lambda c: c.cmd)
+
+    # @brief Checks that no command is the beginning of another command,
+    #        which the lookup in terminal.c relies on.
+    # @return True if the commands are valid.
+    def check_commands(self):
+        valid = True
 
-    def create_help_function(self):
-        with open("terminal_help.c", 'w') as f:
+        for a in self.commands:
+            for b in self.commands:
+                if a is not b and b.cmd.startswith(a.cmd):
+                    print("Error: \"" + a.cmd + "\" is the beginning of \"" +
+                          b.cmd + "\"")
+                    valid = False
+
+        return valid
+
+    def create_command_table(self):
+        with open("terminal_commands.h", 'w') as f:
             print("/*", file=f)
             print("This file is an auto generated file.", file=f)
             print("Do not modify its contents manually!", file=f)
+            print("", file=f)
+            print("The commands of the terminal sorted by command. Only included by", file=f)
+            print("terminal.c.", file=f)
             print("*/", file=f)
-            print("#include <string.h>", file=f)
-            print("#include <stddef.h>", file=f)
-            print("#include \"uart.h\"", file=f)
-
-            print("void terminal_help(char* in)", file=f)
+            print("#define NBR_OF_COMMANDS (" + str(len(self.commands)) + "u)", file=f)
+            print("", file=f)
+            print("static const terminal_command_t COMMANDS[NBR_OF_COMMANDS] =", file=f)
             print("{", file=f)
 
-            first = True
-            for cmd in self.commands:
-                if first:
-                    first = False
-                    print("    if (NULL != strstr(in, \"" + cmd.cmd + "\"))", file=f)
-                else:
-                    print("    else if (NULL != strstr(in, \"" + cmd.cmd + "\"))", file=f)
+            for i, cmd in enumerate(self.commands):
                 print("    {", file=f)
-                print("        uart_write_string(\"\\t" + cmd.doc + "\\n\\r\");", file=f)
-                print("    }", file=f)
-
-            print("    else", file=f)
-            print("    {", file=f)
-
-            commands_list = []
-            for cmd in self.commands:
-                commands_list.append(cmd.cmd + "\\n\\r\\t")
-            commands_list.sort()
-
-            commands_string = '"\\t'
-            for line in commands_list:
-                commands_string += line
-            commands_string += '"'
-
-            print("        uart_write_string(\"\\tType \\\"help <command>\\\" for more info\\n\\r\");", file=f)
-            print("        uart_write_string(\"\\tAvailible commands:\\n\\r\");", file=f)
-            print("        uart_write_string(\"\\t------------------------------------\\n\\r\");", file=f)
-            print("        uart_write_string(" + commands_string + ');', file=f)
-            print("        uart_write_string(\"\\n\\r\");", file=f)
-            print("    }", file=f)
-            print("}", file=f)
-            
-            
+                print("        " + cmd.tag + ", " + str(cmd.min_args) + ", " + cmd.handler + ",", file=f)
+                print("        \"" + cmd.doc + "\"", file=f)
+                print("    }" + ("," if i != len(self.commands) - 1 else ""), file=f)
+
+            print("};", file=f)
+
+
 # ===============================================================================
 # Module test
 # ===============================================================================
@@ -104,6 +141,8 @@ if __name__ == "__main__":
     print("Terminal doc gen started")
     parser = Cmd_parser()
     parser.parse_command_doc()
-    parser.create_help_function()
+    if not parser.check_commands():
+        sys.exit(1)
+    parser.create_command_table()
     print("Terminal doc gen complete")
-    
+
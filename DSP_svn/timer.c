@@ -17,6 +17,7 @@
 
 #include "timer.h"
 #include "configuration_bits.h"
+#include "trace.h"
 
 // =============================================================================
 // Private type definitions
@@ -41,6 +42,9 @@ const uint32_t TIMER_FREQ_HZ = 100;
 // =============================================================================
 static uint16_t pr1_reset_value = 0xFFFF;
 
+// The number of timer overflows since the timer was started.
+static volatile uint32_t tick_count = 0;
+
 // =============================================================================
 // Private function declarations
 // =============================================================================
@@ -52,6 +56,7 @@ static uint16_t pr1_reset_value = 0xFFFF;
 void timer_start()
 {
     g_timer_modulation_event = false;
+    tick_count = 0;
 
     T1CON = 0;
 
@@ -82,6 +87,59 @@ void timer_stop()
     IFS0bits.T1IF = 0;
 }
 
+uint32_t timer_get_tick_count(void)
+{
+    uint32_t ticks;
+
+    // The counter is 32 bits and cannot be read in one instruction. The
+    // increment is done with the interrupts disabled, so a reader in a
+    // higher priority interrupt than the timer never sees a half updated
+    // counter, and the read is done in the same way so the timer interrupt
+    // cannot update it in between.
+    __builtin_disi(0x3FFF);
+    ticks = tick_count;
+    __builtin_disi(0x0000);
+
+    return ticks;
+}
+
+uint16_t timer_get_time(void)
+{
+    return TMR1;
+}
+
+uint16_t timer_get_elapsed(uint16_t start)
+{
+    uint16_t now = TMR1;
+
+    if (now < start)
+    {
+        // The timer has restarted from 0 at the end of the tick
+        now += pr1_reset_value + 1;
+    }
+
+    return now - start;
+}
+
+uint16_t timer_get_counts_per_tick(void)
+{
+    return pr1_reset_value + 1;
+}
+
+uint32_t timer_get_timestamp(void)
+{
+    uint16_t time = TMR1;
+    uint16_t ticks = (uint16_t)tick_count;
+
+    if (IFS0bits.T1IF && (time < (pr1_reset_value / 2)))
+    {
+        // The timer has restarted, but the tick interrupt has not run yet
+        ++ticks;
+    }
+
+    return ((uint32_t)ticks << 16) | time;
+}
+
 // =============================================================================
 // Private function definitions
 // =============================================================================
@@ -91,10 +149,20 @@ void timer_stop()
  */
 void __attribute__((interrupt, no_auto_psv)) _T1Interrupt(void)
 {    
+    TRACE_BEGIN(TRACE_T1_ISR, 0, (uint16_t)tick_count + 1);
+
     PR1 = pr1_reset_value;
 
     g_timer_modulation_event = true;
 
+    // Not preempted by the DMA interrupt halfway, see timer_get_tick_count
+    __builtin_disi(0x3FFF);
+    ++tick_count;
+    __builtin_disi(0x0000);
+
     IFS0bits.T1IF = 0;
+
+    // After the flag is cleared, or the timestamp would count the tick twice
+    TRACE_END(TRACE_T1_ISR, 0, (uint16_t)tick_count);
 }
 
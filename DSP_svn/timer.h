@@ -60,6 +60,49 @@ extern const uint32_t TIMER_FREQ_HZ;
      */
     void timer_stop();
 
+    /**
+     * @brief Gets the number of timer overflows since the timer was started.
+     * @details The timer overflows TIMER_FREQ_HZ times per second.
+     * @param void
+     * @return The number of timer overflows.
+     */
+    uint32_t timer_get_tick_count(void);
+
+    /**
+     * @brief Gets the time within the current tick.
+     * @details The time is counted in timer counts, from 0 to
+     *          timer_get_counts_per_tick() - 1.
+     * @param void
+     * @return The current timer count.
+     */
+    uint16_t timer_get_time(void);
+
+    /**
+     * @brief Gets the time since a time read by timer_get_time.
+     * @details Only valid for intervals shorter than one tick.
+     * @param start - The time at the start of the interval.
+     * @return The number of timer counts since start.
+     */
+    uint16_t timer_get_elapsed(uint16_t start);
+
+    /**
+     * @brief Gets the number of timer counts in one tick.
+     * @param void
+     * @return The number of timer counts per tick.
+     */
+    uint16_t timer_get_counts_per_tick(void);
+
+    /**
+     * @brief Gets the tick count and the time within the tick.
+     * @details Should be called with the interrupts disabled, so that the
+     *          tick count can not change while it is read. A tick which has
+     *          ended but whose interrupt is still pending is counted.
+     * @param void
+     * @return The low 16 bits of the tick count in the high half, and the
+     *         timer count in the low half.
+     */
+    uint32_t timer_get_timestamp(void);
+
 #ifdef	__cplusplus
 }
 #endif
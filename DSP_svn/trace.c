@@ -0,0 +1,216 @@
+/*
+ * This file implements the event trace.
+ *
+ * A record is written with the interrupts disabled, which also makes the
+ * timestamp consistent with the tick count. When the ring buffer is full
+ * the oldest record is overwritten, so the buffer always holds the events
+ * which led up to the point where the trace is read.
+ */
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <xc.h>
+
+#include "trace.h"
+#include "timer.h"
+#include "frame.h"
+#include "control.h"
+#include "uart.h"
+
+// =============================================================================
+// Private type definitions
+// =============================================================================
+typedef struct trace_record_t
+{
+    uint8_t event;      // trace_id_t | TRACE_PHASE_
+    uint8_t arg0;
+    uint16_t arg1;
+    uint16_t tick;      // The low 16 bits of the tick count
+    uint16_t time;      // The timer count within the tick
+} trace_record_t;
+
+// =============================================================================
+// Global variables
+// =============================================================================
+
+// =============================================================================
+// Private constants
+// =============================================================================
+
+#if (TRACE_BUFF_SIZE & (TRACE_BUFF_SIZE - 1)) != 0
+#error TRACE_BUFF_SIZE must be a power of two
+#endif
+
+#define TRACE_BUFF_MASK         (TRACE_BUFF_SIZE - 1)
+
+#define TRACE_ID_MASK           ((uint8_t)~TRACE_PHASE_MASK)
+
+// The record index, the number of records and the timer counts per tick.
+#define FRAME_HEADER_SIZE       (6u)
+
+// The event, the arguments and the timestamp, little endian.
+#define RECORD_SIZE             (8u)
+
+#define RECORDS_PER_FRAME       ((FRAME_MAX_PAYLOAD - FRAME_HEADER_SIZE) /    \
+                                 RECORD_SIZE)
+
+// =============================================================================
+// Private variables
+// =============================================================================
+static volatile uint16_t trace_mask = TRACE_MASK_DEFAULT;
+
+#ifdef TRACE_ENABLED
+static trace_record_t records[TRACE_BUFF_SIZE];
+static uint16_t next_index = 0;     // The slot of the next record
+static bool wrapped = false;        // All slots have been written
+static uint16_t saved_mask;         // The mask before trace_send started
+static bool sending = false;        // trace_send has not sent the last frame
+#endif
+
+// =============================================================================
+// Private function declarations
+// =============================================================================
+
+// =============================================================================
+// Public function definitions
+// =============================================================================
+
+void trace_write(uint8_t event, uint8_t arg0, uint16_t arg1)
+{
+#ifdef TRACE_ENABLED
+    trace_record_t* record;
+    uint32_t timestamp;
+
+    if (0 == (trace_mask & (1u << (event & TRACE_ID_MASK))))
+    {
+        return;
+    }
+
+    __builtin_disi(0x3FFF);
+
+    timestamp = timer_get_timestamp();
+
+    record = &records[next_index];
+    next_index = (next_index + 1) & TRACE_BUFF_MASK;
+
+    if (0 == next_index)
+    {
+        wrapped = true;
+    }
+
+    record->event = event;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+    record->tick = (uint16_t)(timestamp >> 16);
+    record->time = (uint16_t)timestamp;
+
+    __builtin_disi(0x0000);
+#endif
+}
+
+void trace_set_mask(uint16_t mask)
+{
+#ifdef TRACE_ENABLED
+    if (sending)
+    {
+        saved_mask = mask;
+
+        return;
+    }
+#endif
+
+    trace_mask = mask;
+}
+
+uint16_t trace_get_mask(void)
+{
+#ifdef TRACE_ENABLED
+    if (sending)
+    {
+        return saved_mask;
+    }
+#endif
+
+    return trace_mask;
+}
+
+uint16_t trace_send(uint16_t first)
+{
+    uint16_t next = 0;
+#ifdef TRACE_ENABLED
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint8_t buff[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+    uint8_t* p = payload;
+    const trace_record_t* record;
+    uint16_t oldest;
+    uint16_t nbr_of_records;
+    uint16_t size;
+
+    if (!sending)
+    {
+        // An interrupt which is already in trace_write completes before the
+        // main loop continues, so no record is written after this.
+        saved_mask = trace_mask;
+        trace_mask = 0;
+        sending = true;
+    }
+
+    oldest = wrapped ? next_index : 0;
+    nbr_of_records = wrapped ? TRACE_BUFF_SIZE : next_index;
+
+    p = frame_put_u16(p, first);
+    p = frame_put_u16(p, nbr_of_records);
+    p = frame_put_u16(p, timer_get_counts_per_tick());
+
+    for (next = first;
+         (next < nbr_of_records) &&
+         ((uint16_t)(next - first) < RECORDS_PER_FRAME);
+         ++next)
+    {
+        record = &records[(oldest + next) & TRACE_BUFF_MASK];
+
+        *p++ = record->event;
+        *p++ = record->arg0;
+        p = frame_put_u16(p, record->arg1);
+        p = frame_put_u16(p, record->tick);
+        p = frame_put_u16(p, record->time);
+    }
+
+    if (next != first)
+    {
+        size = frame_encode(CONTROL_OPCODE_TRACE_DATA | CONTROL_REPLY_FLAG,
+                            payload, p - payload, buff);
+        uart_write_array(size, buff);
+    }
+
+    if (next >= nbr_of_records)
+    {
+        next = 0;
+        next_index = 0;
+        wrapped = false;
+
+        trace_send_abort();
+    }
+#endif
+
+    return next;
+}
+
+void trace_send_abort(void)
+{
+#ifdef TRACE_ENABLED
+    if (sending)
+    {
+        trace_mask = saved_mask;
+        sending = false;
+    }
+#endif
+}
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
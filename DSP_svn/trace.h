@@ -0,0 +1,153 @@
+/*
+ * File:   trace.h
+ * Author: Erik
+ *
+ * Event trace with timestamps.
+ *
+ * A trace record is an event id, the time of the event and two arguments.
+ * The records are written to a ring buffer in RAM, which always holds the
+ * latest TRACE_BUFF_SIZE records. Writing a record takes a few
+ * microseconds, so it may be done from the main loop and from the
+ * interrupts. The ring buffer is sent on the UART by trace_send, and
+ * trace_decode.py converts it to a timeline in the Chrome trace format.
+ *
+ * The trace is only built when TRACE_ENABLED is defined, either below or
+ * as a project macro. Otherwise the TRACE_ macros do not generate any code.
+ */
+
+#ifndef TRACE_H
+#define	TRACE_H
+
+#ifdef	__cplusplus
+//extern "C" {
+#endif
+
+// =============================================================================
+// Include statements
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Public type definitions
+// =============================================================================
+
+/*
+ * Trace event ids. The names are also listed in trace_decode.py.
+ */
+typedef enum trace_id_t
+{
+    TRACE_NONE = 0,         // Never written, marks an unused slot
+    TRACE_DMA0_ISR,         // arg0: 1 on underrun, arg1: samples in buffer
+    TRACE_T1_ISR,           // arg1: the tick count
+    TRACE_U1RX_ISR,         // arg1: the number of received bytes
+    TRACE_NOTE_ON,          // arg0: channel, arg1: note number
+    TRACE_NOTE_OFF,         // arg0: channel
+    TRACE_RENDER,           // The render task, see sched.h
+    TRACE_MODULATION,       // The modulation task
+    TRACE_TERMINAL,         // The terminal task
+    TRACE_CONTROL,          // The link, control and log task
+    TRACE_NBR_OF_IDS
+} trace_id_t;
+
+// =============================================================================
+// Global variable declarations
+// =============================================================================
+
+// =============================================================================
+// Global constatants
+// =============================================================================
+
+// Uncomment to build with the trace, or define it as a project macro.
+//#define TRACE_ENABLED
+
+// The number of records in the ring buffer, must be a power of two. The
+// frames of all records must fit in the transmit buffer of the UART.
+#define TRACE_BUFF_SIZE         (64u)
+
+// The phase of an event, or:ed with the id in the event byte of a record.
+#define TRACE_PHASE_INSTANT     (0x00u)
+#define TRACE_PHASE_BEGIN       (0x40u)
+#define TRACE_PHASE_END         (0x80u)
+#define TRACE_PHASE_MASK        (0xC0u)
+
+// All ids, one bit per trace_id_t.
+#define TRACE_MASK_ALL          ((1u << TRACE_NBR_OF_IDS) - 2u)
+
+// The ids which are traced after reset. The DMA0 interrupt runs for every
+// sample, so it would fill the ring buffer in a few milliseconds.
+#define TRACE_MASK_DEFAULT      (TRACE_MASK_ALL & ~(1u << TRACE_DMA0_ISR))
+
+#ifdef TRACE_ENABLED
+#define TRACE_INSTANT(id, arg0, arg1)                                         \
+    trace_write((id) | TRACE_PHASE_INSTANT, (arg0), (arg1))
+#define TRACE_BEGIN(id, arg0, arg1)                                           \
+    trace_write((id) | TRACE_PHASE_BEGIN, (arg0), (arg1))
+#define TRACE_END(id, arg0, arg1)                                             \
+    trace_write((id) | TRACE_PHASE_END, (arg0), (arg1))
+#else
+// The arguments are not evaluated, but count as used by the compiler.
+#define TRACE_INSTANT(id, arg0, arg1)   ((void)sizeof((arg0) + (arg1)))
+#define TRACE_BEGIN(id, arg0, arg1)     ((void)sizeof((arg0) + (arg1)))
+#define TRACE_END(id, arg0, arg1)       ((void)sizeof((arg0) + (arg1)))
+#endif
+
+// =============================================================================
+// Public function declarations
+// =============================================================================
+
+/**
+ * @brief Writes a trace record, if the id is enabled by the trace mask.
+ * @details Safe to call from any context. Use the TRACE_ macros, so that
+ *          the call is removed when the trace is not built.
+ * @param event - The trace_id_t or:ed with a TRACE_PHASE_.
+ * @param arg0 - The first argument.
+ * @param arg1 - The second argument.
+ * @return void
+ */
+void trace_write(uint8_t event, uint8_t arg0, uint16_t arg1);
+
+/**
+ * @brief Selects the traced ids.
+ * @details While the ring buffer is being sent the mask is applied when the
+ *          sending ends.
+ * @param mask - One bit per trace_id_t, bit n enables id n.
+ * @return void
+ */
+void trace_set_mask(uint16_t mask);
+
+/**
+ * @brief Gets the traced ids.
+ * @param void
+ * @return One bit per trace_id_t, the mask which is restored when the
+ *         sending ends if the ring buffer is being sent.
+ */
+uint16_t trace_get_mask(void);
+
+/**
+ * @brief Sends one frame of the ring buffer on the UART.
+ * @details The records are sent oldest first, in frames with the opcode
+ *          CONTROL_OPCODE_TRACE_DATA | CONTROL_REPLY_FLAG. Nothing is
+ *          traced from the first frame until the last frame has been sent,
+ *          when the ring buffer is emptied. Should only be called from the
+ *          main loop.
+ * @param first - The index of the first record of the frame, 0 to start.
+ * @return The index of the first record of the next frame, 0 when all
+ *         records have been sent or if the trace is not built.
+ */
+uint16_t trace_send(uint16_t first);
+
+/**
+ * @brief Ends a sending of the ring buffer which has not been completed, and
+ *        restores the trace mask. The records are kept, so that they can be
+ *        sent again. Does nothing if no sending is ongoing.
+ * @param void
+ * @return void
+ */
+void trace_send_abort(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* TRACE_H */
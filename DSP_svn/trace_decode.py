@@ -0,0 +1,170 @@
+# This script converts the event trace of the dsp (see trace.h) into the
+# Chrome trace format, which can be opened in chrome://tracing or Perfetto.
+#
+# The trace is sent by the terminal command "get trace" as binary frames
+# (see CONTROL_OPCODE_TRACE_DATA in control.h). The UART output is read from
+# a file, or from stdin if no file is given, and the last complete trace is
+# written as JSON. Each interrupt and the main loop are shown as separate
+# threads, so that it can be seen where an interrupt preempts the main loop.
+#
+# Usage:
+#   trace_decode.py [-o trace.json] [capture file]
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+sys.path.insert(0, SCRIPT_DIR)
+import log_decode
+
+# Must be the same as in control.h
+CONTROL_OPCODE_TRACE_DATA = 0x0A
+
+# Must be the same as TIMER_FREQ_HZ in timer.c
+TIMER_FREQ_HZ = 100
+
+# Must be the same as in trace.h
+TRACE_PHASE_INSTANT = 0x00
+TRACE_PHASE_BEGIN = 0x40
+TRACE_PHASE_END = 0x80
+TRACE_PHASE_MASK = 0xC0
+
+HEADER_FORMAT = "<HHH"
+RECORD_FORMAT = "<BBHHH"
+
+# The name, the thread and the names of the arguments of each trace_id_t,
+# in the order they are listed in trace.h.
+EVENTS = [
+    ("none", "main loop", ()),
+    ("DMA0 interrupt", "DMA0 interrupt", ("underrun", "samples")),
+    ("T1 interrupt", "T1 interrupt", ("", "tick")),
+    ("U1RX interrupt", "U1RX interrupt", ("", "bytes")),
+    ("note on", "main loop", ("channel", "note")),
+    ("note off", "main loop", ("channel", "")),
+    ("render", "main loop", ()),
+    ("modulation", "main loop", ()),
+    ("terminal", "main loop", ()),
+    ("control", "main loop", ()),
+]
+
+THREADS = ["main loop", "U1RX interrupt", "T1 interrupt", "DMA0 interrupt"]
+
+# @brief Collects the records of the trace frames.
+# @param data - The UART output.
+# @return The timer counts per tick and the records of the last complete
+#         trace, None if there is none.
+def read_trace(data):
+    trace = None
+    last = None
+    for opcode, payload in log_decode.Frame_reader().feed(data):
+        if opcode != CONTROL_OPCODE_TRACE_DATA | log_decode.CONTROL_REPLY_FLAG:
+            continue
+
+        first, size, counts_per_tick = struct.unpack_from(HEADER_FORMAT, payload)
+        offset = struct.calcsize(HEADER_FORMAT)
+        records = list(struct.iter_unpack(RECORD_FORMAT, payload[offset:]))
+
+        if first == 0:
+            trace = [None] * size
+        if trace is None or len(trace) != size:
+            continue
+
+        trace[first:first + len(records)] = records
+        if None not in trace:
+            last = (counts_per_tick, list(trace))
+
+    return last
+
+# @brief Converts the records to Chrome trace events.
+# @param counts_per_tick - The number of timer counts per tick.
+# @param records - The records, oldest first.
+# @return A list of trace events. The timestamps are in microseconds from
+#         the first record.
+def to_chrome_events(counts_per_tick, records):
+    tick_us = 1e6 / TIMER_FREQ_HZ
+    events = []
+    open_events = {}
+    start = None
+    tick_offset = 0
+    last_tick = None
+
+    for name in THREADS:
+        events.append({"name": "thread_name", "ph": "M", "pid": 1,
+                       "tid": THREADS.index(name), "args": {"name": name}})
+
+    for event, arg0, arg1, tick, time in records:
+        # The tick count is 16 bits
+        if last_tick is not None and tick < last_tick and last_tick - tick > 0x8000:
+            tick_offset += 0x10000
+        last_tick = tick
+
+        us = (tick + tick_offset) * tick_us + time * tick_us / counts_per_tick
+        if start is None:
+            start = us
+
+        trace_id = event & ~TRACE_PHASE_MASK
+        phase = event & TRACE_PHASE_MASK
+        if trace_id < len(EVENTS):
+            name, thread, arg_names = EVENTS[trace_id]
+        else:
+            name, thread, arg_names = "id %u" % trace_id, "main loop", ("arg0", "arg1")
+
+        tid = THREADS.index(thread)
+        args = {n: v for n, v in zip(arg_names, (arg0, arg1)) if n}
+        item = {"name": name, "pid": 1, "tid": tid, "ts": round(us - start, 1), "args": args}
+
+        if phase == TRACE_PHASE_BEGIN:
+            item["ph"] = "B"
+            open_events[trace_id] = open_events.get(trace_id, 0) + 1
+        elif phase == TRACE_PHASE_END:
+            # The begin may have been overwritten in the ring buffer
+            if not open_events.get(trace_id):
+                continue
+            open_events[trace_id] -= 1
+            item["ph"] = "E"
+            # The arguments are merged with those of the begin
+            item["args"] = {n: v for n, v in args.items() if v}
+        else:
+            item["ph"] = "i"
+            item["s"] = "t"
+
+        events.append(item)
+
+    return events
+
+
+# ===============================================================================
+# Module test
+# ===============================================================================
+
+if __name__ == "__main__":
+    arg_parser = argparse.ArgumentParser(description = "Converts the trace of the dsp to Chrome trace JSON")
+    arg_parser.add_argument("capture", nargs = "?", help = "UART output, stdin if omitted")
+    arg_parser.add_argument("-o", "--output", help = "the JSON file, stdout if omitted")
+    args = arg_parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    trace = read_trace(data)
+    if trace is None:
+        print("No complete trace found", file = sys.stderr)
+        sys.exit(1)
+
+    counts_per_tick, records = trace
+    result = {"traceEvents": to_chrome_events(counts_per_tick, records),
+              "displayTimeUnit": "ms"}
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(result, f, indent = 1)
+    else:
+        json.dump(result, sys.stdout, indent = 1)
+        print()
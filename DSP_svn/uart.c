@@ -1,6 +1,10 @@
 /*
  * This file handes the UART module.
  *
+ * Transmission is done by a DMA channel, see dma.h. The DMA sends the tx
+ * buffer in contiguous segments, from the first byte to the end of the
+ * buffer or to the last byte, and interrupts once per segment.
+ *
  * References:
  * - PIC24FJ128GA202 datasheet, document number DS30010038C
  *  - dsPIC33/PIC24 Family Reference Manual, Universal Asynchronous
@@ -20,6 +24,9 @@
 #include "uart.h"
 #include "configuration_bits.h"
 #include "pinmap.h"
+#include "frame.h"
+#include "dma.h"
+#include "trace.h"
 
 // =============================================================================
 // Private type definitions
@@ -36,7 +43,11 @@ volatile bool g_uart_receive_event = false;
 #define BUFFER_SIZE     ((uint16_t)1024)
 #define BACKSPACE_CHAR  (0x08)
 
-static const uint32_t UART_BAUD = 9600;
+const uint32_t UART_BAUD = 9600;
+
+#if (UART_FRAME_RX_BUFF_SIZE & (UART_FRAME_RX_BUFF_SIZE - 1)) != 0
+#error UART_FRAME_RX_BUFF_SIZE must be a power of two
+#endif
 
 // =============================================================================
 // Private variables
@@ -48,23 +59,57 @@ static volatile uint8_t tx_buff[BUFFER_SIZE];
 
 static volatile uint16_t rx_buff_first = 0;
 static volatile uint16_t rx_buff_last = 0;
-static volatile uint16_t tx_buff_first = 0;
-static volatile uint16_t tx_buff_last = 0;
-
 static volatile uint16_t rx_buff_size = 0;
-static volatile uint16_t tx_buff_size = 0;
+
+static volatile uint16_t tx_buff_first = 0;     // The next byte to send
+static volatile uint16_t tx_buff_size = 0;      // Including the segment
+
+// The number of bytes being sent by the DMA, 0 if the DMA is idle.
+static volatile uint16_t tx_segment_size = 0;
+
+// Bytes of binary frames. Written by the rx interrupt, read by the main loop.
+static volatile uint8_t frame_rx_buff[UART_FRAME_RX_BUFF_SIZE];
+static volatile uint16_t frame_rx_write_index = 0;
+static volatile uint16_t frame_rx_read_index = 0;
+
+// The number of bytes left of the frame being received, 0 for text.
+static uint8_t frame_bytes_left = 0;
+
+// Set when the next received byte is the length byte of a frame.
+static bool frame_length_next = false;
 
 // =============================================================================
 // Private function declarations
 // =============================================================================
 
 /**
- * @brief Starts transmission of the tx buffer.
+ * @brief Copies bytes into the tx buffer and starts the transmission if the
+ *        DMA is idle.
+ * @details Bytes which do not fit in the tx buffer are dropped.
+ * @param nbr_of_bytes - The number of bytes to send.
+ * @param data - The bytes to send.
+ * @return void
+ */
+static void push_tx(uint16_t nbr_of_bytes, const uint8_t* data);
+
+/**
+ * @brief Starts the DMA on the next segment of the tx buffer, if any.
+ * @details Should be called with the DMA interrupt disabled or from it.
  * @param void
  * @return void
  */
 static void start_tx(void);
 
+/**
+ * @brief Checks if a received byte belongs to a binary frame, and if so puts
+ *        it in the frame receive buffer.
+ * @details Called from the rx interrupt. Only the length byte is looked at,
+ *          the frame is checked by the frame decoder.
+ * @param received - The received byte.
+ * @return True if the byte belongs to a binary frame.
+ */
+static bool receive_frame_byte(uint8_t received);
+
 // =============================================================================
 // Public function definitions
 // =============================================================================
@@ -80,11 +125,16 @@ void uart_init()
         //
         rx_buff_first = 0;
         rx_buff_last = 0;
-        tx_buff_first = 0;
-        tx_buff_last = 0;
-
         rx_buff_size = 0;
+
+        tx_buff_first = 0;
         tx_buff_size = 0;
+        tx_segment_size = 0;
+
+        frame_rx_write_index = 0;
+        frame_rx_read_index = 0;
+        frame_bytes_left = 0;
+        frame_length_next = false;
 
         g_uart_receive_event = false;
 
@@ -113,11 +163,11 @@ void uart_init()
         U1MODEbits.STSEL = 0; // 1 Stop bit
 
         // Interrupt is generated when any character is transfered to the
-        // Transmit Shift Register and the hw transmit buffer is empty.
+        // Transmit Shift Register, so there is room in the hw transmit buffer.
+        // The interrupt triggers the DMA, the CPU is not interrupted.
         U1STAbits.UTXISEL0 = 0;
         U1STAbits.UTXISEL1 = 0;
-        IPC3bits.U1TXIP = 2;  // Interrupt priority
-        IEC0bits.U1TXIE = 1;  // TX interrupt enable
+        IEC0bits.U1TXIE = 0;
 
         // Interrupt is generated each time a data word is transfered from
         // the U1RSR to the receive buffer. There may be one or more characters
@@ -130,6 +180,8 @@ void uart_init()
         U1STAbits.UTXEN = 1;
         U1STAbits.URXEN = 1;
 
+        dma_uart_tx_ch_init();
+
         for (wait_cnt = 0; wait_cnt != FOSC_FREQ / UART_BAUD; ++wait_cnt)
         {
             ;
@@ -141,83 +193,22 @@ void uart_init()
 
 void uart_write(uint8_t data)
 {
-    if ((0 == tx_buff_size) && (0 == U1STAbits.UTXBF))
-    {
-        // hw transmit buffer not full but tx buffer is.
-        U1TXREG = data;
-    }
-    else if (tx_buff_size < BUFFER_SIZE)
-    {
-        if (0 != tx_buff_size)
-        {
-            ++tx_buff_last;
-
-            if (tx_buff_last >= BUFFER_SIZE)
-            {
-                tx_buff_last = 0;
-            }
-        }
-
-        tx_buff[tx_buff_last] = data;
-
-        ++tx_buff_size;
-    }
+    push_tx(1, &data);
 }
 
 void uart_write_string(const char* data)
 {
-    const uint8_t* p = (const uint8_t*)data;
-    
-    // Update the tx buffer.
-    while (*p && (tx_buff_size < BUFFER_SIZE))
-    {
-        if (0 != tx_buff_size)
-        {
-            ++tx_buff_last;
-
-            if (tx_buff_last >= BUFFER_SIZE)
-            {
-                tx_buff_last = 0;
-            }
-        }
-
-        tx_buff[tx_buff_last] = *(p++);
-
-        ++tx_buff_size;
-    }
-
-    start_tx();
+    push_tx(strlen(data), (const uint8_t*)data);
 }
 
 void uart_write_array(uint16_t nbr_of_bytes, const uint8_t* data)
 {
-    uint16_t i;
-
-    // Update the tx buffer.
-    for (i = 0; i != nbr_of_bytes; ++i)
-    {
-        if (tx_buff_size < BUFFER_SIZE)
-        {
-            if (0 != tx_buff_size)
-            {
-                ++tx_buff_last;
-
-                if (tx_buff_last >= BUFFER_SIZE)
-                {
-                    tx_buff_last = 0;
-                }
-            }
-
-            tx_buff[tx_buff_last] = *(data++);
-
-            if (tx_buff_size < BUFFER_SIZE)
-            {
-                ++tx_buff_size;
-            }
-        }
-    }
+    push_tx(nbr_of_bytes, data);
+}
 
-    start_tx();
+uint16_t uart_get_tx_free(void)
+{
+    return BUFFER_SIZE - tx_buff_size;
 }
 
 uint8_t uart_get(uint16_t index)
@@ -262,39 +253,51 @@ void uart_clear_receive_buffer(void)
     IEC0bits.U1RXIE = 1;
 }
 
-
-// =============================================================================
-// Private function definitions
-// =============================================================================
-
-void __attribute__((interrupt, no_auto_psv)) _U1TXInterrupt(void)
+uint16_t uart_read_frame_bytes(uint8_t* dst, uint16_t max_bytes)
 {
-    while ((0 == U1STAbits.UTXBF) && (0 != tx_buff_size))
+    uint16_t write_index = frame_rx_write_index;
+    uint16_t nbr_of_bytes = 0;
+
+    while ((frame_rx_read_index != write_index) && (nbr_of_bytes != max_bytes))
     {
-        // TX fifo not full and there are more things to send
-        U1TXREG = tx_buff[tx_buff_first];
+        dst[nbr_of_bytes++] = frame_rx_buff[frame_rx_read_index];
+        frame_rx_read_index = (frame_rx_read_index + 1) &
+                              (UART_FRAME_RX_BUFF_SIZE - 1);
+    }
 
-        if (1 != tx_buff_size)
-        {
-            ++tx_buff_first;
-        }
+    return nbr_of_bytes;
+}
 
-        if (tx_buff_first >= BUFFER_SIZE)
-        {
-            tx_buff_first = 0;
-        }
+bool uart_has_frame_bytes(void)
+{
+    return frame_rx_read_index != frame_rx_write_index;
+}
+
+void uart_tx_segment_complete(void)
+{
+    tx_buff_first += tx_segment_size;
 
-        --tx_buff_size;
+    if (tx_buff_first >= BUFFER_SIZE)
+    {
+        tx_buff_first -= BUFFER_SIZE;
     }
 
-    IFS0bits.U1TXIF = 0;
+    tx_buff_size -= tx_segment_size;
+
+    start_tx();
 }
 
+
+// =============================================================================
+// Private function definitions
+// =============================================================================
+
 void __attribute__((interrupt, no_auto_psv)) _U1RXInterrupt(void)
 {
     uint8_t received;
+    uint16_t nbr_of_bytes = 0;
 
-    IEC0bits.U1TXIE = 0;
+    TRACE_BEGIN(TRACE_U1RX_ISR, 0, 0);
 
     if (U1STAbits.OERR)
     {
@@ -303,9 +306,15 @@ void __attribute__((interrupt, no_auto_psv)) _U1RXInterrupt(void)
 
     while (U1STAbits.URXDA)
     {
-        g_uart_receive_event = true;
-
         received = U1RXREG;
+        ++nbr_of_bytes;
+
+        if (receive_frame_byte(received))
+        {
+            continue;
+        }
+
+        g_uart_receive_event = true;
 
         if (BACKSPACE_CHAR != received)
         {
@@ -347,35 +356,101 @@ void __attribute__((interrupt, no_auto_psv)) _U1RXInterrupt(void)
 
         uart_write(received);
     }
-    
-    IEC0bits.U1TXIE = 1;
-    
+
     IFS0bits.U1RXIF = 0;
+
+    TRACE_END(TRACE_U1RX_ISR, 0, nbr_of_bytes);
 }
 
-static void start_tx(void)
+static void push_tx(uint16_t nbr_of_bytes, const uint8_t* data)
 {
-    IEC0bits.U1TXIE = 0;
+    uint16_t next;
+
+    // The rx interrupt echoes the received characters
     IEC0bits.U1RXIE = 0;
+    dma_uart_tx_int_disable();
 
-    while ((0 != tx_buff_size) && (0 == U1STAbits.UTXBF))
+    next = tx_buff_first + tx_buff_size;
+
+    if (next >= BUFFER_SIZE)
     {
-        U1TXREG = tx_buff[tx_buff_first];
+        next -= BUFFER_SIZE;
+    }
 
-        if (1 != tx_buff_size)
-        {
-            ++tx_buff_first;
-        }
+    while ((0 != nbr_of_bytes--) && (tx_buff_size < BUFFER_SIZE))
+    {
+        tx_buff[next] = *(data++);
 
-        if (tx_buff_first >= BUFFER_SIZE)
+        if (++next == BUFFER_SIZE)
         {
-            tx_buff_first = 0;
+            next = 0;
         }
 
-        --tx_buff_size;
+        ++tx_buff_size;
+    }
+
+    if (0 == tx_segment_size)
+    {
+        start_tx();
     }
 
-    IEC0bits.U1TXIE = 1;
+    dma_uart_tx_int_enable();
     IEC0bits.U1RXIE = 1;
 }
 
+static void start_tx(void)
+{
+    // The segment ends at the last byte or at the end of the buffer
+    tx_segment_size = BUFFER_SIZE - tx_buff_first;
+
+    if (tx_segment_size > tx_buff_size)
+    {
+        tx_segment_size = tx_buff_size;
+    }
+
+    if (0 != tx_segment_size)
+    {
+        dma_uart_tx_start(&tx_buff[tx_buff_first], tx_segment_size);
+    }
+}
+
+static bool receive_frame_byte(uint8_t received)
+{
+    uint16_t next_index;
+
+    if (frame_length_next)
+    {
+        frame_length_next = false;
+
+        // An invalid length is passed on to the frame decoder, which drops
+        // the frame. The bytes after it are text again.
+        if (received <= FRAME_MAX_PAYLOAD)
+        {
+            frame_bytes_left = received + 2;    // + opcode and CRC
+        }
+    }
+    else if (0 != frame_bytes_left)
+    {
+        --frame_bytes_left;
+    }
+    else if (FRAME_SYNC == received)
+    {
+        frame_length_next = true;
+    }
+    else
+    {
+        return false;
+    }
+
+    next_index = (frame_rx_write_index + 1) & (UART_FRAME_RX_BUFF_SIZE - 1);
+
+    // The byte is dropped if the buffer is full, the frame decoder will then
+    // discard the frame.
+    if (next_index != frame_rx_read_index)
+    {
+        frame_rx_buff[frame_rx_write_index] = received;
+        frame_rx_write_index = next_index;
+    }
+
+    return true;
+}
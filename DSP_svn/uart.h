@@ -5,6 +5,11 @@
  * This file handes UART reads and writes.
  * Writes are buffered asynchronous operations.
  * Reads are also buffered.
+ *
+ * The UART is shared by the text terminal and the binary control protocol
+ * (see control.h). A byte equal to FRAME_SYNC, which never occurs in the
+ * terminal text, starts a binary frame. The bytes of the frame are put in a
+ * separate frame receive buffer and are not echoed.
  */
 
 #ifndef UART_H
@@ -34,10 +39,18 @@
 // This event will be raised every time a character has been received.
 extern volatile bool g_uart_receive_event;
 
+extern const uint32_t UART_BAUD;
+
 // =============================================================================
 // Global constatants
 // =============================================================================
 
+// The size of the frame receive buffer in bytes, must be a power of two.
+#define UART_FRAME_RX_BUFF_SIZE     (128u)
+
+// The number of bits sent per byte: start bit, 8 data bits and stop bit.
+#define UART_BITS_PER_BYTE          (10u)
+
 // =============================================================================
 // Public function declarations
 // =============================================================================
@@ -71,6 +84,14 @@ void uart_write_string(const char* data);
  */
 void uart_write_array(uint16_t nbr_of_bytes, const uint8_t* data);
 
+/**
+ * @brief Gets the free space in the transmit buffer.
+ * @details Bytes which are written when the buffer is full are dropped.
+ * @param void
+ * @return The number of bytes which can be written.
+ */
+uint16_t uart_get_tx_free(void);
+
 /**
  * @brief Gets a byte from the receive buffer.
  * @param index - The index of the byte to get.
@@ -99,6 +120,29 @@ bool uart_is_receive_buffer_empty(void);
  */
 void uart_clear_receive_buffer(void);
 
+/**
+ * @brief Reads received bytes of binary frames.
+ * @param dst - Buffer to copy the bytes to.
+ * @param max_bytes - The maximum number of bytes to read.
+ * @return The number of bytes read.
+ */
+uint16_t uart_read_frame_bytes(uint8_t* dst, uint16_t max_bytes);
+
+/**
+ * @brief Checks if there are received bytes of binary frames.
+ * @param void
+ * @return True if uart_read_frame_bytes has bytes to read.
+ */
+bool uart_has_frame_bytes(void);
+
+/**
+ * @brief Starts sending the next part of the transmit buffer.
+ * @details Called by the DMA interrupt when a transfer has completed.
+ * @param void
+ * @return void
+ */
+void uart_tx_segment_complete(void);
+
 /**
  * @brief Enables the UART receive interrupt.
  * @details This interrupt will affect the transmit and receive buffer.
@@ -117,24 +161,6 @@ static inline void uart_disable_rx_interrupt()
     IEC0bits.U1RXIE = 0;
 }
 
-/**
- * @brief Enables the UART transmit interrupt.
- * @details This interrupt will affect the transmit buffer.
- */
-static inline void uart_enable_tx_interrupt()
-{
-    IEC0bits.U1TXIE = 1;
-}
-
-/**
- * @brief Disables the UART transmit interrupt.
- * @details This interrupt will affect the transmit buffer.
- */
-static inline void uart_disable_tx_interrupt()
-{
-    IEC0bits.U1TXIE = 0;
-}
-
 #ifdef	__cplusplus
 }
 #endif